@@ -0,0 +1,321 @@
+/*
+  CFileWatcher calls a callback when a file changes, i.e to reload hotkeys.json.
+
+  The changes come from a CFileChangeSource: FindFirstChangeNotification() on Windows and
+  inotify on Linux. Both watch the directory of the file, so saving it by writing a new
+  file and renaming it over the old one (as many editors do) is seen too.
+
+  A save is usually several changes (truncate, writes, rename), so the callback is called
+  once the file hasn't changed for the debounce time.
+
+  * Start()
+  -----------
+  bool Start(const std::string &filename, tFileChangedCB cb, void *param, int debounceMs = DefaultDebounceMs);
+  Starts the thread that watches 'filename'. 'cb' is called from that thread with 'param'.
+
+  * Stop()
+  ----------
+  Ends the thread. If the callback is running, it waits for it. The destructor calls Stop().
+*/
+
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <chrono>
+
+#ifdef _WIN32
+//-------------------------------------------------------------------------------------
+CWin32FileChangeSource::CWin32FileChangeSource()
+{
+  m_hChange = INVALID_HANDLE_VALUE;
+  m_hCancel = NULL;
+  m_stamp   = 0;
+}
+
+//-------------------------------------------------------------------------------------
+CWin32FileChangeSource::~CWin32FileChangeSource()
+{
+  Close();
+}
+
+//-------------------------------------------------------------------------------------
+// Last write time and size of the file, 0 if it doesn't exist
+bool CWin32FileChangeSource::GetStamp(uint64_t &stamp)
+{
+  WIN32_FILE_ATTRIBUTE_DATA data;
+
+  if (!::GetFileAttributesExA(m_filename.c_str(), GetFileExInfoStandard, &data))
+  {
+    stamp = 0;
+    return false;
+  }
+
+  stamp = (((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime)
+          ^ (((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+// Watches the directory of the file
+bool CWin32FileChangeSource::Open(const std::string &filename)
+{
+  std::string::size_type slash = filename.find_last_of("\\/");
+  std::string dir = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+
+  Close();
+  m_filename = filename;
+  GetStamp(m_stamp);
+
+  if (!(m_hCancel = ::CreateEvent(NULL, TRUE, FALSE, NULL)))
+    return false;
+
+  m_hChange = ::FindFirstChangeNotificationA(dir.c_str(), FALSE,
+    FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+
+  return m_hChange != INVALID_HANDLE_VALUE;
+}
+
+//-------------------------------------------------------------------------------------
+// The notifications are for the whole directory, so the stamp of the file tells if
+// it was the one that changed
+int CWin32FileChangeSource::Wait(int timeoutMs)
+{
+  HANDLE handles[2] = {(HANDLE)m_hCancel, (HANDLE)m_hChange};
+  ULONGLONG deadline = ::GetTickCount64() + (timeoutMs < 0 ? 0 : timeoutMs);
+
+  for (;;)
+  {
+    DWORD wait = INFINITE;
+    uint64_t stamp;
+
+    if (timeoutMs >= 0)
+    {
+      ULONGLONG now = ::GetTickCount64();
+      wait = now < deadline ? (DWORD)(deadline - now) : 0;
+    }
+
+    switch (::WaitForMultipleObjects(2, handles, FALSE, wait))
+    {
+      case WAIT_OBJECT_0 + 1:
+        ::FindNextChangeNotification((HANDLE)m_hChange);
+        GetStamp(stamp);
+        if (stamp != m_stamp)
+        {
+          m_stamp = stamp;
+          return fwChanged;
+        }
+        break;
+      case WAIT_TIMEOUT:
+        return fwTimeout;
+      default:
+        return fwCanceled;
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------
+void CWin32FileChangeSource::Cancel()
+{
+  if (m_hCancel)
+    ::SetEvent((HANDLE)m_hCancel);
+}
+
+//-------------------------------------------------------------------------------------
+void CWin32FileChangeSource::Close()
+{
+  if (m_hChange != INVALID_HANDLE_VALUE)
+  {
+    ::FindCloseChangeNotification((HANDLE)m_hChange);
+    m_hChange = INVALID_HANDLE_VALUE;
+  }
+
+  if (m_hCancel)
+  {
+    ::CloseHandle((HANDLE)m_hCancel);
+    m_hCancel = NULL;
+  }
+}
+#else
+//-------------------------------------------------------------------------------------
+CInotifyFileChangeSource::CInotifyFileChangeSource()
+{
+  m_fdInotify = m_fdCancel = -1;
+}
+
+//-------------------------------------------------------------------------------------
+CInotifyFileChangeSource::~CInotifyFileChangeSource()
+{
+  Close();
+}
+
+//-------------------------------------------------------------------------------------
+// Watches the directory of the file
+bool CInotifyFileChangeSource::Open(const std::string &filename)
+{
+  std::string::size_type slash = filename.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+
+  Close();
+  m_name = slash == std::string::npos ? filename : filename.substr(slash + 1);
+
+  if ((m_fdInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0 ||
+      (m_fdCancel = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    return false;
+
+  return inotify_add_watch(m_fdInotify, dir.c_str(),
+    IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM) >= 0;
+}
+
+//-------------------------------------------------------------------------------------
+// Reads the events of the directory until one is about the file
+int CInotifyFileChangeSource::Wait(int timeoutMs)
+{
+  typedef std::chrono::steady_clock tClock;
+  tClock::time_point deadline = tClock::now() + std::chrono::milliseconds(timeoutMs < 0 ? 0 : timeoutMs);
+
+  for (;;)
+  {
+    struct pollfd pfd[2];
+    int wait = -1;
+
+    if (timeoutMs >= 0)
+    {
+      long long left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - tClock::now()).count();
+      wait = left > 0 ? (int)left : 0;
+    }
+
+    pfd[0].fd = m_fdCancel;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = m_fdInotify;
+    pfd[1].events = POLLIN;
+
+    int rc = poll(pfd, 2, wait);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    if (rc < 0 || pfd[0].revents)
+      return fwCanceled;
+    if (rc == 0)
+      return fwTimeout;
+
+    // struct inotify_event is followed by its name
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool bChanged = false;
+    ssize_t len;
+
+    while ((len = read(m_fdInotify, buffer, sizeof(buffer))) > 0)
+    {
+      for (char *ptr = buffer; ptr < buffer + len; )
+      {
+        const struct inotify_event *event = (const struct inotify_event *)ptr;
+
+        if (event->len && m_name == event->name)
+          bChanged = true;
+        ptr += sizeof(struct inotify_event) + event->len;
+      }
+    }
+
+    if (bChanged)
+      return fwChanged;
+  }
+}
+
+//-------------------------------------------------------------------------------------
+void CInotifyFileChangeSource::Cancel()
+{
+  uint64_t one = 1;
+
+  // it can only fail if the counter is already set
+  if (m_fdCancel >= 0)
+    (void)!write(m_fdCancel, &one, sizeof(one));
+}
+
+//-------------------------------------------------------------------------------------
+void CInotifyFileChangeSource::Close()
+{
+  if (m_fdInotify >= 0)
+    close(m_fdInotify);
+  if (m_fdCancel >= 0)
+    close(m_fdCancel);
+  m_fdInotify = m_fdCancel = -1;
+}
+#endif
+
+//-------------------------------------------------------------------------------------
+// Initializes internal variables
+CFileWatcher::CFileWatcher(CFileChangeSource *source)
+{
+  m_source     = source ? source : &m_nativeSource;
+  m_callback   = NULL;
+  m_param      = NULL;
+  m_debounceMs = DefaultDebounceMs;
+}
+
+//-------------------------------------------------------------------------------------
+CFileWatcher::~CFileWatcher()
+{
+  Stop();
+}
+
+//-------------------------------------------------------------------------------------
+// Opens the source and starts the watch thread
+bool CFileWatcher::Start(const std::string &filename, tFileChangedCB cb, void *param, int debounceMs)
+{
+  // already started ?
+  if (m_thread.joinable())
+    return true;
+
+  if (!m_source->Open(filename))
+  {
+    m_source->Close();
+    return false;
+  }
+
+  m_callback   = cb;
+  m_param      = param;
+  m_debounceMs = debounceMs;
+  m_thread     = std::thread(WatchLoop, this);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+void CFileWatcher::Stop()
+{
+  if (!m_thread.joinable())
+    return;
+
+  m_source->Cancel();
+  m_thread.join();
+  m_source->Close();
+}
+
+//-------------------------------------------------------------------------------------
+// Watch thread: waits for a change, then until there are no more changes for the
+// debounce time, and calls the callback
+void CFileWatcher::WatchLoop(CFileWatcher *_this)
+{
+  int rc;
+
+  for (;;)
+  {
+    if (_this->m_source->Wait(-1) != CFileChangeSource::fwChanged)
+      return;
+
+    while ((rc = _this->m_source->Wait(_this->m_debounceMs)) == CFileChangeSource::fwChanged)
+      ;
+
+    if (rc == CFileChangeSource::fwCanceled)
+      return;
+
+    if (_this->m_callback)
+      _this->m_callback(_this->m_param);
+  }
+}
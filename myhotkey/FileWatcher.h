@@ -0,0 +1,113 @@
+#ifndef __FILEWATCHER__INC_
+#define __FILEWATCHER__INC_
+
+/*
+ -----------------------------------------------------------------------------
+ Check implementation file for usage info.
+ -----------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+//-------------------------------------------------------------------------------------
+// Notifies the changes of a file. CNativeFileChangeSource is the one of the platform:
+// FindFirstChangeNotification() on Windows and inotify on Linux.
+class CFileChangeSource
+{
+public:
+  //FileWatcherXXXX
+  enum {fwChanged = 0, // the file changed
+        fwTimeout, // no change before the timeout
+        fwCanceled // Cancel() was called, or error
+       };
+
+  virtual ~CFileChangeSource() {}
+
+  // Starts watching 'filename', returns false on error
+  virtual bool Open(const std::string &filename) = 0;
+
+  // Waits up to 'timeoutMs' (-1 for ever) for a change, returns a fwXXXX code
+  virtual int Wait(int timeoutMs) = 0;
+
+  // Makes Wait() return fwCanceled, it may be called from any thread
+  virtual void Cancel() = 0;
+
+  virtual void Close() = 0;
+};
+
+#ifdef _WIN32
+class CWin32FileChangeSource : public CFileChangeSource
+{
+public:
+  CWin32FileChangeSource();
+  ~CWin32FileChangeSource();
+  bool Open(const std::string &filename);
+  int Wait(int timeoutMs);
+  void Cancel();
+  void Close();
+
+private:
+  bool GetStamp(uint64_t &stamp);
+
+  std::string m_filename;
+  void *m_hChange; // HANDLEs
+  void *m_hCancel;
+  uint64_t m_stamp; // last write time and size, to skip the changes of other files
+};
+
+typedef CWin32FileChangeSource CNativeFileChangeSource;
+#else
+class CInotifyFileChangeSource : public CFileChangeSource
+{
+public:
+  CInotifyFileChangeSource();
+  ~CInotifyFileChangeSource();
+  bool Open(const std::string &filename);
+  int Wait(int timeoutMs);
+  void Cancel();
+  void Close();
+
+private:
+  std::string m_name; // without directory
+  int m_fdInotify;
+  int m_fdCancel; // eventfd
+};
+
+typedef CInotifyFileChangeSource CNativeFileChangeSource;
+#endif
+
+//-------------------------------------------------------------------------------------
+// Calls a callback from its own thread when a file changes, once the changes stop
+class CFileWatcher
+{
+public:
+  // on change callback
+  typedef void (*tFileChangedCB)(void *);
+
+  enum {DefaultDebounceMs = 300};
+
+  // 'source' is the native one if NULL
+  CFileWatcher(CFileChangeSource *source = NULL);
+  ~CFileWatcher();
+
+  // Watches 'filename' and calls 'cb' with 'param' when it changes and then doesn't change
+  // for 'debounceMs'. Returns false on error.
+  bool Start(const std::string &filename, tFileChangedCB cb, void *param, int debounceMs = DefaultDebounceMs);
+
+  // Waits for the thread to end, and for the callback if it's running
+  void Stop();
+
+private:
+  static void WatchLoop(CFileWatcher *_this);
+
+  CNativeFileChangeSource m_nativeSource;
+  CFileChangeSource *m_source;
+  std::thread m_thread;
+  tFileChangedCB m_callback;
+  void *m_param;
+  int m_debounceMs;
+};
+
+#endif
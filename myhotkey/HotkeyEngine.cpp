@@ -0,0 +1,428 @@
+/*
+  CHotkeyEngine is the platform neutral part of CHotkeyHandler(): it keeps the hotkey
+  definitions and calls their callbacks when their events arrive. The events come
+  from a CHotkeyEventSource, so the engine doesn't depend on the Windows APIs.
+
+  Definitions are looked up by mod&virt (on insertion) and by registration id (on
+  every event) through hash indexes, and deleted entries are recycled from a free
+  list, so inserting N hotkeys is O(N) and dispatching an event is O(1).
+
+  * InsertHandler()
+  --------------------
+  int InsertHandler(uint16_t mod, uint16_t virt, tHotkeyCB cb, const std::string &param, int &index);
+  'index' will be filled by the index of where the hotkey is stored (0 based).
+  If you attempt to insert a hotkey that already exists then 'index' will be the index value
+  of that previously inserted hotkey.
+  The callback is called with param.c_str().
+
+  * RemoveHandler()
+  --------------------
+  int RemoveHandler(const int index);
+  Removes a hotkey definition. Its index may be returned by a later InsertHandler().
+  This function has effects only when called before EnableAll() or after DisableAll().
+
+  * EnableAll() / DisableAll()
+  ------------------------------
+  Registers or unregisters all definitions into a source. If a registration fails,
+  the ones registered so far are unregistered.
+
+  * Dispatch() / Run()
+  ----------------------
+  Dispatch() calls the callback of the definition of a registration id. Run() dispatches
+  the events of a source until WaitEvent() returns false.
+
+  * SetExecutor()
+  -----------------
+  void SetExecutor(CHotkeyExecutor *executor);
+  When set, Dispatch() submits the callbacks to 'executor' and returns without waiting
+  for them (see HotkeyExecutor.cpp).
+
+  * Diff() / Apply() / Reload()
+  -------------------------------
+  void Diff(const std::vector<tHotkeyBinding> &bindings, std::vector<tHotkeyChange> &changes) const;
+  int Apply(CHotkeyEventSource &source, const std::vector<tHotkeyChange> &changes);
+  Diff() compares the definitions with a new table of bindings: the mod&virt that are only
+  in the definitions are removed, the ones that are only in the table are added, and the
+  ones whose callback or param differ are changed. Apply() makes the changes while enabled:
+  removed hotkeys are unregistered and added ones are registered, but changed and unchanged
+  hotkeys keep their registration. If an added hotkey can't be registered, it's kept
+  unregistered and the error is returned after the other changes are applied; every later
+  Apply() tries to register it again, even without changes.
+  Reload() is Diff() followed by Apply().
+
+  * PostReload() / ApplyPending()
+  ---------------------------------
+  PostReload() hands a table to the thread of Run(), that reloads it between two events
+  and wakes up the source for that. Events that arrive meanwhile wait in the source, so
+  none is dropped. ApplyPending() reloads the posted table at once, i.e before EnableAll().
+*/
+
+#include "HotkeyEngine.h"
+
+//-------------------------------------------------------------------------------------
+// Initializes internal variables
+CHotkeyEngine::CHotkeyEngine()
+{
+  m_executor = NULL;
+  m_bEnabled = false;
+  m_bPending = false;
+}
+
+//-------------------------------------------------------------------------------------
+// Key of m_indexByKey
+uint32_t CHotkeyEngine::MakeKey(uint16_t mod, uint16_t virt)
+{
+  return ((uint32_t)mod << 16) | virt;
+}
+
+//-------------------------------------------------------------------------------------
+// Inserts a hotkey into the list
+// Returns into 'idx' the index of where the definition is added
+// You may use the returned idx to modify/delete this definition
+int CHotkeyEngine::InsertHandler(uint16_t mod, uint16_t virt, tHotkeyCB cb, const std::string &param, int &idx)
+{
+  tHotkeyDef *def;
+
+  // already inserted ?
+  if (FindHandler(mod, virt, idx) == CHotkeyEventSource::hkheOk)
+    return CHotkeyEventSource::hkheOk;
+
+  // Try to use a deleted entry, otherwise add a new one
+  if (!m_listFree.empty())
+  {
+    idx = m_listFree.back();
+    m_listFree.pop_back();
+    m_listHk[idx].serial++;
+  }
+  else
+  {
+    idx = (int)m_listHk.size();
+    m_listHk.push_back(tHotkeyDef());
+    m_listHk[idx].serial = 0;
+  }
+
+  def = &m_listHk[idx];
+  def->mod = mod;
+  def->virt = virt;
+  def->callback = cb;
+  def->id = 0;
+  def->param = param;
+  def->deleted = false;
+
+  m_indexByKey[MakeKey(mod, virt)] = idx;
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// removes a disabled hotkey from the internal list
+int CHotkeyEngine::RemoveHandler(const int index)
+{
+  // index out of range or already removed ?
+  if (index < 0 || m_listHk.size() <= (size_t)index || m_listHk[index].deleted)
+    return CHotkeyEventSource::hkheNoEntry;
+
+  tHotkeyDef *def = &m_listHk[index];
+
+  // mark handler as deleted
+  def->deleted = true;
+  def->param.clear();
+  m_indexByKey.erase(MakeKey(def->mod, def->virt));
+  if (def->id)
+  {
+    m_indexById.erase(def->id);
+    def->id = 0;
+  }
+
+  m_listFree.push_back(index);
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// Finds a hotkeydef given it's modifier 'mod' and virtual key 'virt'
+// If return value is hkheOk then 'idx' is filled with the found index
+// Otherwise 'idx' is left untouched.
+int CHotkeyEngine::FindHandler(uint16_t mod, uint16_t virt, int &idx) const
+{
+  tHotkeyIndex::const_iterator it = m_indexByKey.find(MakeKey(mod, virt));
+
+  if (it == m_indexByKey.end())
+    return CHotkeyEventSource::hkheNoEntry;
+
+  idx = it->second;
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// Locates an enabled hotkey definition given its registration id
+int CHotkeyEngine::FindHandlerById(uint32_t id, const tHotkeyDef *&def) const
+{
+  tHotkeyIndex::const_iterator it = m_indexById.find(id);
+
+  if (it == m_indexById.end())
+    return CHotkeyEventSource::hkheNoEntry;
+
+  def = &m_listHk[it->second];
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// Registers all hotkeys into 'source'
+int CHotkeyEngine::EnableAll(CHotkeyEventSource &source)
+{
+  int rc;
+
+  for (size_t i=0; i < m_listHk.size(); i++)
+  {
+    tHotkeyDef *def = &m_listHk[i];
+
+    // skip deleted entry
+    if (def->deleted || def->id)
+      continue;
+
+    // try to register
+    if ((rc = source.Register(def->mod, def->virt, def->id)) != CHotkeyEventSource::hkheOk)
+    {
+      def->id = 0;
+
+      // disable hotkeys enabled so far
+      DisableAll(source);
+      return rc;
+    }
+
+    m_indexById[def->id] = (int)i;
+  }
+
+  m_bEnabled = true;
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// Unregisters all enabled hotkeys from 'source'
+void CHotkeyEngine::DisableAll(CHotkeyEventSource &source)
+{
+  for (size_t i=0; i < m_listHk.size(); i++)
+  {
+    tHotkeyDef *def = &m_listHk[i];
+
+    if (def->deleted || !def->id)
+      continue;
+
+    source.Unregister(def->id);
+    def->id = 0;
+  }
+
+  m_indexById.clear();
+  m_bEnabled = false;
+}
+
+//-------------------------------------------------------------------------------------
+// Calls the handler of the hotkey registered as 'id'
+int CHotkeyEngine::Dispatch(uint32_t id)
+{
+  tHotkeyIndex::const_iterator it = m_indexById.find(id);
+
+  if (it == m_indexById.end())
+    return CHotkeyEventSource::hkheNoEntry;
+
+  const tHotkeyDef *def = &m_listHk[it->second];
+
+  if (m_executor)
+    m_executor->Submit(it->second, def->serial, def->callback, def->param);
+  else if (def->callback)
+    def->callback((void *)def->param.c_str());
+
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+void CHotkeyEngine::SetExecutor(CHotkeyExecutor *executor)
+{
+  m_executor = executor;
+}
+
+//-------------------------------------------------------------------------------------
+// Dispatch loop, it returns when 'source' is stopped
+int CHotkeyEngine::Run(CHotkeyEventSource &source)
+{
+  uint32_t id;
+
+  while (source.WaitEvent(id))
+  {
+    ApplyPending(source);
+
+    // 0 when woken up
+    if (id)
+      Dispatch(id);
+  }
+
+  return CHotkeyEventSource::hkheOk;
+}
+
+//-------------------------------------------------------------------------------------
+// Compares the definitions with 'bindings'
+void CHotkeyEngine::Diff(const std::vector<tHotkeyBinding> &bindings, std::vector<tHotkeyChange> &changes) const
+{
+  std::unordered_map<uint32_t, size_t> indexWanted;
+  tHotkeyChange change;
+
+  changes.clear();
+
+  // first binding of each mod&virt
+  for (size_t i=0; i < bindings.size(); i++)
+    indexWanted.insert(std::make_pair(MakeKey(bindings[i].mod, bindings[i].virt), i));
+
+  // removed or changed definitions
+  for (size_t i=0; i < m_listHk.size(); i++)
+  {
+    const tHotkeyDef *def = &m_listHk[i];
+
+    if (def->deleted)
+      continue;
+
+    std::unordered_map<uint32_t, size_t>::const_iterator it = indexWanted.find(MakeKey(def->mod, def->virt));
+    change.index = (int)i;
+
+    if (it == indexWanted.end())
+    {
+      change.action = hkcRemove;
+      change.binding = tHotkeyBinding();
+      changes.push_back(change);
+    }
+    else if (bindings[it->second].callback != def->callback || bindings[it->second].param != def->param)
+    {
+      change.action = hkcChange;
+      change.binding = bindings[it->second];
+      changes.push_back(change);
+    }
+  }
+
+  // added definitions, in the order of 'bindings'
+  for (size_t i=0; i < bindings.size(); i++)
+  {
+    uint32_t key = MakeKey(bindings[i].mod, bindings[i].virt);
+
+    if (m_indexByKey.count(key) || indexWanted[key] != i)
+      continue;
+
+    change.action = hkcAdd;
+    change.index = -1;
+    change.binding = bindings[i];
+    changes.push_back(change);
+  }
+}
+
+//-------------------------------------------------------------------------------------
+// Applies the changes of Diff(). The removals come first so their keys can be added again.
+int CHotkeyEngine::Apply(CHotkeyEventSource &source, const std::vector<tHotkeyChange> &changes)
+{
+  int rc = CHotkeyEventSource::hkheOk, err, idx;
+
+  for (size_t i=0; i < changes.size(); i++)
+  {
+    const tHotkeyChange *change = &changes[i];
+    tHotkeyDef *def;
+
+    switch (change->action)
+    {
+      case hkcRemove:
+        def = &m_listHk[change->index];
+        if (def->id)
+          source.Unregister(def->id);
+        RemoveHandler(change->index);
+        break;
+      case hkcChange:
+        // same registration, only what it calls; a press of the old binding that is
+        // still pending in the executor is not merged with the new one
+        def = &m_listHk[change->index];
+        def->serial++;
+        def->callback = change->binding.callback;
+        def->param = change->binding.param;
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (size_t i=0; i < changes.size(); i++)
+  {
+    const tHotkeyBinding *binding = &changes[i].binding;
+
+    if (changes[i].action == hkcAdd)
+      InsertHandler(binding->mod, binding->virt, binding->callback, binding->param, idx);
+  }
+
+  if (!m_bEnabled)
+    return rc;
+
+  // the added definitions and the ones that failed to register before (i.e their key was
+  // taken by another application) are registered
+  for (size_t i=0; i < m_listHk.size(); i++)
+  {
+    tHotkeyDef *def = &m_listHk[i];
+
+    if (def->deleted || def->id)
+      continue;
+
+    if ((err = source.Register(def->mod, def->virt, def->id)) != CHotkeyEventSource::hkheOk)
+    {
+      def->id = 0;
+      if (rc == CHotkeyEventSource::hkheOk)
+        rc = err;
+      continue;
+    }
+    m_indexById[def->id] = (int)i;
+  }
+
+  return rc;
+}
+
+//-------------------------------------------------------------------------------------
+int CHotkeyEngine::Reload(CHotkeyEventSource &source, const std::vector<tHotkeyBinding> &bindings)
+{
+  std::vector<tHotkeyChange> changes;
+
+  Diff(bindings, changes);
+  return Apply(source, changes);
+}
+
+//-------------------------------------------------------------------------------------
+// Hands 'bindings' to the thread of Run()
+void CHotkeyEngine::PostReload(CHotkeyEventSource &source, const std::vector<tHotkeyBinding> &bindings)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lockPending);
+    m_listPending = bindings;
+    m_bPending = true;
+  }
+  source.Wake();
+}
+
+//-------------------------------------------------------------------------------------
+// Reloads the table of PostReload(), if any
+int CHotkeyEngine::ApplyPending(CHotkeyEventSource &source)
+{
+  std::vector<tHotkeyBinding> bindings;
+
+  if (!m_bPending)
+    return CHotkeyEventSource::hkheOk;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lockPending);
+    bindings.swap(m_listPending);
+    m_bPending = false;
+  }
+
+  return Reload(source, bindings);
+}
+
+//-------------------------------------------------------------------------------------
+size_t CHotkeyEngine::Count() const
+{
+  return m_listHk.size() - m_listFree.size();
+}
+
+//-------------------------------------------------------------------------------------
+bool CHotkeyEngine::Empty() const
+{
+  return Count() == 0;
+}
@@ -0,0 +1,173 @@
+#ifndef __HOTKEYENGINE__INC_
+#define __HOTKEYENGINE__INC_
+
+/*
+ -----------------------------------------------------------------------------
+ Check implementation file for usage info.
+ -----------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include "HotkeyExecutor.h"
+
+//-------------------------------------------------------------------------------------
+// Delivers hotkey events to the engine. It's the only part that depends on the
+// platform: CHotkeyHandler implements it with RegisterHotKey() and its message loop,
+// and other sources (i.e replays of recorded events) let the engine run anywhere.
+class CHotkeyEventSource
+{
+public:
+  //HotKeyHandlerErrorsXXXX
+  enum {hkheOk = 0,  // success
+        hkheClassError, // window class registration error
+        hkheWindowError, // window creation error
+        hkheNoEntry, // No handler found at given index
+        hkheRegHotkeyError, // could not register hotkey
+        hkheMessageLoop, // could not create message loop thread
+        hkheInternal // Internal error
+       };
+
+  virtual ~CHotkeyEventSource() {}
+
+  // Starts listening mod+virt, 'id' is filled with the id its events will carry (never 0)
+  virtual int Register(uint16_t mod, uint16_t virt, uint32_t &id) = 0;
+
+  // Stops listening a registered id
+  virtual void Unregister(uint32_t id) = 0;
+
+  // Waits for the next hotkey event and fills 'id' with its registration id, or with 0
+  // when it's woken by Wake(). Returns false when the source is stopped.
+  virtual bool WaitEvent(uint32_t &id) = 0;
+
+  // Makes WaitEvent() return from another thread. Without it, posted changes are
+  // applied on the next event.
+  virtual void Wake() {}
+};
+
+//-------------------------------------------------------------------------------------
+// Binding table and dispatch of hotkeys
+class CHotkeyEngine
+{
+public:
+  // on hotkey occurence callback
+  typedef void (*tHotkeyCB)(void *);
+
+  // hotkey definition
+  typedef struct
+  {
+    uint16_t mod;
+    uint16_t virt;
+    tHotkeyCB callback;
+    uint32_t id; // registration id while enabled, 0 otherwise
+    std::string param;
+    bool deleted;
+    uint32_t serial; // generation of the entry, incremented when it's recycled
+  } tHotkeyDef;
+
+  // hotkey definition of a table to reload
+  typedef struct
+  {
+    uint16_t mod;
+    uint16_t virt;
+    tHotkeyCB callback;
+    std::string param;
+  } tHotkeyBinding;
+
+  //HotkeyChangeXXXX
+  enum {hkcAdd = 0, hkcRemove, hkcChange};
+
+  // a difference between the definitions and a table
+  typedef struct
+  {
+    int action; // hkcXXXX
+    int index; // of the definition, for hkcRemove and hkcChange
+    tHotkeyBinding binding; // for hkcAdd and hkcChange
+  } tHotkeyChange;
+
+  CHotkeyEngine();
+
+  // Inserts a hotkey definition
+  int InsertHandler(uint16_t mod, uint16_t virt, tHotkeyCB cb, const std::string &param, int &index);
+
+  // Removes a hotkey definition
+  int RemoveHandler(const int index);
+
+  // Finds the index of an inserted hotkey definition by mod&virt
+  int FindHandler(uint16_t mod, uint16_t virt, int &index) const;
+
+  // Finds the definition of an enabled hotkey by its registration id
+  int FindHandlerById(uint32_t id, const tHotkeyDef *&def) const;
+
+  // Registers all definitions into 'source'
+  int EnableAll(CHotkeyEventSource &source);
+
+  // Unregisters all definitions from 'source'
+  void DisableAll(CHotkeyEventSource &source);
+
+  // Calls the callback of the hotkey registered with 'id', or submits it to the executor
+  int Dispatch(uint32_t id);
+
+  // Callbacks are submitted to 'executor' instead of being called by Dispatch(), NULL to call them
+  void SetExecutor(CHotkeyExecutor *executor);
+
+  // Dispatches the events of 'source' until it's stopped
+  int Run(CHotkeyEventSource &source);
+
+  // Computes the changes that turn the definitions into 'bindings'. When a mod&virt is
+  // repeated in 'bindings' the first one is taken, as InsertHandler() does.
+  void Diff(const std::vector<tHotkeyBinding> &bindings, std::vector<tHotkeyChange> &changes) const;
+
+  // Applies changes of Diff(), registering the added definitions into 'source' if enabled,
+  // and the ones that couldn't be registered before
+  int Apply(CHotkeyEventSource &source, const std::vector<tHotkeyChange> &changes);
+
+  // Diff() and Apply()
+  int Reload(CHotkeyEventSource &source, const std::vector<tHotkeyBinding> &bindings);
+
+  // Reloads 'bindings' from the thread of Run(), between two events. It may be called from
+  // any thread; a newer table replaces a pending one.
+  void PostReload(CHotkeyEventSource &source, const std::vector<tHotkeyBinding> &bindings);
+
+  // Reloads the posted table, if any
+  int ApplyPending(CHotkeyEventSource &source);
+
+  // number of definitions that are not deleted
+  size_t Count() const;
+
+  bool Empty() const;
+
+private:
+  typedef std::vector<tHotkeyDef> tHotkeyList;
+  typedef std::unordered_map<uint32_t, int> tHotkeyIndex;
+
+  // hotkey list, deleted entries are kept so indexes don't change
+  tHotkeyList m_listHk;
+
+  // deleted entries to recycle
+  std::vector<int> m_listFree;
+
+  // index of m_listHk by mod&virt
+  tHotkeyIndex m_indexByKey;
+
+  // index of m_listHk by registration id
+  tHotkeyIndex m_indexById;
+
+  CHotkeyExecutor *m_executor;
+
+  // registered by EnableAll()
+  bool m_bEnabled;
+
+  // table of PostReload()
+  std::mutex m_lockPending;
+  std::vector<tHotkeyBinding> m_listPending;
+  std::atomic<bool> m_bPending;
+
+  static uint32_t MakeKey(uint16_t mod, uint16_t virt);
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*
+  CHotkeyExecutor runs the callbacks of the hotkeys out of the thread that receives them,
+  so a slow callback (i.e one that waits for a process) doesn't stall the other hotkeys.
+
+  There are a fixed number of worker threads and a slot per binding: a binding runs in
+  one worker at a time, and the presses of a binding that arrive while it's pending or
+  running are coalesced into one pending press, so the queue can't grow beyond the number
+  of bindings. A binding is its index and the generation of that index, so the press of a
+  hotkey that took the index of a removed one isn't merged into a press of the old one.
+
+  * Constructor
+  ---------------
+  CHotkeyExecutor(size_t nWorkers = DefaultWorkers);
+  'nWorkers' is the number of worker threads (1 at least).
+
+  * Start() / Stop()
+  --------------------
+  Start() creates the workers. Stop() waits for the running callbacks and ends the workers,
+  the pending presses are dropped. The destructor calls Stop().
+
+  * Submit()
+  ------------
+  void Submit(int index, uint32_t serial, tHotkeyCB cb, const std::string &param);
+  Enqueues a press of the binding 'index' and returns. 'serial' must change when the index
+  is given to another binding (see CHotkeyEngine::tHotkeyDef). 'cb' will be called with param.c_str()
+  in a worker.
+
+  * Drain()
+  -----------
+  Waits until all the submitted presses have run. It returns at once if not started.
+
+  * GetStats()
+  --------------
+  Copies the counters: presses submitted, coalesced and executed, the number of bindings
+  waiting for a worker (and its max), and the time the presses waited for a worker.
+*/
+
+#include "HotkeyExecutor.h"
+
+//-------------------------------------------------------------------------------------
+// Initializes internal variables
+CHotkeyExecutor::CHotkeyExecutor(size_t nWorkers)
+{
+  m_nWorkers = nWorkers ? nWorkers : 1;
+  m_bStop    = false;
+  m_nRunning = 0;
+  m_stats    = tStats();
+}
+
+//-------------------------------------------------------------------------------------
+CHotkeyExecutor::~CHotkeyExecutor()
+{
+  Stop();
+}
+
+//-------------------------------------------------------------------------------------
+// Key of m_mapBindings
+uint64_t CHotkeyExecutor::MakeKey(int index, uint32_t serial)
+{
+  return ((uint64_t)serial << 32) | (uint32_t)index;
+}
+
+//-------------------------------------------------------------------------------------
+// Creates the worker threads
+void CHotkeyExecutor::Start()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (!m_listWorkers.empty())
+    return;
+
+  m_bStop = false;
+  for (size_t i=0; i < m_nWorkers; i++)
+    m_listWorkers.push_back(std::thread(Worker, this));
+}
+
+//-------------------------------------------------------------------------------------
+// Ends the worker threads once their callbacks return and drops the pending presses
+void CHotkeyExecutor::Stop()
+{
+  std::vector<std::thread> listWorkers;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_bStop = true;
+    listWorkers.swap(m_listWorkers);
+  }
+  m_cvReady.notify_all();
+
+  for (size_t i=0; i < listWorkers.size(); i++)
+    listWorkers[i].join();
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_mapBindings.clear();
+  m_queueReady.clear();
+  m_stats.depth = 0;
+  m_bStop = false;
+  m_cvIdle.notify_all();
+}
+
+//-------------------------------------------------------------------------------------
+// Enqueues a press, or merges it into the pending one of its binding
+void CHotkeyExecutor::Submit(int index, uint32_t serial, tHotkeyCB cb, const std::string &param)
+{
+  if (index < 0)
+    return;
+
+  uint64_t key = MakeKey(index, serial);
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  std::pair<tBindingMap::iterator, bool> inserted = m_mapBindings.insert(std::make_pair(key, tBinding()));
+  tBinding *b = &inserted.first->second;
+
+  if (inserted.second)
+  {
+    b->running = b->pending = false;
+    b->callback = NULL;
+  }
+
+  m_stats.submitted++;
+
+  // already waiting ? the pending press will serve this one too
+  if (b->pending)
+  {
+    m_stats.coalesced++;
+    return;
+  }
+
+  b->pending    = true;
+  b->callback   = cb;
+  b->param      = param;
+  b->submitTime = tClock::now();
+
+  if (++m_stats.depth > m_stats.maxDepth)
+    m_stats.maxDepth = m_stats.depth;
+
+  // a running binding requeues itself when its callback returns
+  if (b->running)
+    return;
+
+  m_queueReady.push_back(key);
+  guard.unlock();
+  m_cvReady.notify_one();
+}
+
+//-------------------------------------------------------------------------------------
+// Waits until the queue is empty and no callback runs
+void CHotkeyExecutor::Drain()
+{
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (!m_listWorkers.empty() && (!m_queueReady.empty() || m_nRunning))
+    m_cvIdle.wait(guard);
+}
+
+//-------------------------------------------------------------------------------------
+void CHotkeyExecutor::GetStats(tStats &stats)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  stats = m_stats;
+}
+
+//-------------------------------------------------------------------------------------
+// Worker thread: runs the callbacks of the ready bindings until Stop()
+void CHotkeyExecutor::Worker(CHotkeyExecutor *_this)
+{
+  std::unique_lock<std::mutex> guard(_this->m_lock);
+
+  for (;;)
+  {
+    while (!_this->m_bStop && _this->m_queueReady.empty())
+      _this->m_cvReady.wait(guard);
+
+    if (_this->m_bStop)
+      return;
+
+    uint64_t key = _this->m_queueReady.front();
+    _this->m_queueReady.pop_front();
+
+    tBinding *b = &_this->m_mapBindings[key];
+    tHotkeyCB callback = b->callback;
+    std::string param = b->param;
+
+    uint64_t waitUs = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(
+                        tClock::now() - b->submitTime).count();
+
+    b->pending = false;
+    b->running = true;
+    _this->m_stats.depth--;
+    _this->m_stats.waitTotalUs += waitUs;
+    if (waitUs > _this->m_stats.waitMaxUs)
+      _this->m_stats.waitMaxUs = waitUs;
+    _this->m_nRunning++;
+
+    guard.unlock();
+    if (callback)
+      callback((void *)param.c_str());
+    guard.lock();
+
+    // elements of m_mapBindings aren't moved by the insertions of Submit()
+    b->running = false;
+    _this->m_nRunning--;
+    _this->m_stats.executed++;
+
+    // pressed again while running ?
+    if (b->pending)
+    {
+      _this->m_queueReady.push_back(key);
+      _this->m_cvReady.notify_one();
+      continue;
+    }
+
+    _this->m_mapBindings.erase(key);
+    if (_this->m_queueReady.empty() && !_this->m_nRunning)
+      _this->m_cvIdle.notify_all();
+  }
+}
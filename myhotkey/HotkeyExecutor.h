@@ -0,0 +1,100 @@
+#ifndef __HOTKEYEXECUTOR__INC_
+#define __HOTKEYEXECUTOR__INC_
+
+/*
+ -----------------------------------------------------------------------------
+ Check implementation file for usage info.
+ -----------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+//-------------------------------------------------------------------------------------
+// Runs the hotkey callbacks in a pool of worker threads, so the thread that receives
+// the hotkeys only enqueues them
+class CHotkeyExecutor
+{
+public:
+  // on hotkey occurence callback
+  typedef void (*tHotkeyCB)(void *);
+
+  enum {DefaultWorkers = 2};
+
+  // counters
+  typedef struct
+  {
+    uint64_t submitted; // presses received by Submit()
+    uint64_t coalesced; // presses merged into a pending one of the same binding
+    uint64_t executed; // callbacks run
+    size_t depth; // bindings waiting for a worker now
+    size_t maxDepth; // max of depth
+    uint64_t waitTotalUs; // time from Submit() to the start of the callback, sum and max
+    uint64_t waitMaxUs;
+  } tStats;
+
+  CHotkeyExecutor(size_t nWorkers = DefaultWorkers);
+  ~CHotkeyExecutor();
+
+  // Starts the workers, if not started
+  void Start();
+
+  // Waits for the running callbacks and stops the workers, the pending ones are dropped
+  void Stop();
+
+  // Enqueues a press of the binding 'index' of generation 'serial'. 'param' is copied and
+  // passed to 'cb' as c_str()
+  void Submit(int index, uint32_t serial, tHotkeyCB cb, const std::string &param);
+
+  // Waits until there isn't anything pending or running
+  void Drain();
+
+  void GetStats(tStats &stats);
+
+private:
+  typedef std::chrono::steady_clock tClock;
+
+  // state of a binding
+  typedef struct
+  {
+    bool running;
+    bool pending; // a press waits, either in m_queueReady or for 'running' to end
+    tHotkeyCB callback;
+    std::string param;
+    tClock::time_point submitTime;
+  } tBinding;
+
+  static void Worker(CHotkeyExecutor *_this);
+
+  static uint64_t MakeKey(int index, uint32_t serial);
+
+  size_t m_nWorkers;
+  std::vector<std::thread> m_listWorkers;
+  bool m_bStop;
+
+  typedef std::unordered_map<uint64_t, tBinding> tBindingMap;
+
+  // bindings that are pending or running, by MakeKey()
+  tBindingMap m_mapBindings;
+
+  // bindings with a pending press that aren't running, in order of arrival
+  std::deque<uint64_t> m_queueReady;
+
+  // callbacks running now
+  size_t m_nRunning;
+
+  tStats m_stats;
+
+  std::mutex m_lock;
+  std::condition_variable m_cvReady;
+  std::condition_variable m_cvIdle;
+};
+
+#endif
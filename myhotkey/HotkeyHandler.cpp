@@ -16,6 +16,20 @@
   Monday, Oct 20, 2003
              * Removed 'using std::vector' from header file
              * Fixed a minor bug in RemoveHandler()
+  Friday, Oct 16, 2026
+             * Moved the hotkey list and the dispatch to CHotkeyEngine (HotkeyEngine.cpp),
+               lookups by id and by mod&virt are hashed now. CHotkeyHandler is its
+               CHotkeyEventSource on top of RegisterHotKey() and the message loop.
+             * InsertHandler() doesn't insert duplicates when there are deleted entries
+  Saturday, Oct 17, 2026
+             * The callbacks run in the workers of CHotkeyExecutor (HotkeyExecutor.cpp), the
+               message loop only enqueues them. Presses of a binding that is already
+               queued or running are coalesced.
+             * Added GetExecutorStats()
+             * Added Reload(): it applies the differences with a new table of hotkeys from
+               the message loop thread, without stopping it.
+             * Stop() posts WM_HKH_STOP and the message loop thread unregisters the
+               hotkeys, so they aren't changed by two threads at once.
 */
 
 /* -----------------------------------------------------------------------------
@@ -58,8 +72,9 @@
 
   * Constructor
   ---------------
-  CHotkeyHandler(bool Debug = false);
+  CHotkeyHandler(bool Debug = false, size_t Workers = CHotkeyExecutor::DefaultWorkers);
   This constructor initializes internal variables and sets debug info on/off
+  'Workers' is the number of threads that run the callbacks.
   If you call Start() and do not call Stop() the destructor will automatically Stop() for you.
 
   * Start()
@@ -75,6 +90,8 @@
   -----------
   int Stop();
   After you've started the hotkey listener, you can stop it w/ Stop().
+  The hotkeys are unregistered by the message loop thread before it ends, like Reload()
+  registers them from that thread.
   Stop() will return success if it was stopped successfully or if it was not started at all.
 
 
@@ -82,14 +99,15 @@
   --------------------
   int InsertHandler(WORD mod, WORD virt, tHotkeyCB cb, int &index);
   This function will return an error code.
-  'index' will be filled by the index of where the hotkey is stored (1 based).
+  'index' will be filled by the index of where the hotkey is stored (0 based).
   If you attempt to insert a hotkey that already exists then 'index' will be the index value
   of that previously inserted hotkey.
 
   'mod' is any of the MOD_XXXX constants.
   'virt' is the virtual key code.
   'cb' is the handler that will be called. The prototype is: void Callback(void *param)
-  The 'param' of 'cb' will be the one that you passed when you called Start()
+  It's called from a worker thread, and a binding is never run twice at the same time.
+  The 'param' of 'cb' will be param.c_str()
 
   * RemoveHandler()
   --------------------
@@ -97,6 +115,20 @@
   Removes a hotkey definition. This function has effects only when called before Start()
   or after Stop().
 
+  * Reload()
+  ------------
+  int Reload(const std::vector<CHotkeyEngine::tHotkeyBinding> &bindings);
+  Makes 'bindings' the hotkey definitions. It may be called at any time: when started, the
+  message loop thread applies it between two hotkeys and only the added and removed hotkeys
+  are registered and unregistered (see CHotkeyEngine::Diff()). The rest keep working while
+  reloading. Otherwise the definitions are replaced at once.
+
+  * GetExecutorStats()
+  ----------------------
+  void GetExecutorStats(CHotkeyExecutor::tStats &stats);
+  Fills 'stats' with the counters of the callbacks queue: presses submitted, coalesced and
+  executed, the queue depth and the time the presses waited for a worker.
+
   * HotkeyModifiersToFlags()
   ----------------------------
   WORD HotkeyModifiersToFlags(WORD modf);
@@ -129,14 +161,21 @@
 #include <string>
 using namespace std;
 
+// posted to our window to apply a reload
+#define WM_HKH_WAKE (WM_APP + 0x48)
+
+// posted to our window by Stop()
+#define WM_HKH_STOP (WM_APP + 0x49)
+
 //-------------------------------------------------------------------------------------
 // Initializes internal variables
-CHotkeyHandler::CHotkeyHandler(bool Debug)
+CHotkeyHandler::CHotkeyHandler(bool Debug, size_t Workers) : m_executor(Workers)
 {
   bDebug     = Debug;
   m_bStarted = false;
   m_hWnd     = NULL;
   m_hMessageLoopThread = m_hPollingError = m_hRaceProtection = NULL;
+  m_engine.SetExecutor(&m_executor);
 }
 
 //-------------------------------------------------------------------------------------
@@ -185,18 +224,11 @@ bool CHotkeyHandler::BeginRaceProtection()
 // If this function is of use only before a Start() call or after a Stop()
 int CHotkeyHandler::RemoveHandler(const int index)
 {
-  // index out of range ?
-  if (m_listHk.size() <= index)
-    return hkheNoEntry;
-
-  // mark handler as deleted
-  m_listHk.at(index).deleted = true;
-  return hkheOk;
+  return m_engine.RemoveHandler(index);
 }
 
 //-------------------------------------------------------------------------------------
-// Generates a unique atom and then registers a hotkey
-//
+// Message of the last error
 std::wstring CHotkeyHandler::GetErrMsg()
 {
     LPWSTR lpMsgBuf;
@@ -215,20 +247,16 @@ std::wstring CHotkeyHandler::GetErrMsg()
     return msg;
 }
 
-int CHotkeyHandler::EnableHotkey(const int index)
+//-------------------------------------------------------------------------------------
+// Generates a unique atom and then registers a hotkey
+// The atom is the id of the hotkey events
+int CHotkeyHandler::Register(uint16_t mod, uint16_t virt, uint32_t &id)
 {
   TCHAR atomname[MAX_PATH];
   ATOM a;
 
-  // get hotkey definition
-  tHotkeyDef *def = &m_listHk.at(index);
-
-  // If entry does not exist then return Ok
-  if (def->deleted)
-    return hkheOk;
-
   // compose atom name
-  wsprintf(atomname, _T("ED7D65EB-B139-44BB-B455-7BB83FE361DE-%08lX"), MAKELONG(def->virt, def->mod));
+  wsprintf(atomname, _T("ED7D65EB-B139-44BB-B455-7BB83FE361DE-%08lX"), MAKELONG(virt, mod));
 
   // Try to create an atom
   a = ::GlobalAddAtom(atomname);
@@ -237,12 +265,12 @@ int CHotkeyHandler::EnableHotkey(const int index)
   if (!a)
     a = ::GlobalFindAtom(atomname); // try to locate atom
 
-  if (!a || !::RegisterHotKey(m_hWnd, a, def->mod, def->virt))
+  if (!a || !::RegisterHotKey(m_hWnd, a, mod, virt))
   {
     //MOD_CONTROL | MOD_ALT MOD_SHIFT
     wchar_t info[256] = {0};
     swprintf_s(info, 256, L"hotkey: Failed to RegisterHotKey %d(alt:1, ctrl:2, shift:4) %c: %s\n",
-        def->mod, (char)def->virt,
+        mod, (char)virt,
         GetErrMsg().c_str());
     OutputDebugStringW(info);
 
@@ -251,88 +279,79 @@ int CHotkeyHandler::EnableHotkey(const int index)
     return hkheRegHotkeyError;
   }
 
-  // store atom into definition too
-  def->id = a;
+  id = a;
   return hkheOk;
 }
 
 
 //-------------------------------------------------------------------------------------
 // Unregisters a hotkey and deletes the atom
-int CHotkeyHandler::DisableHotkey(const int index)
+void CHotkeyHandler::Unregister(uint32_t id)
 {
-  // get hotkey definition
-  tHotkeyDef *def = &m_listHk.at(index);
-
-  // skip deleted entry
-  if (def->deleted)
-    return hkheOk;
-
-  // already registered
-  if (def->id)
-  {
-    UnregisterHotKey(m_hWnd, def->id);
-    GlobalDeleteAtom(def->id);
-    return hkheOk;
-  }
-  else
-    return hkheNoEntry;
+  UnregisterHotKey(m_hWnd, id);
+  GlobalDeleteAtom((ATOM) id);
 }
 
-
 //-------------------------------------------------------------------------------------
-// Locates a hotkey definition given its ID
-int CHotkeyHandler::FindHandlerById(const ATOM id, tHotkeyDef *&def)
+// Pumps the messages of our window until a hotkey is received
+// Returns false when the window is destroyed or stopped by Stop()
+bool CHotkeyHandler::WaitEvent(uint32_t &id)
 {
-  tHotkeyList::iterator i;
+  MSG msg;
+  BOOL bRet;
 
-  for (i=m_listHk.begin(); i != m_listHk.end(); i++)
+  while ( ((bRet = ::GetMessage(&msg, m_hWnd, 0, 0)) != 0) )
   {
-    def = &*i;
-    if ((def->id == id) && !def->deleted)
-      return hkheOk;
+    if (bRet == -1 || msg.message == WM_HKH_STOP)
+      break;
+
+    ::TranslateMessage(&msg);
+    ::DispatchMessage(&msg);
+
+    // woken up by Wake()
+    if (msg.message == WM_HKH_WAKE)
+    {
+      id = 0;
+      return true;
+    }
+
+    // hotkey received ? (wParam == id (ATOM))
+    if (msg.message == WM_HOTKEY)
+    {
+      if (bDebug)
+        OutputDebugStringA("received a hotkey");
+      id = (uint32_t) msg.wParam;
+      return true;
+    }
   }
-  return hkheNoEntry;
+  return false;
 }
 
 //-------------------------------------------------------------------------------------
-// Finds a deleted entry
-int CHotkeyHandler::FindDeletedHandler(int &idx)
+// Makes WaitEvent() return, so the engine applies a posted reload
+void CHotkeyHandler::Wake()
 {
-  tHotkeyDef *def;
-  int i, c = m_listHk.size();
-  for (i=0; i< c; i++)
-  {
-    def = &m_listHk[i];
-    if (def->deleted)
-    {
-      idx = i;
-      return hkheOk;
-    }
-  }
-  return hkheNoEntry;
+  if (m_hWnd)
+    ::PostMessage(m_hWnd, WM_HKH_WAKE, 0, 0);
 }
 
 //-------------------------------------------------------------------------------------
-// Finds a hotkeydef given it's modifier 'mod' and virtuak key 'virt'
-// If return value is hkheOk then 'idx' is filled with the found index
-// Otherwise 'idx' is left untouched.
-int CHotkeyHandler::FindHandler(WORD mod, WORD virt, int &idx)
+// Applies a new table of hotkeys, from the message loop thread if it's started
+int CHotkeyHandler::Reload(const std::vector<CHotkeyEngine::tHotkeyBinding> &bindings)
 {
-  tHotkeyDef *def;
-  int i, c = m_listHk.size();
-  for (i=0; i < c; i++)
-  {
-    def = &m_listHk[i];
-    // found anything in the list ?
-    if ( (def->mod == mod) && (def->virt == virt) && !def->deleted)
-    {
-      // return its id
-      idx = i;
-      return hkheOk;
-    }
-  }
-  return hkheNoEntry;
+  int rc = hkheOk;
+
+  if (!BeginRaceProtection())
+    return hkheInternal;
+
+  // the hotkeys are registered by our window, so only its thread may register them
+  if (m_bStarted && m_hMessageLoopThread)
+    m_engine.PostReload(*this, bindings);
+  else
+    rc = m_engine.Reload(*this, bindings);
+
+  EndRaceProtection();
+  return rc;
 }
 
 //-------------------------------------------------------------------------------------
@@ -341,32 +360,7 @@ int CHotkeyHandler::FindHandler(WORD mod, WORD virt, int &idx)
 // You may use the returned idx to modify/delete this definition
 int CHotkeyHandler::InsertHandler(WORD mod, WORD virt, tHotkeyCB cb, string param, int &idx)
 {
-  tHotkeyDef def;
-
-  // Try to find a deleted entry and use it
-  if (FindDeletedHandler(idx) == hkheOk)
-  {
-    tHotkeyDef *d = &m_listHk.at(idx);
-    d->deleted = false;
-    d->id = NULL;
-    d->callback = cb;
-    d->virt = virt;
-    d->mod = mod;
-    d->param = param;
-  }
-  // Add a new entry
-  else if (FindHandler(mod, virt, idx) == hkheNoEntry)
-  {
-    def.mod = mod;
-    def.virt = virt;
-    def.callback = cb;
-    def.id = NULL;
-    def.deleted = false;
-    def.param = param;
-    idx = m_listHk.size();
-    m_listHk.push_back(def);
-  }
-  return hkheOk;
+  return m_engine.InsertHandler(mod, virt, cb, param, idx);
 }
 
 //-------------------------------------------------------------------------------------
@@ -407,59 +401,31 @@ DWORD WINAPI CHotkeyHandler::MessageLoop(LPVOID Param)
     return rc;
   }
 
+  // a reload posted after a Stop()
+  _this->m_engine.ApplyPending(*_this);
+
   // register all hotkeys
-  for (int i=0; i<_this->m_listHk.size(); i++)
+  if ((rc = _this->m_engine.EnableAll(*_this)) != hkheOk)
   {
-    // try to register
-    if ((rc = _this->EnableHotkey(i)) != hkheOk)
-    {
-      // disable hotkeys enabled so far
-      for (int j=0;j<i;j++)
-        _this->DisableHotkey(j);
-
-      // uninit window
-      _this->MakeWindow(true);
-
-      // signal that error is ready
-      _this->m_PollingError = rc;
-      ::SetEvent(_this->m_hPollingError);
-      OutputDebugStringA("hotkey, outer MessageLoop because failed to EnableHotkey");
-      return rc;
-    }
+    // uninit window
+    _this->MakeWindow(true);
+
+    // signal that error is ready
+    _this->m_PollingError = rc;
+    ::SetEvent(_this->m_hPollingError);
+    OutputDebugStringA("hotkey, outer MessageLoop because failed to EnableHotkey");
+    return rc;
   }
 
   _this->m_PollingError = hkheOk;
   ::SetEvent(_this->m_hPollingError);
 
-  MSG msg;
-  BOOL bRet;
-
   OutputDebugStringA("hotkey, GetMessage...");
-  while ( ((bRet = ::GetMessage(&msg, _this->m_hWnd, 0, 0)) != 0) )
-  {
-    if (bRet == -1)
-      break;
+  _this->m_engine.Run(*_this);
 
-    // hotkey received ?
-    if (msg.message == WM_HOTKEY)
-    {
-      tHotkeyDef *def;
-
-      OutputDebugStringA("received a hotkey");
-      // try to find handler (wParam == id (ATOM)
-      if (_this->FindHandlerById( (ATOM) msg.wParam, def) == hkheOk)
-      {
-        // call the registered handler
-          OutputDebugStringA("received a hotkey1");
-        if (def->callback)
-          //def->callback(_this->m_lpCallbackParam);
-          OutputDebugStringA("received a hotkey12");
-          def->callback((void*)def->param.c_str());
-      }
-    }
-    ::TranslateMessage(&msg);
-    ::DispatchMessage(&msg);
-  }
+  // the hotkeys are unregistered from here, so the engine is never used by two threads
+  _this->m_engine.DisableAll(*_this);
+  ::DestroyWindow(_this->m_hWnd);
   return hkheOk;
 }
 
@@ -476,7 +442,7 @@ int CHotkeyHandler::Start(LPVOID cbParam)
     return hkheOk;
 
   // Do not start if no entries are there!
-  if (m_listHk.empty())
+  if (m_engine.Empty())
     return hkheNoEntry;
 
   if (!BeginRaceProtection())
@@ -490,6 +456,9 @@ int CHotkeyHandler::Start(LPVOID cbParam)
 
   m_lpCallbackParam = cbParam;
 
+  // start the workers before any hotkey can arrive
+  m_executor.Start();
+
   // create message loop thread
   DWORD dwThreadId;
   m_hMessageLoopThread =
@@ -502,6 +471,7 @@ int CHotkeyHandler::Start(LPVOID cbParam)
 
   if (!m_hMessageLoopThread)
   {
+    m_executor.Stop();
     rc = hkheMessageLoop;
     goto cleanup;
   }
@@ -511,13 +481,22 @@ int CHotkeyHandler::Start(LPVOID cbParam)
 
   if (m_PollingError != hkheOk)
   {
+    m_executor.Stop();
     ::CloseHandle(m_hMessageLoopThread);
     m_hMessageLoopThread = NULL;
   }
   rc = m_PollingError;
 
-  m_bStarted = true;
 cleanup:
+  // not started: a later Start() (i.e after a Reload()) tries again
+  if (rc == hkheOk)
+    m_bStarted = true;
+  else if (m_hPollingError)
+  {
+    ::CloseHandle(m_hPollingError);
+    m_hPollingError = NULL;
+  }
+
   EndRaceProtection();
   return rc;
 }
@@ -536,17 +515,18 @@ int CHotkeyHandler::Stop()
   if (!BeginRaceProtection())
     return hkheInternal;
 
-  // disable all hotkeys
-  for (int i=0;i<m_listHk.size();i++)
-    DisableHotkey(i);
-
-  // tell message loop to terminate
-  ::SendMessage(m_hWnd, WM_DESTROY, 0, 0);
+  // tell message loop to disable all hotkeys and terminate
+  ::PostMessage(m_hWnd, WM_HKH_STOP, 0, 0);
 
   // wait for the thread to exit by itself
   if (::WaitForSingleObject(m_hMessageLoopThread, 3000) == WAIT_TIMEOUT)
+  {
     ::TerminateThread(m_hMessageLoopThread, 0); // kill thread
 
+    // the thread is gone, so the hotkeys can be disabled from here
+    m_engine.DisableAll(*this);
+  }
+
   DWORD exitCode;
   ::GetExitCodeThread(m_hMessageLoopThread, &exitCode);
 
@@ -558,6 +538,9 @@ int CHotkeyHandler::Stop()
   // unregister window class
   MakeWindow(true);
 
+  // wait for the running callbacks
+  m_executor.Stop();
+
   // kill error polling event
   ::CloseHandle(m_hPollingError);
 
@@ -633,6 +616,14 @@ int CHotkeyHandler::MakeWindow(bool bUnmake)
 
 
 
+//---------------------------------------------------------------------------------
+// Counters of the callbacks queue
+//
+void CHotkeyHandler::GetExecutorStats(CHotkeyExecutor::tStats &stats)
+{
+  m_executor.GetStats(stats);
+}
+
 //---------------------------------------------------------------------------------
 // Converts HOTKEYFLAGS used by CHotKeyCtrl into MOD_XXX used by windows API
 //
@@ -12,30 +12,20 @@
 #include <tchar.h>
 #include <vector>
 #include <string>
+#include "HotkeyEngine.h"
 using namespace std;
 
-class CHotkeyHandler
+class CHotkeyHandler : public CHotkeyEventSource
 {
 private:
   // on hotkey occurence callback
-  typedef void (*tHotkeyCB)(void *);
+  typedef CHotkeyEngine::tHotkeyCB tHotkeyCB;
 
-  // hotkey definition
-  typedef struct
-  {
-    WORD mod;
-    WORD virt;
-    tHotkeyCB callback;
-    ATOM id;
-    string param; //Yage add this member
-    bool deleted;
-  } tHotkeyDef;
+  // hotkey list and dispatch
+  CHotkeyEngine m_engine;
 
-  // hotkeys definition list
-  typedef std::vector<tHotkeyDef> tHotkeyList;
-
-  // hotkey list
-  tHotkeyList m_listHk;
+  // runs the callbacks out of the message loop thread
+  CHotkeyExecutor m_executor;
 
   // window call back
   static LRESULT CALLBACK WindowProc(HWND, UINT, WPARAM, LPARAM);
@@ -51,17 +41,12 @@ private:
 
   //
   std::wstring GetErrMsg();
-  int EnableHotkey(const int);
-  int DisableHotkey(const int);
-
-  // Finds the unique ID (ATOM) of an already enabled hotkey
-  int FindHandlerById(const ATOM id, tHotkeyDef *&);
-
-  // Finds the index of an already inserted Hotkey def by Mod&Virt
-  int FindHandler(WORD mod, WORD virt, int &index);
 
-  // Finds for a deleted entry
-  int FindDeletedHandler(int &idx);
+  // CHotkeyEventSource: RegisterHotKey() and the message loop of m_hWnd
+  int Register(uint16_t mod, uint16_t virt, uint32_t &id);
+  void Unregister(uint32_t id);
+  bool WaitEvent(uint32_t &id);
+  void Wake();
 
   // handle of the message loop thread
   HANDLE m_hMessageLoopThread;
@@ -81,7 +66,7 @@ private:
   bool   m_bStarted;
 public:
   bool bDebug;
-  CHotkeyHandler(bool Debug = false);
+  CHotkeyHandler(bool Debug = false, size_t Workers = CHotkeyExecutor::DefaultWorkers);
   ~CHotkeyHandler();
 
   int Start(LPVOID = NULL);
@@ -93,18 +78,14 @@ public:
   // Removes a hotkey definition
   int RemoveHandler(const int index);
 
+  // Replaces the hotkey definitions, changing only the ones that differ
+  int Reload(const std::vector<CHotkeyEngine::tHotkeyBinding> &bindings);
+
+  // Counters of the callbacks queue
+  void GetExecutorStats(CHotkeyExecutor::tStats &stats);
+
   static WORD HotkeyModifiersToFlags(WORD modf);
   static WORD HotkeyFlagsToModifiers(WORD hkf);
-
-  //HotKeyHandlerErrorsXXXX
-  enum {hkheOk = 0,  // success
-        hkheClassError, // window class registration error
-        hkheWindowError, // window creation error
-        hkheNoEntry, // No handler found at given index
-        hkheRegHotkeyError, // could not register hotkey
-        hkheMessageLoop, // could not create message loop thread
-        hkheInternal // Internal error
-       };
 };
 
 #endif
\ No newline at end of file
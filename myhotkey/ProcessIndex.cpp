@@ -0,0 +1,379 @@
+/*
+  CProcessIndex finds the running processes by image name without spawning tasklist.
+
+  Processes are enumerated by a CProcessSource (CreateToolhelp32Snapshot() on Windows,
+  /proc on Linux) and kept in two hash maps: pid -> name and name -> pids. A snapshot is
+  only taken when it's needed:
+    - on the first Find()
+    - when Find() doesn't know the name, maybe the process started later
+    - when a known process of the name has exited or its pid was reused
+    - when Find() is asked for all the processes of the name
+    - when Refresh() is called
+  A snapshot updates the index with the processes that started and exited since the
+  previous one, instead of rebuilding it.
+
+  * Find()
+  ----------
+  bool Find(const std::string &name, std::vector<uint32_t> &pids, bool bAll = false);
+  Fills 'pids' with the pids of the processes named 'name'. The name is compared with the
+  whole image name (i.e "tank.exe" matches "Tank.exe" but not "MyTank.exe" or "Tank"),
+  ignoring the ascii case.
+  The pids that weren't just seen by a snapshot are checked with GetName() of the source
+  before being returned, so a pid reused by another process isn't returned for 'name'.
+  Without 'bAll' the cached pids are enough, and a process started after the last
+  snapshot may be missing while an older one of the same name runs. With 'bAll' a
+  snapshot is always taken, as tasklist did, i.e to terminate all of them.
+
+  * Refresh()
+  -------------
+  Takes a snapshot now. Use it when new processes of an already found name may have started.
+
+  * Invalidate()
+  ----------------
+  void Invalidate(uint32_t pid);
+  Removes 'pid' from the index, i.e after it was terminated.
+
+  The methods may be called from several threads.
+*/
+
+#include "ProcessIndex.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+//-------------------------------------------------------------------------------------
+// Enumerates the processes with a Toolhelp32 snapshot
+bool CToolhelpProcessSource::Snapshot(std::vector<tProcessEntry> &list)
+{
+  PROCESSENTRY32W pe;
+  HANDLE hSnapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+
+  if (hSnapshot == INVALID_HANDLE_VALUE)
+    return false;
+
+  list.clear();
+  pe.dwSize = sizeof(pe);
+  for (BOOL bNext = ::Process32FirstW(hSnapshot, &pe); bNext; bNext = ::Process32NextW(hSnapshot, &pe))
+  {
+    char name[MAX_PATH * 3];
+    tProcessEntry entry;
+
+    // image name to utf-8
+    if (!::WideCharToMultiByte(CP_UTF8, 0, pe.szExeFile, -1, name, sizeof(name), NULL, NULL))
+      continue;
+
+    entry.pid = pe.th32ProcessID;
+    entry.name = name;
+    list.push_back(entry);
+  }
+
+  ::CloseHandle(hSnapshot);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+// File name of the full image path
+bool CToolhelpProcessSource::QueryName(void *hProcess, std::string &name)
+{
+  WCHAR path[MAX_PATH * 2];
+  char utf8[MAX_PATH * 6];
+  DWORD len = MAX_PATH * 2;
+
+  if (!::QueryFullProcessImageNameW((HANDLE)hProcess, 0, path, &len))
+    return false;
+
+  const WCHAR *file = wcsrchr(path, L'\\');
+  if (!::WideCharToMultiByte(CP_UTF8, 0, file ? file + 1 : path, -1, utf8, sizeof(utf8), NULL, NULL))
+    return false;
+
+  name = utf8;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The name is only read while the process runs: an exited one keeps its pid while
+// there are handles to it, but it's not the process of that pid anymore
+bool CToolhelpProcessSource::GetName(uint32_t pid, std::string &name)
+{
+  DWORD exitCode;
+  HANDLE hProcess = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+
+  if (!hProcess)
+    return false;
+
+  bool bOk = ::GetExitCodeProcess(hProcess, &exitCode) && (exitCode == STILL_ACTIVE) && QueryName(hProcess, name);
+  ::CloseHandle(hProcess);
+  return bOk;
+}
+
+#else
+//-------------------------------------------------------------------------------------
+// The name is the one of /proc/<pid>/exe, or /proc/<pid>/comm when exe can't be read
+// (other users, kernel threads)
+bool CProcFsProcessSource::ReadName(uint32_t pid, std::string &name)
+{
+  char path[64], buffer[4096];
+  ssize_t len;
+
+  snprintf(path, sizeof(path), "/proc/%u/exe", pid);
+  if ((len = readlink(path, buffer, sizeof(buffer) - 1)) > 0)
+  {
+    const char *deleted = " (deleted)";
+    buffer[len] = 0;
+
+    // the image was replaced after the process started
+    if ((size_t)len > strlen(deleted) && !strcmp(buffer + len - strlen(deleted), deleted))
+      buffer[len - strlen(deleted)] = 0;
+
+    const char *slash = strrchr(buffer, '/');
+    name = slash ? slash + 1 : buffer;
+    return true;
+  }
+
+  FILE *f;
+
+  snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+  if (!(f = fopen(path, "r")))
+    return false; // exited
+
+  if (!fgets(buffer, sizeof(buffer), f))
+    buffer[0] = 0;
+  fclose(f);
+
+  buffer[strcspn(buffer, "\n")] = 0;
+  name = buffer;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+// Enumerates the numeric entries of /proc
+bool CProcFsProcessSource::Snapshot(std::vector<tProcessEntry> &list)
+{
+  DIR *dir = opendir("/proc");
+  struct dirent *ent;
+
+  if (!dir)
+    return false;
+
+  list.clear();
+  while ((ent = readdir(dir)) != NULL)
+  {
+    char *end;
+    tProcessEntry entry;
+
+    unsigned long pid = strtoul(ent->d_name, &end, 10);
+    if (*end || end == ent->d_name)
+      continue;
+
+    // exited meanwhile ?
+    if (!ReadName((uint32_t)pid, entry.name))
+      continue;
+
+    entry.pid = (uint32_t)pid;
+    list.push_back(entry);
+  }
+
+  closedir(dir);
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool CProcFsProcessSource::GetName(uint32_t pid, std::string &name)
+{
+  return ReadName(pid, name);
+}
+#endif
+
+//-------------------------------------------------------------------------------------
+// Initializes internal variables
+CProcessIndex::CProcessIndex(CProcessSource *source)
+{
+  m_source   = source ? source : &m_nativeSource;
+  m_bLoaded  = false;
+  m_nRefresh = 0;
+}
+
+//-------------------------------------------------------------------------------------
+// Names are compared ignoring the ascii case
+std::string CProcessIndex::MakeKey(const std::string &name)
+{
+  std::string key = name;
+
+  for (size_t i=0; i < key.size(); i++)
+  {
+    if (key[i] >= 'A' && key[i] <= 'Z')
+      key[i] += 'a' - 'A';
+  }
+  return key;
+}
+
+//-------------------------------------------------------------------------------------
+void CProcessIndex::InsertLocked(uint32_t pid, const std::string &key)
+{
+  tIndexed &indexed = m_nameByPid[pid];
+
+  indexed.key = key;
+  indexed.refresh = m_nRefresh;
+  m_pidsByName[key].push_back(pid);
+}
+
+//-------------------------------------------------------------------------------------
+void CProcessIndex::EraseLocked(uint32_t pid)
+{
+  tNameByPid::iterator it = m_nameByPid.find(pid);
+
+  if (it == m_nameByPid.end())
+    return;
+
+  tPidsByName::iterator itName = m_pidsByName.find(it->second.key);
+  if (itName != m_pidsByName.end())
+  {
+    std::vector<uint32_t> &pids = itName->second;
+
+    for (size_t i=0; i < pids.size(); i++)
+    {
+      if (pids[i] == pid)
+      {
+        pids[i] = pids.back();
+        pids.pop_back();
+        break;
+      }
+    }
+
+    if (pids.empty())
+      m_pidsByName.erase(itName);
+  }
+
+  m_nameByPid.erase(it);
+}
+
+//-------------------------------------------------------------------------------------
+// Applies a snapshot to the index: only the processes that are new, or that have a
+// different name (the pid was reused), or that are gone are changed
+bool CProcessIndex::RefreshLocked()
+{
+  std::vector<CProcessSource::tProcessEntry> list;
+
+  if (!m_source->Snapshot(list))
+    return false;
+
+  m_nRefresh++;
+  for (size_t i=0; i < list.size(); i++)
+  {
+    std::string key = MakeKey(list[i].name);
+    tNameByPid::iterator it = m_nameByPid.find(list[i].pid);
+
+    if (it != m_nameByPid.end())
+    {
+      if (it->second.key == key)
+      {
+        it->second.refresh = m_nRefresh;
+        continue;
+      }
+      EraseLocked(list[i].pid);
+    }
+    InsertLocked(list[i].pid, key);
+  }
+
+  // remove the ones that were not seen
+  std::vector<uint32_t> listGone;
+  for (tNameByPid::iterator it = m_nameByPid.begin(); it != m_nameByPid.end(); ++it)
+  {
+    if (it->second.refresh != m_nRefresh)
+      listGone.push_back(it->first);
+  }
+  for (size_t i=0; i < listGone.size(); i++)
+    EraseLocked(listGone[i]);
+
+  m_bLoaded = true;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------
+bool CProcessIndex::Refresh()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return RefreshLocked();
+}
+
+//-------------------------------------------------------------------------------------
+// Looks the name up. The index is refreshed if the name is unknown, if one of its pids
+// has exited or now has another name, or if all the processes are wanted.
+bool CProcessIndex::Find(const std::string &name, std::vector<uint32_t> &pids, bool bAll)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  std::string key = MakeKey(name);
+  bool bRefreshed = false;
+
+  pids.clear();
+  if (!m_bLoaded || bAll)
+  {
+    if (!RefreshLocked())
+      return false;
+    bRefreshed = true;
+  }
+
+  for (;;)
+  {
+    tPidsByName::iterator it = m_pidsByName.find(key);
+    bool bStale = false;
+
+    pids.clear();
+    if (it != m_pidsByName.end())
+    {
+      for (size_t i=0; i < it->second.size(); i++)
+      {
+        uint32_t pid = it->second[i];
+        std::string current;
+
+        // the snapshot has just seen them, the others may be gone or reused
+        if (bRefreshed || (m_source->GetName(pid, current) && MakeKey(current) == key))
+          pids.push_back(pid);
+        else
+          bStale = true;
+      }
+    }
+
+    if (bRefreshed || (!pids.empty() && !bStale))
+      break;
+
+    // the snapshot updates the stale pids too
+    if (!RefreshLocked())
+      break;
+    bRefreshed = true;
+  }
+
+  return !pids.empty();
+}
+
+//-------------------------------------------------------------------------------------
+void CProcessIndex::Invalidate(uint32_t pid)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  EraseLocked(pid);
+}
+
+//-------------------------------------------------------------------------------------
+size_t CProcessIndex::Count()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_nameByPid.size();
+}
+
+//-------------------------------------------------------------------------------------
+uint64_t CProcessIndex::RefreshCount()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_nRefresh;
+}
@@ -0,0 +1,120 @@
+#ifndef __PROCESSINDEX__INC_
+#define __PROCESSINDEX__INC_
+
+/*
+ -----------------------------------------------------------------------------
+ Check implementation file for usage info.
+ -----------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+//-------------------------------------------------------------------------------------
+// Enumerates the running processes. CNativeProcessSource is the one of the platform:
+// a Toolhelp32 snapshot on Windows and /proc on Linux.
+class CProcessSource
+{
+public:
+  typedef struct
+  {
+    uint32_t pid;
+    std::string name; // image name, utf-8 (i.e "notepad.exe")
+  } tProcessEntry;
+
+  virtual ~CProcessSource() {}
+
+  // Fills 'list' with the running processes, returns false on error
+  virtual bool Snapshot(std::vector<tProcessEntry> &list) = 0;
+
+  // Sets 'name' to the current image name of 'pid'. Returns false if it has exited or
+  // its name can't be read.
+  virtual bool GetName(uint32_t pid, std::string &name) = 0;
+};
+
+#ifdef _WIN32
+class CToolhelpProcessSource : public CProcessSource
+{
+public:
+  bool Snapshot(std::vector<tProcessEntry> &list);
+  bool GetName(uint32_t pid, std::string &name);
+
+  // Image name of a process handle opened with PROCESS_QUERY_LIMITED_INFORMATION
+  static bool QueryName(void *hProcess, std::string &name);
+};
+
+typedef CToolhelpProcessSource CNativeProcessSource;
+#else
+class CProcFsProcessSource : public CProcessSource
+{
+public:
+  bool Snapshot(std::vector<tProcessEntry> &list);
+  bool GetName(uint32_t pid, std::string &name);
+
+  // Image name from /proc/<pid>/exe, or /proc/<pid>/comm
+  static bool ReadName(uint32_t pid, std::string &name);
+};
+
+typedef CProcFsProcessSource CNativeProcessSource;
+#endif
+
+//-------------------------------------------------------------------------------------
+// Index of the running processes by image name
+class CProcessIndex
+{
+public:
+  // 'source' is the native one if NULL
+  CProcessIndex(CProcessSource *source = NULL);
+
+  // Fills 'pids' with the processes whose image name is 'name' (case insensitive).
+  // If 'bAll', a snapshot is taken first so the processes started since the previous
+  // one are found too. Returns false if there isn't any.
+  bool Find(const std::string &name, std::vector<uint32_t> &pids, bool bAll = false);
+
+  // Takes a snapshot and updates the index with the processes that started or exited
+  bool Refresh();
+
+  // Forgets the pids that have exited, i.e after they were terminated
+  void Invalidate(uint32_t pid);
+
+  // Number of indexed processes
+  size_t Count();
+
+  // Number of snapshots taken
+  uint64_t RefreshCount();
+
+  // Key of a name, two image names are the same if their keys are equal
+  static std::string MakeKey(const std::string &name);
+
+private:
+  typedef struct
+  {
+    std::string key; // key of its name
+    uint64_t refresh; // last Refresh() that saw it
+  } tIndexed;
+
+  typedef std::unordered_map<uint32_t, tIndexed> tNameByPid;
+  typedef std::unordered_map<std::string, std::vector<uint32_t> > tPidsByName;
+
+  CNativeProcessSource m_nativeSource;
+  CProcessSource *m_source;
+
+  bool RefreshLocked();
+  void InsertLocked(uint32_t pid, const std::string &key);
+  void EraseLocked(uint32_t pid);
+
+  // indexed processes, by pid and by the key of their name
+  tNameByPid m_nameByPid;
+  tPidsByName m_pidsByName;
+
+  bool m_bLoaded;
+  uint64_t m_nRefresh;
+
+  // Find() is called from the executor workers
+  std::mutex m_lock;
+};
+
+#endif
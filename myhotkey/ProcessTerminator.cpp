@@ -0,0 +1,288 @@
+/*
+  CProcessTerminator terminates processes by image name without running cmd.exe and
+  TASKKILL.exe: the pids come from a CProcessIndex and are terminated through handles
+  of a CProcessControl (process handles on Windows, pidfds on Linux).
+
+  All the pids are opened and terminated first, and then they're waited for at once, so
+  the timeout is for the whole batch and not for each process. Terminated pids are
+  removed from the index.
+
+  When terminating by name, the index takes a new snapshot so all the running instances
+  are found (as TASKKILL /IM did), and the image name of each process is read again
+  through its handle once opened: a pid that exited and was reused by another process
+  meanwhile is skipped, not terminated.
+
+  * Terminate()
+  ---------------
+  int Terminate(const std::string &name, std::vector<tResult> &results, uint32_t timeoutMs = 0);
+  int Terminate(const std::vector<uint32_t> &pids, std::vector<tResult> &results, uint32_t timeoutMs = 0);
+  Terminates the processes named 'name' (see CProcessIndex::Find()) or the given pids.
+  'results' gets one entry per terminated or failed pid with its pteXXXX code and, on pteOpenError and
+  pteTerminateError, the system error code.
+  If 'timeoutMs' isn't 0, it waits up to 'timeoutMs' for the processes to exit; the ones
+  that don't are pteTimeout. Otherwise it returns once the termination is requested.
+  It returns pteNotFound if there isn't any process, pteOk if all of them are ok, or the
+  code of the first one that failed.
+
+  Error codes
+  -------------
+  CProcessTerminator::pteXXXXX
+    pteOk             - Success
+    pteNotFound       - No process found
+    pteOpenError      - Could not open the process
+    pteTerminateError - Could not terminate the process
+    pteTimeout        - The process didn't exit in time
+*/
+
+#include "ProcessTerminator.h"
+
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// syscall numbers, for headers older than the calls
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+#endif
+
+#ifdef _WIN32
+//-------------------------------------------------------------------------------------
+uint32_t CWin32ProcessControl::Open(uint32_t pid, tHandle &handle)
+{
+  HANDLE hProcess = ::OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+
+  if (!hProcess)
+    return ::GetLastError();
+
+  handle = (tHandle)hProcess;
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------
+// The handle keeps the process (and its pid) until it's closed
+bool CWin32ProcessControl::GetName(tHandle handle, uint32_t, std::string &name)
+{
+  return CToolhelpProcessSource::QueryName((void *)handle, name);
+}
+
+//-------------------------------------------------------------------------------------
+uint32_t CWin32ProcessControl::Terminate(tHandle handle)
+{
+  // same exit code as TASKKILL /F
+  if (!::TerminateProcess((HANDLE)handle, 1))
+    return ::GetLastError();
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------
+// The handles are waited for one after another until the deadline
+void CWin32ProcessControl::WaitExit(const std::vector<tHandle> &handles, uint32_t timeoutMs, std::vector<bool> &exited)
+{
+  ULONGLONG deadline = ::GetTickCount64() + timeoutMs;
+
+  exited.assign(handles.size(), false);
+  for (size_t i=0; i < handles.size(); i++)
+  {
+    ULONGLONG now = ::GetTickCount64();
+    DWORD wait = now < deadline ? (DWORD)(deadline - now) : 0;
+
+    exited[i] = ::WaitForSingleObject((HANDLE)handles[i], wait) == WAIT_OBJECT_0;
+  }
+}
+
+//-------------------------------------------------------------------------------------
+void CWin32ProcessControl::Close(tHandle handle)
+{
+  ::CloseHandle((HANDLE)handle);
+}
+#else
+//-------------------------------------------------------------------------------------
+uint32_t CPidfdProcessControl::Open(uint32_t pid, tHandle &handle)
+{
+  long fd = syscall(SYS_pidfd_open, (pid_t)pid, 0);
+
+  if (fd < 0)
+    return errno;
+
+  handle = (tHandle)fd;
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------
+// The name is read from /proc/<pid>. The pid can't be reused until the process of the
+// pidfd is reaped, so if it's still there after reading the name, the name was its own.
+bool CPidfdProcessControl::GetName(tHandle handle, uint32_t pid, std::string &name)
+{
+  if (!CProcFsProcessSource::ReadName(pid, name))
+    return false;
+
+  return syscall(SYS_pidfd_send_signal, (int)handle, 0, NULL, 0) == 0;
+}
+
+//-------------------------------------------------------------------------------------
+// The pidfd refers to the process that was opened, even if its pid is reused later
+uint32_t CPidfdProcessControl::Terminate(tHandle handle)
+{
+  if (syscall(SYS_pidfd_send_signal, (int)handle, SIGKILL, NULL, 0) < 0)
+    return errno;
+  return 0;
+}
+
+//-------------------------------------------------------------------------------------
+// A pidfd is readable once its process has exited
+void CPidfdProcessControl::WaitExit(const std::vector<tHandle> &handles, uint32_t timeoutMs, std::vector<bool> &exited)
+{
+  typedef std::chrono::steady_clock tClock;
+  tClock::time_point deadline = tClock::now() + std::chrono::milliseconds(timeoutMs);
+  std::vector<struct pollfd> listPoll;
+  size_t nExited = 0;
+
+  exited.assign(handles.size(), false);
+  for (size_t i=0; i < handles.size(); i++)
+  {
+    struct pollfd pfd;
+    pfd.fd = (int)handles[i];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    listPoll.push_back(pfd);
+  }
+
+  while (nExited < handles.size())
+  {
+    long long wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - tClock::now()).count();
+
+    int rc = poll(&listPoll[0], listPoll.size(), wait > 0 ? (int)wait : 0);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    if (rc <= 0)
+      break;
+
+    for (size_t i=0; i < listPoll.size(); i++)
+    {
+      if (listPoll[i].revents)
+      {
+        exited[i] = true;
+        nExited++;
+        listPoll[i].fd = -1; // ignored by the next poll()
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------
+void CPidfdProcessControl::Close(tHandle handle)
+{
+  close((int)handle);
+}
+#endif
+
+//-------------------------------------------------------------------------------------
+// Initializes internal variables
+CProcessTerminator::CProcessTerminator(CProcessIndex &index, CProcessControl *control) : m_index(index)
+{
+  m_control = control ? control : &m_nativeControl;
+}
+
+//-------------------------------------------------------------------------------------
+// Terminates the processes of an image name, all the running ones
+int CProcessTerminator::Terminate(const std::string &name, std::vector<tResult> &results, uint32_t timeoutMs)
+{
+  std::vector<uint32_t> pids;
+
+  results.clear();
+  if (!m_index.Find(name, pids, true))
+    return pteNotFound;
+
+  return TerminatePids(pids, &name, results, timeoutMs);
+}
+
+//-------------------------------------------------------------------------------------
+int CProcessTerminator::Terminate(const std::vector<uint32_t> &pids, std::vector<tResult> &results, uint32_t timeoutMs)
+{
+  return TerminatePids(pids, NULL, results, timeoutMs);
+}
+
+//-------------------------------------------------------------------------------------
+// Opens and terminates all pids, then waits for them at once
+int CProcessTerminator::TerminatePids(const std::vector<uint32_t> &pids, const std::string *name, std::vector<tResult> &results, uint32_t timeoutMs)
+{
+  std::vector<CProcessControl::tHandle> listHandles;
+  std::vector<size_t> listWaiting; // index in results of each one of listHandles
+  std::string key = name ? CProcessIndex::MakeKey(*name) : std::string();
+  int rc = pteOk;
+
+  results.clear();
+  for (size_t i=0; i < pids.size(); i++)
+  {
+    CProcessControl::tHandle handle;
+    tResult result;
+
+    result.pid = pids[i];
+    result.rc = pteOk;
+    if ((result.error = m_control->Open(pids[i], handle)) != 0)
+      result.rc = pteOpenError;
+    else
+    {
+      std::string current;
+
+      // exited, or the pid is now of another process ?
+      if (name && !(m_control->GetName(handle, pids[i], current) && CProcessIndex::MakeKey(current) == key))
+      {
+        m_control->Close(handle);
+        m_index.Invalidate(pids[i]);
+        continue;
+      }
+
+      if ((result.error = m_control->Terminate(handle)) != 0)
+      {
+        result.rc = pteTerminateError;
+        m_control->Close(handle);
+      }
+      else
+      {
+        listHandles.push_back(handle);
+        listWaiting.push_back(results.size());
+      }
+    }
+    results.push_back(result);
+  }
+
+  if (results.empty())
+    return pteNotFound;
+
+  if (timeoutMs && !listHandles.empty())
+  {
+    std::vector<bool> exited;
+
+    m_control->WaitExit(listHandles, timeoutMs, exited);
+    for (size_t i=0; i < listWaiting.size(); i++)
+    {
+      if (!exited[i])
+        results[listWaiting[i]].rc = pteTimeout;
+    }
+  }
+
+  for (size_t i=0; i < listHandles.size(); i++)
+    m_control->Close(listHandles[i]);
+
+  for (size_t i=0; i < results.size(); i++)
+  {
+    if (results[i].rc == pteOk)
+      m_index.Invalidate(results[i].pid);
+    else if (rc == pteOk)
+      rc = results[i].rc;
+  }
+
+  return rc;
+}
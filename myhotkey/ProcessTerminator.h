@@ -0,0 +1,107 @@
+#ifndef __PROCESSTERMINATOR__INC_
+#define __PROCESSTERMINATOR__INC_
+
+/*
+ -----------------------------------------------------------------------------
+ Check implementation file for usage info.
+ -----------------------------------------------------------------------------
+*/
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include "ProcessIndex.h"
+
+//-------------------------------------------------------------------------------------
+// Terminates processes through handles. CNativeProcessControl is the one of the platform:
+// OpenProcess()/TerminateProcess() on Windows and pidfd_open()/pidfd_send_signal() on Linux.
+class CProcessControl
+{
+public:
+  // process handle, or pidfd
+  typedef intptr_t tHandle;
+
+  virtual ~CProcessControl() {}
+
+  // Opens 'pid' to terminate it and to wait for it. Returns 0 or the system error code.
+  virtual uint32_t Open(uint32_t pid, tHandle &handle) = 0;
+
+  // Sets 'name' to the image name of the process opened as 'handle' (that was 'pid').
+  // Returns false if it can't be read or the process has exited.
+  virtual bool GetName(tHandle handle, uint32_t pid, std::string &name) = 0;
+
+  // Requests the termination. Returns 0 or the system error code.
+  virtual uint32_t Terminate(tHandle handle) = 0;
+
+  // Waits up to 'timeoutMs' for all 'handles' to exit and sets 'exited' of each one
+  virtual void WaitExit(const std::vector<tHandle> &handles, uint32_t timeoutMs, std::vector<bool> &exited) = 0;
+
+  virtual void Close(tHandle handle) = 0;
+};
+
+#ifdef _WIN32
+class CWin32ProcessControl : public CProcessControl
+{
+public:
+  uint32_t Open(uint32_t pid, tHandle &handle);
+  bool GetName(tHandle handle, uint32_t pid, std::string &name);
+  uint32_t Terminate(tHandle handle);
+  void WaitExit(const std::vector<tHandle> &handles, uint32_t timeoutMs, std::vector<bool> &exited);
+  void Close(tHandle handle);
+};
+
+typedef CWin32ProcessControl CNativeProcessControl;
+#else
+class CPidfdProcessControl : public CProcessControl
+{
+public:
+  uint32_t Open(uint32_t pid, tHandle &handle);
+  bool GetName(tHandle handle, uint32_t pid, std::string &name);
+  uint32_t Terminate(tHandle handle);
+  void WaitExit(const std::vector<tHandle> &handles, uint32_t timeoutMs, std::vector<bool> &exited);
+  void Close(tHandle handle);
+};
+
+typedef CPidfdProcessControl CNativeProcessControl;
+#endif
+
+//-------------------------------------------------------------------------------------
+// Terminates all the processes of an image name
+class CProcessTerminator
+{
+public:
+  //ProcessTerminatorErrorsXXXX
+  enum {pteOk = 0, // success
+        pteNotFound, // no process with that name
+        pteOpenError, // could not open the process
+        pteTerminateError, // could not terminate the process
+        pteTimeout // the process didn't exit before the timeout
+       };
+
+  // result of a process
+  typedef struct
+  {
+    uint32_t pid;
+    int rc; // pteXXXX
+    uint32_t error; // system error code of pteOpenError and pteTerminateError
+  } tResult;
+
+  // 'control' is the native one if NULL
+  CProcessTerminator(CProcessIndex &index, CProcessControl *control = NULL);
+
+  // Terminates the processes named 'name' and fills 'results' with one entry per pid
+  int Terminate(const std::string &name, std::vector<tResult> &results, uint32_t timeoutMs = 0);
+
+  // Terminates the given pids
+  int Terminate(const std::vector<uint32_t> &pids, std::vector<tResult> &results, uint32_t timeoutMs = 0);
+
+private:
+  // Terminates 'pids', skipping the ones whose image name isn't 'name' if it isn't NULL
+  int TerminatePids(const std::vector<uint32_t> &pids, const std::string *name, std::vector<tResult> &results, uint32_t timeoutMs);
+
+  CProcessIndex &m_index;
+  CNativeProcessControl m_nativeControl;
+  CProcessControl *m_control;
+};
+
+#endif
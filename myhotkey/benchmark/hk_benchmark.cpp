@@ -0,0 +1,337 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+// Latency from a hotkey press to its action, through the dispatch of CHotkeyHandler
+// (CHotkeyEngine and CHotkeyExecutor) with traces replayed by a ReplaySource instead of
+// RegisterHotKey, so it runs headless.
+//
+// usage: hk_benchmark [--events N] [--workers N] [--action-us US] [--scenario NAME]
+//                     [--trace FILE] [--save-trace FILE] [--output FILE]
+
+#include "hk_benchmark_trace.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace hk_benchmark{
+
+	typedef struct{
+		ZJ_VAR_STRING(scenario);
+		ZJ_VAR_INT64(events);
+		ZJ_VAR_INT64(executed); // callbacks run, less than events when presses are coalesced
+		ZJ_VAR_INT64(coalesced);
+		ZJ_VAR_INT64(max_queue_depth);
+		ZJ_VAR_DOUBLE(seconds);
+		// press -> start of the action, microseconds
+		ZJ_VAR_DOUBLE(dispatch_p50_us);
+		ZJ_VAR_DOUBLE(dispatch_p99_us);
+		ZJ_VAR_DOUBLE(dispatch_p999_us);
+		ZJ_VAR_DOUBLE(dispatch_max_us);
+		// the same, only for the bindings other than the first one (the slow or repeated one)
+		ZJ_VAR_DOUBLE(dispatch_others_p99_us);
+		// press -> end of the action
+		ZJ_VAR_DOUBLE(complete_p50_us);
+		ZJ_VAR_DOUBLE(complete_p99_us);
+		ZJ_VAR_DOUBLE(complete_p999_us);
+		// start -> end of the action
+		ZJ_VAR_DOUBLE(action_p50_us);
+		ZJ_VAR_DOUBLE(action_p99_us);
+		// work of the loop thread per event: lookup and submit
+		ZJ_VAR_DOUBLE(loop_p50_us);
+		ZJ_VAR_DOUBLE(loop_p99_us);
+	}BenchmarkResult;
+
+	typedef struct{
+		ZJ_VAR_STRING(date);
+		ZJ_VAR_INT64(workers);
+		ZJ_VAR_VECTOR_OBJECT(BenchmarkResult,results);
+	}BenchmarkReport;
+
+	typedef struct{
+		size_t n_events;
+		size_t n_workers;
+		int64_t action_us;
+		std::string scenario;
+		std::string trace;
+		std::string save_trace;
+		std::string output;
+	}BenchmarkOptions;
+
+	typedef struct{
+		const char *name;
+		const char *description;
+		int n_bindings;
+		int64_t first_action_us; // action of binding 0
+		std::vector<TraceEvent> (*generate)(size_t n_events, int n_bindings);
+	}Scenario;
+
+	std::vector<TraceEvent> generate_steady_scenario(size_t n_events, int n_bindings){
+		return generate_steady(n_events,n_bindings,1000,1);
+	}
+
+	std::vector<TraceEvent> generate_burst_scenario(size_t n_events, int n_bindings){
+		return generate_bursts(n_events,n_bindings,64,20000,2);
+	}
+
+	std::vector<TraceEvent> generate_repeat_scenario(size_t n_events, int n_bindings){
+		return generate_repeat_storm(n_events,n_bindings,2000,100,3);
+	}
+
+	std::vector<TraceEvent> generate_slow_scenario(size_t n_events, int n_bindings){
+		return generate_steady(n_events,n_bindings,1000,4);
+	}
+
+	static const Scenario scenarios[]={
+		{"steady","1000 presses/s of 16 keys",16,0,generate_steady_scenario}
+		,{"burst","bursts of 64 presses every 20 ms",16,0,generate_burst_scenario}
+		,{"repeat","autorepeat of a 2 ms action at 2000/s, other keys at 100/s",16,2000,generate_repeat_scenario}
+		,{"slow","1000 presses/s, one key takes 50 ms (i.e waits for a process)",16,50000,generate_slow_scenario}
+	};
+
+	// state of the scenario that runs, for the callback
+	typedef struct{
+		std::vector<PressQueue> *press_queues;
+		std::vector<int64_t> action_us; // by binding
+		std::mutex lock;
+		std::vector<double> dispatch_times;
+		std::vector<double> dispatch_others_times;
+		std::vector<double> complete_times;
+		std::vector<double> action_times;
+	}RunState;
+
+	static RunState *run_state=NULL;
+
+	double to_us(Clock::duration duration){
+		return std::chrono::duration<double,std::micro>(duration).count();
+	}
+
+	// nearest rank
+	double get_percentile(std::vector<double> & times, double percentile){
+		if(times.empty()){
+			return 0;
+		}
+
+		size_t rank=(size_t)(percentile*times.size()+0.999999);
+		rank=rank > 0?rank-1:0;
+		std::nth_element(times.begin(),times.begin()+rank,times.end());
+		return times[rank];
+	}
+
+	// the action of every binding, param is its index
+	void on_hotkey(void *param){
+		int binding=atoi((const char *)param);
+		std::vector<Clock::time_point> presses;
+		Clock::time_point started=Clock::now();
+
+		(*run_state->press_queues)[binding].take(presses);
+
+		if(run_state->action_us[binding] > 0){
+			std::this_thread::sleep_for(std::chrono::microseconds(run_state->action_us[binding]));
+		}
+
+		Clock::time_point finished=Clock::now();
+
+		std::lock_guard<std::mutex> guard(run_state->lock);
+		for(auto & press: presses){
+			run_state->dispatch_times.push_back(to_us(started-press));
+			if(binding != 0){
+				run_state->dispatch_others_times.push_back(to_us(started-press));
+			}
+			run_state->complete_times.push_back(to_us(finished-press));
+		}
+		run_state->action_times.push_back(to_us(finished-started));
+	}
+
+	void run(BenchmarkReport & report, const BenchmarkOptions & options, const char *name, const std::vector<TraceEvent> & trace, int64_t first_action_us){
+		std::vector<uint32_t> keys;
+		RunState state;
+		CHotkeyEngine engine;
+		CHotkeyExecutor executor(options.n_workers > 0?options.n_workers:1);
+		CHotkeyExecutor::tStats stats;
+		int index;
+
+		// a binding per distinct key of the trace, in order of appearance
+		for(auto & event: trace){
+			uint32_t key=((uint32_t)event.mod << 16) | event.virt;
+			if(std::find(keys.begin(),keys.end(),key) == keys.end()){
+				keys.push_back(key);
+			}
+		}
+
+		std::vector<PressQueue> press_queues(keys.size());
+		ReplaySource source(trace,press_queues);
+
+		state.press_queues=&press_queues;
+		for(size_t i=0; i < keys.size(); i++){
+			uint16_t mod=(uint16_t)(keys[i] >> 16),virt=(uint16_t)(keys[i] & 0xffff);
+			engine.InsertHandler(mod,virt,on_hotkey,std::to_string(i),index);
+			source.setBinding(mod,virt,(int)i);
+			state.action_us.push_back((i == 0?first_action_us:0)+options.action_us);
+		}
+		run_state=&state;
+
+		// as CHotkeyHandler::Start() and its MessageLoop()
+		if(options.n_workers > 0){
+			engine.SetExecutor(&executor);
+			executor.Start();
+		}
+
+		if(engine.EnableAll(source) != CHotkeyEventSource::hkheOk){
+			throw std::runtime_error("cannot register the keys of the trace");
+		}
+
+		Clock::time_point start=Clock::now();
+		engine.Run(source);
+		executor.Drain();
+		double seconds=std::chrono::duration<double>(Clock::now()-start).count();
+
+		executor.Stop();
+		engine.DisableAll(source);
+		executor.GetStats(stats);
+		run_state=NULL;
+
+		std::vector<double> loop_times=source.getLoopTimes();
+		zetjsoncpp::JsonVarObject<BenchmarkResult> *result=(zetjsoncpp::JsonVarObject<BenchmarkResult> *)report.results.newJsonVar();
+		result->scenario=name;
+		result->events=(int64_t)trace.size();
+		result->executed=(int64_t)state.action_times.size();
+		result->coalesced=(int64_t)stats.coalesced;
+		result->max_queue_depth=(int64_t)stats.maxDepth;
+		result->seconds=seconds;
+		result->dispatch_p50_us=get_percentile(state.dispatch_times,0.5);
+		result->dispatch_p99_us=get_percentile(state.dispatch_times,0.99);
+		result->dispatch_p999_us=get_percentile(state.dispatch_times,0.999);
+		result->dispatch_max_us=get_percentile(state.dispatch_times,1);
+		result->dispatch_others_p99_us=get_percentile(state.dispatch_others_times,0.99);
+		result->complete_p50_us=get_percentile(state.complete_times,0.5);
+		result->complete_p99_us=get_percentile(state.complete_times,0.99);
+		result->complete_p999_us=get_percentile(state.complete_times,0.999);
+		result->action_p50_us=get_percentile(state.action_times,0.5);
+		result->action_p99_us=get_percentile(state.action_times,0.99);
+		result->loop_p50_us=get_percentile(loop_times,0.5);
+		result->loop_p99_us=get_percentile(loop_times,0.99);
+
+		printf("%-8s %7zu %8lli %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %8.2f\n"
+			,name
+			,trace.size()
+			,(long long)(int64_t)result->executed
+			,(double)result->dispatch_p50_us
+			,(double)result->dispatch_p99_us
+			,(double)result->dispatch_p999_us
+			,(double)result->dispatch_others_p99_us
+			,(double)result->complete_p99_us
+			,(double)result->action_p99_us
+			,(double)result->loop_p99_us
+		);
+		fflush(stdout);
+	}
+
+	void usage(){
+		printf("usage: hk_benchmark [--events N] [--workers N] [--action-us US] [--scenario NAME]\n");
+		printf("                    [--trace FILE] [--save-trace FILE] [--output FILE]\n\n");
+		printf("  --workers 0 runs the actions in the loop thread, as without executor\n");
+		printf("  --trace replays a trace file instead of the scenarios\n");
+		printf("  --save-trace writes the trace of --scenario\n\n");
+		printf("scenarios:\n");
+		for(auto & scenario: scenarios){
+			printf("  %-8s %s\n",scenario.name,scenario.description);
+		}
+	}
+}
+
+using namespace hk_benchmark;
+
+int main(int argc, char *argv[]){
+	BenchmarkOptions options;
+	zetjsoncpp::JsonVarObject<BenchmarkReport> report;
+	char date[64];
+	time_t t=time(NULL);
+
+	options.n_events=2000;
+	options.n_workers=CHotkeyExecutor::DefaultWorkers;
+	options.action_us=0;
+	options.output="hk_benchmark.json";
+
+	for(int i=1; i < argc; i++){
+		std::string arg=argv[i];
+		if(arg == "--help" || arg == "-h"){
+			usage();
+			return 0;
+		}
+		if(i+1 >= argc){
+			fprintf(stderr,"missing value for \"%s\"\n",arg.c_str());
+			usage();
+			return 1;
+		}
+
+		const char *value=argv[++i];
+		if(arg == "--events"){
+			options.n_events=(size_t)atol(value);
+		}else if(arg == "--workers"){
+			options.n_workers=(size_t)atol(value);
+		}else if(arg == "--action-us"){
+			options.action_us=atoll(value);
+		}else if(arg == "--scenario"){
+			options.scenario=value;
+		}else if(arg == "--trace"){
+			options.trace=value;
+		}else if(arg == "--save-trace"){
+			options.save_trace=value;
+		}else if(arg == "--output"){
+			options.output=value;
+		}else{
+			fprintf(stderr,"unknown option \"%s\"\n",arg.c_str());
+			usage();
+			return 1;
+		}
+	}
+
+	if(!options.save_trace.empty() && options.scenario.empty()){
+		fprintf(stderr,"--save-trace needs --scenario\n");
+		return 1;
+	}
+
+	strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%SZ",gmtime(&t));
+
+	report.date=date;
+	report.workers=(int64_t)options.n_workers;
+
+	printf("workers: %zu (times in us)\n\n",options.n_workers);
+	printf("%-8s %7s %8s %10s %10s %10s %10s %10s %10s %8s\n","scenario","events","executed","p50","p99","p99.9","others p99","done p99","action p99","loop p99");
+
+	try{
+		if(!options.trace.empty()){
+			run(report,options,"trace",load_trace(options.trace),0);
+		}else{
+			bool found=false;
+			for(auto & scenario: scenarios){
+				if(options.scenario.empty() || options.scenario == scenario.name){
+					std::vector<TraceEvent> trace=scenario.generate(options.n_events,scenario.n_bindings);
+					found=true;
+
+					if(!options.save_trace.empty()){
+						save_trace(trace,options.save_trace);
+					}
+					run(report,options,scenario.name,trace,scenario.first_action_us);
+				}
+			}
+
+			if(!found){
+				fprintf(stderr,"unknown scenario \"%s\"\n",options.scenario.c_str());
+				usage();
+				return 1;
+			}
+		}
+
+		zetjsoncpp::serialize_file(&report,options.output);
+	}catch(std::exception & ex){
+		fprintf(stderr,"error: %s\n",ex.what());
+		return 1;
+	}
+
+	printf("\nresults written to %s\n",options.output.c_str());
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "hk_benchmark_trace.h"
+
+#include <thread>
+
+namespace hk_benchmark{
+
+	// splitmix64, so a trace is the same in every platform and run
+	class Random{
+	public:
+		Random(uint64_t seed){
+			state=seed;
+		}
+
+		uint64_t next(){
+			uint64_t z=(state+=0x9e3779b97f4a7c15ULL);
+			z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+			z=(z^(z>>27))*0x94d049bb133111ebULL;
+			return z^(z>>31);
+		}
+
+		uint64_t next(uint64_t n){
+			return next()%n;
+		}
+
+	private:
+		uint64_t state;
+	};
+
+	uint16_t get_trace_virt(int n){
+		// 'A'..'Z', then '0'..'9', then function keys (VK_F1...)
+		if(n < 26){
+			return (uint16_t)('A'+n);
+		}
+		if(n < 36){
+			return (uint16_t)('0'+n-26);
+		}
+		return (uint16_t)(0x70+n-36);
+	}
+
+	TraceEvent make_event(int64_t time_us, int binding){
+		TraceEvent event;
+		event.time_us=time_us;
+		event.mod=TRACE_MOD;
+		event.virt=get_trace_virt(binding);
+		return event;
+	}
+
+	std::vector<TraceEvent> generate_steady(size_t n_events, int n_bindings, double rate, uint64_t seed){
+		std::vector<TraceEvent> trace;
+		Random random(seed);
+
+		for(size_t i=0; i < n_events; i++){
+			trace.push_back(make_event((int64_t)(i*1000000.0/rate),(int)random.next(n_bindings)));
+		}
+
+		return trace;
+	}
+
+	std::vector<TraceEvent> generate_bursts(size_t n_events, int n_bindings, size_t burst_size, int64_t interval_us, uint64_t seed){
+		std::vector<TraceEvent> trace;
+		Random random(seed);
+
+		for(size_t i=0; i < n_events; i++){
+			trace.push_back(make_event((int64_t)(i/burst_size)*interval_us,(int)random.next(n_bindings)));
+		}
+
+		return trace;
+	}
+
+	std::vector<TraceEvent> generate_repeat_storm(size_t n_events, int n_bindings, double repeat_rate, double rate, uint64_t seed){
+		std::vector<TraceEvent> trace;
+		Random random(seed);
+		double repeat_time=0,other_time=0;
+
+		// merge of the two sequences by time
+		while(trace.size() < n_events){
+			if(n_bindings < 2 || repeat_time <= other_time){
+				trace.push_back(make_event((int64_t)repeat_time,0));
+				repeat_time+=1000000.0/repeat_rate;
+			}else{
+				trace.push_back(make_event((int64_t)other_time,1+(int)random.next(n_bindings-1)));
+				other_time+=1000000.0/rate;
+			}
+		}
+
+		return trace;
+	}
+
+	std::vector<TraceEvent> load_trace(const std::string & filename){
+		std::vector<TraceEvent> trace;
+		auto file=zetjsoncpp::deserialize_file<zetjsoncpp::JsonVarObject<TraceFile>>(filename);
+
+		for(size_t i=0; i < file->events.size(); i++){
+			auto file_event=file->events[(int)i];
+			TraceEvent event;
+			event.time_us=(int64_t)file_event->time_us;
+			event.mod=(uint16_t)(int64_t)file_event->mod;
+			event.virt=(uint16_t)(int64_t)file_event->virt;
+			trace.push_back(event);
+		}
+
+		delete file;
+		return trace;
+	}
+
+	void save_trace(const std::vector<TraceEvent> & trace, const std::string & filename){
+		zetjsoncpp::JsonVarObject<TraceFile> file;
+
+		for(auto & event: trace){
+			auto file_event=(zetjsoncpp::JsonVarObject<TraceFileEvent> *)file.events.newJsonVar();
+			file_event->time_us=event.time_us;
+			file_event->mod=(int64_t)event.mod;
+			file_event->virt=(int64_t)event.virt;
+		}
+
+		zetjsoncpp::serialize_file(&file,filename);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// PressQueue
+
+	void PressQueue::push(Clock::time_point time){
+		std::lock_guard<std::mutex> guard(lock);
+		times.push_back(time);
+	}
+
+	void PressQueue::take(std::vector<Clock::time_point> & _times){
+		std::lock_guard<std::mutex> guard(lock);
+		_times.swap(times);
+		times.clear();
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// ReplaySource
+
+	ReplaySource::ReplaySource(const std::vector<TraceEvent> & _trace, std::vector<PressQueue> & _press_queues)
+		:trace(_trace),press_queues(_press_queues){
+		next_id=1;
+		next_event=0;
+		unbound_events=0;
+	}
+
+	void ReplaySource::setBinding(uint16_t mod, uint16_t virt, int binding){
+		binding_by_key[make_key(mod,virt)]=binding;
+	}
+
+	int ReplaySource::Register(uint16_t mod, uint16_t virt, uint32_t &id){
+		uint32_t key=make_key(mod,virt);
+
+		if(id_by_key.count(key)){
+			return hkheRegHotkeyError;
+		}
+
+		id=next_id++;
+		id_by_key[key]=id;
+		key_by_id[id]=key;
+		return hkheOk;
+	}
+
+	void ReplaySource::Unregister(uint32_t id){
+		auto it=key_by_id.find(id);
+		if(it != key_by_id.end()){
+			id_by_key.erase(it->second);
+			key_by_id.erase(it);
+		}
+	}
+
+	bool ReplaySource::WaitEvent(uint32_t &id){
+		if(next_event == 0){
+			start=Clock::now();
+		}else{
+			loop_times.push_back(std::chrono::duration<double,std::micro>(Clock::now()-last_return).count());
+		}
+
+		while(next_event < trace.size()){
+			const TraceEvent & event=trace[next_event++];
+			uint32_t key=make_key(event.mod,event.virt);
+			Clock::time_point press=start+std::chrono::microseconds(event.time_us);
+
+			// If the loop is behind, the press happened at its time and the delay is part of the
+			// latency. Otherwise it happens when the replay wakes up, so the oversleep is not counted.
+			if(Clock::now() < press){
+				std::this_thread::sleep_until(press);
+				press=Clock::now();
+			}
+
+			auto it_id=id_by_key.find(key);
+			auto it_binding=binding_by_key.find(key);
+			if(it_id == id_by_key.end() || it_binding == binding_by_key.end()){
+				unbound_events++;
+				continue;
+			}
+
+			press_queues[it_binding->second].push(press);
+			last_return=Clock::now();
+			id=it_id->second;
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#pragma once
+
+#include "zetjsoncpp.h"
+#include "HotkeyEngine.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace hk_benchmark{
+
+	typedef std::chrono::steady_clock Clock;
+
+	// a key press, at time_us from the start of the trace
+	typedef struct{
+		int64_t time_us;
+		uint16_t mod;
+		uint16_t virt;
+	}TraceEvent;
+
+	// file of a trace: {"events":[{"time_us":0,"mod":3,"virt":65},...]}
+	typedef struct{
+		ZJ_VAR_INT64(time_us);
+		ZJ_VAR_INT64(mod);
+		ZJ_VAR_INT64(virt);
+	}TraceFileEvent;
+
+	typedef struct{
+		ZJ_VAR_VECTOR_OBJECT(TraceFileEvent,events);
+	}TraceFile;
+
+	// modifiers of all generated bindings (MOD_CONTROL | MOD_ALT)
+	const uint16_t TRACE_MOD=0x0003;
+
+	// key of the binding n of a generated trace
+	uint16_t get_trace_virt(int n);
+
+	// n_events presses of n_bindings random keys at rate presses per second
+	std::vector<TraceEvent> generate_steady(size_t n_events, int n_bindings, double rate, uint64_t seed);
+
+	// bursts of burst_size presses at once, every interval_us
+	std::vector<TraceEvent> generate_bursts(size_t n_events, int n_bindings, size_t burst_size, int64_t interval_us, uint64_t seed);
+
+	// the key of binding 0 repeated at repeat_rate (an autorepeat storm), mixed with presses of
+	// the other bindings at rate
+	std::vector<TraceEvent> generate_repeat_storm(size_t n_events, int n_bindings, double repeat_rate, double rate, uint64_t seed);
+
+	std::vector<TraceEvent> load_trace(const std::string & filename);
+	void save_trace(const std::vector<TraceEvent> & trace, const std::string & filename);
+
+	// Presses of a binding that have not run yet. The source adds them and the callback of
+	// the binding takes them all, as the executor coalesces presses.
+	class PressQueue{
+	public:
+		void push(Clock::time_point time);
+		void take(std::vector<Clock::time_point> & times);
+
+	private:
+		std::mutex lock;
+		std::vector<Clock::time_point> times;
+	};
+
+	// Event source that replays a trace in real time. Each event is returned by WaitEvent at
+	// its time (or at once, if the dispatch is behind) and its press time is added to the
+	// PressQueue of its binding. The press time is the time of the event when the dispatch is
+	// behind, so the time the loop thread was blocked is part of the latency.
+	class ReplaySource: public CHotkeyEventSource{
+	public:
+		// press_queues is indexed by the bindings of setBinding
+		ReplaySource(const std::vector<TraceEvent> & trace, std::vector<PressQueue> & press_queues);
+
+		// mod&virt is the key of 'binding'
+		void setBinding(uint16_t mod, uint16_t virt, int binding);
+
+		int Register(uint16_t mod, uint16_t virt, uint32_t &id);
+		void Unregister(uint32_t id);
+		bool WaitEvent(uint32_t &id);
+
+		// time between the return of WaitEvent and the next call, that is, the dispatch in the
+		// loop thread (lookup and submit to the executor), in microseconds
+		const std::vector<double> & getLoopTimes(){return loop_times;}
+
+		// presses of keys that were not registered
+		size_t getUnboundEvents(){return unbound_events;}
+
+	private:
+		const std::vector<TraceEvent> & trace;
+		std::vector<PressQueue> & press_queues;
+		std::unordered_map<uint32_t,int> binding_by_key;
+		std::unordered_map<uint32_t,uint32_t> id_by_key;
+		std::unordered_map<uint32_t,uint32_t> key_by_id;
+		uint32_t next_id;
+		size_t next_event;
+		size_t unbound_events;
+		Clock::time_point start;
+		Clock::time_point last_return;
+		std::vector<double> loop_times;
+
+		static uint32_t make_key(uint16_t mod, uint16_t virt){
+			return ((uint32_t)mod << 16) | virt;
+		}
+	};
+}
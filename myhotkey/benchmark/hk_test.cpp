@@ -0,0 +1,509 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+// Tests of the reload of the hotkey table: CHotkeyEngine::Diff() and Apply() over a
+// source that records the registrations, the executor across reloads, the /proc and
+// pidfd backends of the process index and terminator and the inotify backend of the file
+// watcher. It prints the failed checks and returns 1 if any.
+
+#include "HotkeyEngine.h"
+#include "ProcessIndex.h"
+#include "ProcessTerminator.h"
+#include "FileWatcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define HK_TEST_CHECK(cond) hk_test::check((cond),#cond,__LINE__)
+
+namespace hk_test{
+
+	int n_checks=0;
+	int n_failed=0;
+
+	void check(bool ok, const char *cond, int line){
+		n_checks++;
+		if(!ok){
+			fprintf(stderr,"hk_test.cpp:%i: check failed: %s\n",line,cond);
+			n_failed++;
+		}
+	}
+
+	// registered ids, a key can be made to fail
+	class RecordSource: public CHotkeyEventSource{
+	public:
+		RecordSource(){
+			next_id=1;
+			fail_key=0;
+		}
+
+		int Register(uint16_t mod, uint16_t virt, uint32_t &id){
+			if(make_key(mod,virt) == fail_key){
+				return hkheRegHotkeyError;
+			}
+			id=next_id++;
+			registered.insert(id);
+			return hkheOk;
+		}
+
+		void Unregister(uint32_t id){
+			registered.erase(id);
+		}
+
+		bool WaitEvent(uint32_t &){
+			return false;
+		}
+
+		static uint32_t make_key(uint16_t mod, uint16_t virt){
+			return ((uint32_t)mod << 16) | virt;
+		}
+
+		std::set<uint32_t> registered;
+		uint32_t next_id;
+		uint32_t fail_key;
+	};
+
+	std::string last_call;
+
+	void callback_a(void *param){
+		last_call=std::string("a:")+(const char *)param;
+	}
+
+	void callback_b(void *param){
+		last_call=std::string("b:")+(const char *)param;
+	}
+
+	// calls of callback_record and callback_hold, that run in the executor
+	std::mutex lock_calls;
+	std::vector<std::string> calls;
+
+	void callback_record(void *param){
+		std::lock_guard<std::mutex> guard(lock_calls);
+		calls.push_back((const char *)param);
+	}
+
+	// keeps its worker busy for a while
+	void callback_hold(void *param){
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		callback_record(param);
+	}
+
+	CHotkeyEngine::tHotkeyBinding make_binding(uint16_t virt, CHotkeyEngine::tHotkeyCB callback, const std::string & param){
+		CHotkeyEngine::tHotkeyBinding binding;
+		binding.mod=3;
+		binding.virt=virt;
+		binding.callback=callback;
+		binding.param=param;
+		return binding;
+	}
+
+	size_t count_changes(const std::vector<CHotkeyEngine::tHotkeyChange> & changes, int action){
+		size_t n=0;
+		for(size_t i=0; i < changes.size(); i++){
+			n+=changes[i].action == action;
+		}
+		return n;
+	}
+
+	// registration id of mod&virt, 0 if not inserted or not registered
+	uint32_t get_id(CHotkeyEngine & engine, uint16_t virt){
+		int index;
+		const CHotkeyEngine::tHotkeyDef *def=NULL;
+
+		if(engine.FindHandler(3,virt,index) != CHotkeyEventSource::hkheOk){
+			return 0;
+		}
+
+		for(uint32_t id=1; id < 100; id++){
+			if(engine.FindHandlerById(id,def) == CHotkeyEventSource::hkheOk && def->virt == virt){
+				return id;
+			}
+		}
+		return 0;
+	}
+
+	// dispatches the key and returns what its callback was called with
+	std::string press(CHotkeyEngine & engine, uint16_t virt){
+		last_call.clear();
+		engine.Dispatch(get_id(engine,virt));
+		return last_call;
+	}
+
+	void test_add(){
+		CHotkeyEngine engine;
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+		std::vector<CHotkeyEngine::tHotkeyChange> changes;
+
+		bindings.push_back(make_binding('A',callback_a,"1"));
+		bindings.push_back(make_binding('B',callback_a,"2"));
+		bindings.push_back(make_binding('A',callback_b,"repeated")); // the first one is taken
+
+		engine.Diff(bindings,changes);
+		HK_TEST_CHECK(changes.size() == 2 && count_changes(changes,CHotkeyEngine::hkcAdd) == 2);
+
+		// not enabled: nothing is registered
+		HK_TEST_CHECK(engine.Apply(source,changes) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(engine.Count() == 2 && source.registered.empty());
+
+		HK_TEST_CHECK(engine.EnableAll(source) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(source.registered.size() == 2);
+		HK_TEST_CHECK(press(engine,'A') == "a:1");
+
+		// same table, no changes
+		engine.Diff(bindings,changes);
+		HK_TEST_CHECK(changes.empty());
+
+		// added while enabled: registered at once
+		bindings.push_back(make_binding('C',callback_b,"3"));
+		HK_TEST_CHECK(engine.Reload(source,bindings) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(source.registered.size() == 3 && press(engine,'C') == "b:3");
+	}
+
+	void test_remove_and_rebind(){
+		CHotkeyEngine engine;
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+		std::vector<CHotkeyEngine::tHotkeyChange> changes;
+
+		bindings.push_back(make_binding('A',callback_a,"1"));
+		bindings.push_back(make_binding('B',callback_a,"2"));
+		bindings.push_back(make_binding('C',callback_a,"3"));
+		engine.Reload(source,bindings);
+		engine.EnableAll(source);
+
+		uint32_t id_a=get_id(engine,'A');
+		uint32_t id_b=get_id(engine,'B');
+
+		// B removed, A calls another callback, C another param
+		bindings.erase(bindings.begin()+1);
+		bindings[0].callback=callback_b;
+		bindings[1].param="33";
+
+		engine.Diff(bindings,changes);
+		HK_TEST_CHECK(changes.size() == 3);
+		HK_TEST_CHECK(count_changes(changes,CHotkeyEngine::hkcRemove) == 1);
+		HK_TEST_CHECK(count_changes(changes,CHotkeyEngine::hkcChange) == 2);
+
+		HK_TEST_CHECK(engine.Apply(source,changes) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(engine.Count() == 2);
+		HK_TEST_CHECK(source.registered.count(id_b) == 0 && get_id(engine,'B') == 0);
+
+		// changed hotkeys keep their registration
+		HK_TEST_CHECK(get_id(engine,'A') == id_a && source.registered.count(id_a) == 1);
+		HK_TEST_CHECK(press(engine,'A') == "b:1");
+		HK_TEST_CHECK(press(engine,'C') == "a:33");
+
+		// the action of C moved to D: C is unregistered and D registered
+		bindings[1].virt='D';
+		uint32_t id_c=get_id(engine,'C');
+		HK_TEST_CHECK(engine.Reload(source,bindings) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(source.registered.count(id_c) == 0 && get_id(engine,'C') == 0);
+		HK_TEST_CHECK(press(engine,'D') == "a:33");
+		HK_TEST_CHECK(source.registered.size() == 2);
+	}
+
+	void test_free_slot(){
+		CHotkeyEngine engine;
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+		int index_b,index_e,index_f;
+
+		bindings.push_back(make_binding('A',callback_a,"1"));
+		bindings.push_back(make_binding('B',callback_a,"2"));
+		engine.Reload(source,bindings);
+		engine.EnableAll(source);
+		engine.FindHandler(3,'B',index_b);
+
+		// B removed and E added in the same reload: E takes the slot of B
+		bindings[1]=make_binding('E',callback_b,"5");
+		HK_TEST_CHECK(engine.Reload(source,bindings) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(engine.FindHandler(3,'E',index_e) == CHotkeyEventSource::hkheOk && index_e == index_b);
+		HK_TEST_CHECK(engine.FindHandler(3,'B',index_b) == CHotkeyEventSource::hkheNoEntry);
+		HK_TEST_CHECK(press(engine,'E') == "b:5");
+		HK_TEST_CHECK(engine.Count() == 2 && source.registered.size() == 2);
+
+		// a new key without free slots is appended
+		bindings.push_back(make_binding('F',callback_a,"6"));
+		engine.Reload(source,bindings);
+		HK_TEST_CHECK(engine.FindHandler(3,'F',index_f) == CHotkeyEventSource::hkheOk && index_f == 2);
+	}
+
+	void test_register_error(){
+		CHotkeyEngine engine;
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+
+		bindings.push_back(make_binding('A',callback_a,"1"));
+		engine.Reload(source,bindings);
+		engine.EnableAll(source);
+
+		// G can't be registered: the other changes are applied and G stays unregistered
+		source.fail_key=RecordSource::make_key(3,'G');
+		bindings[0].param="11";
+		bindings.push_back(make_binding('G',callback_a,"7"));
+		bindings.push_back(make_binding('H',callback_a,"8"));
+		HK_TEST_CHECK(engine.Reload(source,bindings) == CHotkeyEventSource::hkheRegHotkeyError);
+		HK_TEST_CHECK(engine.Count() == 3 && source.registered.size() == 2);
+		HK_TEST_CHECK(press(engine,'A') == "a:11" && press(engine,'H') == "a:8");
+		HK_TEST_CHECK(get_id(engine,'G') == 0);
+
+		// the key of G is released: the same table registers it
+		source.fail_key=0;
+		HK_TEST_CHECK(engine.Reload(source,bindings) == CHotkeyEventSource::hkheOk);
+		HK_TEST_CHECK(source.registered.size() == 3 && press(engine,'G') == "a:7");
+	}
+
+	// a press of a hotkey that took the slot of a removed one isn't merged into the press
+	// of the removed one that is still queued
+	void test_executor_free_slot(){
+		CHotkeyEngine engine;
+		CHotkeyExecutor executor(1);
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+		int index_b,index_e;
+
+		bindings.push_back(make_binding('A',callback_hold,"hold"));
+		bindings.push_back(make_binding('B',callback_record,"old"));
+		engine.Reload(source,bindings);
+		engine.EnableAll(source);
+		engine.SetExecutor(&executor);
+		executor.Start();
+		engine.FindHandler(3,'B',index_b);
+
+		// B waits for the worker that runs A
+		engine.Dispatch(get_id(engine,'A'));
+		engine.Dispatch(get_id(engine,'B'));
+
+		bindings[1]=make_binding('E',callback_record,"new");
+		engine.Reload(source,bindings);
+		HK_TEST_CHECK(engine.FindHandler(3,'E',index_e) == CHotkeyEventSource::hkheOk && index_e == index_b);
+		engine.Dispatch(get_id(engine,'E'));
+
+		executor.Drain();
+		executor.Stop();
+
+		std::lock_guard<std::mutex> guard(lock_calls);
+		HK_TEST_CHECK(calls.size() == 3);
+		HK_TEST_CHECK(std::count(calls.begin(),calls.end(),std::string("old")) == 1);
+		HK_TEST_CHECK(std::count(calls.begin(),calls.end(),std::string("new")) == 1);
+	}
+
+	// a binding whose callback changes in place runs apart from the presses pending before
+	void test_executor_change(){
+		CHotkeyEngine engine;
+		CHotkeyExecutor executor(1);
+		RecordSource source;
+		std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+
+		{
+			std::lock_guard<std::mutex> guard(lock_calls);
+			calls.clear();
+		}
+
+		bindings.push_back(make_binding('A',callback_hold,"hold"));
+		bindings.push_back(make_binding('B',callback_record,"old"));
+		engine.Reload(source,bindings);
+		engine.EnableAll(source);
+		engine.SetExecutor(&executor);
+		executor.Start();
+
+		// B waits for the worker that runs A
+		engine.Dispatch(get_id(engine,'A'));
+		engine.Dispatch(get_id(engine,'B'));
+
+		bindings[1].param="new";
+		engine.Reload(source,bindings);
+		engine.Dispatch(get_id(engine,'B'));
+
+		executor.Drain();
+		executor.Stop();
+
+		std::lock_guard<std::mutex> guard(lock_calls);
+		HK_TEST_CHECK(calls.size() == 3);
+		HK_TEST_CHECK(std::count(calls.begin(),calls.end(),std::string("old")) == 1);
+		HK_TEST_CHECK(std::count(calls.begin(),calls.end(),std::string("new")) == 1);
+	}
+
+	// starts n processes 'sleep 30'
+	std::vector<uint32_t> start_sleeps(size_t n){
+		std::vector<uint32_t> pids;
+
+		for(size_t i=0; i < n; i++){
+			pid_t pid=fork();
+			if(pid == 0){
+				execlp("sleep","sleep","30",(char *)NULL);
+				_exit(127);
+			}
+			if(pid > 0){
+				pids.push_back((uint32_t)pid);
+			}
+		}
+		return pids;
+	}
+
+	void stop_sleeps(const std::vector<uint32_t> & pids){
+		for(size_t i=0; i < pids.size(); i++){
+			kill((pid_t)pids[i],SIGKILL);
+			waitpid((pid_t)pids[i],NULL,0);
+		}
+	}
+
+	// true if all 'pids' are in 'found'
+	bool contains_all(const std::vector<uint32_t> & found, const std::vector<uint32_t> & pids){
+		for(size_t i=0; i < pids.size(); i++){
+			if(std::find(found.begin(),found.end(),pids[i]) == found.end()){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// waits for the forked children to run sleep, the name of the test until then
+	bool find_sleeps(CProcessIndex & index, const std::vector<uint32_t> & pids, std::vector<uint32_t> & found){
+		for(int i=0; i < 200; i++){
+			if(index.Find("SLEEP",found,true) && contains_all(found,pids)){
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return false;
+	}
+
+	void test_process_index(){
+		CProcessIndex index;
+		std::vector<uint32_t> pids=start_sleeps(3),found;
+
+		HK_TEST_CHECK(pids.size() == 3);
+
+		// the whole image name, ignoring the case
+		HK_TEST_CHECK(find_sleeps(index,pids,found));
+		HK_TEST_CHECK(!index.Find("slee",found) && found.empty());
+
+		// known name whose pids still run: no snapshot
+		uint64_t n_refresh=index.RefreshCount();
+		HK_TEST_CHECK(index.Find("sleep",found) && contains_all(found,pids));
+		HK_TEST_CHECK(index.RefreshCount() == n_refresh);
+
+		// a pid that has exited is found stale and the index is refreshed
+		stop_sleeps(std::vector<uint32_t>(1,pids[0]));
+		HK_TEST_CHECK(!index.Find("sleep",found) || std::find(found.begin(),found.end(),pids[0]) == found.end());
+		HK_TEST_CHECK(index.RefreshCount() > n_refresh);
+
+		stop_sleeps(std::vector<uint32_t>(pids.begin()+1,pids.end()));
+	}
+
+	// pidfds whose termination is never requested, so the processes outlive the wait
+	class NoTerminateControl: public CPidfdProcessControl{
+	public:
+		uint32_t Terminate(tHandle){
+			return 0;
+		}
+	};
+
+	void test_process_terminator(){
+		CProcessIndex index;
+		NoTerminateControl no_terminate_control;
+		CProcessTerminator no_terminate(index,&no_terminate_control);
+		CProcessTerminator terminator(index);
+		std::vector<CProcessTerminator::tResult> results;
+		std::vector<uint32_t> pids=start_sleeps(3),found;
+		size_t n_ok=0,n_timeout=0;
+
+		HK_TEST_CHECK(find_sleeps(index,pids,found));
+
+		// by pid, not by name, so the other sleep processes of the system are left running
+		HK_TEST_CHECK(no_terminate.Terminate(pids,results,50) == CProcessTerminator::pteTimeout);
+		for(size_t i=0; i < results.size(); i++){
+			n_timeout+=results[i].pid == pids[i] && results[i].rc == CProcessTerminator::pteTimeout;
+		}
+		HK_TEST_CHECK(results.size() == 3 && n_timeout == 3);
+
+		HK_TEST_CHECK(terminator.Terminate(pids,results,1000) == CProcessTerminator::pteOk);
+		for(size_t i=0; i < results.size(); i++){
+			n_ok+=results[i].pid == pids[i] && results[i].rc == CProcessTerminator::pteOk && results[i].error == 0;
+		}
+		HK_TEST_CHECK(results.size() == 3 && n_ok == 3);
+
+		// reaped, they're gone from /proc
+		for(size_t i=0; i < pids.size(); i++){
+			waitpid((pid_t)pids[i],NULL,0);
+		}
+		index.Find("sleep",found,true);
+		for(size_t i=0; i < pids.size(); i++){
+			HK_TEST_CHECK(std::find(found.begin(),found.end(),pids[i]) == found.end());
+		}
+	}
+
+	std::atomic<int> n_file_changes(0);
+
+	void callback_file_changed(void *){
+		n_file_changes++;
+	}
+
+	bool write_file(const std::string & filename, const char *text){
+		FILE *fp=fopen(filename.c_str(),"w");
+		if(fp == NULL){
+			return false;
+		}
+		fputs(text,fp);
+		fclose(fp);
+		return true;
+	}
+
+	// a save as editors do it: a new file renamed over the watched one
+	void test_file_watcher(){
+		char dir[]="/tmp/hk_test_XXXXXX";
+		typedef std::chrono::steady_clock tClock;
+
+		HK_TEST_CHECK(mkdtemp(dir) != NULL);
+		std::string filename=std::string(dir)+"/hotkeys.json";
+		std::string filename_tmp=std::string(dir)+"/hotkeys.json.tmp";
+		HK_TEST_CHECK(write_file(filename,"{}"));
+
+		CFileWatcher watcher;
+		HK_TEST_CHECK(watcher.Start(filename,callback_file_changed,NULL,100));
+
+		HK_TEST_CHECK(write_file(filename_tmp,"{\"hotkeytasks\":{}}"));
+		HK_TEST_CHECK(rename(filename_tmp.c_str(),filename.c_str()) == 0);
+
+		// the callback comes after 100ms without changes, and only once
+		for(int i=0; i < 200 && n_file_changes == 0; i++){
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		HK_TEST_CHECK(n_file_changes == 1);
+
+		// the thread waits for a change for ever, Stop() wakes it
+		tClock::time_point start=tClock::now();
+		watcher.Stop();
+		HK_TEST_CHECK(tClock::now()-start < std::chrono::milliseconds(500));
+
+		remove(filename.c_str());
+		rmdir(dir);
+	}
+}
+
+int main(){
+	hk_test::test_add();
+	hk_test::test_remove_and_rebind();
+	hk_test::test_free_slot();
+	hk_test::test_register_error();
+	hk_test::test_executor_free_slot();
+	hk_test::test_executor_change();
+	hk_test::test_process_index();
+	hk_test::test_process_terminator();
+	hk_test::test_file_watcher();
+
+	printf("hk_test: %i checks, %i failed\n",hk_test::n_checks,hk_test::n_failed);
+	return hk_test::n_failed ? 1 : 0;
+}
@@ -0,0 +1,337 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+// Throughput of deserialize, deserialize_file, unmapped documents (checked and skipped), deserialize_lazy, serialize and the binary snapshots over generated corpora.
+//
+// usage: zj_benchmark [--size MB] [--min-time SECONDS] [--corpus NAME] [--tmp DIR] [--output FILE]
+
+#include "zj_benchmark_corpus.h"
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <sys/resource.h>
+
+#define ZJ_BENCHMARK_MIN_ITERATIONS	3
+
+//------------------------------------------------------------------------------------------------
+// allocation counter
+//
+// malloc is replaced instead of operator new, so the buffers of the library that are allocated
+// with malloc (sink chunks, file buffers) are counted too. operator new calls malloc. The
+// allocators of glibc do the work.
+
+static std::atomic<size_t> n_allocations(0);
+
+extern "C"{
+
+	void *__libc_malloc(size_t size);
+	void *__libc_calloc(size_t n, size_t size);
+	void *__libc_realloc(void *ptr, size_t size);
+	void __libc_free(void *ptr);
+
+	void *malloc(size_t size){
+		n_allocations.fetch_add(1,std::memory_order_relaxed);
+		return __libc_malloc(size);
+	}
+
+	void *calloc(size_t n, size_t size){
+		n_allocations.fetch_add(1,std::memory_order_relaxed);
+		return __libc_calloc(n,size);
+	}
+
+	// it may move the block, so it's counted as an allocation
+	void *realloc(void *ptr, size_t size){
+		n_allocations.fetch_add(1,std::memory_order_relaxed);
+		return __libc_realloc(ptr,size);
+	}
+
+	void free(void *ptr){
+		__libc_free(ptr);
+	}
+}
+
+namespace zj_benchmark{
+
+	typedef struct{
+		ZJ_VAR_STRING(corpus);
+		ZJ_VAR_STRING(operation);
+		ZJ_VAR_INT64(bytes);
+		ZJ_VAR_INT64(iterations);
+		ZJ_VAR_DOUBLE(seconds); // median of the iterations
+		ZJ_VAR_DOUBLE(mb_per_second);
+		ZJ_VAR_INT64(allocations); // per document
+		ZJ_VAR_INT64(peak_rss_kb);
+	}BenchmarkResult;
+
+	typedef struct{
+		ZJ_VAR_STRING(library_version);
+		ZJ_VAR_STRING(scan_implementation);
+		ZJ_VAR_STRING(date);
+		ZJ_VAR_INT64(corpus_bytes);
+		ZJ_VAR_VECTOR_OBJECT(BenchmarkResult,results);
+	}BenchmarkReport;
+
+	typedef struct{
+		size_t corpus_bytes;
+		double min_time;
+		std::string corpus;
+		std::string tmp_dir;
+		std::string output;
+	}BenchmarkOptions;
+
+	// Resets the peak of resident memory, so the peak of each operation can be measured
+	// alone. Linux >= 4.0, otherwise the peak of the whole process is reported.
+	void reset_peak_rss(){
+		FILE *fp=fopen("/proc/self/clear_refs","w");
+		if(fp != NULL){
+			fputs("5",fp);
+			fclose(fp);
+		}
+	}
+
+	int64_t get_peak_rss_kb(){
+		char line[256];
+		int64_t peak=-1;
+		FILE *fp=fopen("/proc/self/status","r");
+
+		if(fp != NULL){
+			while(fgets(line,sizeof(line),fp) != NULL){
+				if(strncmp(line,"VmHWM:",6) == 0){
+					peak=strtoll(line+6,NULL,10);
+					break;
+				}
+			}
+			fclose(fp);
+		}
+
+		if(peak < 0){
+			struct rusage usage;
+			getrusage(RUSAGE_SELF,&usage);
+			peak=usage.ru_maxrss;
+		}
+
+		return peak;
+	}
+
+	double now(){
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Runs operation at least ZJ_BENCHMARK_MIN_ITERATIONS times and min_time seconds, and adds its result.
+	// operation returns the bytes it processed.
+	template<typename _T_OPERATION>
+	void run(BenchmarkReport & report, const BenchmarkOptions & options, const char *corpus, const char *operation_name, _T_OPERATION operation){
+		std::vector<double> times;
+		size_t bytes=0;
+		size_t allocations;
+		double start=now();
+
+		reset_peak_rss();
+
+		// first iteration apart, so allocations of one document are counted exactly
+		allocations=n_allocations.load(std::memory_order_relaxed);
+		double t=now();
+		bytes=operation();
+		times.push_back(now()-t);
+		allocations=n_allocations.load(std::memory_order_relaxed)-allocations;
+
+		while(times.size() < ZJ_BENCHMARK_MIN_ITERATIONS || (now()-start) < options.min_time){
+			t=now();
+			operation();
+			times.push_back(now()-t);
+		}
+
+		std::sort(times.begin(),times.end());
+
+		zetjsoncpp::JsonVarObject<BenchmarkResult> *result=(zetjsoncpp::JsonVarObject<BenchmarkResult> *)report.results.newJsonVar();
+		result->corpus=corpus;
+		result->operation=operation_name;
+		result->bytes=(int64_t)bytes;
+		result->iterations=(int64_t)times.size();
+		result->seconds=times[times.size()/2];
+		result->mb_per_second=result->seconds > 0?(bytes/(1024.0*1024.0))/result->seconds:0;
+		result->allocations=(int64_t)allocations;
+		result->peak_rss_kb=get_peak_rss_kb();
+
+		printf("%-10s %-25s %10zu %6zu %10.2f %12zu %12lli\n"
+			,corpus
+			,operation_name
+			,bytes
+			,times.size()
+			,(double)result->mb_per_second
+			,allocations
+			,(long long)(int64_t)result->peak_rss_kb
+		);
+		fflush(stdout);
+	}
+
+	void write_file(const std::string & filename, const std::string & text){
+		FILE *fp=fopen(filename.c_str(),"wb");
+		bool ok=fp != NULL && fwrite(text.c_str(),1,text.size(),fp) == text.size();
+
+		if(fp != NULL){
+			ok&=fclose(fp) == 0;
+		}
+
+		if(!ok){
+			throw std::runtime_error(zetjsoncpp::zj_strutils::format("cannot write \"%s\"",filename.c_str()));
+		}
+	}
+
+	void run_corpus(BenchmarkReport & report, const BenchmarkOptions & options, Corpus *corpus){
+		std::string text=corpus->generate(options.corpus_bytes);
+		std::string filename=options.tmp_dir+"/zj_benchmark_"+corpus->getName()+".json";
+		zetjsoncpp::JsonVar *json_var=NULL;
+
+		write_file(filename,text);
+
+		try{
+			run(report,options,corpus->getName(),"deserialize",[&](){
+				delete corpus->deserialize(text);
+				return text.size();
+			});
+
+			run(report,options,corpus->getName(),"deserialize_file",[&](){
+				delete corpus->deserializeFile(filename);
+				return text.size();
+			});
+
+			// values of keys that are not mapped are only checked
+			run(report,options,corpus->getName(),"deserialize_unmapped",[&](){
+				delete zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<UnmappedDocument>>(text);
+				return text.size();
+			});
+
+			// or skipped without parsing them
+			run(report,options,corpus->getName(),"deserialize_skip_unmapped",[&](){
+				delete zetjsoncpp::deserialize_skip_unmapped<zetjsoncpp::JsonVarObject<UnmappedDocument>>(text);
+				return text.size();
+			});
+
+			// only the tape, as a lower bound of any lazy read
+			run(report,options,corpus->getName(),"deserialize_lazy",[&](){
+				delete zetjsoncpp::deserialize_lazy(text);
+				return text.size();
+			});
+
+			json_var=corpus->deserialize(text);
+
+			run(report,options,corpus->getName(),"serialize_minimized",[&](){
+				return zetjsoncpp::serialize(json_var,true).size();
+			});
+
+			run(report,options,corpus->getName(),"serialize",[&](){
+				return zetjsoncpp::serialize(json_var,false).size();
+			});
+
+			run(report,options,corpus->getName(),"serialize_binary",[&](){
+				return zetjsoncpp::serialize_binary(json_var).size();
+			});
+
+			// bytes of the text, so its MB/s compares with deserialize
+			std::string snapshot=zetjsoncpp::serialize_binary(json_var);
+			run(report,options,corpus->getName(),"deserialize_binary",[&](){
+				delete corpus->deserializeBinary(snapshot);
+				return text.size();
+			});
+		}catch(...){
+			delete json_var;
+			remove(filename.c_str());
+			throw;
+		}
+
+		delete json_var;
+		remove(filename.c_str());
+	}
+
+	void usage(){
+		printf("usage: zj_benchmark [--size MB] [--min-time SECONDS] [--corpus NAME] [--tmp DIR] [--output FILE]\n\n");
+		printf("corpora:");
+		for(auto corpus: get_corpora()){
+			printf(" %s",corpus->getName());
+		}
+		printf("\n");
+	}
+}
+
+using namespace zj_benchmark;
+
+int main(int argc, char *argv[]){
+	BenchmarkOptions options;
+	zetjsoncpp::JsonVarObject<BenchmarkReport> report;
+	char date[64];
+	time_t t=time(NULL);
+
+	options.corpus_bytes=4*1024*1024;
+	options.min_time=1.0;
+	options.tmp_dir="/tmp";
+	options.output="zj_benchmark.json";
+
+	for(int i=1; i < argc; i++){
+		std::string arg=argv[i];
+		if(arg == "--help" || arg == "-h"){
+			usage();
+			return 0;
+		}
+		if(i+1 >= argc){
+			fprintf(stderr,"missing value for \"%s\"\n",arg.c_str());
+			usage();
+			return 1;
+		}
+
+		const char *value=argv[++i];
+		if(arg == "--size"){
+			options.corpus_bytes=(size_t)(atof(value)*1024*1024);
+		}else if(arg == "--min-time"){
+			options.min_time=atof(value);
+		}else if(arg == "--corpus"){
+			options.corpus=value;
+		}else if(arg == "--tmp"){
+			options.tmp_dir=value;
+		}else if(arg == "--output"){
+			options.output=value;
+		}else{
+			fprintf(stderr,"unknown option \"%s\"\n",arg.c_str());
+			usage();
+			return 1;
+		}
+	}
+
+	strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%SZ",gmtime(&t));
+
+	report.library_version=zetjsoncpp::zj_strutils::format("%i.%i.%i",ZETJSONCPP_MAJOR_VERSION,ZETJSONCPP_MINOR_VERSION,ZETJSONCPP_PATCH_VERSION);
+	report.scan_implementation=zetjsoncpp::zj_scan::get_implementation_name();
+	report.date=date;
+	report.corpus_bytes=(int64_t)options.corpus_bytes;
+
+	printf("zetjsoncpp %s (scan: %s)\n\n",report.library_version.c_str(),report.scan_implementation.c_str());
+	printf("%-10s %-25s %10s %6s %10s %12s %12s\n","corpus","operation","bytes","iters","MB/s","allocs/doc","peak rss KB");
+
+	try{
+		bool found=false;
+		for(auto corpus: get_corpora()){
+			if(options.corpus.empty() || options.corpus == corpus->getName()){
+				found=true;
+				run_corpus(report,options,corpus);
+			}
+		}
+
+		if(!found){
+			fprintf(stderr,"unknown corpus \"%s\"\n",options.corpus.c_str());
+			usage();
+			return 1;
+		}
+
+		zetjsoncpp::serialize_file(&report,options.output);
+	}catch(std::exception & ex){
+		fprintf(stderr,"error: %s\n",ex.what());
+		return 1;
+	}
+
+	printf("\nresults written to %s\n",options.output.c_str());
+
+	return 0;
+}
@@ -0,0 +1,298 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "zj_benchmark_corpus.h"
+
+namespace zj_benchmark{
+
+	// splitmix64, so the corpus is the same in every platform and run
+	class Random{
+	public:
+		Random(uint64_t seed){
+			state=seed;
+		}
+
+		uint64_t next(){
+			uint64_t z=(state+=0x9e3779b97f4a7c15ULL);
+			z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+			z=(z^(z>>27))*0x94d049bb133111ebULL;
+			return z^(z>>31);
+		}
+
+		uint64_t next(uint64_t n){
+			return next()%n;
+		}
+
+		double nextDouble(){
+			return (next()>>11)*(1.0/9007199254740992.0);
+		}
+
+	private:
+		uint64_t state;
+	};
+
+	static const char *words[]={
+		"alpha","bravo","charlie","delta","echo","foxtrot","golf","hotel","india","juliett"
+		,"kilo","lima","mike","november","oscar","papa","quebec","romeo","sierra","tango"
+	};
+
+	void append_word(std::string & text, Random & random){
+		text+=words[random.next(sizeof(words)/sizeof(words[0]))];
+	}
+
+	// text of n words, sometimes with escaped quotes and backslashes
+	void append_string(std::string & text, Random & random, int n_words){
+		text+='\"';
+		for(int i=0; i < n_words; i++){
+			if(i > 0){
+				text+=' ';
+			}
+			// escapes go before the word
+			if(random.next(16) == 0){
+				text+=random.next(2)==0?"\\\"":"\\\\";
+			}
+			append_word(text,random);
+		}
+		text+='\"';
+	}
+
+	void append_number(std::string & text, double value){
+		char buffer[ZJ_NUMBER_MAX_CHARS];
+		text.append(buffer,zetjsoncpp::zj_number::to_chars(buffer,value)-buffer);
+	}
+
+	void append_number(std::string & text, int64_t value){
+		char buffer[ZJ_NUMBER_MAX_CHARS];
+		text.append(buffer,zetjsoncpp::zj_number::to_chars(buffer,value)-buffer);
+	}
+
+	void append_ident(std::string & text, int ident){
+		text+='\n';
+		text.append(ident,'\t');
+	}
+
+	template<typename _T_DOCUMENT>
+	class CorpusOf: public Corpus{
+	public:
+		virtual zetjsoncpp::JsonVar *deserialize(const std::string & text){
+			return zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<_T_DOCUMENT>>(text);
+		}
+
+		virtual zetjsoncpp::JsonVar *deserializeFile(const std::string & filename){
+			return zetjsoncpp::deserialize_file<zetjsoncpp::JsonVarObject<_T_DOCUMENT>>(filename);
+		}
+
+		virtual zetjsoncpp::JsonVar *deserializeBinary(const std::string & snapshot){
+			return zetjsoncpp::deserialize_binary<zetjsoncpp::JsonVarObject<_T_DOCUMENT>>(snapshot);
+		}
+	};
+
+	class DeepCorpus: public CorpusOf<DeepDocument>{
+	public:
+		virtual const char *getName(){ return "deep";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(1);
+			std::string text="{\"nodes\":[";
+
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				for(int depth=ZJ_BENCHMARK_DEEP_DEPTH; depth >= 0; depth--){
+					append_ident(text,ZJ_BENCHMARK_DEEP_DEPTH-depth+1);
+					text+="{\"id\":";
+					append_number(text,(int64_t)random.next(1000000));
+					text+=depth>0?",\"child\":":",\"name\":";
+				}
+				append_string(text,random,2);
+				text.append(ZJ_BENCHMARK_DEEP_DEPTH+1,'}');
+			}
+
+			text+="\n]}";
+			return text;
+		}
+	};
+
+	class WideCorpus: public CorpusOf<WideDocument>{
+	public:
+		virtual const char *getName(){ return "wide";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(2);
+			std::string text="{\"records\":[";
+			char name[8];
+
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				append_ident(text,1);
+				text+='{';
+				for(int i=0; i < 32; i++){
+					snprintf(name,sizeof(name),"%c%02i","idsb"[i/8],i%8);
+					text+=i>0?",\"":"\"";
+					text+=name;
+					text+="\":";
+					switch(i/8){
+					case 0:
+						append_number(text,(int64_t)(random.next()>>random.next(64)));
+						break;
+					case 1:
+						append_number(text,(random.nextDouble()-0.5)*1e6);
+						break;
+					case 2:
+						append_string(text,random,1+(int)random.next(4));
+						break;
+					default:
+						text+=random.next(2)==0?"true":"false";
+						break;
+					}
+				}
+				text+='}';
+			}
+
+			text+="\n]}";
+			return text;
+		}
+	};
+
+	class NumbersCorpus: public CorpusOf<NumbersDocument>{
+	public:
+		virtual const char *getName(){ return "numbers";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(3);
+			std::string text="{\"floats\":[";
+
+			for(int n=0; text.size() < target_size/2; n++){
+				text+=n>0?",":"";
+				if(n%16 == 0){
+					append_ident(text,1);
+				}
+				append_number(text,(double)(float)((random.nextDouble()-0.5)*1000));
+			}
+
+			text+="\n],\"doubles\":[";
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				if(n%16 == 0){
+					append_ident(text,1);
+				}
+				append_number(text,(random.nextDouble()-0.5)*pow(10,(double)random.next(40)-20));
+			}
+
+			text+="\n]}";
+			return text;
+		}
+	};
+
+	class StringsCorpus: public CorpusOf<StringsDocument>{
+	public:
+		virtual const char *getName(){ return "strings";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(4);
+			std::string text="{\"strings\":[";
+
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				append_ident(text,1);
+				// mostly short strings, some long ones
+				append_string(text,random,random.next(8)==0?20+(int)random.next(200):1+(int)random.next(6));
+			}
+
+			text+="\n]}";
+			return text;
+		}
+	};
+
+	class MapsCorpus: public CorpusOf<MapsDocument>{
+	public:
+		virtual const char *getName(){ return "maps";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(5);
+			std::string text="{\"tree\":{";
+
+			for(int n=0; text.size() < target_size/2; n++){
+				text+=n>0?",":"";
+				append_ident(text,1);
+				text+="\"key";
+				append_number(text,(int64_t)n);
+				text+='_';
+				append_word(text,random);
+				text+="\":";
+				append_string(text,random,1+(int)random.next(3));
+			}
+
+			text+="\n},\"hash\":{";
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				append_ident(text,1);
+				text+="\"";
+				append_word(text,random);
+				text+='_';
+				append_number(text,(int64_t)n);
+				text+="\":";
+				append_number(text,random.nextDouble()*1000);
+			}
+
+			text+="\n}}";
+			return text;
+		}
+	};
+
+	class CommentsCorpus: public CorpusOf<CommentsDocument>{
+	public:
+		virtual const char *getName(){ return "comments";}
+
+		virtual std::string generate(size_t target_size){
+			Random random(6);
+			std::string text="// records with comments\n{\"records\":[";
+
+			for(int n=0; text.size() < target_size; n++){
+				text+=n>0?",":"";
+				append_ident(text,1);
+				text+="/* record ";
+				append_number(text,(int64_t)n);
+				text+=" */";
+				append_ident(text,1);
+				text+="{ \"id\":";
+				append_number(text,(int64_t)n);
+				text+=", // ";
+				append_word(text,random);
+				append_ident(text,2);
+				text+="\"name\":";
+				append_string(text,random,2);
+				text+=", /* ";
+				append_word(text,random);
+				text+="\n\t\t ";
+				append_word(text,random);
+				text+=" */ \"value\":";
+				append_number(text,random.nextDouble());
+				text+=",";
+				append_ident(text,2);
+				text+="// ";
+				append_word(text,random);
+				append_ident(text,2);
+				text+="\"enabled\":";
+				text+=random.next(2)==0?"true":"false";
+				text+=" }";
+			}
+
+			text+="\n]}";
+			return text;
+		}
+	};
+
+	const std::vector<Corpus *> & get_corpora(){
+		static DeepCorpus deep;
+		static WideCorpus wide;
+		static NumbersCorpus numbers;
+		static StringsCorpus strings;
+		static MapsCorpus maps;
+		static CommentsCorpus comments;
+		static std::vector<Corpus *> corpora={&deep,&wide,&numbers,&strings,&maps,&comments};
+
+		return corpora;
+	}
+}
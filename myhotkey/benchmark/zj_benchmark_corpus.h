@@ -0,0 +1,97 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#pragma once
+
+#include "zetjsoncpp.h"
+
+#define ZJ_BENCHMARK_DEEP_DEPTH		24
+
+namespace zj_benchmark{
+
+	// deep: vector of objects nested ZJ_BENCHMARK_DEEP_DEPTH levels
+	template<int _T_DEPTH>
+	struct DeepNode{
+		ZJ_VAR_INT64(id);
+		ZJ_VAR_OBJECT(DeepNode<_T_DEPTH-1>,child);
+	};
+
+	template<>
+	struct DeepNode<0>{
+		ZJ_VAR_INT64(id);
+		ZJ_VAR_STRING(name);
+	};
+
+	typedef struct{
+		ZJ_VAR_VECTOR_OBJECT(DeepNode<ZJ_BENCHMARK_DEEP_DEPTH>,nodes);
+	}DeepDocument;
+
+	// wide: vector of objects with 32 properties
+	typedef struct{
+		ZJ_VAR_INT64(i00); ZJ_VAR_INT64(i01); ZJ_VAR_INT64(i02); ZJ_VAR_INT64(i03);
+		ZJ_VAR_INT64(i04); ZJ_VAR_INT64(i05); ZJ_VAR_INT64(i06); ZJ_VAR_INT64(i07);
+		ZJ_VAR_DOUBLE(d00); ZJ_VAR_DOUBLE(d01); ZJ_VAR_DOUBLE(d02); ZJ_VAR_DOUBLE(d03);
+		ZJ_VAR_DOUBLE(d04); ZJ_VAR_DOUBLE(d05); ZJ_VAR_DOUBLE(d06); ZJ_VAR_DOUBLE(d07);
+		ZJ_VAR_STRING(s00); ZJ_VAR_STRING(s01); ZJ_VAR_STRING(s02); ZJ_VAR_STRING(s03);
+		ZJ_VAR_STRING(s04); ZJ_VAR_STRING(s05); ZJ_VAR_STRING(s06); ZJ_VAR_STRING(s07);
+		ZJ_VAR_BOOLEAN(b00); ZJ_VAR_BOOLEAN(b01); ZJ_VAR_BOOLEAN(b02); ZJ_VAR_BOOLEAN(b03);
+		ZJ_VAR_BOOLEAN(b04); ZJ_VAR_BOOLEAN(b05); ZJ_VAR_BOOLEAN(b06); ZJ_VAR_BOOLEAN(b07);
+	}WideRecord;
+
+	typedef struct{
+		ZJ_VAR_VECTOR_OBJECT(WideRecord,records);
+	}WideDocument;
+
+	// numbers: large vectors of floats and doubles
+	typedef struct{
+		ZJ_VAR_VECTOR_NUMBER(floats);
+		ZJ_VAR_VECTOR_DOUBLE(doubles);
+	}NumbersDocument;
+
+	// strings: large vector of strings of several lengths, some with escapes
+	typedef struct{
+		ZJ_VAR_VECTOR_STRING(strings);
+	}StringsDocument;
+
+	// maps: many keys in the default (std::map) and the hash storage
+	typedef struct{
+		ZJ_VAR_MAP_STRING(tree);
+		ZJ_VAR_HASH_MAP_DOUBLE(hash);
+	}MapsDocument;
+
+	// comments: small records surrounded by line and block comments
+	typedef struct{
+		ZJ_VAR_INT64(id);
+		ZJ_VAR_STRING(name);
+		ZJ_VAR_DOUBLE(value);
+		ZJ_VAR_BOOLEAN(enabled);
+	}CommentedRecord;
+
+	typedef struct{
+		ZJ_VAR_VECTOR_OBJECT(CommentedRecord,records);
+	}CommentsDocument;
+
+	// no property of any corpus, so the whole document is skipped
+	typedef struct{
+		ZJ_VAR_BOOLEAN(unmapped);
+	}UnmappedDocument;
+
+	// A kind of document: it generates its text and parses it with its type.
+	class Corpus{
+	public:
+		virtual const char *getName()=0;
+
+		// returns a document of target_size bytes approximately. The same target_size gives always the same document.
+		virtual std::string generate(size_t target_size)=0;
+
+		virtual zetjsoncpp::JsonVar *deserialize(const std::string & text)=0;
+		virtual zetjsoncpp::JsonVar *deserializeFile(const std::string & filename)=0;
+		virtual zetjsoncpp::JsonVar *deserializeBinary(const std::string & snapshot)=0;
+
+		virtual ~Corpus(){}
+	};
+
+	// all the corpora, owned by the function
+	const std::vector<Corpus *> & get_corpora();
+}
@@ -0,0 +1,947 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+// Tests of zetjsoncpp: the results and the errors of the other ways to parse and write (push,
+// stream, lazy...) are compared with the ones of deserialize and serialize. It prints the
+// failed checks and returns 1 if any.
+
+#include "zetjsoncpp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define ZJ_TEST_CHECK(cond) zj_test::check((cond),#cond,__LINE__)
+
+namespace zj_test{
+
+	int n_checks=0;
+	int n_failed=0;
+
+	void check(bool ok, const char *cond, int line){
+		n_checks++;
+		if(!ok){
+			fprintf(stderr,"zj_test.cpp:%i: check failed: %s\n",line,cond);
+			n_failed++;
+		}
+	}
+
+	typedef struct{
+		ZJ_VAR_INT64(id);
+		ZJ_VAR_STRING(name);
+		ZJ_VAR_DOUBLE(value);
+		ZJ_VAR_BOOLEAN(enabled);
+	}Record;
+
+	typedef struct{
+		ZJ_VAR_STRING(title);
+		ZJ_VAR_OBJECT(Record,main);
+		ZJ_VAR_VECTOR_OBJECT(Record,records);
+		ZJ_VAR_VECTOR_INT64(ids);
+		ZJ_VAR_VECTOR_DOUBLE(values);
+		ZJ_VAR_MAP_STRING(names);
+	}Document;
+
+	typedef zetjsoncpp::JsonVarObject<Document> JsonDocument;
+
+	// every kind of token: escapes, surrogate pairs, utf-8, exponents and comments, so all
+	// of them are split by some chunk size
+	const char *document_text=
+		"// line comment\n"
+		"{\n"
+		"\t\"title\": \"tab\\t quote\\\" backslash\\\\ \\u00e9 \\ud83d\\ude00 \xc3\xa9\",\n"
+		"\t/* block\n comment */ \"main\": {\"id\": -9007199254740993, \"name\": \"\", \"value\": 1.5e-300, \"enabled\": false},\n"
+		"\t\"records\": [\n"
+		"\t\t{\"id\": 1, \"name\": \"one\", \"value\": 0.1, \"enabled\": true},\n"
+		"\t\t{\"id\": 2, \"name\": \"two\\n\", \"value\": -2.5E+10, \"enabled\": false}\n"
+		"\t],\n"
+		"\t\"ids\": [0, 1, -1, 9223372036854775807, -9223372036854775807],\n"
+		"\t\"values\": [0, -0.0, 123456789.125, 1e308, 4.9e-324],\n"
+		"\t\"names\":{\"a\":\"A\",\"b\\u0000c\":\"B\",\"\":\"empty\"}\n"
+		"}\n";
+
+	// deserializes text with PushDeserializer in chunks of chunk_size. It returns NULL and sets
+	// error if it fails.
+	JsonDocument *deserialize_push(const std::string & text, size_t chunk_size, zetjsoncpp::DeserializeError & error){
+		JsonDocument *json_document=new JsonDocument;
+		zetjsoncpp::PushDeserializer push_deserializer(json_document);
+		bool ok=true;
+
+		for(size_t offset=0; ok && offset < text.size(); offset+=chunk_size){
+			ok=push_deserializer.tryFeed(text.c_str()+offset,std::min(chunk_size,text.size()-offset));
+		}
+
+		if(!ok || !push_deserializer.tryFinish()){
+			error=push_deserializer.getError();
+			delete json_document;
+			return NULL;
+		}
+
+		return json_document;
+	}
+
+	void test_push_chunks(){
+		std::string text=document_text;
+		JsonDocument *expected=zetjsoncpp::deserialize<JsonDocument>(text);
+		std::string expected_text=zetjsoncpp::serialize(expected);
+		size_t n_equal=0, n_chunk_sizes=0;
+
+		ZJ_TEST_CHECK(expected->records.size() == 2 && expected->names.size() == 3);
+
+		// every chunk size up to 64 and one bigger than the text
+		for(size_t chunk_size=1; chunk_size <= text.size(); chunk_size=chunk_size < 64 ? chunk_size+1 : text.size()){
+			zetjsoncpp::DeserializeError error;
+			JsonDocument *json_document=deserialize_push(text,chunk_size,error);
+
+			n_chunk_sizes++;
+			if(json_document != NULL){
+				n_equal+=zetjsoncpp::serialize(json_document) == expected_text;
+				delete json_document;
+			}
+			if(chunk_size == text.size()){
+				break;
+			}
+		}
+		ZJ_TEST_CHECK(n_equal == n_chunk_sizes);
+
+		// deserialize_stream reads a file in chunks
+		FILE *fp=tmpfile();
+		fwrite(text.c_str(),1,text.size(),fp);
+		rewind(fp);
+		JsonDocument *json_document=zetjsoncpp::deserialize_stream<JsonDocument>(fp,NULL,7);
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(json_document) == expected_text);
+		delete json_document;
+		fclose(fp);
+
+		delete expected;
+	}
+
+	// errors are the ones of deserialize and are found at the same line whatever the chunks
+	// are (deserialize of a string doesn't count lines, so they are compared with one chunk)
+	void test_push_errors(){
+		const char *invalid_texts[]={
+			"{\"title\": \"not closed",
+			"{\"title\" \"no colon\"}",
+			"{\"ids\": [1, 2 3]}",
+			"{\"ids\": [1, 01]}",
+			"{\"title\": \"bad escape \\x\"}",
+			"{\"main\": {\"id\": 1 \"name\": \"a\"}}",
+			"{\"values\": [nan]}",
+			"{\"title\": \"a\",\n\"ids\": [1,\n\n2, x]}",
+			"{\"records\": [{\"id\": 1}"
+		};
+
+		for(size_t i=0; i < sizeof(invalid_texts)/sizeof(invalid_texts[0]); i++){
+			std::string text=invalid_texts[i];
+			zetjsoncpp::DeserializeError expected, expected_push, error;
+			JsonDocument *json_document=zetjsoncpp::deserialize<JsonDocument>(text,expected);
+			size_t n_same=0;
+
+			ZJ_TEST_CHECK(json_document == NULL && expected);
+			delete json_document;
+
+			json_document=deserialize_push(text,text.size(),expected_push);
+			ZJ_TEST_CHECK(json_document == NULL && expected_push.code == expected.code);
+			delete json_document;
+
+			for(size_t chunk_size=1; chunk_size <= text.size(); chunk_size++){
+				error.clear();
+				json_document=deserialize_push(text,chunk_size,error);
+				n_same+=json_document == NULL && error.code == expected.code && error.line == expected_push.line;
+				delete json_document;
+			}
+			if(n_same != text.size()){
+				fprintf(stderr,"zj_test.cpp: push errors differ from deserialize for: %s\n",text.c_str());
+			}
+			ZJ_TEST_CHECK(n_same == text.size());
+		}
+	}
+
+	// true if deserialize_stream throws std::runtime_error and not a parse error
+	bool stream_throws(FILE *fp, size_t chunk_size){
+		try{
+			delete zetjsoncpp::deserialize_stream<JsonDocument>(fp,NULL,chunk_size);
+		}catch(zetjsoncpp::deserialize_error_exception &){
+			return false;
+		}catch(std::runtime_error &){
+			return true;
+		}
+		return false;
+	}
+
+	// a read error isn't taken as the end of the input, and chunks can't be empty
+	void test_stream_errors(){
+		FILE *fp=tmpfile();
+		fputs("{}",fp);
+		rewind(fp);
+		ZJ_TEST_CHECK(stream_throws(fp,0));
+		fclose(fp);
+
+		// reading a directory fails (EISDIR)
+		if((fp=fopen("/tmp","rb")) != NULL){
+			ZJ_TEST_CHECK(stream_throws(fp,16));
+			fclose(fp);
+		}
+	}
+
+	// writes text to a new temporary file and returns its name
+	std::string write_temp_file(const std::string & text){
+		char filename[]="/tmp/zj_test_XXXXXX";
+		int fd=mkstemp(filename);
+
+		if(fd < 0){
+			return "";
+		}
+		ZJ_TEST_CHECK(write(fd,text.c_str(),text.size()) == (ssize_t)text.size());
+		close(fd);
+		return filename;
+	}
+
+	// line of the message of a deserialize_error_exception of filename ("[ERR file:line] ..."), -1 if none
+	int get_exception_line(const std::exception & ex, const std::string & filename){
+		const char *str_file=strstr(ex.what(),(filename+":").c_str());
+		return str_file != NULL ? atoi(str_file+filename.size()+1) : -1;
+	}
+
+	// line of the error of a lazy read of filename, -1 if there isn't any
+	template<typename _F>
+	int get_lazy_error_line(const std::string & filename, _F read){
+		zetjsoncpp::JsonLazyDocument *lazy=zetjsoncpp::deserialize_file_lazy(filename);
+		int line=-1;
+
+		try{
+			read(lazy->getRoot<Document>());
+		}catch(zetjsoncpp::deserialize_error_exception & ex){
+			line=get_exception_line(ex,filename);
+		}
+		delete lazy;
+		return line;
+	}
+
+	void test_lazy(){
+		std::string text=document_text;
+		JsonDocument *expected=zetjsoncpp::deserialize<JsonDocument>(text);
+		zetjsoncpp::JsonLazyDocument *lazy=zetjsoncpp::deserialize_lazy(text);
+		zetjsoncpp::JsonLazyObject<Document> root=lazy->getRoot<Document>();
+
+		// views are deserialized as deserialize does, into their own copies
+		zetjsoncpp::JsonVarObject<Record> & main=root.getObject(&Document::main).get();
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(&main) == zetjsoncpp::serialize(&expected->main));
+		zetjsoncpp::JsonVarObject<Record> & record=root.getVector(&Document::records).at(1).get();
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(&record) == zetjsoncpp::serialize(expected->records[1]));
+		ZJ_TEST_CHECK(root.get(&Document::ids).size() == 5 && root.get(&Document::ids)[3] == expected->ids[3]);
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(&root.get()) == zetjsoncpp::serialize(expected));
+		ZJ_TEST_CHECK((void *)&main != (void *)&root.get().main);
+
+		delete lazy;
+		delete expected;
+
+		// errors after objects and vectors of several lines, found while visiting the root
+		// (missing comma) and while deserializing a value
+		const char *invalid_texts[]={
+			"{\n\"main\": {\n\"id\": 1\n},\n\"title\": \"a\"\n\"ids\": []\n}",
+			"{\n\"records\": [\n{\"id\": 1},\n{\"id\": 2}\n],\n\"ids\": [1,\n2, x]\n}"
+		};
+
+		for(size_t i=0; i < sizeof(invalid_texts)/sizeof(invalid_texts[0]); i++){
+			std::string filename=write_temp_file(invalid_texts[i]);
+			zetjsoncpp::DeserializeError expected_error;
+
+			ZJ_TEST_CHECK(zetjsoncpp::deserialize_file<JsonDocument>(filename,expected_error) == NULL && expected_error.line > 3);
+			ZJ_TEST_CHECK(get_lazy_error_line(filename,[](zetjsoncpp::JsonLazyObject<Document> root){ root.get(); }) == expected_error.line);
+			ZJ_TEST_CHECK(get_lazy_error_line(filename,[](zetjsoncpp::JsonLazyObject<Document> root){ root.get(&Document::ids); }) == expected_error.line);
+			remove(filename.c_str());
+		}
+	}
+
+	// strings are decoded as they're read, and the errors are found at the char that is wrong
+	void test_string_decode(){
+		const char *prefix="{\"title\": \"ab";
+		const struct{
+			const char *content;
+			const char *decoded;
+		}valid_strings[]={
+			{"\\\" \\\\ \\/ \\b\\f\\n\\r\\t","\" \\ / \b\f\n\r\t"},
+			{"\\u0041\\u00e9\\u20AC","A\xc3\xa9\xe2\x82\xac"},
+			{"\\ud83d\\ude00 \xf0\x9f\x98\x80","\xf0\x9f\x98\x80 \xf0\x9f\x98\x80"},
+			{"\\u0001\\u001f\xc3\xa9 \xef\xbf\xbf \xf4\x8f\xbf\xbf","\x01\x1f\xc3\xa9 \xef\xbf\xbf \xf4\x8f\xbf\xbf"}
+		};
+		const struct{
+			const char *content;
+			zetjsoncpp::DeserializeErrorCode code;
+		}invalid_strings[]={
+			{"\\x",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE},
+			{"\\U0041",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE},
+			{"\\u12",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE},
+			{"\\u12g4",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE},
+			{"\\ud83d",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE}, // lone high surrogate
+			{"\\ude00\\ud83d",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE}, // lone low surrogate
+			{"\\ud83d\\u0041",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE}, // high surrogate without low one
+			{"\\ud83d\\ud83d",zetjsoncpp::DESERIALIZE_ERROR_INVALID_ESCAPE},
+			{"\xc0\xaf",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8}, // overlong '/'
+			{"\xe0\x80\xaf",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8},
+			{"\xf0\x80\x80\xaf",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8},
+			{"\xed\xa0\x80",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8}, // surrogate as utf-8
+			{"\xf4\x90\x80\x80",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8}, // beyond U+10FFFF
+			{"\x80",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8}, // continuation byte
+			{"\xc3",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8}, // truncated by the quote
+			{"\xff",zetjsoncpp::DESERIALIZE_ERROR_INVALID_UTF8},
+			{"\t",zetjsoncpp::DESERIALIZE_ERROR_CONTROL_CHAR},
+			{"\x01",zetjsoncpp::DESERIALIZE_ERROR_CONTROL_CHAR},
+			{"\x1f",zetjsoncpp::DESERIALIZE_ERROR_CONTROL_CHAR}
+		};
+
+		for(size_t i=0; i < sizeof(valid_strings)/sizeof(valid_strings[0]); i++){
+			zetjsoncpp::DeserializeError error;
+			JsonDocument *json_document=zetjsoncpp::deserialize<JsonDocument>(std::string(prefix)+valid_strings[i].content+"\"}",error);
+
+			ZJ_TEST_CHECK(json_document != NULL && json_document->title == std::string("ab")+valid_strings[i].decoded);
+			if(json_document != NULL){ // the serializer escapes what it must, so it's read back the same
+				JsonDocument *json_copy=zetjsoncpp::deserialize<JsonDocument>(zetjsoncpp::serialize(json_document),error);
+				ZJ_TEST_CHECK(json_copy != NULL && json_copy->title == json_document->title);
+				delete json_copy;
+			}
+			delete json_document;
+		}
+
+		for(size_t i=0; i < sizeof(invalid_strings)/sizeof(invalid_strings[0]); i++){
+			zetjsoncpp::DeserializeError error;
+			JsonDocument *json_document=zetjsoncpp::deserialize<JsonDocument>(std::string(prefix)+invalid_strings[i].content+"\"}",error);
+
+			if(error.code != invalid_strings[i].code || error.offset != strlen(prefix)){
+				fprintf(stderr,"zj_test.cpp: string error %i at %i for: %s\n",(int)error.code,(int)error.offset,invalid_strings[i].content);
+			}
+			ZJ_TEST_CHECK(json_document == NULL && error.code == invalid_strings[i].code && error.offset == strlen(prefix));
+		}
+
+		// new lines must be escaped too
+		zetjsoncpp::DeserializeError error;
+		ZJ_TEST_CHECK(zetjsoncpp::deserialize<JsonDocument>("{\"title\": \"a\nb\"}",error) == NULL && error.code == zetjsoncpp::DESERIALIZE_ERROR_STRING_NOT_CLOSED);
+	}
+
+	// value written by to_chars and parsed back, that must have the same bits
+	template<typename _T>
+	bool round_trips(_T value){
+		char buffer[ZJ_NUMBER_MAX_CHARS];
+		char *end=zetjsoncpp::zj_number::to_chars(buffer,value);
+		_T parsed;
+
+		return zetjsoncpp::zj_number::parse(buffer,end-buffer,&parsed) && memcmp(&parsed,&value,sizeof(value)) == 0;
+	}
+
+	// parse gives the bits of the C library, that rounds correctly, or fails if they're not finite
+	template<typename _T>
+	bool parses_as_strtod(const char *str, _T expected){
+		_T value=0;
+
+		if(!std::isfinite(expected)){
+			return !zetjsoncpp::zj_number::parse(str,strlen(str),&value);
+		}
+		return zetjsoncpp::zj_number::parse(str,strlen(str),&value) && memcmp(&value,&expected,sizeof(value)) == 0;
+	}
+
+	bool parses_as_strtod(const char *str){
+		return parses_as_strtod(str,strtod(str,NULL)) && parses_as_strtod(str,strtof(str,NULL));
+	}
+
+	void test_number_round_trip(){
+		const double doubles[]={
+			0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0/3, 123456789.125, 9007199254740992.0, 9007199254740994.0,
+			1e22, 1e23, 1e308, 1.7976931348623157e308, -1.7976931348623157e308,
+			2.2250738585072014e-308, 2.2250738585072009e-308, 4.9e-324, -4.9e-324, 5e-310
+		};
+		const float floats[]={
+			0.0f, -0.0f, 1.0f, 0.1f, 1.0f/3, 16777216.0f, 3.4028235e38f, 1.17549435e-38f, 1.17549421e-38f, 1.4e-45f
+		};
+		const int64_t ints[]={
+			0, 1, -1, 10, -10, 9007199254740993LL, INT64_MAX, INT64_MIN, INT64_MIN+1
+		};
+		// halfway between two doubles or floats (ties to even) and inputs with more digits
+		// than the fast path takes
+		const char *decimals[]={
+			"9007199254740993", "9007199254740995", "-9007199254740993", "16777217", "16777219",
+			"1.00000000000000011102230246251565404236316680908203125",
+			"1.00000005960464477539062500",
+			"2.2250738585072011e-308", "4.9406564584124654e-324", "2.4703282292062328e-324",
+			"1.7976931348623158e308", "123456789012345678901234567890", "0.1e1", "1e-400",
+			"1e23", "8.98846567431158e307", "4.35e-5", "7.038531e-26"
+		};
+		size_t n_doubles=0, n_floats=0, n_ints=0, n_decimals=0;
+		uint64_t random=0x9e3779b97f4a7c15ULL;
+
+		for(size_t i=0; i < sizeof(doubles)/sizeof(doubles[0]); i++){
+			n_doubles+=round_trips(doubles[i]);
+		}
+		ZJ_TEST_CHECK(n_doubles == sizeof(doubles)/sizeof(doubles[0]));
+
+		for(size_t i=0; i < sizeof(floats)/sizeof(floats[0]); i++){
+			n_floats+=round_trips(floats[i]);
+		}
+		ZJ_TEST_CHECK(n_floats == sizeof(floats)/sizeof(floats[0]));
+
+		for(size_t i=0; i < sizeof(ints)/sizeof(ints[0]); i++){
+			n_ints+=round_trips(ints[i]);
+		}
+		ZJ_TEST_CHECK(n_ints == sizeof(ints)/sizeof(ints[0]));
+
+		for(size_t i=0; i < sizeof(decimals)/sizeof(decimals[0]); i++){
+			if(!parses_as_strtod(decimals[i])){
+				fprintf(stderr,"zj_test.cpp: parse differs from strtod for: %s\n",decimals[i]);
+			}
+			n_decimals+=parses_as_strtod(decimals[i]);
+		}
+		ZJ_TEST_CHECK(n_decimals == sizeof(decimals)/sizeof(decimals[0]));
+
+		// finite values of random bits
+		n_doubles=n_floats=n_ints=0;
+		for(int i=0; i < 100000; i++){
+			double value;
+			float value_float;
+			uint32_t bits_float;
+
+			random=random*6364136223846793005ULL+1442695040888963407ULL;
+			memcpy(&value,&random,sizeof(value));
+			bits_float=(uint32_t)(random >> 32);
+			memcpy(&value_float,&bits_float,sizeof(value_float));
+
+			n_doubles+=!std::isfinite(value) || round_trips(value);
+			n_floats+=!std::isfinite(value_float) || round_trips(value_float);
+			n_ints+=round_trips((int64_t)random);
+		}
+		ZJ_TEST_CHECK(n_doubles == 100000 && n_floats == 100000 && n_ints == 100000);
+
+		// not finite in the type, or not a json number
+		double value=0;
+		float value_float=0;
+		int64_t value_int=0;
+		ZJ_TEST_CHECK(!zetjsoncpp::zj_number::parse("1e309",5,&value) && !zetjsoncpp::zj_number::parse("3.5e38",6,&value_float));
+		ZJ_TEST_CHECK(!zetjsoncpp::zj_number::parse("9223372036854775808",19,&value_int) && !zetjsoncpp::zj_number::parse("1.5",3,&value_int));
+		ZJ_TEST_CHECK(!zetjsoncpp::zj_number::parse("+1",2,&value) && !zetjsoncpp::zj_number::parse("01",2,&value) && !zetjsoncpp::zj_number::parse("1.",2,&value));
+
+		// nan and inf have no json representation
+		char buffer[ZJ_NUMBER_MAX_CHARS];
+		ZJ_TEST_CHECK(std::string(buffer,zetjsoncpp::zj_number::to_chars(buffer,std::numeric_limits<double>::quiet_NaN())) == "null");
+		ZJ_TEST_CHECK(std::string(buffer,zetjsoncpp::zj_number::to_chars(buffer,-std::numeric_limits<float>::infinity())) == "null");
+	}
+
+	// serialized json_document, or the code and offset of error
+	std::string get_result(JsonDocument *json_document, const zetjsoncpp::DeserializeError & error){
+		std::string result=json_document != NULL ? zetjsoncpp::serialize(json_document) : zetjsoncpp::zj_strutils::format("error %i at %i",(int)error.code,(int)error.offset);
+		delete json_document;
+		return result+"\n";
+	}
+
+	// results of documents (valid, with unmapped values and invalid) that start at every offset
+	// of a block, as deserialize, deserialize_skip_unmapped, in situ and lazy read them
+	std::string get_scan_results(){
+		const char *texts[]={
+			document_text,
+			"{\"extra\": {\"a\": [1, \"]}\\\\\", \"\\\"[\", /* ] } */ {}], \"b\": {\"c\": [[[]]]}},\n"
+			"\"title\": \"a long title with \\\"escapes\\\" and \\u00e9, longer than a block of sixty four chars\",\n"
+			"\"other\": [\"x\", {\"y\": \"}\"}], \"ids\": [1, 2, 3]}",
+			"{\"title\": \"bad escape after some chars \\q\"}",
+			"{\"title\": \"control char after some chars \x01\"}",
+			"{\"title\": \"not closed\n\"}",
+			"{\"title\": \"utf-8 truncated \xc3\"}",
+			"{\"extra\": [1, {\"a\": 2]}, \"title\": \"t\"}"
+		};
+		std::string results;
+
+		for(size_t i=0; i < sizeof(texts)/sizeof(texts[0]); i++){
+			for(size_t offset=0; offset < 64; offset++){
+				std::string text=std::string(offset,' ')+texts[i];
+				std::vector<char> buffer(text.c_str(),text.c_str()+text.size()+1);
+				zetjsoncpp::DeserializeError error;
+
+				results+=get_result(zetjsoncpp::deserialize<JsonDocument>(text,error),error);
+				error.clear();
+				results+=get_result(zetjsoncpp::deserialize_skip_unmapped<JsonDocument>(text,error),error);
+				error.clear();
+				results+=get_result(zetjsoncpp::deserialize_in_situ<JsonDocument>(buffer.data(),error),error);
+				error.clear();
+
+				zetjsoncpp::JsonLazyDocument *lazy=zetjsoncpp::deserialize_lazy(text,error);
+				if(lazy != NULL){
+					try{
+						results+=zetjsoncpp::serialize(&lazy->getRoot<Document>().get())+"\n";
+					}catch(zetjsoncpp::deserialize_error_exception & ex){
+						results+=std::string(ex.what())+"\n";
+					}
+					delete lazy;
+				}else{
+					results+=get_result(NULL,error);
+				}
+			}
+		}
+
+		return results;
+	}
+
+	// output of program --scan with ZETJSONCPP_SCAN=name, "" if it fails
+	std::string run_scan(const char *program, const char *name){
+		std::string command=zetjsoncpp::zj_strutils::format("ZETJSONCPP_SCAN=%s %s --scan",name,program);
+		std::string output;
+		char buffer[4096];
+		size_t len;
+		FILE *fp=popen(command.c_str(),"r");
+
+		if(fp == NULL){
+			return "";
+		}
+		while((len=fread(buffer,1,sizeof(buffer),fp)) > 0){
+			output.append(buffer,len);
+		}
+		return pclose(fp) == 0 ? output : "";
+	}
+
+	// results of an output of run_scan, after the name of the implementation
+	std::string get_scan_output_results(const std::string & output){
+		size_t end_name=output.find('\n');
+		return end_name != std::string::npos ? output.substr(end_name+1) : "";
+	}
+
+	// the implementations of zj_scan give the same results; each one is selected once by
+	// process, so program (this test) is run for each one with --scan
+	void test_scan_implementations(const char *program){
+		std::string scalar=run_scan(program,"scalar");
+		std::string sse2=run_scan(program,"sse2");
+		std::string avx2=run_scan(program,"avx2");
+		std::string expected=get_scan_results();
+
+		ZJ_TEST_CHECK(scalar.compare(0,7,"scalar\n") == 0);
+		ZJ_TEST_CHECK(!expected.empty() && get_scan_output_results(scalar) == expected);
+#if defined(__SSE2__) || defined(_M_X64)
+		// avx2 falls back to sse2 if the cpu doesn't have it
+		ZJ_TEST_CHECK(sse2.compare(0,5,"sse2\n") == 0);
+		ZJ_TEST_CHECK(avx2.compare(0,5,"avx2\n") == 0 || avx2.compare(0,5,"sse2\n") == 0);
+		ZJ_TEST_CHECK(get_scan_output_results(sse2) == expected);
+		ZJ_TEST_CHECK(get_scan_output_results(avx2) == expected);
+#endif
+	}
+
+	// document with n_records records of 2 lines, and the error of error_kind in the record
+	// error_record (none if it's n_records)
+	std::string get_records_text(size_t n_records, size_t error_record, int error_kind){
+		std::string text="{\"title\": \"records\",\n\"records\": [\n";
+
+		for(size_t i=0; i < n_records; i++){
+			std::string record=zetjsoncpp::zj_strutils::format(
+				"{\"id\": %i, \"name\": \"record \\\"%i\\\" /* not a comment */\",\n\"value\": %i.5, /* [ */ \"enabled\": %s}%s\n"
+				,(int)i,(int)i,(int)i,i%2?"true":"false",i+1<n_records?",":""
+			);
+
+			if(i == error_record){
+				switch(error_kind){
+				case 0: // bad value
+					record.replace(record.find("\"value\": ")+9,1,"x");
+					break;
+				case 1: // no comma after the object
+					record.replace(record.rfind('}'),1," ");
+					break;
+				default: // string not closed
+					record.replace(record.find("\"record")+7,1,"\n");
+					break;
+				}
+			}
+			text+=record;
+		}
+
+		return text+"],\n\"ids\": [1, 2]\n}\n";
+	}
+
+	// big vectors are split by threads but the results and errors are the ones of deserialize
+	void test_parallel(){
+		const size_t sizes[]={0, 1, 255, 256, 257, 1000, 5000};
+		size_t n_equal=0, n_errors_equal=0, n_errors=0;
+
+		for(size_t i=0; i < sizeof(sizes)/sizeof(sizes[0]); i++){
+			std::string text=get_records_text(sizes[i],sizes[i],0);
+			JsonDocument *expected=zetjsoncpp::deserialize<JsonDocument>(text);
+			std::string expected_text=zetjsoncpp::serialize(expected);
+
+			for(unsigned n_threads=2; n_threads <= 8; n_threads*=2){
+				JsonDocument *json_document=zetjsoncpp::deserialize_parallel<JsonDocument>(text,n_threads);
+				n_equal+=json_document->records.size() == sizes[i] && zetjsoncpp::serialize(json_document) == expected_text;
+				delete json_document;
+			}
+			delete expected;
+		}
+		ZJ_TEST_CHECK(n_equal == 3*sizeof(sizes)/sizeof(sizes[0]));
+
+		// errors in the elements parsed before the parallel part, in the first and last ones of it
+		const size_t error_records[]={0, 100, 255, 256, 257, 700, 999};
+		for(size_t i=0; i < sizeof(error_records)/sizeof(error_records[0]); i++){
+			for(int error_kind=0; error_kind < 3; error_kind++){
+				std::string text=get_records_text(1000,error_records[i],error_kind);
+				std::string filename=write_temp_file(text);
+				zetjsoncpp::DeserializeError expected, expected_file;
+
+				ZJ_TEST_CHECK(zetjsoncpp::deserialize<JsonDocument>(text,expected) == NULL && expected);
+				ZJ_TEST_CHECK(zetjsoncpp::deserialize_file<JsonDocument>(filename,expected_file) == NULL && expected_file.line > (int)error_records[i]*2);
+
+				for(unsigned n_threads=2; n_threads <= 8; n_threads*=2){
+					zetjsoncpp::DeserializeError error, error_file;
+
+					n_errors++;
+					n_errors_equal+=zetjsoncpp::deserialize_parallel<JsonDocument>(text,n_threads,error) == NULL
+						&& error.code == expected.code && error.offset == expected.offset && error.line == expected.line
+						&& zetjsoncpp::deserialize_file_parallel<JsonDocument>(filename,n_threads,error_file) == NULL
+						&& error_file.code == expected_file.code && error_file.line == expected_file.line;
+				}
+				remove(filename.c_str());
+			}
+		}
+		ZJ_TEST_CHECK(n_errors_equal == n_errors);
+	}
+
+	// code of the error of loading snapshot_filename checking source_filename, 0 if it loads
+	int get_snapshot_error(const std::string & snapshot_filename, const std::string & source_filename){
+		zetjsoncpp::DeserializeError error;
+		JsonDocument *json_document=zetjsoncpp::deserialize_binary_file<JsonDocument>(snapshot_filename,source_filename,error);
+
+		delete json_document;
+		return json_document != NULL ? 0 : (int)error.code;
+	}
+
+	void test_binary(){
+		JsonDocument *json_document=zetjsoncpp::deserialize<JsonDocument>(document_text);
+		std::string expected_text=zetjsoncpp::serialize(json_document);
+		std::string snapshot=zetjsoncpp::serialize_binary(json_document);
+		zetjsoncpp::DeserializeError error;
+		size_t n_truncated=0, n_flipped=0;
+
+		// round trip, also for a schema that has the parsed state of each property
+		JsonDocument *json_copy=zetjsoncpp::deserialize_binary<JsonDocument>(snapshot);
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(json_copy) == expected_text);
+		delete json_copy;
+
+		// other schema and other format version
+		ZJ_TEST_CHECK(zetjsoncpp::deserialize_binary<zetjsoncpp::JsonVarObject<Record>>(snapshot,error) == NULL && error.code == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+		std::string other_version=snapshot;
+		other_version[4]^=0x1;
+		ZJ_TEST_CHECK(zetjsoncpp::deserialize_binary<JsonDocument>(other_version,error) == NULL && error.code == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+
+		// every truncation is corrupt
+		for(size_t len=0; len < snapshot.size(); len++){
+			error.clear();
+			n_truncated+=zetjsoncpp::deserialize_binary<JsonDocument>(snapshot.substr(0,len),error) == NULL && error.code == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_CORRUPT;
+		}
+		ZJ_TEST_CHECK(n_truncated == snapshot.size());
+
+		// a flipped byte is a snapshot error or a tree of other values, never read out of the snapshot
+		for(size_t i=0; i < snapshot.size(); i++){
+			std::string flipped=snapshot;
+			flipped[i]^=0xff;
+
+			error.clear();
+			json_copy=zetjsoncpp::deserialize_binary<JsonDocument>(flipped,error);
+			n_flipped+=json_copy != NULL || error.code == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_CORRUPT || error.code == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE;
+			delete json_copy;
+		}
+		ZJ_TEST_CHECK(n_flipped == snapshot.size());
+
+		// snapshot of a source file: stale when the source changes its size or its modification
+		// time, or is removed
+		std::string source_filename=write_temp_file(document_text);
+		std::string snapshot_filename=write_temp_file("");
+		struct timespec times[2];
+
+		zetjsoncpp::serialize_binary_file(json_document,snapshot_filename,source_filename);
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == 0);
+		json_copy=zetjsoncpp::deserialize_binary_file<JsonDocument>(snapshot_filename,source_filename);
+		ZJ_TEST_CHECK(zetjsoncpp::serialize(json_copy) == expected_text);
+		delete json_copy;
+
+		times[0].tv_sec=times[1].tv_sec=1000000000;
+		times[0].tv_nsec=times[1].tv_nsec=0;
+		ZJ_TEST_CHECK(utimensat(AT_FDCWD,source_filename.c_str(),times,0) == 0);
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+
+		zetjsoncpp::serialize_binary_file(json_document,snapshot_filename,source_filename);
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == 0);
+		FILE *fp=fopen(source_filename.c_str(),"ab");
+		fputc(' ',fp);
+		fclose(fp);
+		ZJ_TEST_CHECK(utimensat(AT_FDCWD,source_filename.c_str(),times,0) == 0); // only the size changed
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+
+		// without source it's only checked against the schema
+		json_copy=zetjsoncpp::deserialize_binary_file<JsonDocument>(snapshot_filename,error);
+		ZJ_TEST_CHECK(json_copy != NULL);
+		delete json_copy;
+
+		zetjsoncpp::serialize_binary_file(json_document,snapshot_filename);
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+
+		remove(source_filename.c_str());
+		ZJ_TEST_CHECK(get_snapshot_error(snapshot_filename,source_filename) == zetjsoncpp::DESERIALIZE_ERROR_SNAPSHOT_STALE);
+		remove(snapshot_filename.c_str());
+
+		delete json_document;
+	}
+
+	typedef struct{
+		ZJ_VAR_STRING_VIEW(text);
+		ZJ_VAR_STRING_VIEW(emoji);
+		ZJ_VAR_STRING_VIEW(plain);
+		ZJ_VAR_STRING(copy);
+	}InSitu;
+
+	// as InSitu, with strings that are copies
+	typedef struct{
+		ZJ_VAR_STRING(text);
+		ZJ_VAR_STRING(emoji);
+		ZJ_VAR_STRING(plain);
+		ZJ_VAR_STRING(copy);
+	}InSituCopy;
+
+	// true if view is in [buffer,buffer+buffer_len) and it ends with '\0' there
+	bool is_view_in(std::string_view view, const char *buffer, size_t buffer_len){
+		return view.data() >= buffer && view.data()+view.size() < buffer+buffer_len && view.data()[view.size()] == 0;
+	}
+
+	void test_in_situ(){
+		const char *text=
+			"{\"text\": \"line\\nnext \\\"quoted\\\" \\u00e9\\u20ac \\\\\",\n"
+			"\"emoji\": \"\\ud83d\\ude00\\uD83D\\uDE00\", \"plain\": \"no escapes\", \"copy\": \"a\\tb\"}";
+		size_t text_len=strlen(text);
+		std::vector<char> buffer(text,text+text_len+1);
+		zetjsoncpp::DeserializeError error;
+		zetjsoncpp::JsonVarObject<InSitu> *json_in_situ=zetjsoncpp::deserialize_in_situ<zetjsoncpp::JsonVarObject<InSitu>>(buffer.data(),error);
+
+		ZJ_TEST_CHECK(json_in_situ != NULL);
+		if(json_in_situ != NULL){
+			// decoded in place, in the caller's buffer
+			ZJ_TEST_CHECK(json_in_situ->text == std::string_view("line\nnext \"quoted\" \xc3\xa9\xe2\x82\xac \\"));
+			ZJ_TEST_CHECK(json_in_situ->emoji == std::string_view("\xf0\x9f\x98\x80\xf0\x9f\x98\x80"));
+			ZJ_TEST_CHECK(json_in_situ->plain == std::string_view("no escapes") && json_in_situ->copy == std::string("a\tb"));
+			ZJ_TEST_CHECK(is_view_in(json_in_situ->text,buffer.data(),buffer.size()) && is_view_in(json_in_situ->emoji,buffer.data(),buffer.size()));
+			ZJ_TEST_CHECK(json_in_situ->plain.c_str() == buffer.data()+(strstr(text,"no escapes")-text));
+			ZJ_TEST_CHECK(json_in_situ->text.c_str() == buffer.data()+(strstr(text,"line")-text));
+			ZJ_TEST_CHECK(buffer[text_len] == 0);
+			delete json_in_situ;
+		}
+
+		// the file is mapped privately, so it's not modified
+		std::string filename=write_temp_file(text);
+		zetjsoncpp::JsonInSituDocument<zetjsoncpp::JsonVarObject<InSitu>> *document=zetjsoncpp::deserialize_file_in_situ<zetjsoncpp::JsonVarObject<InSitu>>(filename);
+		ZJ_TEST_CHECK(document->getRoot()->emoji == std::string_view("\xf0\x9f\x98\x80\xf0\x9f\x98\x80"));
+		delete document;
+		char *file_text=zetjsoncpp::zj_file::read(filename);
+		ZJ_TEST_CHECK(strcmp(file_text,text) == 0);
+		free(file_text);
+		remove(filename.c_str());
+
+		// errors are the ones of deserialize, and the buffer after the error is not modified,
+		// though strings before it and the one of the error are decoded
+		const char *invalid_texts[]={
+			"{\"text\": \"a\\nb\", \"emoji\": \"\\ud83d\\u0041\"}",
+			"{\"text\": \"a\\nb\", \"emoji\": \"\\u00e9 \\q\"}",
+			"{\"text\": \"a\\nb\", \"emoji\": \"\\u00e9 \xc3\"}",
+			"{\"text\": \"a\\nb\", \"emoji\": \"\\u00e9 \x01\"}",
+			"{\"text\": \"a\\nb\", \"emoji\": \"\\u00e9 not closed\n\"}",
+			"{\"text\": \"a\\nb\", \"plain\": \"\\u00e9\" \"copy\": \"c\"}",
+			"{\"text\": \"a\\nb\", \"copy\": \"\\u00e9\", \"emoji\": 1}"
+		};
+
+		for(size_t i=0; i < sizeof(invalid_texts)/sizeof(invalid_texts[0]); i++){
+			size_t invalid_len=strlen(invalid_texts[i]);
+			std::vector<char> invalid_buffer(invalid_texts[i],invalid_texts[i]+invalid_len+1);
+			zetjsoncpp::DeserializeError expected;
+
+			error.clear();
+			ZJ_TEST_CHECK(zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<InSituCopy>>(invalid_texts[i],expected) == NULL && expected);
+			ZJ_TEST_CHECK(zetjsoncpp::deserialize_in_situ<zetjsoncpp::JsonVarObject<InSitu>>(invalid_buffer.data(),error) == NULL);
+			ZJ_TEST_CHECK(error.code == expected.code && error.offset == expected.offset);
+
+			// errors of strings are at the char of the error, but a string not closed is reported at its quote
+			size_t unmodified=error.offset;
+			if(error.code == zetjsoncpp::DESERIALIZE_ERROR_STRING_NOT_CLOSED){
+				unmodified+=strcspn(invalid_texts[i]+error.offset,"\n");
+			}
+			ZJ_TEST_CHECK(unmodified <= invalid_len && memcmp(invalid_buffer.data()+unmodified,invalid_texts[i]+unmodified,invalid_len+1-unmodified) == 0);
+		}
+	}
+
+	typedef struct{
+		ZJ_VAR_MAP_STRING(names);
+		ZJ_VAR_MAP_INT64(ids);
+		ZJ_VAR_MAP_OBJECT(Record,records);
+	}TreeMaps;
+
+	typedef struct{
+		ZJ_VAR_FLAT_MAP_STRING(names);
+		ZJ_VAR_FLAT_MAP_INT64(ids);
+		ZJ_VAR_FLAT_MAP_OBJECT(Record,records);
+	}FlatMaps;
+
+	typedef struct{
+		ZJ_VAR_HASH_MAP_STRING(names);
+		ZJ_VAR_HASH_MAP_INT64(ids);
+		ZJ_VAR_HASH_MAP_OBJECT(Record,records);
+	}HashMaps;
+
+	// maps of more keys than the hash storage slots, so it grows while they are inserted
+	std::string get_maps_text(const char *extra_name=""){
+		std::string names, ids, records;
+		for(int i=0; i < 100; i++){
+			const char *separator=i > 0 ? ",":"";
+			names+=zetjsoncpp::zj_strutils::format("%s\"n%i\":\"%i\"",separator,(i*37)%100,i);
+			ids+=zetjsoncpp::zj_strutils::format("%s\"i%i\":%i",separator,(i*53)%100,i);
+			if(i < 20){
+				records+=zetjsoncpp::zj_strutils::format("%s\"r%i\":{\"id\":%i,\"name\":\"r\",\"value\":0.5,\"enabled\":true}",separator,(i*7)%20,i);
+			}
+		}
+		return "{\"names\":{"+names+extra_name+"},\"ids\":{"+ids+"},\"records\":{"+records+"}}";
+	}
+
+	// entries of json_maps sorted by key, as the storages iterate them in different orders
+	template<typename _T_MAPS>
+	std::string get_map_entries(zetjsoncpp::JsonVarObject<_T_MAPS> *json_maps){
+		std::vector<std::string> entries;
+		for(auto it=json_maps->names.begin(); it != json_maps->names.end(); it++){
+			entries.push_back(it->first+"="+(std::string)it->second);
+		}
+		for(auto it=json_maps->ids.begin(); it != json_maps->ids.end(); it++){
+			entries.push_back(it->first+"="+std::to_string((int64_t)it->second));
+		}
+		for(auto it=json_maps->records.begin(); it != json_maps->records.end(); it++){
+			entries.push_back(it->first+"="+std::to_string((int64_t)it->second->id));
+		}
+		std::sort(entries.begin(),entries.end());
+		std::string result;
+		for(size_t i=0; i < entries.size(); i++){
+			result+=entries[i]+",";
+		}
+		return result+"\n";
+	}
+
+	// runs the same inserts, duplicated key, erases, iteration and serialization on maps of
+	// _T_MAPS storages. The serialization is read back as tree maps, which are sorted.
+	template<typename _T_MAPS>
+	std::string get_map_storage_results(){
+		zetjsoncpp::DeserializeError error;
+		std::string results;
+
+		zetjsoncpp::JsonVarObject<_T_MAPS> *json_maps=zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<_T_MAPS>>(get_maps_text(",\"n5\":\"dup\""),error);
+		results+=json_maps == NULL ? zetjsoncpp::zj_strutils::format("error %i at %i\n",(int)error.code,(int)error.offset) : "no error\n";
+		delete json_maps;
+
+		json_maps=zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<_T_MAPS>>(get_maps_text());
+		results+=get_map_entries(json_maps);
+
+		// insert doesn't replace existing keys
+		json_maps->names.insert("n5",zetjsoncpp::JsonVarString<>("replaced"));
+		json_maps->names.insert("new",zetjsoncpp::JsonVarString<>("inserted"));
+		for(int i=0; i < 100; i+=3){
+			json_maps->ids.erase(zetjsoncpp::zj_strutils::format("i%i",i));
+			json_maps->records.erase(zetjsoncpp::zj_strutils::format("r%i",i));
+		}
+		json_maps->names.erase("missing");
+		results+=zetjsoncpp::zj_strutils::format("%i %i %i %i %i %s\n"
+			,(int)json_maps->names.size(),(int)json_maps->ids.size(),(int)json_maps->records.size()
+			,(int)json_maps->ids.count("i3"),(int)(json_maps->ids.find("i4") != json_maps->ids.end())
+			,json_maps->names["n5"].c_str());
+		results+=get_map_entries(json_maps);
+
+		zetjsoncpp::JsonVarObject<TreeMaps> *json_copy=zetjsoncpp::deserialize<zetjsoncpp::JsonVarObject<TreeMaps>>(zetjsoncpp::serialize(json_maps));
+		results+=zetjsoncpp::serialize(json_copy);
+		delete json_copy;
+
+		json_maps->records.clear();
+		results+=zetjsoncpp::zj_strutils::format("\n%i\n",(int)json_maps->records.size());
+		delete json_maps;
+
+		return results;
+	}
+
+	void test_map_storages(){
+		std::string tree_results=get_map_storage_results<TreeMaps>();
+		ZJ_TEST_CHECK(tree_results.find("error 10 at ") == 0);
+		ZJ_TEST_CHECK(tree_results.find("n5=65,") != std::string::npos && tree_results.find("new=inserted,") != std::string::npos);
+		ZJ_TEST_CHECK(get_map_storage_results<FlatMaps>() == tree_results);
+		ZJ_TEST_CHECK(get_map_storage_results<HashMaps>() == tree_results);
+	}
+
+	// serialized json_document, or the code, offset and line of error
+	std::string get_result_line(JsonDocument *json_document, const zetjsoncpp::DeserializeError & error){
+		return json_document != NULL ? get_result(json_document,error) : zetjsoncpp::zj_strutils::format("error %i at %i line %i\n",(int)error.code,(int)error.offset,error.line);
+	}
+
+	void test_skip_unmapped(){
+		// unmapped objects and vectors with comments, brackets in strings and escaped backslashes
+		const char *unmapped_text=
+			"{\n"
+			"\t\"zz\": {\"a\": [1, {\"b\": \"]}\\\\\"}, \"\\\\\\\"[\"], /* ] } \" \n\n */ \"c\": {}},\n"
+			"\t\"main\": {\"id\": 3, \"unknown\": [[], [{}], \"\\\\\", // ] \"\n 4], \"name\": \"m\"},\n"
+			"\t\"zy\": [\"{\\\\\\\\\", {\"x\": null}, /* [ */ \"\\\\\\\\\\\"]\"],\n"
+			"\t\"records\": [{\"id\": 1, \"zx\": {\"s\": \"\\u005c\\\\\"}}],\n"
+			"\t\"names\": {\"k\": \"v\"}\n"
+			"}\n";
+		zetjsoncpp::DeserializeError error;
+
+		std::string expected=get_result_line(zetjsoncpp::deserialize<JsonDocument>(unmapped_text,error),error);
+		ZJ_TEST_CHECK(expected.find("\"id\":3") != std::string::npos && expected.find("\"k\":\"v\"") != std::string::npos);
+		ZJ_TEST_CHECK(get_result_line(zetjsoncpp::deserialize_skip_unmapped<JsonDocument>(unmapped_text,error),error) == expected);
+
+		std::string filename=write_temp_file(unmapped_text);
+		ZJ_TEST_CHECK(get_result_line(zetjsoncpp::deserialize_file_skip_unmapped<JsonDocument>(filename,error),error) == expected);
+		remove(filename.c_str());
+
+		// errors after skipped values are at the same line. Mismatched brackets and nesting of
+		// more than 64 levels fall back to the parser and its error
+		std::string deep_vector=std::string(100,'[')+std::string(100,']');
+		std::string invalid_texts[]={
+			std::string(unmapped_text).substr(0,strlen(unmapped_text)-3)+",\n\"title\": tru}"
+			,"{\"zz\": {\"a\": [1, 2}},\n\"title\": \"t\"}"
+			,"{\"zz\": [{\"a\": 1]],\n\"title\": \"t\"}"
+			,"{\"zz\": {\"a\": \"not closed\n}}"
+			,"{\"zz\": [/* not closed ]}"
+			,"{\"zz\": "+deep_vector+",\n\"title\": \"t\"}"
+			,"{\"zz\": "+deep_vector+",\n\"title\": 1}"
+			,"{\"zz\": "+std::string(100,'[')+"}"+std::string(99,']')+"}"
+			,"{\"zz\": "+std::string(70,'{')+"}"
+		};
+		for(size_t i=0; i < sizeof(invalid_texts)/sizeof(invalid_texts[0]); i++){
+			std::string expected=get_result_line(zetjsoncpp::deserialize<JsonDocument>(invalid_texts[i],error),error);
+			std::string result=get_result_line(zetjsoncpp::deserialize_skip_unmapped<JsonDocument>(invalid_texts[i],error),error);
+			if(result != expected){
+				fprintf(stderr,"zj_test.cpp: skip unmapped text %i: %s, expected %s",(int)i,result.c_str(),expected.c_str());
+			}
+			ZJ_TEST_CHECK(result == expected && (i == 5 || expected.find("error") == 0));
+
+			// files count lines from 1
+			std::string filename=write_temp_file(invalid_texts[i]);
+			expected=get_result_line(zetjsoncpp::deserialize_file<JsonDocument>(filename,error),error);
+			ZJ_TEST_CHECK(get_result_line(zetjsoncpp::deserialize_file_skip_unmapped<JsonDocument>(filename,error),error) == expected);
+			remove(filename.c_str());
+		}
+	}
+}
+
+int main(int argc, char *argv[]){
+	if(argc > 1 && strcmp(argv[1],"--scan") == 0){ // see test_scan_implementations
+		printf("%s\n%s",zetjsoncpp::zj_scan::get_implementation_name(),zj_test::get_scan_results().c_str());
+		return 0;
+	}
+
+	zj_test::test_push_chunks();
+	zj_test::test_push_errors();
+	zj_test::test_stream_errors();
+	zj_test::test_lazy();
+	zj_test::test_string_decode();
+	zj_test::test_number_round_trip();
+	zj_test::test_scan_implementations(argv[0]);
+	zj_test::test_parallel();
+	zj_test::test_binary();
+	zj_test::test_in_situ();
+	zj_test::test_map_storages();
+	zj_test::test_skip_unmapped();
+
+	printf("zj_test: %i checks, %i failed\n",zj_test::n_checks,zj_test::n_failed);
+	return zj_test::n_failed ? 1 : 0;
+}
@@ -18,17 +18,24 @@ namespace zetjsoncpp {
 		case JSON_VAR_TYPE_BOOLEAN: return "JsonVarBoolean";
 			//case INT32_TYPE: return "INT32_TYPE";
 		case JSON_VAR_TYPE_NUMBER: return "JsonVarNumber";
+		case JSON_VAR_TYPE_DOUBLE: return "JsonVarDouble";
+		case JSON_VAR_TYPE_INT64: return "JsonVarInt64";
 		case JSON_VAR_TYPE_STRING: return "JsonVarString";
+		case JSON_VAR_TYPE_STRING_VIEW: return "JsonVarStringView";
 		case JSON_VAR_TYPE_OBJECT: return "JsonVarObject";
 
 		case JSON_VAR_TYPE_VECTOR_OF_BOOLEANS: return "JsonVarVectorBoolean";
 			//case ARRAY_INT32_TYPE: return "ARRAY INT32 TYPE";
 		case JSON_VAR_TYPE_VECTOR_OF_NUMBERS: return "JsonVarVectorNumber";
+		case JSON_VAR_TYPE_VECTOR_OF_DOUBLES: return "JsonVarVectorDouble";
+		case JSON_VAR_TYPE_VECTOR_OF_INT64S: return "JsonVarVectorInt64";
 		case JSON_VAR_TYPE_VECTOR_OF_STRINGS: return "JsonVarVectorString";
 		case JSON_VAR_TYPE_VECTOR_OF_OBJECTS: return "JsonVarVectorObject";
 
 		case JSON_VAR_TYPE_MAP_OF_BOOLEANS: return "JsonVarMapBoolean";
 		case JSON_VAR_TYPE_MAP_OF_NUMBERS: return "JsonVarMapNumber";
+		case JSON_VAR_TYPE_MAP_OF_DOUBLES: return "JsonVarMapDouble";
+		case JSON_VAR_TYPE_MAP_OF_INT64S: return "JsonVarMapInt64";
 		case JSON_VAR_TYPE_MAP_OF_STRINGS: return "JsonVarMapString";
 		case JSON_VAR_TYPE_MAP_OF_OBJECTS: return "JsonVarMapObject";
 		}
@@ -37,14 +44,33 @@ namespace zetjsoncpp {
 	}
 
 	JsonVar::JsonVar() {
-		this->__zj_variable_name__ = "";
-		this->__zj_ptr_data_end__ = NULL;
-		this->__zj_ptr_data_start__ = NULL;
-		this->__zj_size_data__ = 0;
-		this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_UNKNOWN;
 		this->__zj_is_parsed__ = false;
 	}
 
+	const JsonVarDescriptor *JsonVar::getDescriptor(){
+		static const JsonVarDescriptor descriptor={std::string_view(),JsonVarType::JSON_VAR_TYPE_UNKNOWN,sizeof(JsonVar)};
+		return &descriptor;
+	}
+
+	uint64_t JsonVar::getSchemaHash(){
+		const JsonVarDescriptor *descriptor=getDescriptor();
+		uint64_t hash=hashSchema(ZJ_SCHEMA_HASH_SEED,descriptor->name.data(),descriptor->name.size());
+		uint16_t type=descriptor->type;
+
+		return hashSchema(hash,&type,sizeof(type));
+	}
+
+	uint64_t JsonVar::hashSchema(uint64_t hash, const void *data, size_t len){
+		const uint8_t *bytes=(const uint8_t *)data;
+
+		for(size_t i=0; i < len; i++){
+			hash^=bytes[i];
+			hash*=1099511628211ULL;
+		}
+
+		return hash;
+	}
+
 	JsonVar *JsonVar::newJsonVar(){
 		throw std::runtime_error("internal error: newJsonVar not implemented");
 		return NULL;
@@ -55,7 +81,7 @@ namespace zetjsoncpp {
 	}
 
 	const char *JsonVar::getTypeStr(){
-		return idTypeToString(this->__zj_type__);
+		return idTypeToString(this->getType());
 	}
 
 	void JsonVar::setParsed(bool parsed) {
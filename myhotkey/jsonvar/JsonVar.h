@@ -13,10 +13,14 @@
 #define  MIN(a,  b)              ((a)  <  (b)  ?  (a)  :  (b))
 #endif
 
-#define ZJ_MAX_CONST_CHAR 50
+// chars of a name given to ZJ_CONST_CHAR, longer names don't compile
+#define ZJ_MAX_CONST_CHAR 127
+
+// initial value of schema hashes (FNV-1a 64 bits offset basis)
+#define ZJ_SCHEMA_HASH_SEED 14695981039346656037ULL
 
 #define ZJ_CONST_CHAR(s)\
-	getChr(s,0),\
+	zetjsoncpp::check_const_char_size<sizeof(s)>(getChr(s,0)),\
 	getChr(s,1),\
 	getChr(s,2),\
 	getChr(s,3),\
@@ -66,60 +70,191 @@
 	getChr(s,47),\
 	getChr(s,48),\
 	getChr(s,49),\
-	getChr(s,50)
-
-#define getChr(name, ii) ((MIN(ii,ZJ_MAX_CONST_CHAR))<sizeof(name)/sizeof(*name)?name[ii]:0)
+	getChr(s,50),\
+	getChr(s,51),\
+	getChr(s,52),\
+	getChr(s,53),\
+	getChr(s,54),\
+	getChr(s,55),\
+	getChr(s,56),\
+	getChr(s,57),\
+	getChr(s,58),\
+	getChr(s,59),\
+	getChr(s,60),\
+	getChr(s,61),\
+	getChr(s,62),\
+	getChr(s,63),\
+	getChr(s,64),\
+	getChr(s,65),\
+	getChr(s,66),\
+	getChr(s,67),\
+	getChr(s,68),\
+	getChr(s,69),\
+	getChr(s,70),\
+	getChr(s,71),\
+	getChr(s,72),\
+	getChr(s,73),\
+	getChr(s,74),\
+	getChr(s,75),\
+	getChr(s,76),\
+	getChr(s,77),\
+	getChr(s,78),\
+	getChr(s,79),\
+	getChr(s,80),\
+	getChr(s,81),\
+	getChr(s,82),\
+	getChr(s,83),\
+	getChr(s,84),\
+	getChr(s,85),\
+	getChr(s,86),\
+	getChr(s,87),\
+	getChr(s,88),\
+	getChr(s,89),\
+	getChr(s,90),\
+	getChr(s,91),\
+	getChr(s,92),\
+	getChr(s,93),\
+	getChr(s,94),\
+	getChr(s,95),\
+	getChr(s,96),\
+	getChr(s,97),\
+	getChr(s,98),\
+	getChr(s,99),\
+	getChr(s,100),\
+	getChr(s,101),\
+	getChr(s,102),\
+	getChr(s,103),\
+	getChr(s,104),\
+	getChr(s,105),\
+	getChr(s,106),\
+	getChr(s,107),\
+	getChr(s,108),\
+	getChr(s,109),\
+	getChr(s,110),\
+	getChr(s,111),\
+	getChr(s,112),\
+	getChr(s,113),\
+	getChr(s,114),\
+	getChr(s,115),\
+	getChr(s,116),\
+	getChr(s,117),\
+	getChr(s,118),\
+	getChr(s,119),\
+	getChr(s,120),\
+	getChr(s,121),\
+	getChr(s,122),\
+	getChr(s,123),\
+	getChr(s,124),\
+	getChr(s,125),\
+	getChr(s,126),\
+	getChr(s,127)
+
+#define getChr(name, ii) ((ii)<sizeof(name)/sizeof(*name)?name[ii]:0)
 
 #define ZJ_CAST_JSON_VAR_STRING 				(zetjsoncpp::JsonVarString<> *)
+#define ZJ_CAST_JSON_VAR_STRING_VIEW 			(zetjsoncpp::JsonVarStringView<> *)
 #define ZJ_CAST_JSON_VAR_BOOLEAN 				(zetjsoncpp::JsonVarBoolean<> *)
 #define ZJ_CAST_JSON_VAR_NUMBER 				(zetjsoncpp::JsonVarNumber<> *)
+#define ZJ_CAST_JSON_VAR_DOUBLE 				(zetjsoncpp::JsonVarDouble<> *)
+#define ZJ_CAST_JSON_VAR_INT64 					(zetjsoncpp::JsonVarInt64<> *)
 #define ZJ_CAST_JSON_VAR_OBJECT 				(zetjsoncpp::JsonVarObject<> *)
 #define ZJ_CAST_JSON_VAR_VECTOR_OF_BOOLEANS 	(zetjsoncpp::JsonVarVectorBoolean<> *)
 #define ZJ_CAST_JSON_VAR_VECTOR_OF_NUMBERS 		(zetjsoncpp::JsonVarVectorNumber<> *)
+#define ZJ_CAST_JSON_VAR_VECTOR_OF_DOUBLES 		(zetjsoncpp::JsonVarVectorDouble<> *)
+#define ZJ_CAST_JSON_VAR_VECTOR_OF_INT64S 		(zetjsoncpp::JsonVarVectorInt64<> *)
 #define ZJ_CAST_JSON_VAR_VECTOR_OF_STRINGS 		(zetjsoncpp::JsonVarVectorString<> *)
 #define ZJ_CAST_JSON_VAR_VECTOR_OF_OBJECTS 		(zetjsoncpp::JsonVarVectorObject<> *)
 #define ZJ_CAST_JSON_VAR_MAP_OF_BOOLEANS 		(zetjsoncpp::JsonVarMapBoolean<> *)
 #define ZJ_CAST_JSON_VAR_MAP_OF_NUMBERS 		(zetjsoncpp::JsonVarMapNumber<> *)
+#define ZJ_CAST_JSON_VAR_MAP_OF_DOUBLES 		(zetjsoncpp::JsonVarMapDouble<> *)
+#define ZJ_CAST_JSON_VAR_MAP_OF_INT64S 			(zetjsoncpp::JsonVarMapInt64<> *)
 #define ZJ_CAST_JSON_VAR_MAP_OF_STRINGS 		(zetjsoncpp::JsonVarMapString<> *)
 #define ZJ_CAST_JSON_VAR_MAP_OF_OBJECTS 		(zetjsoncpp::JsonVarMapObject<> *)
 
 #define ZJ_VAR_BOOLEAN(name) zetjsoncpp::JsonVarBoolean<ZJ_CONST_CHAR(#name)>						name
 #define ZJ_VAR_NUMBER(name) zetjsoncpp::JsonVarNumber<ZJ_CONST_CHAR(#name)>							name
+#define ZJ_VAR_DOUBLE(name) zetjsoncpp::JsonVarDouble<ZJ_CONST_CHAR(#name)>							name
+#define ZJ_VAR_INT64(name) zetjsoncpp::JsonVarInt64<ZJ_CONST_CHAR(#name)>							name
 #define ZJ_VAR_STRING(name) zetjsoncpp::JsonVarString<ZJ_CONST_CHAR(#name)>							name
+#define ZJ_VAR_STRING_VIEW(name) zetjsoncpp::JsonVarStringView<ZJ_CONST_CHAR(#name)>					name
 #define ZJ_VAR_OBJECT(type,name) zetjsoncpp::JsonVarObject<type,ZJ_CONST_CHAR(#name)>				name
 
 #define ZJ_VAR_VECTOR_BOOLEAN(name) zetjsoncpp::JsonVarVectorBoolean<ZJ_CONST_CHAR(#name)>			name
 #define ZJ_VAR_VECTOR_NUMBER(name) zetjsoncpp::JsonVarVectorNumber<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_VECTOR_DOUBLE(name) zetjsoncpp::JsonVarVectorDouble<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_VECTOR_INT64(name) zetjsoncpp::JsonVarVectorInt64<ZJ_CONST_CHAR(#name)>				name
 #define ZJ_VAR_VECTOR_STRING(name) zetjsoncpp::JsonVarVectorString<ZJ_CONST_CHAR(#name)>			name
 #define ZJ_VAR_VECTOR_OBJECT(type,name) zetjsoncpp::JsonVarVectorObject<type,ZJ_CONST_CHAR(#name)>	name
 
 #define ZJ_VAR_MAP_BOOLEAN(name) zetjsoncpp::JsonVarMapBoolean<ZJ_CONST_CHAR(#name)>				name
 #define ZJ_VAR_MAP_NUMBER(name) zetjsoncpp::JsonVarMapNumber<ZJ_CONST_CHAR(#name)>					name
+#define ZJ_VAR_MAP_DOUBLE(name) zetjsoncpp::JsonVarMapDouble<ZJ_CONST_CHAR(#name)>					name
+#define ZJ_VAR_MAP_INT64(name) zetjsoncpp::JsonVarMapInt64<ZJ_CONST_CHAR(#name)>					name
 #define ZJ_VAR_MAP_STRING(name) zetjsoncpp::JsonVarMapString<ZJ_CONST_CHAR(#name)>					name
 #define ZJ_VAR_MAP_OBJECT(type,name) zetjsoncpp::JsonVarMapObject<type,ZJ_CONST_CHAR(#name)>		name
 
+#define ZJ_VAR_FLAT_MAP_BOOLEAN(name) zetjsoncpp::JsonVarFlatMapBoolean<ZJ_CONST_CHAR(#name)>		name
+#define ZJ_VAR_FLAT_MAP_NUMBER(name) zetjsoncpp::JsonVarFlatMapNumber<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_FLAT_MAP_DOUBLE(name) zetjsoncpp::JsonVarFlatMapDouble<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_FLAT_MAP_INT64(name) zetjsoncpp::JsonVarFlatMapInt64<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_FLAT_MAP_STRING(name) zetjsoncpp::JsonVarFlatMapString<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_FLAT_MAP_OBJECT(type,name) zetjsoncpp::JsonVarFlatMapObject<type,ZJ_CONST_CHAR(#name)>	name
+
+#define ZJ_VAR_HASH_MAP_BOOLEAN(name) zetjsoncpp::JsonVarHashMapBoolean<ZJ_CONST_CHAR(#name)>		name
+#define ZJ_VAR_HASH_MAP_NUMBER(name) zetjsoncpp::JsonVarHashMapNumber<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_HASH_MAP_DOUBLE(name) zetjsoncpp::JsonVarHashMapDouble<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_HASH_MAP_INT64(name) zetjsoncpp::JsonVarHashMapInt64<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_HASH_MAP_STRING(name) zetjsoncpp::JsonVarHashMapString<ZJ_CONST_CHAR(#name)>			name
+#define ZJ_VAR_HASH_MAP_OBJECT(type,name) zetjsoncpp::JsonVarHashMapObject<type,ZJ_CONST_CHAR(#name)>	name
+
 
 namespace zetjsoncpp {
 
+	// first char of ZJ_CONST_CHAR, it checks the size of the name at compile time
+	template<size_t _T_NAME_SIZE>
+	constexpr char check_const_char_size(char c){
+		static_assert(_T_NAME_SIZE <= ZJ_MAX_CONST_CHAR+1, "name given to ZJ_CONST_CHAR is longer than ZJ_MAX_CONST_CHAR");
+		return c;
+	}
+
 	typedef enum:uint16_t{
 		JSON_VAR_TYPE_UNKNOWN		 =0, // 0
 		JSON_VAR_TYPE_BOOLEAN		 =0x1<<1, // 0x01
 		JSON_VAR_TYPE_NUMBER		 =0x1<<2, // 0x02
 		JSON_VAR_TYPE_STRING		 =0x1<<3, // 0x03
 		JSON_VAR_TYPE_OBJECT		 =0x1<<4, // 0x04
+		JSON_VAR_TYPE_DOUBLE		 =0x1<<5, // 0x20
+		JSON_VAR_TYPE_INT64		 =0x1<<6, // 0x40
+		JSON_VAR_TYPE_STRING_VIEW	 =0x1<<7, // 0x80, string in the parsed buffer (in situ only)
 		JSON_VAR_TYPE_VECTOR 		= 0x100,  //
 		JSON_VAR_TYPE_VECTOR_OF_BOOLEANS = JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_BOOLEAN, // 6
 		JSON_VAR_TYPE_VECTOR_OF_NUMBERS = JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_NUMBER, // 7
 		JSON_VAR_TYPE_VECTOR_OF_STRINGS =JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_STRING, // 9
 		JSON_VAR_TYPE_VECTOR_OF_OBJECTS = JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_OBJECT, //10
+		JSON_VAR_TYPE_VECTOR_OF_DOUBLES = JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_DOUBLE,
+		JSON_VAR_TYPE_VECTOR_OF_INT64S = JSON_VAR_TYPE_VECTOR+JSON_VAR_TYPE_INT64,
 		JSON_VAR_TYPE_MAP=0x200,
 		JSON_VAR_TYPE_MAP_OF_BOOLEANS = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_BOOLEAN, // 12
 		JSON_VAR_TYPE_MAP_OF_NUMBERS = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_NUMBER, // 13
 		JSON_VAR_TYPE_MAP_OF_STRINGS = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_STRING, // 14
 		JSON_VAR_TYPE_MAP_OF_OBJECTS = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_OBJECT, // 15
+		JSON_VAR_TYPE_MAP_OF_DOUBLES = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_DOUBLE,
+		JSON_VAR_TYPE_MAP_OF_INT64S = JSON_VAR_TYPE_MAP+JSON_VAR_TYPE_INT64,
 
 	}JsonVarType;
 
+	class JsonVarPropertyTable;
+	class JsonVarMapVisitor;
+	class JsonVarVectorBuilder;
+
+	// What all the JsonVars of one type have in common. There's one constant per type
+	// (see JsonVar::getDescriptor), so instances only keep their value and parsed state.
+	typedef struct{
+		std::string_view name; // empty for the elements of vectors and maps
+		JsonVarType type;
+		size_t size; // sizeof the JsonVar type, it is the step to the next property of an object
+	}JsonVarDescriptor;
+
 	class JsonVar {//: public CVariable {
 	public:
 
@@ -134,20 +269,39 @@ namespace zetjsoncpp {
 		virtual JsonVar *newJsonVar();
 		// It create a new json var slot for map container.
 		virtual JsonVar *newJsonVar(const std::string & key);
+		// It creates a builder of slots for vector container apart from it (i.e. in other thread),
+		// NULL if the container doesn't support it.
+		virtual JsonVarVectorBuilder *newJsonVarBuilder(){ return NULL;}
+		// It appends the slots created by builder (see newJsonVarBuilder).
+		virtual void appendJsonVars(JsonVarVectorBuilder *){}
 
 
 		const char *getTypeStr();
 
 		virtual ~JsonVar();
 
-		void * getPtrDataStart(){ return __zj_ptr_data_start__;}
+		// Name, type and size of the JsonVar type.
+		virtual const JsonVarDescriptor *getDescriptor();
+		// Start of the properties of object types, NULL otherwise.
+		virtual void * getPtrDataStart(){ return NULL;}
 		virtual void * getPtrValue(){ return NULL;}
+		// Property lookup table for object types, NULL otherwise.
+		virtual const JsonVarPropertyTable *getPropertyTable(){ return NULL;}
+		// Visits the entries of map types in iteration order, nothing otherwise.
+		virtual void visitMapEntries(JsonVarMapVisitor &){}
+
+
+		size_t  getSizeData(){return getDescriptor()->size;}
+		JsonVarType getType(){return getDescriptor()->type;}
+		// names are constants of the JsonVarNamed types, so the view is valid forever
+		std::string_view getVariableName(){return getDescriptor()->name;}
 
+		// Hash of the name and the type, and for objects (or containers of objects) of the names
+		// and types of its properties recursively. Values are not hashed.
+		virtual uint64_t getSchemaHash();
 
-		void * getPtrDataEnd(){return __zj_ptr_data_end__;}
-		size_t  getSizeData(){return __zj_size_data__;}
-		JsonVarType getType(){return __zj_type__;}
-		std::string getVariableName(){return __zj_variable_name__;}
+		// FNV-1a 64 of data, continuing from hash
+		static uint64_t hashSchema(uint64_t hash, const void *data, size_t len);
 
 		void setParsed(bool parsed);
 
@@ -155,27 +309,26 @@ namespace zetjsoncpp {
 
 	protected:
 		bool __zj_is_parsed__;
-		JsonVarType __zj_type__;
-		size_t __zj_size_data__;
-		std::string  __zj_variable_name__;
-		void 	     *__zj_ptr_data_start__; // can be int, bool, vector, prop_grp, etc ...
-		JsonVar *__zj_ptr_data_end__;
 	};
 
 
 
 };
 
+#include "JsonVarPropertyTable.h"
+#include "JsonVarPool.h"
 #include "JsonVarNamed.h"
 #include "JsonVarBoolean.h"
 #include "JsonVarNumber.h"
 #include "JsonVarString.h"
+#include "JsonVarStringView.h"
 #include "JsonVarObject.h"
 #include "JsonVarVector.h"
 #include "JsonVarVectorBoolean.h"
 #include "JsonVarVectorNumber.h"
 #include "JsonVarVectorString.h"
 #include "JsonVarVectorObject.h"
+#include "JsonVarMapStorage.h"
 #include "JsonVarMap.h"
 #include "JsonVarMapBoolean.h"
 #include "JsonVarMapNumber.h"
@@ -92,6 +92,10 @@ namespace zetjsoncpp{
 
 
 
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarBoolean<_T_NAME...>,JsonVarType::JSON_VAR_TYPE_BOOLEAN>();
+		}
+
 		virtual ~JsonVarBoolean(){}
 
 	private:
@@ -100,8 +104,6 @@ namespace zetjsoncpp{
 
 		void init() {
 			__zj_value__=false;
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_BOOLEAN;
-			this->__zj_size_data__ = sizeof(JsonVarBoolean<_T_NAME...>);
 		}
 
 	};
@@ -1,14 +1,20 @@
 namespace zetjsoncpp{
 
+	// Receives the entries of a map container through JsonVar::visitMapEntries.
+	class JsonVarMapVisitor {
+	public:
+		virtual void visit(const std::string & key, JsonVar *json_var)=0;
+		virtual ~JsonVarMapVisitor() {}
+	};
 
-	template<typename _T_DATA>
+	// _T_STORAGE is one of the storages of JsonVarMapStorage.h (std::map by default).
+	template<typename _T_DATA, template<typename> class _T_STORAGE = JsonVarMapStorageTree>
 	class JsonVarMap {
 	protected:
-		std::map<std::string,_T_DATA> __zj_map_data__;
+		_T_STORAGE<_T_DATA> __zj_map_data__;
 	public:
 
-		typedef typename std::map<std::string,_T_DATA>::iterator JsonVarIteratorMap;
-		//typename JsonVarIterator std::map<std::string,_T_DATA>::iterator;
+		typedef typename _T_STORAGE<_T_DATA>::iterator JsonVarIteratorMap;
 
 		JsonVarMap() {}
 
@@ -20,28 +26,45 @@ namespace zetjsoncpp{
 			return __zj_map_data__.end();
 		}
 
+		// returns end() if the key doesn't exist
+		JsonVarIteratorMap find(const std::string & key){
+			return __zj_map_data__.find(key);
+		}
+
+		size_t count(const std::string & key) const {
+			return __zj_map_data__.find(key) != __zj_map_data__.end() ? 1 : 0;
+		}
 
 		_T_DATA const& 	operator[](const std::string & key) const {
-			return __zj_map_data__.at(key);
+			return at(key);
 		}
 
 		_T_DATA & 	operator[](const std::string & key) {
-			return __zj_map_data__.at(key);
+			return at(key);
 		}
 
+		_T_DATA & 	at(const std::string & key) {
+			auto it = __zj_map_data__.find(key);
+			if (it == __zj_map_data__.end()) {
+				throw std::out_of_range(zj_strutils::format("key \"%s\" not found",key.c_str()));
+			}
+			return it->second;
+		}
 
 		_T_DATA const& 	at(const std::string & key) const {
-			return __zj_map_data__.at(key);
+			return const_cast<JsonVarMap *>(this)->at(key);
 		}
 
+		// as std::map::insert, it doesn't replace the value of an existing key
 		virtual void insert(const std::string & key, const _T_DATA & tt) {
-			__zj_map_data__.insert ( std::pair<std::string,_T_DATA>(key,tt) );
+			auto result = __zj_map_data__.emplace(key);
+			if (result.second) {
+				result.first->second = tt;
+			}
 		}
 
 		virtual void 	erase(const std::string & key) {
-			if (__zj_map_data__.count(key)>0) {
-				__zj_map_data__.erase(key);
-			}
+			__zj_map_data__.erase(key);
 		}
 
 		virtual void 	clear() {
@@ -52,17 +75,33 @@ namespace zetjsoncpp{
 			return __zj_map_data__.size();
 		}
 
-		std::map<std::string,_T_DATA> * getStdMap() {
-			return &__zj_map_data__;
+		// only for the default storage
+		template<typename _T_MAP_STORAGE = _T_STORAGE<_T_DATA>>
+		typename _T_MAP_STORAGE::StdMap * getStdMap() {
+			return __zj_map_data__.getStdMap();
 		}
 
 		virtual JsonVar * getJsonVarPtr(const std::string & key_id) {
-			return (JsonVar *)&__zj_map_data__.at(key_id);
+			return toJsonVar(at(key_id));
 		}
 
 		virtual ~JsonVarMap() {
 
 		}
 
+	protected:
+
+		void visitEntries(JsonVarMapVisitor & visitor) {
+			for (auto it = __zj_map_data__.begin(); it != __zj_map_data__.end(); it++) {
+				visitor.visit(it->first, toJsonVar(it->second));
+			}
+		}
+
+	private:
+
+		// values are JsonVars or pointers to JsonVarObject
+		static JsonVar *toJsonVar(JsonVar & json_var) { return &json_var; }
+		static JsonVar *toJsonVar(JsonVar * json_var) { return json_var; }
+
 	};
 }
@@ -1,42 +1,53 @@
 namespace zetjsoncpp{
 
-	template<char... _T_NAME>
-	class JsonVarMapBoolean: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarBoolean<>> {
+	template<template<typename> class _T_STORAGE, char... _T_NAME>
+	class JsonVarBasicMapBoolean: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarBoolean<>, _T_STORAGE> {
 
 	public:
 
-		JsonVarMapBoolean() {
-			init();
+		JsonVarBasicMapBoolean() {
 		}
 
-		JsonVarMapBoolean(const std::map<std::string,bool> & _map_bools) {
-			init();
+		JsonVarBasicMapBoolean(const std::map<std::string,bool> & _map_bools) {
 			copy(_map_bools);
 		}
 
 		virtual JsonVar *newJsonVar(const std::string & key_id){
-			if(this->__zj_map_data__.count(key_id) != 0){
+			auto result = this->__zj_map_data__.emplace(key_id);
+			if(result.second == false){
 				throw std::runtime_error(zj_strutils::format("property name \"%s\" already exists",key_id.c_str()));
 			}
-			this->__zj_map_data__[key_id]=JsonVarBoolean<>();
 
-			return &this->__zj_map_data__[key_id];
+			return &result.first->second;
+		}
+
+		virtual void visitMapEntries(JsonVarMapVisitor & visitor) {
+			this->visitEntries(visitor);
 		}
 
-		virtual ~JsonVarMapBoolean() {
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarBasicMapBoolean<_T_STORAGE, _T_NAME...>,JsonVarType::JSON_VAR_TYPE_MAP_OF_BOOLEANS>();
+		}
+
+		virtual ~JsonVarBasicMapBoolean() {
 
 		}
 	private:
 		void copy(const std::map<std::string,bool> & m){
 			this->__zj_map_data__.clear();
 			for(auto it=m.begin(); it != m.end();it++){
-				this->__zj_map_data__[it->first]=it->second;
+				this->__zj_map_data__.emplace(it->first).first->second=it->second;
 			}
 		}
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_MAP_OF_BOOLEANS;
-			this->__zj_size_data__ = sizeof(JsonVarMapBoolean< _T_NAME...>);
-		}
 	};
+
+	template<char... _T_NAME>
+	using JsonVarMapBoolean = JsonVarBasicMapBoolean<JsonVarMapStorageTree, _T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarFlatMapBoolean = JsonVarBasicMapBoolean<JsonVarMapStorageFlat, _T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarHashMapBoolean = JsonVarBasicMapBoolean<JsonVarMapStorageHash, _T_NAME...>;
 }
@@ -1,50 +1,82 @@
 namespace zetjsoncpp{
 
-	template<char... _T_NAME>
-	class JsonVarMapNumber: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarNumber<>> {
+	template<template<typename> class _T_STORAGE, typename _T_VALUE, char... _T_NAME>
+	class JsonVarBasicMapNumeric: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarNumeric<_T_VALUE>, _T_STORAGE> {
 
 	public:
 
-		JsonVarMapNumber() {
-			init();
+		JsonVarBasicMapNumeric() {
 		}
 
-		JsonVarMapNumber(const std::map<std::string,float> & _map_numbers) {
-			init();
+		JsonVarBasicMapNumeric(const std::map<std::string,_T_VALUE> & _map_numbers) {
 			copy(_map_numbers);
 		}
 
 
-		JsonVarVectorNumber<> & operator=(const  std::map<std::string,float> & _map_numbers){
+		JsonVarBasicMapNumeric & operator=(const  std::map<std::string,_T_VALUE> & _map_numbers){
 			copy(_map_numbers);
 			return *this;
 		}
 
 		virtual JsonVar *newJsonVar(const std::string & key_id){
-			if(this->__zj_map_data__.count(key_id) != 0){
+			auto result = this->__zj_map_data__.emplace(key_id);
+			if(result.second == false){
 				throw std::runtime_error(zj_strutils::format("property name \"%s\" already exists",key_id.c_str()));
 			}
-			this->__zj_map_data__[key_id]=JsonVarNumber<>();
 
-			return &this->__zj_map_data__[key_id];
+			return &result.first->second;
 		}
 
-		virtual ~JsonVarMapNumber() {
+		virtual void visitMapEntries(JsonVarMapVisitor & visitor) {
+			this->visitEntries(visitor);
+		}
+
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarBasicMapNumeric<_T_STORAGE,_T_VALUE,_T_NAME...>,(JsonVarType)(JsonVarType::JSON_VAR_TYPE_MAP+JsonVarNumericType<_T_VALUE>::value)>();
+		}
+
+		virtual ~JsonVarBasicMapNumeric() {
 
 		}
 
 	private:
-		void copy(const std::map<std::string,float> & m){
+		void copy(const std::map<std::string,_T_VALUE> & m){
 			this->__zj_map_data__.clear();
 			for(auto it=m.begin(); it != m.end();it++){
-				this->__zj_map_data__[it->first]=it->second;
+				this->__zj_map_data__.emplace(it->first).first->second=it->second;
 			}
 		}
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_MAP_OF_NUMBERS;
-			this->__zj_size_data__ = sizeof(JsonVarMapNumber< _T_NAME...>);
-		}
 
 	};
+
+	template<typename _T_VALUE, char... _T_NAME>
+	using JsonVarMapNumeric = JsonVarBasicMapNumeric<JsonVarMapStorageTree,_T_VALUE,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarMapNumber = JsonVarMapNumeric<float,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarMapDouble = JsonVarMapNumeric<double,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarMapInt64 = JsonVarMapNumeric<int64_t,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarFlatMapNumber = JsonVarBasicMapNumeric<JsonVarMapStorageFlat,float,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarFlatMapDouble = JsonVarBasicMapNumeric<JsonVarMapStorageFlat,double,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarFlatMapInt64 = JsonVarBasicMapNumeric<JsonVarMapStorageFlat,int64_t,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarHashMapNumber = JsonVarBasicMapNumeric<JsonVarMapStorageHash,float,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarHashMapDouble = JsonVarBasicMapNumeric<JsonVarMapStorageHash,double,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarHashMapInt64 = JsonVarBasicMapNumeric<JsonVarMapStorageHash,int64_t,_T_NAME...>;
 }
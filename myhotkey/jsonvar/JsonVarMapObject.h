@@ -1,49 +1,81 @@
 namespace zetjsoncpp{
 
-	template<typename _T_DATA, char... _T_NAME>
-	class JsonVarMapObject : public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarObject<_T_DATA> * > {
+	template<template<typename> class _T_STORAGE, typename _T_DATA, char... _T_NAME>
+	class JsonVarBasicMapObject : public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarObject<_T_DATA> *, _T_STORAGE > {
 
 
 	public:
 
-		JsonVarMapObject() {
-			init();
+		JsonVarBasicMapObject() {
 		}
-
+
 		virtual JsonVar *newJsonVar(const std::string & key_id) {
 
-			if(this->__zj_map_data__.count(key_id) != 0){
+			auto result = this->__zj_map_data__.emplace(key_id);
+			if(result.second == false){
 				throw std::runtime_error(zj_strutils::format("property name \"%s\" already exists",key_id.c_str()));
 			}
 
-			JsonVarObject< _T_DATA> *tt = new JsonVarObject<_T_DATA>;
-			this->__zj_map_data__[key_id]=tt;
-			return (JsonVar *)tt;
+			try {
+				result.first->second = __zj_pool__.newElement();
+			} catch (...) {
+				this->__zj_map_data__.erase(key_id);
+				throw;
+			}
+			return result.first->second;
+		}
+
+		virtual void 	erase(const std::string & key) {
+			auto it = this->__zj_map_data__.find(key);
+			if (it != this->__zj_map_data__.end()) {
+				JsonVarObject< _T_DATA> *json_object = it->second;
+				this->__zj_map_data__.erase(key);
+				__zj_pool__.deleteElement(json_object);
+			}
 		}
 
 		virtual void 	clear() {
 			destroy();
 		}
 
-		virtual JsonVar * getJsonVarPtr(const std::string & key_id) {
-			return (JsonVar *)this->__zj_map_data__.at(key_id);
+		virtual void visitMapEntries(JsonVarMapVisitor & visitor) {
+			this->visitEntries(visitor);
 		}
+
 		void destroy() {
 
 			for (auto it = this->__zj_map_data__.begin(); it != this->__zj_map_data__.end(); it++) {
-				delete it->second;
+				__zj_pool__.deleteElement(it->second);
 			}
 
 			this->__zj_map_data__.clear();
+			__zj_pool__.clear();
 		}
 
-		virtual ~JsonVarMapObject() {
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarBasicMapObject<_T_STORAGE, _T_DATA, _T_NAME...>,JsonVarType::JSON_VAR_TYPE_MAP_OF_OBJECTS>();
+		}
+
+		virtual uint64_t getSchemaHash(){
+			uint64_t data_hash=JsonVarObject<_T_DATA>::getDataSchemaHash();
+			return JsonVar::hashSchema(JsonVar::getSchemaHash(),&data_hash,sizeof(data_hash));
+		}
+
+		virtual ~JsonVarBasicMapObject() {
 			destroy();
 		}
 	private:
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_MAP_OF_OBJECTS;
-			this->__zj_size_data__ = sizeof(JsonVarMapObject<_T_DATA, _T_NAME...>);
-		}
+
+		// elements are allocated from the container pool
+		JsonVarPool<JsonVarObject<_T_DATA>> __zj_pool__;
 	};
+
+	template<typename _T_DATA, char... _T_NAME>
+	using JsonVarMapObject = JsonVarBasicMapObject<JsonVarMapStorageTree, _T_DATA, _T_NAME...>;
+
+	template<typename _T_DATA, char... _T_NAME>
+	using JsonVarFlatMapObject = JsonVarBasicMapObject<JsonVarMapStorageFlat, _T_DATA, _T_NAME...>;
+
+	template<typename _T_DATA, char... _T_NAME>
+	using JsonVarHashMapObject = JsonVarBasicMapObject<JsonVarMapStorageHash, _T_DATA, _T_NAME...>;
 }
@@ -0,0 +1,261 @@
+
+#define ZJ_MAP_STORAGE_HASH_MIN_SLOTS	16
+
+namespace zetjsoncpp{
+
+	// Storages for JsonVarMap. All of them provide the same interface:
+	//
+	// - iterator/const_iterator over pairs of key (first) and value (second)
+	// - find(key) returns end() if the key doesn't exist
+	// - emplace(key) inserts a default value if the key doesn't exist, with a single search,
+	//   and returns the iterator to the entry and whether it was inserted
+	// - erase(key) returns whether the key existed
+	//
+	// Keys must not be modified through the iterators.
+
+	// std::map: sorted by key, nodes never move.
+	template<typename _T_DATA>
+	class JsonVarMapStorageTree {
+	public:
+
+		typedef std::map<std::string,_T_DATA> StdMap;
+		typedef typename StdMap::iterator iterator;
+		typedef typename StdMap::const_iterator const_iterator;
+
+		iterator begin() { return __zj_map__.begin(); }
+		iterator end() { return __zj_map__.end(); }
+		const_iterator begin() const { return __zj_map__.begin(); }
+		const_iterator end() const { return __zj_map__.end(); }
+
+		size_t size() const { return __zj_map__.size(); }
+
+		iterator find(const std::string & key) { return __zj_map__.find(key); }
+		const_iterator find(const std::string & key) const { return __zj_map__.find(key); }
+
+		std::pair<iterator,bool> emplace(const std::string & key) {
+			iterator it = __zj_map__.lower_bound(key);
+			if (it != __zj_map__.end() && it->first == key) {
+				return std::make_pair(it, false);
+			}
+			return std::make_pair(__zj_map__.emplace_hint(it, key, _T_DATA()), true);
+		}
+
+		bool erase(const std::string & key) {
+			return __zj_map__.erase(key) > 0;
+		}
+
+		void clear() { __zj_map__.clear(); }
+
+		StdMap * getStdMap() { return &__zj_map__; }
+
+	private:
+		StdMap __zj_map__;
+	};
+
+	// Sorted vector: sorted by key, entries are contiguous. Keys that arrive in order are
+	// appended, otherwise the entries after the key are moved, so it fits small maps or
+	// maps that are written once and read many times. Inserting or erasing invalidates
+	// iterators and pointers to the values.
+	template<typename _T_DATA>
+	class JsonVarMapStorageFlat {
+	public:
+
+		typedef std::pair<std::string,_T_DATA> Entry;
+		typedef typename std::vector<Entry>::iterator iterator;
+		typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+		iterator begin() { return __zj_entries__.begin(); }
+		iterator end() { return __zj_entries__.end(); }
+		const_iterator begin() const { return __zj_entries__.begin(); }
+		const_iterator end() const { return __zj_entries__.end(); }
+
+		size_t size() const { return __zj_entries__.size(); }
+
+		iterator find(const std::string & key) {
+			iterator it = lowerBound(key);
+			return it != __zj_entries__.end() && it->first == key ? it : __zj_entries__.end();
+		}
+
+		const_iterator find(const std::string & key) const {
+			return const_cast<JsonVarMapStorageFlat *>(this)->find(key);
+		}
+
+		std::pair<iterator,bool> emplace(const std::string & key) {
+			if (__zj_entries__.size() == 0 || __zj_entries__.back().first < key) {
+				__zj_entries__.push_back(Entry(key, _T_DATA()));
+				return std::make_pair(__zj_entries__.end() - 1, true);
+			}
+
+			iterator it = lowerBound(key);
+			if (it->first == key) {
+				return std::make_pair(it, false);
+			}
+			return std::make_pair(__zj_entries__.insert(it, Entry(key, _T_DATA())), true);
+		}
+
+		bool erase(const std::string & key) {
+			iterator it = find(key);
+			if (it == __zj_entries__.end()) {
+				return false;
+			}
+			__zj_entries__.erase(it);
+			return true;
+		}
+
+		void clear() { __zj_entries__.clear(); }
+
+	private:
+		std::vector<Entry> __zj_entries__;
+
+		iterator lowerBound(const std::string & key) {
+			size_t first = 0, count = __zj_entries__.size();
+
+			while (count > 0) {
+				size_t step = count / 2;
+				if (__zj_entries__[first + step].first < key) {
+					first += step + 1;
+					count -= step + 1;
+				} else {
+					count = step;
+				}
+			}
+			return __zj_entries__.begin() + first;
+		}
+	};
+
+	// Open addressing hash: entries are contiguous in insertion order and a table of
+	// slots (linear probing) points to them. Erasing moves the last entry to the erased
+	// place. Inserting or erasing invalidates iterators and pointers to the values.
+	template<typename _T_DATA>
+	class JsonVarMapStorageHash {
+	public:
+
+		typedef std::pair<std::string,_T_DATA> Entry;
+		typedef typename std::vector<Entry>::iterator iterator;
+		typedef typename std::vector<Entry>::const_iterator const_iterator;
+
+		JsonVarMapStorageHash() {
+			__zj_mask__ = 0;
+		}
+
+		iterator begin() { return __zj_entries__.begin(); }
+		iterator end() { return __zj_entries__.end(); }
+		const_iterator begin() const { return __zj_entries__.begin(); }
+		const_iterator end() const { return __zj_entries__.end(); }
+
+		size_t size() const { return __zj_entries__.size(); }
+
+		iterator find(const std::string & key) {
+			uint32_t slot;
+			if (__zj_slots__.size() == 0 || !findSlot(key, hash(key), slot)) {
+				return __zj_entries__.end();
+			}
+			return __zj_entries__.begin() + (__zj_slots__[slot].entry - 1);
+		}
+
+		const_iterator find(const std::string & key) const {
+			return const_cast<JsonVarMapStorageHash *>(this)->find(key);
+		}
+
+		std::pair<iterator,bool> emplace(const std::string & key) {
+			uint32_t h = hash(key);
+			uint32_t slot;
+
+			// keep the load under 3/4
+			if ((__zj_entries__.size() + 1) * 4 > __zj_slots__.size() * 3) {
+				rehash(__zj_slots__.size() > 0 ? (uint32_t)__zj_slots__.size() * 2 : ZJ_MAP_STORAGE_HASH_MIN_SLOTS);
+			}
+
+			if (findSlot(key, h, slot)) {
+				return std::make_pair(__zj_entries__.begin() + (__zj_slots__[slot].entry - 1), false);
+			}
+
+			__zj_entries__.push_back(Entry(key, _T_DATA()));
+			__zj_slots__[slot].entry = (uint32_t)__zj_entries__.size();
+			__zj_slots__[slot].hash = h;
+			return std::make_pair(__zj_entries__.end() - 1, true);
+		}
+
+		bool erase(const std::string & key) {
+			uint32_t slot;
+			if (__zj_slots__.size() == 0 || !findSlot(key, hash(key), slot)) {
+				return false;
+			}
+
+			uint32_t entry = __zj_slots__[slot].entry - 1;
+			removeSlot(slot);
+
+			// move the last entry to the hole, so entries remain contiguous
+			uint32_t last = (uint32_t)__zj_entries__.size() - 1;
+			if (entry != last) {
+				uint32_t last_slot;
+				findSlot(__zj_entries__[last].first, hash(__zj_entries__[last].first), last_slot);
+				__zj_slots__[last_slot].entry = entry + 1;
+				__zj_entries__[entry] = std::move(__zj_entries__[last]);
+			}
+			__zj_entries__.pop_back();
+			return true;
+		}
+
+		void clear() {
+			__zj_entries__.clear();
+			__zj_slots__.clear();
+			__zj_mask__ = 0;
+		}
+
+	private:
+
+		typedef struct {
+			uint32_t entry; // entry index + 1, 0 if empty
+			uint32_t hash;
+		} Slot;
+
+		std::vector<Entry> __zj_entries__;
+		std::vector<Slot> __zj_slots__;
+		uint32_t __zj_mask__;
+
+		static uint32_t hash(const std::string & key) {
+			return JsonVarPropertyTable::hash(0, key.c_str(), key.size());
+		}
+
+		// returns true and the slot of key, or false and the empty slot where key goes
+		bool findSlot(const std::string & key, uint32_t h, uint32_t & slot) const {
+			for (slot = h & __zj_mask__; __zj_slots__[slot].entry != 0; slot = (slot + 1) & __zj_mask__) {
+				if (__zj_slots__[slot].hash == h && __zj_entries__[__zj_slots__[slot].entry - 1].first == key) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// backward shift deletion, so probe sequences don't need tombstones
+		void removeSlot(uint32_t hole) {
+			for (uint32_t slot = (hole + 1) & __zj_mask__; __zj_slots__[slot].entry != 0; slot = (slot + 1) & __zj_mask__) {
+				uint32_t home = __zj_slots__[slot].hash & __zj_mask__;
+				// the slot can fill the hole if its home is not in (hole,slot]
+				if (((slot - home) & __zj_mask__) >= ((slot - hole) & __zj_mask__)) {
+					__zj_slots__[hole] = __zj_slots__[slot];
+					hole = slot;
+				}
+			}
+			__zj_slots__[hole].entry = 0;
+		}
+
+		void rehash(uint32_t n_slots) {
+			std::vector<Slot> old_slots(n_slots);
+
+			old_slots.swap(__zj_slots__);
+			__zj_mask__ = n_slots - 1;
+
+			for (size_t i = 0; i < old_slots.size(); i++) {
+				if (old_slots[i].entry != 0) {
+					uint32_t slot = old_slots[i].hash & __zj_mask__;
+					while (__zj_slots__[slot].entry != 0) {
+						slot = (slot + 1) & __zj_mask__;
+					}
+					__zj_slots__[slot] = old_slots[i];
+				}
+			}
+		}
+	};
+}
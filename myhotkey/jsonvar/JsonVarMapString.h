@@ -1,52 +1,62 @@
 namespace zetjsoncpp{
 
-	template<char... _T_NAME>
-	class JsonVarMapString: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarString<>> {
+	template<template<typename> class _T_STORAGE, char... _T_NAME>
+	class JsonVarBasicMapString: public JsonVarNamed<_T_NAME...>, public JsonVarMap<JsonVarString<>, _T_STORAGE> {
 
 	public:
 
-		JsonVarMapString() {
-			init();
+		JsonVarBasicMapString() {
 		}
 
-		JsonVarMapString(const std::map<std::string,std::string> & _map_string) {
-			init();
+		JsonVarBasicMapString(const std::map<std::string,std::string> & _map_string) {
 			copy(_map_string);
 		}
 
 
-		JsonVarMapString<> & operator=(const  std::map<std::string,std::string> & _map_string){
+		JsonVarBasicMapString & operator=(const  std::map<std::string,std::string> & _map_string){
 			copy(_map_string);
 			return *this;
 		}
 
 		virtual JsonVar *newJsonVar(const std::string & key_id){
-			if(this->__zj_map_data__.count(key_id) != 0){
+			auto result = this->__zj_map_data__.emplace(key_id);
+			if(result.second == false){
 				throw std::runtime_error(zj_strutils::format("property name \"%s\" already exists",key_id.c_str()));
 			}
-			this->__zj_map_data__[key_id]=JsonVarString<>();
 
-			return &this->__zj_map_data__[key_id];
+			return &result.first->second;
+		}
+
+		virtual void visitMapEntries(JsonVarMapVisitor & visitor) {
+			this->visitEntries(visitor);
 		}
 
 
 
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarBasicMapString<_T_STORAGE, _T_NAME...>,JsonVarType::JSON_VAR_TYPE_MAP_OF_STRINGS>();
+		}
 
-		virtual ~JsonVarMapString() {
+		virtual ~JsonVarBasicMapString() {
 
 		}
 	private:
 		void copy(const std::map<std::string,std::string> & m){
 			this->__zj_map_data__.clear();
 			for(auto it=m.begin(); it != m.end();it++){
-				this->__zj_map_data__[it->first]=it->second;
+				this->__zj_map_data__.emplace(it->first).first->second=it->second;
 			}
 		}
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_MAP_OF_STRINGS;
-			this->__zj_size_data__ = sizeof(JsonVarMapString< _T_NAME...>);
-		}
 
 	};
+
+	template<char... _T_NAME>
+	using JsonVarMapString = JsonVarBasicMapString<JsonVarMapStorageTree, _T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarFlatMapString = JsonVarBasicMapString<JsonVarMapStorageFlat, _T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarHashMapString = JsonVarBasicMapString<JsonVarMapStorageHash, _T_NAME...>;
 }
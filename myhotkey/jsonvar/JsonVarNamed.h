@@ -2,31 +2,27 @@ namespace zetjsoncpp{
 
 	template<char... _T_NAME>
 	class JsonVarNamed : public JsonVar {
-	protected:
-		//----------------------------------------------------------------
-		// DON'T MOVE zj_var_ini AND NOT DECLARE ANY VAR UNDER __zj_var_ini__!!!!
-		JsonVar 	__zj_var_ini__;
-		//
-		//----------------------------------------------------------------
 	public:
 
 		//----------------------------------------------------------------
 
-		JsonVarNamed() {
+		// name of the property, one constant per template. ZJ_CONST_CHAR pads the name
+		// with zeros, so its length is the number of chars that are not zero.
+		static constexpr char VARIABLE_NAME[] = { _T_NAME..., 0 };
+		static constexpr size_t VARIABLE_NAME_LEN = (0 + ... + (_T_NAME != 0 ? 1 : 0));
 
-			std::vector<char> vec = {_T_NAME... };
-			std::string s_aux(vec.begin(), vec.end());
+		JsonVarNamed() {}
 
-			char buffer[512] = { 0 };
+		virtual ~JsonVarNamed() {}
 
-			strcpy(buffer, s_aux.c_str());
-			this->__zj_variable_name__ = buffer;
-			this->__zj_size_data__ = sizeof(JsonVarNamed);
+	protected:
 
+		// the descriptor of _T_JSON_VAR, that returns it from its getDescriptor
+		template<typename _T_JSON_VAR, JsonVarType _T_TYPE>
+		static const JsonVarDescriptor *getDescriptorOf() {
+			static constexpr JsonVarDescriptor descriptor = { std::string_view(VARIABLE_NAME, VARIABLE_NAME_LEN), _T_TYPE, sizeof(_T_JSON_VAR) };
+			return &descriptor;
 		}
 
-		virtual ~JsonVarNamed() {}
-
-
 	};
 }
@@ -1,36 +1,55 @@
 namespace zetjsoncpp{
 
-	template<char... _T_NAME>
-	class JsonVarNumber : public JsonVarNamed<_T_NAME ...>{
+	// json var type of each numeric value type
+	template<typename _T_VALUE>
+	struct JsonVarNumericType;
+
+	template<>
+	struct JsonVarNumericType<float>{
+		static const JsonVarType value=JsonVarType::JSON_VAR_TYPE_NUMBER;
+	};
+
+	template<>
+	struct JsonVarNumericType<double>{
+		static const JsonVarType value=JsonVarType::JSON_VAR_TYPE_DOUBLE;
+	};
+
+	template<>
+	struct JsonVarNumericType<int64_t>{
+		static const JsonVarType value=JsonVarType::JSON_VAR_TYPE_INT64;
+	};
+
+	template<typename _T_VALUE, char... _T_NAME>
+	class JsonVarNumeric : public JsonVarNamed<_T_NAME ...>{
 	public:
 
-			static float parse(const std::string & str ){
-				float f=0;
-				if(zj_strutils::str_to_float(&f,str)!=zj_strutils::STR_2_NUMBER_SUCCESS){
-					throw std::runtime_error(std::string("cannot convert ") + str + std::string(" as float"));
+			static _T_VALUE parse(const std::string & str ){
+				_T_VALUE f=0;
+				if(!zj_number::parse(str.c_str(),str.size(),&f)){
+					throw std::runtime_error(std::string("cannot convert ") + str + std::string(" as ")+JsonVar::idTypeToString(JsonVarNumericType<_T_VALUE>::value));
 				}
 
 				return f;
 			}
 
-			JsonVarNumber() {
+			JsonVarNumeric() {
 				init();
 			}
 
-			 JsonVarNumber(float f) {
+			 JsonVarNumeric(_T_VALUE f) {
 				init();
 				this->__zj_value__ = f;
 			}
 
-			 JsonVarNumber(const std::string & s) {
+			 JsonVarNumeric(const std::string & s) {
 				init();
 				this->__zj_value__ = parse(s);
 			}
 
 			//-----
 			// pre neg
-			JsonVarNumber   operator -  (){
-				return JsonVarNumber(-__zj_value__);
+			JsonVarNumeric   operator -  (){
+				return JsonVarNumeric(-__zj_value__);
 			}
 
 
@@ -39,113 +58,113 @@ namespace zetjsoncpp{
 
 
 			// operators
-			JsonVarNumber & operator=(float _value){
+			JsonVarNumeric & operator=(_T_VALUE _value){
 				__zj_value__=_value;
 				return *this;
 			}
 
-			JsonVarNumber & operator=(const JsonVarNumber & _n){
+			JsonVarNumeric & operator=(const JsonVarNumeric & _n){
 				__zj_value__=_n.__zj_value__;
 				return *this;
 			}
 
-			operator float(){
+			operator _T_VALUE(){
 				return this->__zj_value__;
 			}
 
 			//-----
 			// +
-			JsonVarNumber   operator +  (const JsonVarNumber & n) {
+			JsonVarNumeric   operator +  (const JsonVarNumeric & n) {
 				return (__zj_value__ + n.__zj_value__);
 			}
 
-			JsonVarNumber   operator +  (float n)  {
-				return JsonVarNumber(__zj_value__ + n);
+			JsonVarNumeric   operator +  (_T_VALUE n)  {
+				return JsonVarNumeric(__zj_value__ + n);
 			}
 
-			JsonVarNumber   operator +  (int n)  {
-				return JsonVarNumber(__zj_value__ + n);
+			JsonVarNumeric   operator +  (int n)  {
+				return JsonVarNumeric(__zj_value__ + n);
 			}
 			//-----
 			// -
-			JsonVarNumber   operator -  (const JsonVarNumber & n) {
+			JsonVarNumeric   operator -  (const JsonVarNumeric & n) {
 				return (__zj_value__ - n.__zj_value__);
 			}
 
-			JsonVarNumber   operator -  (float n)  {
-				return JsonVarNumber(__zj_value__ - n);
+			JsonVarNumeric   operator -  (_T_VALUE n)  {
+				return JsonVarNumeric(__zj_value__ - n);
 			}
 
-			JsonVarNumber   operator -  (int n)  {
-				return JsonVarNumber(__zj_value__ - n);
+			JsonVarNumeric   operator -  (int n)  {
+				return JsonVarNumeric(__zj_value__ - n);
 			}
 			//-----
 			// *
-			JsonVarNumber   operator *  (const JsonVarNumber & n) {
-				return JsonVarNumber(__zj_value__ * n.__zj_value__);
+			JsonVarNumeric   operator *  (const JsonVarNumeric & n) {
+				return JsonVarNumeric(__zj_value__ * n.__zj_value__);
 			}
-			JsonVarNumber   operator *  (float  n) {
-				return JsonVarNumber(__zj_value__ * n);
+			JsonVarNumeric   operator *  (_T_VALUE  n) {
+				return JsonVarNumeric(__zj_value__ * n);
 			}
-			JsonVarNumber   operator *  (int  n) {
-				return JsonVarNumber(__zj_value__ * n);
+			JsonVarNumeric   operator *  (int  n) {
+				return JsonVarNumeric(__zj_value__ * n);
 			}
 			//-----
 			// /
-			JsonVarNumber   operator /  (const JsonVarNumber & n) {
+			JsonVarNumeric   operator /  (const JsonVarNumeric & n) {
 
 				if(n.__zj_value__ ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(__zj_value__ / n.__zj_value__);
+				return JsonVarNumeric(__zj_value__ / n.__zj_value__);
 			}
 
-			JsonVarNumber   operator /  (float  n) {
+			JsonVarNumeric   operator /  (_T_VALUE  n) {
 
 				if(n ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(__zj_value__ / n);
+				return JsonVarNumeric(__zj_value__ / n);
 			}
 
-			JsonVarNumber   operator /  (int  n) {
+			JsonVarNumeric   operator /  (int  n) {
 
 				if(n ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(__zj_value__ / n);
+				return JsonVarNumeric(__zj_value__ / n);
 			}
 			//-----
 			// %
-			JsonVarNumber   operator %  (const JsonVarNumber & n) {
+			JsonVarNumeric   operator %  (const JsonVarNumeric & n) {
 
 				if(n.m_numVar ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(fmod(__zj_value__ , n.__zj_value__));
+				return JsonVarNumeric(fmod(__zj_value__ , n.__zj_value__));
 			}
 
-			JsonVarNumber   operator %  (float  n) {
+			JsonVarNumeric   operator %  (_T_VALUE  n) {
 
 				if(n ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(fmod(__zj_value__, n));
+				return JsonVarNumeric(fmod(__zj_value__, n));
 			}
 
-			JsonVarNumber   operator %  (int  n) {
+			JsonVarNumeric   operator %  (int  n) {
 
 				if(n ==0)
 					throw ("Error divide by 0");
 
-				return JsonVarNumber(fmod(__zj_value__ , n));
+				return JsonVarNumeric(fmod(__zj_value__ , n));
 			}
 			//-----
 			// !=
-			bool 	  operator == (const JsonVarNumber & n){
+			bool 	  operator == (const JsonVarNumeric & n){
 				return __zj_value__ == n.__zj_value__;
 			}
-			bool 	  operator == (float n){
+			bool 	  operator == (_T_VALUE n){
 				return __zj_value__ == n;
 			}
 			bool 	  operator == (int n){
@@ -153,10 +172,10 @@ namespace zetjsoncpp{
 			}
 			//-----
 			// !=
-			bool 	  operator != (const JsonVarNumber & n){
+			bool 	  operator != (const JsonVarNumeric & n){
 				return __zj_value__ != n.__zj_value__;
 			}
-			bool 	  operator != (float n){
+			bool 	  operator != (_T_VALUE n){
 				return __zj_value__ != n;
 			}
 			bool 	  operator != (int n){
@@ -164,10 +183,10 @@ namespace zetjsoncpp{
 			}
 			//-----
 			// !=
-			bool 	  operator <  (const JsonVarNumber & n){
+			bool 	  operator <  (const JsonVarNumeric & n){
 				return __zj_value__ < n.__zj_value__;
 			}
-			bool 	  operator <  (float n){
+			bool 	  operator <  (_T_VALUE n){
 				return __zj_value__ < n;
 			}
 			bool 	  operator <  (int n){
@@ -175,10 +194,10 @@ namespace zetjsoncpp{
 			}
 			//-----
 			// <=
-			bool 	  operator <= (const JsonVarNumber & n){
+			bool 	  operator <= (const JsonVarNumeric & n){
 				return __zj_value__ <= n.__zj_value__;
 			}
-			bool 	  operator <= (float n){
+			bool 	  operator <= (_T_VALUE n){
 				return __zj_value__ <= n;
 			}
 			bool 	  operator <= (int n){
@@ -187,10 +206,10 @@ namespace zetjsoncpp{
 
 			//-----
 			// >
-			bool 	  operator >  (const JsonVarNumber & n){
+			bool 	  operator >  (const JsonVarNumeric & n){
 				return __zj_value__ > n.__zj_value__;
 			}
-			bool 	  operator >  (float n){
+			bool 	  operator >  (_T_VALUE n){
 				return __zj_value__ > n;
 			}
 			bool 	  operator >  (int n){
@@ -198,10 +217,10 @@ namespace zetjsoncpp{
 			}
 			//-----
 			// >=
-			bool	operator >= (const JsonVarNumber & n){
+			bool	operator >= (const JsonVarNumeric & n){
 				return __zj_value__ >= n.__zj_value__;
 			}
-			bool 	  operator >= (float n){
+			bool 	  operator >= (_T_VALUE n){
 				return __zj_value__ >= n;
 			}
 			bool 	  operator >= (int n){
@@ -209,27 +228,27 @@ namespace zetjsoncpp{
 			}
 			//-----
 			// +=
-			JsonVarNumber & operator += (const JsonVarNumber & n){
+			JsonVarNumeric & operator += (const JsonVarNumeric & n){
 				__zj_value__ += n.__zj_value__;
 				return (*this);
 			}
 
-			JsonVarNumber & operator += (float n1){
+			JsonVarNumeric & operator += (_T_VALUE n1){
 				__zj_value__ += n1;
 				return (*this);
 			}
 
-			JsonVarNumber & operator *= (const JsonVarNumber & n){
+			JsonVarNumeric & operator *= (const JsonVarNumeric & n){
 				__zj_value__ *= n.__zj_value__;
 				return (*this);
 			}
 
-			JsonVarNumber & operator *= (float n1){
+			JsonVarNumeric & operator *= (_T_VALUE n1){
 				__zj_value__ *= n1;
 				return (*this);
 			}
 
-			JsonVarNumber & operator /= (const JsonVarNumber & n){
+			JsonVarNumeric & operator /= (const JsonVarNumeric & n){
 				if(n.__zj_value__ == 0)
 					throw("Divide by 0!");
 
@@ -237,7 +256,7 @@ namespace zetjsoncpp{
 				return (*this);
 			}
 
-			JsonVarNumber & operator /= (float n1){
+			JsonVarNumeric & operator /= (_T_VALUE n1){
 
 				if(n1 == 0){
 					throw("Divide by 0!");
@@ -247,37 +266,48 @@ namespace zetjsoncpp{
 				return (*this);
 			}
 			//--- -=
-			JsonVarNumber & operator -= (const JsonVarNumber & n){
+			JsonVarNumeric & operator -= (const JsonVarNumeric & n){
 				__zj_value__ -= n.m_numVar;
 				return (*this);
 			}
 
-			JsonVarNumber & operator -= (float n1){
+			JsonVarNumeric & operator -= (_T_VALUE n1){
 				__zj_value__ -= n1;
 				return (*this);
 			}
 
-			JsonVarNumber & operator ++(){
+			JsonVarNumeric & operator ++(){
 				__zj_value__++;
 				return (*this);
 			}
-			float  operator ++(int){
-				JsonVarNumber n(__zj_value__);
+			_T_VALUE  operator ++(int){
+				JsonVarNumeric n(__zj_value__);
 				operator++();
 				return n;
 			}
 
-			virtual ~JsonVarNumber(){}
+			virtual const JsonVarDescriptor *getDescriptor(){
+				return this->template getDescriptorOf<JsonVarNumeric<_T_VALUE,_T_NAME...>,JsonVarNumericType<_T_VALUE>::value>();
+			}
+
+			virtual ~JsonVarNumeric(){}
 	private:
 
-		float __zj_value__;
+		_T_VALUE __zj_value__;
 
 		void init() {
 			__zj_value__ = 0;
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_NUMBER;
-			this->__zj_size_data__ = sizeof(JsonVarNumber<_T_NAME...>);
 		}
 
 
 	};
+
+	template<char... _T_NAME>
+	using JsonVarNumber = JsonVarNumeric<float,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarDouble = JsonVarNumeric<double,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarInt64 = JsonVarNumeric<int64_t,_T_NAME...>;
 }
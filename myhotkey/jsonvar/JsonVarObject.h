@@ -1,42 +1,66 @@
 namespace zetjsoncpp{
 
 	//----------------------------------------------------------------
-	// DON'T DEFINE ANY VARIABLE ON JsonVarObject CLASS !!!!
+	// Properties are the JsonVars of _T_DATA, one after the other, and they are found
+	// through the property table of _T_DATA. _T_DATA MUST ONLY DECLARE JsonVars !!!!
 	template<typename _T_DATA, char... _T_NAME>
 	class JsonVarObject : public JsonVarNamed< _T_NAME...>, public _T_DATA {
-	protected:
-		//----------------------------------------------------------------
-		// DON'T DEFINE ANY VARIABLE UP __zj_var_end__ !!!!
-		JsonVar 	__zj_var_end__;
-		//
-		//----------------------------------------------------------------
 	public:
 		//----------------------------------------------------------------
 		JsonVarObject(...) {
-			init();
 		}
 
 		JsonVarObject(uint32_t numParam,...) {
-			init(numParam);
 		}
 
+		virtual void * getPtrDataStart(){
+			return static_cast<_T_DATA *>(this);
+		}
+
+		virtual const JsonVarPropertyTable *getPropertyTable(){
+			return JsonVarPropertyTable::getInstance<_T_DATA>(this);
+		}
 
-		virtual ~JsonVarObject(){};
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarObject<_T_DATA,_T_NAME...>,JsonVarType::JSON_VAR_TYPE_OBJECT>();
+		}
+
+		virtual uint64_t getSchemaHash(){
+			uint64_t data_hash=getDataSchemaHash();
+			return JsonVar::hashSchema(JsonVar::getSchemaHash(),&data_hash,sizeof(data_hash));
+		}
 
-	private:
-		void init(uint32_t numParam = 0, ...) {
-			// PRE: All arguments must be std::string. The program can parse the appropiate type variable
-			// with its emmbedded type.
+		// Hash of the properties of _T_DATA, also used by the containers of objects. If _T_DATA
+		// contains itself (through a vector or a map) the inner one is hashed as the seed only.
+		static uint64_t getDataSchemaHash(){
+			static thread_local bool is_hashing=false;
+			uint64_t hash=ZJ_SCHEMA_HASH_SEED;
 
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_OBJECT;
-			this->__zj_size_data__ = sizeof(JsonVarObject<_T_DATA,_T_NAME...>);
+			if(is_hashing){
+				return hash;
+			}
 
-			JsonVar *ptr = ((JsonVar *)&this->__zj_var_ini__ + 1);
-			this->__zj_ptr_data_start__ = ptr;
-			this->__zj_ptr_data_end__ = ((JsonVar *)&__zj_var_end__ - 1);
+			is_hashing=true;
+			try{
+				JsonVarObject<_T_DATA> json_object;
+				const JsonVarPropertyTable *property_table=json_object.getPropertyTable();
+				char *data_start=(char *)json_object.getPtrDataStart();
 
+				for(size_t i=0; i < property_table->size(); i++){
+					uint64_t property_hash=((JsonVar *)(data_start+property_table->at(i).offset))->getSchemaHash();
+					hash=JsonVar::hashSchema(hash,&property_hash,sizeof(property_hash));
+				}
+			}catch(...){
+				is_hashing=false;
+				throw;
+			}
+			is_hashing=false;
+
+			return hash;
 		}
 
+		virtual ~JsonVarObject(){};
+
 	};
 
 
@@ -0,0 +1,125 @@
+
+#define ZJ_POOL_SLAB_MIN_ELEMENTS	8
+#define ZJ_POOL_SLAB_MAX_SIZE		(1024*1024)
+
+namespace zetjsoncpp{
+
+	// Slab allocator for the elements of a container. Elements are built in slabs that
+	// double its capacity up to ZJ_POOL_SLAB_MAX_SIZE bytes, so consecutive elements are
+	// contiguous in memory and releasing all of them costs one free per slab instead of
+	// one per element. Slots of deleted elements are reused by the next newElement.
+	template<typename _T_DATA>
+	class JsonVarPool {
+	public:
+
+		JsonVarPool() {
+			__zj_free_list__ = NULL;
+			__zj_slab_used__ = 0;
+			__zj_slab_capacity__ = 0;
+		}
+
+		_T_DATA *newElement() {
+			void *slot = allocate();
+
+			try {
+				return new (slot) _T_DATA;
+			} catch (...) {
+				release(slot);
+				throw;
+			}
+		}
+
+		void deleteElement(_T_DATA *element) {
+			element->~_T_DATA();
+			release(element);
+		}
+
+		// Takes the slabs of other, so the elements built by other are released by this pool.
+		void splice(JsonVarPool & other) {
+			__zj_slabs__.reserve(__zj_slabs__.size() + other.__zj_slabs__.size());
+
+			// the last slab is kept at the end because it is the one in use
+			__zj_slabs__.insert(__zj_slabs__.begin(), other.__zj_slabs__.begin(), other.__zj_slabs__.end());
+
+			if (other.__zj_free_list__ != NULL) {
+				void *last = other.__zj_free_list__;
+				while (*(void **)last != NULL) {
+					last = *(void **)last;
+				}
+				*(void **)last = __zj_free_list__;
+				__zj_free_list__ = other.__zj_free_list__;
+			}
+
+			if (__zj_slab_capacity__ == 0) { // this pool was empty, so the last slab is the one of other
+				__zj_slab_used__ = other.__zj_slab_used__;
+				__zj_slab_capacity__ = other.__zj_slab_capacity__;
+			}
+
+			other.__zj_slabs__.clear();
+			other.__zj_free_list__ = NULL;
+			other.__zj_slab_used__ = 0;
+			other.__zj_slab_capacity__ = 0;
+		}
+
+		// Frees all slabs. Elements still alive must be deleted before.
+		void clear() {
+			for (unsigned i = 0; i < __zj_slabs__.size(); i++) {
+				::operator delete(__zj_slabs__[i]);
+			}
+
+			__zj_slabs__.clear();
+			__zj_free_list__ = NULL;
+			__zj_slab_used__ = 0;
+			__zj_slab_capacity__ = 0;
+		}
+
+		~JsonVarPool() {
+			clear();
+		}
+
+	private:
+
+		std::vector<char *> __zj_slabs__;
+		void *__zj_free_list__; // deleted slots, linked through its first bytes
+		size_t __zj_slab_used__; // elements used in the last slab
+		size_t __zj_slab_capacity__; // elements of the last slab
+
+		// elements point to its slab, so the pool cannot be copied
+		JsonVarPool(const JsonVarPool &);
+		JsonVarPool & operator=(const JsonVarPool &);
+
+		void *allocate() {
+			void *slot;
+
+			if (__zj_free_list__ != NULL) {
+				slot = __zj_free_list__;
+				__zj_free_list__ = *(void **)slot;
+				return slot;
+			}
+
+			if (__zj_slab_used__ == __zj_slab_capacity__) {
+				size_t capacity = ZJ_POOL_SLAB_MIN_ELEMENTS;
+				if (__zj_slab_capacity__ > 0) {
+					capacity = __zj_slab_capacity__;
+					if (capacity * sizeof(_T_DATA) < ZJ_POOL_SLAB_MAX_SIZE) {
+						capacity *= 2;
+					}
+				}
+
+				__zj_slabs__.reserve(__zj_slabs__.size() + 1);
+				__zj_slabs__.push_back((char *)::operator new(capacity * sizeof(_T_DATA)));
+				__zj_slab_capacity__ = capacity;
+				__zj_slab_used__ = 0;
+			}
+
+			slot = __zj_slabs__.back() + __zj_slab_used__ * sizeof(_T_DATA);
+			__zj_slab_used__++;
+			return slot;
+		}
+
+		void release(void *slot) {
+			*(void **)slot = __zj_free_list__;
+			__zj_free_list__ = slot;
+		}
+	};
+}
@@ -0,0 +1,109 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "../zetjsoncpp.h"
+
+#define ZJ_PROPERTY_TABLE_MAX_SEEDS		256
+
+namespace zetjsoncpp{
+
+	JsonVarPropertyTable::JsonVarPropertyTable(JsonVar *json_object, size_t size_data){
+		char *aux_p = (char *)json_object->getPtrDataStart();
+		char *end_p = aux_p + size_data;
+
+		__zj_seed__=0;
+		__zj_mask__=0;
+		__zj_max_probe__=0;
+
+		// Main loop iteration to whole C struct
+		for (; aux_p + sizeof(JsonVar) <= end_p; ) {
+			JsonVar * p_sv = (JsonVar *)aux_p;
+			JsonVarProperty property;
+
+			property.name=p_sv->getVariableName();
+			property.offset=aux_p-(char *)json_object->getPtrDataStart();
+			property.type=p_sv->getType();
+			__zj_properties__.push_back(property);
+
+			aux_p += p_sv->getSizeData();
+		}
+
+		if(__zj_properties__.size() == 0){
+			return;
+		}
+
+		uint32_t n_slots=1;
+		while(n_slots < __zj_properties__.size()*2){
+			n_slots<<=1;
+		}
+
+		// search a perfect hash, growing the table until 8 times the number of properties.
+		// If there's no luck accept collisions resolved by linear probing.
+		for(uint32_t max_probe=0;;max_probe++){
+			for(uint32_t slots=n_slots; slots <= n_slots*4; slots<<=1){
+				for(uint32_t seed=0; seed < ZJ_PROPERTY_TABLE_MAX_SEEDS; seed++){
+					if(build(seed,slots,max_probe)){
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	uint32_t JsonVarPropertyTable::hash(uint32_t seed, const char *str, size_t len){
+		// FNV-1a
+		uint32_t h=2166136261u ^ (seed * 16777619u);
+		for(size_t i=0; i < len; i++){
+			h^=(uint8_t)str[i];
+			h*=16777619u;
+		}
+		return h ^ (h >> 15);
+	}
+
+	bool JsonVarPropertyTable::build(uint32_t seed, uint32_t n_slots, uint32_t max_probe){
+		__zj_slots__.assign(n_slots,-1);
+		__zj_seed__=seed;
+		__zj_mask__=n_slots-1;
+		__zj_max_probe__=max_probe;
+
+		for(size_t i=0; i < __zj_properties__.size(); i++){
+			std::string_view name=__zj_properties__[i].name;
+			uint32_t h=hash(seed,name.data(),name.size());
+			uint32_t probe=0;
+
+			while(__zj_slots__[(h+probe) & __zj_mask__] != -1){
+				if(++probe > max_probe){
+					return false;
+				}
+			}
+
+			__zj_slots__[(h+probe) & __zj_mask__]=(int)i;
+		}
+
+		return true;
+	}
+
+	int JsonVarPropertyTable::find(const char *name, size_t name_len) const{
+		if(__zj_slots__.size() == 0){
+			return -1;
+		}
+
+		uint32_t h=hash(__zj_seed__,name,name_len);
+
+		for(uint32_t probe=0; probe <= __zj_max_probe__; probe++){
+			int index=__zj_slots__[(h+probe) & __zj_mask__];
+			if(index == -1){
+				return -1;
+			}
+
+			std::string_view property_name=__zj_properties__[index].name;
+			if(property_name.size() == name_len && memcmp(property_name.data(),name,name_len) == 0){
+				return index;
+			}
+		}
+
+		return -1;
+	}
+}
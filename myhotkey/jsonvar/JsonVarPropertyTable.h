@@ -0,0 +1,45 @@
+namespace zetjsoncpp{
+
+	// Lookup table of the properties of a JsonVarObject type: name -> index and offset
+	// from the start of the object data. It is built once per _T_DATA the first time an
+	// object of that type is used. Names are placed with a seeded hash that is searched
+	// until there are no collisions, so a lookup is one hash, one slot and one compare.
+	class JsonVarPropertyTable {
+	public:
+
+		typedef struct{
+			std::string_view name; // constant of the JsonVarNamed type
+			size_t offset; // offset from JsonVar::getPtrDataStart()
+			JsonVarType type;
+		}JsonVarProperty;
+
+		template<typename _T_DATA>
+		static const JsonVarPropertyTable *getInstance(JsonVar *json_object){
+			static JsonVarPropertyTable property_table(json_object,sizeof(_T_DATA));
+			return &property_table;
+		}
+
+		// properties are read from json_object, whose data (see JsonVar::getPtrDataStart) takes size_data bytes
+		JsonVarPropertyTable(JsonVar *json_object, size_t size_data);
+
+		// returns the index of the property or -1 if not exist
+		int find(const char *name, size_t name_len) const;
+
+		size_t size() const { return __zj_properties__.size(); }
+
+		const JsonVarProperty & at(size_t index) const { return __zj_properties__[index]; }
+
+		// FNV-1a of str, also used by the hash storage of maps
+		static uint32_t hash(uint32_t seed, const char *str, size_t len);
+
+	private:
+
+		std::vector<JsonVarProperty> __zj_properties__;
+		std::vector<int> __zj_slots__; // property index or -1 if empty
+		uint32_t __zj_seed__;
+		uint32_t __zj_mask__;
+		uint32_t __zj_max_probe__; // 0 if the hash is perfect
+
+		bool build(uint32_t seed, uint32_t n_slots, uint32_t max_probe);
+	};
+}
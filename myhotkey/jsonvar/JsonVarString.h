@@ -5,11 +5,9 @@ namespace zetjsoncpp{
 	public:
 
 		JsonVarString() {
-			init();
 		}
 
 		JsonVarString(const std::string & s) {
-			init();
 			__zj_value__ = s;
 		}
 
@@ -70,14 +68,12 @@ namespace zetjsoncpp{
 		}
 
 
-		virtual ~JsonVarString(){}
-	protected:
-
-		virtual void init() {
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_STRING;
-			this->__zj_size_data__ = sizeof(JsonVarString<_T_NAME...>);
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarString<_T_NAME...>,JsonVarType::JSON_VAR_TYPE_STRING>();
 		}
 
+		virtual ~JsonVarString(){}
+
 	private:
 
 		std::string __zj_value__;
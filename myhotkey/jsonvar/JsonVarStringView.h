@@ -0,0 +1,55 @@
+namespace zetjsoncpp{
+
+	// String that points to the buffer it was parsed from, so it's only deserialized in situ
+	// (see deserialize_in_situ) and it's valid while the buffer is. Escapes are decoded in the
+	// buffer and the string ends with '\0' there, so c_str() doesn't copy.
+	template<char... _T_NAME>
+	class JsonVarStringView : public JsonVarNamed<_T_NAME... >{
+	public:
+
+		JsonVarStringView() {
+			__zj_value__ = std::string_view("",0);
+		}
+
+		virtual void * getPtrValue(){ return &__zj_value__;}
+
+		operator std::string_view() const{return __zj_value__;}
+
+		// the view of a parsed string always ends with '\0'
+		const char *c_str() const{
+			return __zj_value__.data();
+		}
+
+		size_t size() const{
+			return __zj_value__.size();
+		}
+
+		friend bool operator ==(const std::string_view & s1,const JsonVarStringView & s2)  {
+			return s1==s2.__zj_value__;
+		}
+
+		friend bool operator ==(const JsonVarStringView & s1,const std::string_view & s2)  {
+			return s1.__zj_value__==s2;
+		}
+
+		friend bool operator !=(const std::string_view & s1,const JsonVarStringView & s2)  {
+			return s1!=s2.__zj_value__;
+		}
+
+		friend bool operator !=(const JsonVarStringView & s1,const std::string_view & s2)  {
+			return s1.__zj_value__!=s2;
+		}
+
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarStringView<_T_NAME...>,JsonVarType::JSON_VAR_TYPE_STRING_VIEW>();
+		}
+
+		virtual ~JsonVarStringView(){}
+
+	private:
+
+		std::string_view __zj_value__;
+
+
+	};
+}
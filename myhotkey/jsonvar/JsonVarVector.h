@@ -12,6 +12,14 @@
 
 namespace zetjsoncpp{
 
+	// Creates elements of a vector apart from it. They are moved to the vector, in creation
+	// order, by JsonVar::appendJsonVars.
+	class JsonVarVectorBuilder {
+	public:
+		virtual JsonVar *newJsonVar()=0;
+		virtual ~JsonVarVectorBuilder() {}
+	};
+
 	template<typename _T_DATA>
 	class JsonVarVector {
 	protected:
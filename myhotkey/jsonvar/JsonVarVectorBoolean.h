@@ -6,11 +6,9 @@ namespace zetjsoncpp{
 	public:
 		//_T_NAME name;
 		JsonVarVectorBoolean() {
-			init();
 		}
 
 		JsonVarVectorBoolean(const std::vector<bool> & _vec_booleans) {
-			init();
 			copy(_vec_booleans);
 		}
 
@@ -26,6 +24,10 @@ namespace zetjsoncpp{
 			return &this->__zj_vector_data__[this->__zj_vector_data__.size()-1];
 		}
 
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarVectorBoolean<_T_NAME...>,JsonVarType::JSON_VAR_TYPE_VECTOR_OF_BOOLEANS>();
+		}
+
 		virtual ~JsonVarVectorBoolean(){}
 
 	private:
@@ -36,10 +38,6 @@ namespace zetjsoncpp{
 			}
 		}
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_VECTOR_OF_BOOLEANS;
-			this->__zj_size_data__ = sizeof(JsonVarVectorBoolean<_T_NAME...>);
-		}
 
 
 	};
@@ -1,69 +1,76 @@
 namespace zetjsoncpp{
 
-	// ARRAY FLOAT
-	template<char... _T_NAME>
-	class JsonVarVectorNumber : public JsonVarNamed<_T_NAME...>, public JsonVarVector<JsonVarNumber<>> {
+	// ARRAY FLOAT/DOUBLE/INT64
+	template<typename _T_VALUE, char... _T_NAME>
+	class JsonVarVectorNumeric : public JsonVarNamed<_T_NAME...>, public JsonVarVector<JsonVarNumeric<_T_VALUE>> {
 
 	public:
 		//_T_NAME name;
-		JsonVarVectorNumber() {
-			init();
+		JsonVarVectorNumeric() {
 		}
 
-		JsonVarVectorNumber(const std::vector<float> & _vec_numbers) {
-			init();
+		JsonVarVectorNumeric(const std::vector<_T_VALUE> & _vec_numbers) {
 			copy(_vec_numbers);
 		}
 
 
-		JsonVarVectorNumber<> & operator=(const std::vector<float> & _vec_numbers){
+		JsonVarVectorNumeric & operator=(const std::vector<_T_VALUE> & _vec_numbers){
 			copy(_vec_numbers);
 			return *this;
 		}
 
 		virtual JsonVar *newJsonVar(){
-			this->__zj_vector_data__.push_back(JsonVarNumber<>(10));
+			this->__zj_vector_data__.emplace_back();
 
 			return &this->__zj_vector_data__[this->__zj_vector_data__.size()-1];
 		}
 
 		float *toFloatBuffer(size_t & length) {
 
-			float *floatBuf = new float[__zj_vector_data__.size()];
-			for (unsigned i = 0; i < __zj_vector_data__.size(); i++){
-				floatBuf[i]=__zj_vector_data__[i];
+			float *floatBuf = new float[this->__zj_vector_data__.size()];
+			for (unsigned i = 0; i < this->__zj_vector_data__.size(); i++){
+				floatBuf[i]=(float)this->__zj_vector_data__[i];
 			}
 
-			length=__zj_vector_data__.size();
+			length=this->__zj_vector_data__.size();
 			return floatBuf;
 		}
 
 
 		short *toShortBuffer(size_t & length) {
 
-			short * shortBuf = new short[__zj_vector_data__.size()];
-			for (unsigned i = 0; i < __zj_vector_data__.size(); i++){
-				shortBuf[i]=__zj_vector_data__[i];
+			short * shortBuf = new short[this->__zj_vector_data__.size()];
+			for (unsigned i = 0; i < this->__zj_vector_data__.size(); i++){
+				shortBuf[i]=(short)this->__zj_vector_data__[i];
 			}
 
-			length = __zj_vector_data__.size();
+			length = this->__zj_vector_data__.size();
 			return shortBuf;
 		}
 
-		virtual ~JsonVarVectorNumber() {
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarVectorNumeric<_T_VALUE,_T_NAME...>,(JsonVarType)(JsonVarType::JSON_VAR_TYPE_VECTOR+JsonVarNumericType<_T_VALUE>::value)>();
+		}
+
+		virtual ~JsonVarVectorNumeric() {
 		}
 
 	private:
-		void copy(const std::vector<float> & v){
+		void copy(const std::vector<_T_VALUE> & v){
 			this->__zj_vector_data__.clear();
 			for(auto it=v.begin(); it != v.end();it++){
 				this->__zj_vector_data__.push_back(*it);
 			}
 		}
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_VECTOR_OF_NUMBERS;
-			this->__zj_size_data__ = sizeof(JsonVarVectorNumber<_T_NAME...>);
-		}
 	};
+
+	template<char... _T_NAME>
+	using JsonVarVectorNumber = JsonVarVectorNumeric<float,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarVectorDouble = JsonVarVectorNumeric<double,_T_NAME...>;
+
+	template<char... _T_NAME>
+	using JsonVarVectorInt64 = JsonVarVectorNumeric<int64_t,_T_NAME...>;
 }
@@ -6,24 +6,42 @@ namespace zetjsoncpp{
 	public:
 
 		JsonVarVectorObject() {
-			init();
 		}
 
 		virtual JsonVar *newJsonVar() {
 
-			JsonVarObject< _T_DATA> *tt = new JsonVarObject<_T_DATA>;
-			this->__zj_vector_data__.push_back(tt);
+			JsonVarObject< _T_DATA> *tt = __zj_pool__.newElement();
+			try {
+				this->__zj_vector_data__.push_back(tt);
+			} catch (...) {
+				__zj_pool__.deleteElement(tt);
+				throw;
+			}
 			return (JsonVar *)tt;
 		}
 
+		virtual JsonVarVectorBuilder *newJsonVarBuilder() {
+			return new Builder();
+		}
+
+		virtual void appendJsonVars(JsonVarVectorBuilder *json_var_builder) {
+			Builder *builder = (Builder *)json_var_builder;
+
+			// reserve first, so nothing fails once the elements change of owner
+			this->__zj_vector_data__.reserve(this->__zj_vector_data__.size() + builder->elements.size());
+			__zj_pool__.splice(builder->pool);
+			this->__zj_vector_data__.insert(this->__zj_vector_data__.end(), builder->elements.begin(), builder->elements.end());
+			builder->elements.clear();
+		}
+
 		virtual void			 	push_back(const _T_DATA & tt) {
 			throw std::runtime_error("push_back not available, please use newJsonVar in order to add JsonVarObject");
 		}
 
 		virtual  void 	erase(int idx_position) {
-			JsonVar *json_object = this->__zj_vector_data__.at(idx_position);
+			JsonVarObject< _T_DATA> *json_object = this->__zj_vector_data__.at(idx_position);
 			this->__zj_vector_data__.erase(this->__zj_vector_data__.begin()+idx_position);
-			delete json_object;
+			__zj_pool__.deleteElement(json_object);
 		}
 
 		virtual  void 	insert(int idx_position, const _T_DATA & tt) {
@@ -41,11 +59,21 @@ namespace zetjsoncpp{
 		void destroy() {
 
 			for (unsigned i = 0; i < this->__zj_vector_data__.size(); i++) {
-				delete this->__zj_vector_data__[i];
+				__zj_pool__.deleteElement(this->__zj_vector_data__[i]);
 				this->__zj_vector_data__[i] = NULL;
 			}
 
 			this->__zj_vector_data__.clear();
+			__zj_pool__.clear();
+		}
+
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarVectorObject<_T_DATA, _T_NAME...>,JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS>();
+		}
+
+		virtual uint64_t getSchemaHash(){
+			uint64_t data_hash=JsonVarObject<_T_DATA>::getDataSchemaHash();
+			return JsonVar::hashSchema(JsonVar::getSchemaHash(),&data_hash,sizeof(data_hash));
 		}
 
 		virtual ~JsonVarVectorObject() {
@@ -53,9 +81,31 @@ namespace zetjsoncpp{
 		}
 	private:
 
-		void init(){
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS;
-			this->__zj_size_data__ = sizeof(JsonVarVectorObject<_T_DATA, _T_NAME...>);
-		}
+		// elements are built in its own pool, that is moved to the container pool on append
+		class Builder : public JsonVarVectorBuilder {
+		public:
+			JsonVarPool<JsonVarObject<_T_DATA>> pool;
+			std::vector<JsonVarObject<_T_DATA> *> elements;
+
+			virtual JsonVar *newJsonVar() {
+				JsonVarObject< _T_DATA> *tt = pool.newElement();
+				try {
+					elements.push_back(tt);
+				} catch (...) {
+					pool.deleteElement(tt);
+					throw;
+				}
+				return tt;
+			}
+
+			virtual ~Builder() {
+				for (unsigned i = 0; i < elements.size(); i++) {
+					pool.deleteElement(elements[i]);
+				}
+			}
+		};
+
+		// elements are allocated from the container pool
+		JsonVarPool<JsonVarObject<_T_DATA>> __zj_pool__;
 	};
 }
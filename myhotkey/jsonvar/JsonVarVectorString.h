@@ -6,11 +6,9 @@ namespace zetjsoncpp{
 	public:
 		//_T_NAME name;
 		JsonVarVectorString() {
-			init();
 		}
 
 		JsonVarVectorString(const std::vector<std::string> & _vec_string) {
-			init();
 			copy(_vec_string);
 		}
 
@@ -26,6 +24,10 @@ namespace zetjsoncpp{
 			return &this->__zj_vector_data__[this->__zj_vector_data__.size()-1];
 		}
 
+		virtual const JsonVarDescriptor *getDescriptor(){
+			return this->template getDescriptorOf<JsonVarVectorString< _T_NAME...>,JsonVarType::JSON_VAR_TYPE_VECTOR_OF_STRINGS>();
+		}
+
 		virtual ~JsonVarVectorString(){}
 
 	private:
@@ -37,10 +39,6 @@ namespace zetjsoncpp{
 			}
 		}
 
-		void init() {
-			this->__zj_type__ = JsonVarType::JSON_VAR_TYPE_VECTOR_OF_STRINGS;
-			this->__zj_size_data__ = sizeof(JsonVarVectorString< _T_NAME...>);
-		}
 
 
 	};
@@ -2,10 +2,11 @@
 #include <iostream>
 #include <conio.h>
 #include <stdio.h>
-#include <QProcess>
 #include <Windows.h>
 
 #include "hotkeyhandler.h"
+#include "ProcessTerminator.h"
+#include "FileWatcher.h"
 #include "zetjsoncpp.h"
 using namespace zetjsoncpp;
 
@@ -28,25 +29,19 @@ void hand1(void* s)
     WinExec((char*)s, SW_SHOW);
 }
 
-int findProcess(const QString& name)
+// running processes by image name, refreshed when a name is not found
+CProcessIndex processIndex;
+
+// terminates the processes of processIndex
+CProcessTerminator processTerminator(processIndex);
+
+int findProcess(const char* name)
 {
-    QProcess p;
-    p.start("tasklist");
-    p.waitForFinished();
-
-    QString output = p.readAllStandardOutput();
-    QStringList lines = output.split("\n");
-
-    //OutputDebugStringA(output.toStdString().c_str());
-    for (QString line : lines) {
-        //OutputDebugStringA(line.toStdString().c_str());
-        if (line.contains(name, Qt::CaseInsensitive)) {
-            line.replace(QRegExp("[\\s]+"), " ");
-            QStringList parts = line.split(" ");
-            return parts[1].toInt();
-        }
+    std::vector<uint32_t> pids;
+    if (!processIndex.Find(name, pids)) {
+        return 0;
     }
-    return 0;
+    return pids[0];
 }
 
 typedef struct
@@ -127,12 +122,18 @@ void killhandler(void* process_name)
     //    ::ShowWindow(hTask, SW_HIDE);
     //}
 
-    QProcess killprocess;
-    //QString cmd = QString("TASKKILL /PID %1 /F").arg(pid);
-    QString cmd = QString("cmd.exe /c TASKKILL.exe /F /IM %1").arg((char*)process_name);
-    OutputDebugStringA(cmd.toStdString().c_str());
-    killprocess.start(cmd.toStdString().c_str());
-    killprocess.waitForFinished();
+    std::vector<CProcessTerminator::tResult> results;
+    int err = processTerminator.Terminate((char*)process_name, results, 1000);
+    if (err == CProcessTerminator::pteNotFound) {
+        OutputDebugStringA("cannot find the process");
+        return;
+    }
+
+    for (auto &result : results) {
+        char info[128];
+        sprintf_s(info, sizeof(info), "kill %u: %d (error %u)", result.pid, result.rc, result.error);
+        OutputDebugStringA(info);
+    }
 }
 
 
@@ -146,6 +147,58 @@ typedef struct
 
 CHotkeyHandler hk;
 
+// reloads the hotkeys when the file is saved
+const std::string hotkeysFile = "hotkeys.json";
+CFileWatcher hotkeysWatcher;
+
+template<typename T>
+void addHotkeys(T& tasks, CHotkeyEngine::tHotkeyCB cb, std::vector<CHotkeyEngine::tHotkeyBinding>& bindings)
+{
+    for (auto it_map = tasks.begin(); it_map != tasks.end(); it_map++) {
+        if (it_map->first.size() > 0) {
+            CHotkeyEngine::tHotkeyBinding binding;
+            binding.mod = MOD_CONTROL | MOD_ALT;
+            binding.virt = it_map->first[0];
+            binding.callback = cb;
+            binding.param = it_map->second;
+            bindings.push_back(binding);
+            OutputDebugStringA(it_map->second.c_str());
+        }
+    }
+}
+
+// hotkeys of the file, it throws if the file can't be parsed
+void loadHotkeys(const std::string& filename, std::vector<CHotkeyEngine::tHotkeyBinding>& bindings)
+{
+    auto json_object = zetjsoncpp::deserialize_file<zetjsoncpp::JsonVarObject<HotKeyTask>>(filename);
+
+    addHotkeys(json_object->tasks, hand1, bindings);
+    addHotkeys(json_object->hidetasks, hidehandler, bindings);
+    addHotkeys(json_object->killtasks, killhandler, bindings);
+    delete json_object;
+}
+
+// called by hotkeysWatcher (param is the myhotkey window), the hotkeys that didn't change
+// keep working meanwhile
+void onHotkeysChanged(void* param)
+{
+    std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+    try {
+        loadHotkeys(hotkeysFile, bindings);
+    }
+    catch (std::exception& ex) {
+        // keep the current hotkeys until the file is fixed, the window is told in its thread
+        OutputDebugStringA(ex.what());
+        QMetaObject::invokeMethod((myhotkey*)param, "onHotkeysError", Qt::QueuedConnection, Q_ARG(QString, QString::fromLocal8Bit(ex.what())));
+        return;
+    }
+
+    hk.Reload(bindings);
+    // in case there were no hotkeys before
+    hk.Start(nullptr);
+    OutputDebugStringA("hotkeys reloaded");
+}
+
 myhotkey::myhotkey(QWidget *parent)
     : QMainWindow(parent)
 {
@@ -183,47 +236,13 @@ myhotkey::myhotkey(QWidget *parent)
 
     OutputDebugStringA("enter myhotkey contructor");
     //hotkey
-    int err, id;
+    int err;
     try {
 
-        hk.RemoveHandler(id = 0);
-
         //std::string filename = R"(C:\Users\shake\Desktop\S\tc\hotkeys.json)";
-        std::string filename = "hotkeys.json";
-        auto json_object = zetjsoncpp::deserialize_file<zetjsoncpp::JsonVarObject<HotKeyTask>>(filename);
-
-        // iterate of all interpolations and replace its data values...
-        auto &tasks = json_object->tasks;
-        for (auto it_map = tasks.begin(); it_map != tasks.end(); it_map++) {
-            if (it_map->first.size() > 0) {
-                char k = it_map->first[0];
-                hk.InsertHandler(MOD_CONTROL | MOD_ALT, k, hand1, it_map->second, id);
-                OutputDebugStringA(it_map->second.c_str());
-                //err = hk.Start((LPVOID)(it_map->second.c_str()));
-                //if (err != CHotkeyHandler::hkheOk) {
-                //    printf("Error %d on Start()\n", err);
-                //}
-            }
-        }
-
-        auto &hidetasks = json_object->hidetasks;
-        for (auto it_map = hidetasks.begin(); it_map != hidetasks.end(); it_map++) {
-            if (it_map->first.size() > 0) {
-                char k = it_map->first[0];
-                hk.InsertHandler(MOD_CONTROL | MOD_ALT, k, hidehandler, it_map->second, id);
-                //MOD_WIN
-            }
-        }
-
-        auto &killtasks = json_object->killtasks;
-        for (auto it_map = killtasks.begin(); it_map != killtasks.end(); it_map++) {
-            if (it_map->first.size() > 0) {
-                char k = it_map->first[0];
-                hk.InsertHandler(MOD_CONTROL | MOD_ALT, k, killhandler, it_map->second, id);
-                OutputDebugStringA(it_map->second.c_str());
-            }
-        }
-
+        std::vector<CHotkeyEngine::tHotkeyBinding> bindings;
+        loadHotkeys(hotkeysFile, bindings);
+        hk.Reload(bindings);
 
         err = hk.Start(nullptr);
         if (err != CHotkeyHandler::hkheOk) {
@@ -244,12 +263,17 @@ myhotkey::myhotkey(QWidget *parent)
     }
     catch (std::exception& ex) {
         fprintf(stderr, "%s\n", ex.what());
+        onHotkeysError(QString::fromLocal8Bit(ex.what()));
     }
 
+    if (!hotkeysWatcher.Start(hotkeysFile, onHotkeysChanged, this)) {
+        OutputDebugStringA("cannot watch the hotkeys file");
+    }
 }
 
 myhotkey::~myhotkey()
 {
+    hotkeysWatcher.Stop();
     hk.Stop();
 }
 
@@ -267,6 +291,12 @@ void myhotkey::closeEvent(QCloseEvent * event)
 
 }
 
+void myhotkey::onHotkeysError(const QString &message)
+{
+    // i.e. strings with invalid escapes, as paths with single backslashes
+    SysIcon->showMessage(QString::fromStdString(hotkeysFile), message, QSystemTrayIcon::Warning);
+}
+
 void myhotkey::on_activatedSysTrayIcon(QSystemTrayIcon::ActivationReason reason)
 {
     switch (reason) {
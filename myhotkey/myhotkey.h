@@ -19,6 +19,8 @@ private:
 
 private slots:
     void on_activatedSysTrayIcon(QSystemTrayIcon::ActivationReason reason);
+    // the hotkeys file can't be loaded, the message is shown in the tray
+    void onHotkeysError(const QString &message);
 
 private:
     Ui::myhotkeyClass ui;
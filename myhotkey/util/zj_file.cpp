@@ -1,5 +1,15 @@
 #include "../zetjsoncpp.h"
 
+#if defined(__linux__) && !defined(ZJ_FILE_DISABLE_MMAP)
+#define ZJ_FILE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// first buffer size to read the files without size, it doubles until the end
+#define ZJ_FILE_READ_CHUNK_SIZE 4096
+
 namespace zetjsoncpp
 {
 	namespace zj_file{
@@ -83,5 +93,163 @@ namespace zetjsoncpp
 
 			return    -1;
 		}
+
+		// reads fp until its end, for the files whose size isn't known (pipes, /proc files)
+		static char *read_all(FILE *fp, const std::string & filename, size_t & size){
+			size_t capacity=ZJ_FILE_READ_CHUNK_SIZE, len;
+			char *buffer=(char *)malloc(capacity+1);
+
+			if(buffer == NULL){
+				throw std::bad_alloc();
+			}
+
+			size=0;
+			while((len=fread(buffer+size,1,capacity-size,fp)) > 0){
+				size+=len;
+				if(size == capacity){
+					char *grown=(char *)realloc(buffer,capacity*2+1);
+					if(grown == NULL){
+						free(buffer);
+						throw std::bad_alloc();
+					}
+					buffer=grown;
+					capacity*=2;
+				}
+			}
+
+			if(ferror(fp)){
+				free(buffer);
+				throw std::runtime_error("I can't read file \""+filename+"\"");
+			}
+
+			return buffer;
+		}
+
+		bool get_stamp(const std::string & filename, FileStamp & file_stamp){
+			struct stat file_stat;
+
+			if(stat(filename.c_str(),&file_stat) != 0){
+				return false;
+			}
+
+			file_stamp.size=(uint64_t)file_stat.st_size;
+#if defined(__linux__)
+			file_stamp.mtime=(int64_t)file_stat.st_mtim.tv_sec*1000000000+file_stat.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+			file_stamp.mtime=(int64_t)file_stat.st_mtimespec.tv_sec*1000000000+file_stat.st_mtimespec.tv_nsec;
+#else
+			file_stamp.mtime=(int64_t)file_stat.st_mtime;
+#endif
+			return true;
+		}
+
+		MappedFile map(const std::string & filename, bool writable){
+			MappedFile mapped_file;
+			struct stat file_stat;
+
+			mapped_file.buffer=NULL;
+			mapped_file.size=0;
+			mapped_file.mapped_size=0;
+
+#ifdef ZJ_FILE_MMAP
+			int fd=open(filename.c_str(),O_RDONLY);
+			if(fd == -1){
+				throw std::runtime_error("I can't open file \""+filename+"\"");
+			}
+
+			if(fstat(fd,&file_stat) != 0){
+				close(fd);
+				throw std::runtime_error("I can't read file \""+filename+"\"");
+			}
+
+			// files without size (pipes, /proc files) may have contents, they're read
+			if(file_stat.st_size > 0){
+				size_t page_size=(size_t)sysconf(_SC_PAGESIZE);
+				int protection=writable?PROT_READ|PROT_WRITE:PROT_READ; // private pages are copied when they're written
+				mapped_file.size=(size_t)file_stat.st_size;
+				// file pages + at least one byte more for the NUL terminator. Bytes after the
+				// end of file in the last page are zero, and if the file fills its last page
+				// an extra anonymous zero page is left after it.
+				mapped_file.mapped_size=(mapped_file.size/page_size+1)*page_size;
+
+				// reserve the whole range with zero pages and then map the file over it
+				void *base=mmap(NULL,mapped_file.mapped_size,protection,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+				if(base != MAP_FAILED){
+					if(mmap(base,mapped_file.size,protection,MAP_PRIVATE|MAP_FIXED,fd,0) == MAP_FAILED){
+						munmap(base,mapped_file.mapped_size);
+						base=MAP_FAILED;
+					}else{
+						madvise(base,mapped_file.size,MADV_SEQUENTIAL);
+					}
+				}
+
+				if(base != MAP_FAILED){
+					close(fd);
+					mapped_file.buffer=(char *)base;
+					return mapped_file;
+				}
+			}
+			close(fd);
+
+			// cannot map (i.e special files), fallback to read
+			mapped_file.mapped_size=0;
+#endif
+			FILE *fp;
+			if((fp = fopen(filename.c_str(),"rb")) == NULL){
+				throw std::runtime_error("I can't open file \""+filename+"\"");
+			}
+
+			if(fstat(fileno(fp),&file_stat) != 0){
+				fclose(fp);
+				throw std::runtime_error("I can't read file \""+filename+"\"");
+			}
+
+			mapped_file.size=(size_t)file_stat.st_size;
+			if(mapped_file.size == 0){
+				try{
+					mapped_file.buffer=read_all(fp,filename,mapped_file.size);
+				}catch(...){
+					fclose(fp);
+					throw;
+				}
+				fclose(fp);
+
+				mapped_file.buffer[mapped_file.size]=0;
+				return mapped_file;
+			}
+
+			if((mapped_file.buffer=(char *)malloc(mapped_file.size+1)) == NULL){
+				fclose(fp);
+				throw std::bad_alloc();
+			}
+
+			if(fread(mapped_file.buffer, 1, mapped_file.size, fp) != mapped_file.size){
+				free(mapped_file.buffer);
+				fclose(fp);
+				throw std::runtime_error("number elements doesn't match with length file ("+filename+")");
+			}
+			fclose(fp);
+
+			mapped_file.buffer[mapped_file.size]=0;
+			return mapped_file;
+		}
+
+		void unmap(MappedFile & mapped_file){
+			if(mapped_file.buffer == NULL){
+				return;
+			}
+#ifdef ZJ_FILE_MMAP
+			if(mapped_file.mapped_size > 0){
+				munmap(mapped_file.buffer,mapped_file.mapped_size);
+			}else
+#endif
+			{
+				free(mapped_file.buffer);
+			}
+
+			mapped_file.buffer=NULL;
+			mapped_file.size=0;
+			mapped_file.mapped_size=0;
+		}
 	}
 }
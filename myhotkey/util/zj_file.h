@@ -3,9 +3,33 @@
 namespace zetjsoncpp
 {
 	namespace zj_file{
+
+		// File content mapped in memory. The buffer is always NUL terminated at buffer[size]
+		typedef struct{
+			char *buffer;
+			size_t size; // file size
+			size_t mapped_size; // size of the mapping, 0 if the content was read in a heap buffer
+		}MappedFile;
+
 		bool exists(const std::string & m_file) ;
 		char * read(const std::string & filename, bool end_string_char=true);
 		int  length(const  std::string  & file);
+
+		// mmap the file on Linux or read it in a heap buffer elsewhere. Size is taken with one fstat,
+		// files that have no size (pipes, /proc files) are read until their end.
+		// If writable, the buffer can be modified (i.e in situ parse) and the changes are private,
+		// the file is not written.
+		MappedFile map(const std::string & filename, bool writable=false);
+		void unmap(MappedFile & mapped_file);
+
+		// Size and modification time of a file, that change when it's written
+		typedef struct{
+			uint64_t size;
+			int64_t mtime; // nanoseconds from the epoch where the system has them, seconds otherwise
+		}FileStamp;
+
+		// false if the file can't be stat
+		bool get_stamp(const std::string & filename, FileStamp & file_stamp);
 	}
 
 }
@@ -0,0 +1,693 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "../zetjsoncpp.h"
+#include <errno.h>
+#include <limits>
+
+#if defined(_WIN32)
+#include <locale.h>
+#elif defined(__APPLE__)
+#include <xlocale.h>
+#else
+#include <locale.h>
+#endif
+
+// Exact fast path relies on double/float operations being done without extended
+// precision (i.e x87 FPU)
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0 && !defined(_MSC_VER)
+#define ZJ_NUMBER_DISABLE_FAST_PATH
+#endif
+
+// Formatting is based on Grisu2 algorithm (Florian Loitsch, "Printing
+// Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010)
+
+namespace zetjsoncpp{
+
+	namespace zj_number{
+
+		//-------------------------------------------------------------------------------------
+		// PARSE
+
+		// up to 19 decimal digits always fit in uint64
+		#define ZJ_NUMBER_MAX_MANTISSA_DIGITS 19
+
+		typedef struct{
+			bool negative;
+			uint64_t mantissa;
+			int exponent; // value = mantissa * 10^exponent
+			bool truncated; // mantissa had more than ZJ_NUMBER_MAX_MANTISSA_DIGITS digits
+			bool is_integer; // it had no fraction or exponent
+		}DecimalNumber;
+
+		const double POW10_DOUBLE[]={
+			1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11
+			,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+		};
+
+		inline bool is_digit(char c){
+			return c >= '0' && c <= '9';
+		}
+
+		// Reads a number with json grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+		bool read_decimal(const char *str, const char *str_end, DecimalNumber & decimal){
+			const char *str_current=str;
+			int digits=0;
+			int exponent=0;
+
+			decimal.negative=false;
+			decimal.mantissa=0;
+			decimal.truncated=false;
+			decimal.is_integer=true;
+
+			if(str_current < str_end && *str_current == '-'){
+				decimal.negative=true;
+				str_current++;
+			}
+
+			if(str_current == str_end || !is_digit(*str_current)){
+				return false;
+			}
+
+			if(*str_current == '0'){
+				str_current++;
+			}else{
+				for(; str_current < str_end && is_digit(*str_current); str_current++){
+					if(digits < ZJ_NUMBER_MAX_MANTISSA_DIGITS){
+						decimal.mantissa=decimal.mantissa*10+(*str_current-'0');
+						digits++;
+					}else{ // digits that don't fit only scales the value
+						decimal.truncated|=(*str_current != '0');
+						exponent++;
+					}
+				}
+			}
+
+			if(str_current < str_end && *str_current == '.'){
+				decimal.is_integer=false;
+				str_current++;
+				if(str_current == str_end || !is_digit(*str_current)){
+					return false;
+				}
+
+				for(; str_current < str_end && is_digit(*str_current); str_current++){
+					if(digits < ZJ_NUMBER_MAX_MANTISSA_DIGITS){
+						if(decimal.mantissa != 0 || *str_current != '0'){ // leading zeros are not significant
+							digits++;
+						}
+						decimal.mantissa=decimal.mantissa*10+(*str_current-'0');
+						exponent--;
+					}else{
+						decimal.truncated|=(*str_current != '0');
+					}
+				}
+			}
+
+			if(str_current < str_end && (*str_current == 'e' || *str_current == 'E')){
+				bool negative_exponent=false;
+				int explicit_exponent=0;
+
+				decimal.is_integer=false;
+				str_current++;
+				if(str_current < str_end && (*str_current == '+' || *str_current == '-')){
+					negative_exponent=*str_current == '-';
+					str_current++;
+				}
+
+				if(str_current == str_end || !is_digit(*str_current)){
+					return false;
+				}
+
+				for(; str_current < str_end && is_digit(*str_current); str_current++){
+					if(explicit_exponent < 100000){ // out of any range anyway
+						explicit_exponent=explicit_exponent*10+(*str_current-'0');
+					}
+				}
+
+				exponent+=negative_exponent?-explicit_exponent:explicit_exponent;
+			}
+
+			decimal.exponent=exponent;
+
+			return str_current == str_end;
+		}
+
+		// C locale is used in the fallback, so the decimal separator is always '.'
+#if defined(_WIN32)
+		_locale_t get_c_locale(){
+			static _locale_t c_locale=_create_locale(LC_NUMERIC,"C");
+			return c_locale;
+		}
+		#define ZJ_STRTOD(str,end) _strtod_l(str,end,get_c_locale())
+		#define ZJ_STRTOF(str,end) _strtof_l(str,end,get_c_locale())
+#else
+		locale_t get_c_locale(){
+			static locale_t c_locale=newlocale(LC_NUMERIC_MASK,"C",(locale_t)0);
+			return c_locale;
+		}
+		#define ZJ_STRTOD(str,end) strtod_l(str,end,get_c_locale())
+		#define ZJ_STRTOF(str,end) strtof_l(str,end,get_c_locale())
+#endif
+
+		// str was already checked by read_decimal, so strtod doesn't see any of the forms it
+		// accepts but json doesn't (i.e +1, .5, 0x10, nan, inf)
+		template<typename _T_VALUE>
+		bool parse_fallback(const char *str, size_t str_len, _T_VALUE *value){
+			char buffer[128];
+			std::string str_aux;
+			const char *str_number=buffer;
+			char *end=NULL;
+			_T_VALUE result;
+
+			// strtod needs a NUL terminated string
+			if(str_len < sizeof(buffer)){
+				memcpy(buffer,str,str_len);
+				buffer[str_len]=0;
+			}else{
+				str_aux.assign(str,str_len);
+				str_number=str_aux.c_str();
+			}
+
+			errno=0;
+			if(sizeof(_T_VALUE) == sizeof(float)){
+				result=(_T_VALUE)ZJ_STRTOF(str_number,&end);
+			}else{
+				result=(_T_VALUE)ZJ_STRTOD(str_number,&end);
+			}
+
+			if(end != str_number+str_len){
+				return false;
+			}
+
+			// overflow
+			if((errno == ERANGE && isinf(result)) || !isfinite(result)){
+				return false;
+			}
+
+			*value=result;
+			return true;
+		}
+
+		// Clinger's fast path: double represents exactly integers up to 2^53 and powers of 10
+		// up to 10^22, so one single operation gives the correctly rounded result
+		bool parse_fast_path(const DecimalNumber & decimal, double *value){
+#ifndef ZJ_NUMBER_DISABLE_FAST_PATH
+			if(!decimal.truncated
+				&& decimal.mantissa <= ((uint64_t)1 << 53)
+				&& decimal.exponent >= -22 && decimal.exponent <= 22
+			){
+				double result=(double)decimal.mantissa;
+				if(decimal.exponent < 0){
+					result/=POW10_DOUBLE[-decimal.exponent];
+				}else{
+					result*=POW10_DOUBLE[decimal.exponent];
+				}
+				*value=decimal.negative?-result:result;
+				return true;
+			}
+#endif
+			return false;
+		}
+
+		bool parse(const char *str, size_t str_len, float *value){
+			DecimalNumber decimal;
+			double result;
+
+			if(!read_decimal(str,str+str_len,decimal)){
+				return false;
+			}
+
+			// The correctly rounded double rounds to the correct float unless it falls just
+			// in the middle of two floats (or it is out of the normal range of float)
+			if(parse_fast_path(decimal,&result)){
+				uint64_t bits;
+				memcpy(&bits,&result,sizeof(bits));
+				if((fabs(result) >= FLT_MIN && fabs(result) <= FLT_MAX && (bits & 0x1FFFFFFF) != 0x10000000) || result == 0){
+					*value=(float)result;
+					return true;
+				}
+			}
+
+			return parse_fallback(str,str_len,value);
+		}
+
+		bool parse(const char *str, size_t str_len, double *value){
+			DecimalNumber decimal;
+
+			if(!read_decimal(str,str+str_len,decimal)){
+				return false;
+			}
+
+			if(parse_fast_path(decimal,value)){
+				return true;
+			}
+
+			return parse_fallback(str,str_len,value);
+		}
+
+		bool parse(const char *str, size_t str_len, int64_t *value){
+			const char *str_current=str;
+			const char *str_end=str+str_len;
+			bool negative=false;
+			uint64_t result=0;
+			uint64_t limit=INT64_MAX;
+
+			if(str_current < str_end && *str_current == '-'){
+				negative=true;
+				limit=(uint64_t)INT64_MAX+1;
+				str_current++;
+			}
+
+			if(str_current == str_end){
+				return false;
+			}
+
+			// no leading zeros, as in json
+			if(*str_current == '0' && str_current+1 < str_end && is_digit(str_current[1])){
+				return false;
+			}
+
+			for(; str_current < str_end && is_digit(*str_current); str_current++){
+				unsigned digit=*str_current-'0';
+				if(result > (limit-digit)/10){ // overflow
+					return false;
+				}
+				result=result*10+digit;
+			}
+
+			if(str_current != str_end){
+				// also accepts integral values written with fraction or exponent (i.e 1.0, 1e3)
+				double double_value;
+				if(!parse(str,str_len,&double_value)
+					|| double_value != floor(double_value)
+					|| double_value < -9223372036854775808.0
+					|| double_value >= 9223372036854775808.0
+				){
+					return false;
+				}
+				*value=(int64_t)double_value;
+				return true;
+			}
+
+			*value=negative?(int64_t)(0-result):(int64_t)result;
+			return true;
+		}
+
+		//-------------------------------------------------------------------------------------
+		// FORMAT
+
+		// Floating point number f * 2^e
+		typedef struct{
+			uint64_t f;
+			int e;
+		}DiyFp;
+
+		inline DiyFp diy_fp(uint64_t f, int e){
+			DiyFp x={f,e};
+			return x;
+		}
+
+		inline DiyFp diy_fp_sub(const DiyFp & x, const DiyFp & y){
+			return diy_fp(x.f-y.f,x.e);
+		}
+
+		// upper 64 bits of the 128 bits product, rounded
+		inline DiyFp diy_fp_mul(const DiyFp & x, const DiyFp & y){
+			const uint64_t u_lo=x.f & 0xFFFFFFFFu;
+			const uint64_t u_hi=x.f >> 32;
+			const uint64_t v_lo=y.f & 0xFFFFFFFFu;
+			const uint64_t v_hi=y.f >> 32;
+
+			const uint64_t p0=u_lo*v_lo;
+			const uint64_t p1=u_lo*v_hi;
+			const uint64_t p2=u_hi*v_lo;
+			const uint64_t p3=u_hi*v_hi;
+
+			uint64_t q=(p0 >> 32)+(p1 & 0xFFFFFFFFu)+(p2 & 0xFFFFFFFFu);
+			q+=(uint64_t)1 << 31;
+
+			return diy_fp(p3+(p2 >> 32)+(p1 >> 32)+(q >> 32),x.e+y.e+64);
+		}
+
+		inline DiyFp diy_fp_normalize(DiyFp x){
+			while((x.f >> 63) == 0){
+				x.f<<=1;
+				x.e--;
+			}
+			return x;
+		}
+
+		inline DiyFp diy_fp_normalize_to(const DiyFp & x, int e){
+			return diy_fp(x.f << (x.e-e),e);
+		}
+
+		typedef struct{
+			DiyFp w;
+			DiyFp minus;
+			DiyFp plus;
+		}Boundaries;
+
+		// Value and the boundaries of the rounding interval of a positive finite value
+		template<typename _T_VALUE, typename _T_BITS>
+		Boundaries compute_boundaries(_T_VALUE value){
+			const int precision=std::numeric_limits<_T_VALUE>::digits; // including hidden bit
+			const int bias=std::numeric_limits<_T_VALUE>::max_exponent-1+(precision-1);
+			const int min_exponent=1-bias;
+			const uint64_t hidden_bit=(uint64_t)1 << (precision-1);
+			_T_BITS bits;
+			memcpy(&bits,&value,sizeof(bits));
+
+			const uint64_t e=(uint64_t)bits >> (precision-1);
+			const uint64_t f=(uint64_t)bits & (hidden_bit-1);
+
+			DiyFp v=e==0?diy_fp(f,min_exponent):diy_fp(f+hidden_bit,(int)e-bias);
+
+			// lower boundary is closer when the value is a power of 2 (but not the min normal)
+			bool lower_boundary_is_closer=f == 0 && e > 1;
+			DiyFp m_plus=diy_fp(2*v.f+1,v.e-1);
+			DiyFp m_minus=lower_boundary_is_closer?diy_fp(4*v.f-1,v.e-2):diy_fp(2*v.f-1,v.e-1);
+
+			Boundaries boundaries;
+			boundaries.plus=diy_fp_normalize(m_plus);
+			boundaries.minus=diy_fp_normalize_to(m_minus,boundaries.plus.e);
+			boundaries.w=diy_fp_normalize(v);
+			return boundaries;
+		}
+
+		// products with the cached power are kept with binary exponent in [ALPHA,GAMMA]
+		#define ZJ_NUMBER_ALPHA -60
+		#define ZJ_NUMBER_GAMMA -32
+
+		typedef struct{
+			uint64_t f;
+			int e;
+			int k; // decimal exponent
+		}CachedPower;
+
+		#define ZJ_NUMBER_CACHED_POWERS_MIN_DEC_EXP -348
+		#define ZJ_NUMBER_CACHED_POWERS_DEC_STEP 8
+
+		// normalized 10^k for k=-348,-340,...,340
+		const CachedPower CACHED_POWERS[]={
+			 {0xFA8FD5A0081C0288,-1220, -348}
+			,{0xBAAEE17FA23EBF76,-1193, -340}
+			,{0x8B16FB203055AC76,-1166, -332}
+			,{0xCF42894A5DCE35EA,-1140, -324}
+			,{0x9A6BB0AA55653B2D,-1113, -316}
+			,{0xE61ACF033D1A45DF,-1087, -308}
+			,{0xAB70FE17C79AC6CA,-1060, -300}
+			,{0xFF77B1FCBEBCDC4F,-1034, -292}
+			,{0xBE5691EF416BD60C,-1007, -284}
+			,{0x8DD01FAD907FFC3C, -980, -276}
+			,{0xD3515C2831559A83, -954, -268}
+			,{0x9D71AC8FADA6C9B5, -927, -260}
+			,{0xEA9C227723EE8BCB, -901, -252}
+			,{0xAECC49914078536D, -874, -244}
+			,{0x823C12795DB6CE57, -847, -236}
+			,{0xC21094364DFB5637, -821, -228}
+			,{0x9096EA6F3848984F, -794, -220}
+			,{0xD77485CB25823AC7, -768, -212}
+			,{0xA086CFCD97BF97F4, -741, -204}
+			,{0xEF340A98172AACE5, -715, -196}
+			,{0xB23867FB2A35B28E, -688, -188}
+			,{0x84C8D4DFD2C63F3B, -661, -180}
+			,{0xC5DD44271AD3CDBA, -635, -172}
+			,{0x936B9FCEBB25C996, -608, -164}
+			,{0xDBAC6C247D62A584, -582, -156}
+			,{0xA3AB66580D5FDAF6, -555, -148}
+			,{0xF3E2F893DEC3F126, -529, -140}
+			,{0xB5B5ADA8AAFF80B8, -502, -132}
+			,{0x87625F056C7C4A8B, -475, -124}
+			,{0xC9BCFF6034C13053, -449, -116}
+			,{0x964E858C91BA2655, -422, -108}
+			,{0xDFF9772470297EBD, -396, -100}
+			,{0xA6DFBD9FB8E5B88F, -369,  -92}
+			,{0xF8A95FCF88747D94, -343,  -84}
+			,{0xB94470938FA89BCF, -316,  -76}
+			,{0x8A08F0F8BF0F156B, -289,  -68}
+			,{0xCDB02555653131B6, -263,  -60}
+			,{0x993FE2C6D07B7FAC, -236,  -52}
+			,{0xE45C10C42A2B3B06, -210,  -44}
+			,{0xAA242499697392D3, -183,  -36}
+			,{0xFD87B5F28300CA0E, -157,  -28}
+			,{0xBCE5086492111AEB, -130,  -20}
+			,{0x8CBCCC096F5088CC, -103,  -12}
+			,{0xD1B71758E219652C,  -77,   -4}
+			,{0x9C40000000000000,  -50,    4}
+			,{0xE8D4A51000000000,  -24,   12}
+			,{0xAD78EBC5AC620000,    3,   20}
+			,{0x813F3978F8940984,   30,   28}
+			,{0xC097CE7BC90715B3,   56,   36}
+			,{0x8F7E32CE7BEA5C70,   83,   44}
+			,{0xD5D238A4ABE98068,  109,   52}
+			,{0x9F4F2726179A2245,  136,   60}
+			,{0xED63A231D4C4FB27,  162,   68}
+			,{0xB0DE65388CC8ADA8,  189,   76}
+			,{0x83C7088E1AAB65DB,  216,   84}
+			,{0xC45D1DF942711D9A,  242,   92}
+			,{0x924D692CA61BE758,  269,  100}
+			,{0xDA01EE641A708DEA,  295,  108}
+			,{0xA26DA3999AEF774A,  322,  116}
+			,{0xF209787BB47D6B85,  348,  124}
+			,{0xB454E4A179DD1877,  375,  132}
+			,{0x865B86925B9BC5C2,  402,  140}
+			,{0xC83553C5C8965D3D,  428,  148}
+			,{0x952AB45CFA97A0B3,  455,  156}
+			,{0xDE469FBD99A05FE3,  481,  164}
+			,{0xA59BC234DB398C25,  508,  172}
+			,{0xF6C69A72A3989F5C,  534,  180}
+			,{0xB7DCBF5354E9BECE,  561,  188}
+			,{0x88FCF317F22241E2,  588,  196}
+			,{0xCC20CE9BD35C78A5,  614,  204}
+			,{0x98165AF37B2153DF,  641,  212}
+			,{0xE2A0B5DC971F303A,  667,  220}
+			,{0xA8D9D1535CE3B396,  694,  228}
+			,{0xFB9B7CD9A4A7443C,  720,  236}
+			,{0xBB764C4CA7A44410,  747,  244}
+			,{0x8BAB8EEFB6409C1A,  774,  252}
+			,{0xD01FEF10A657842C,  800,  260}
+			,{0x9B10A4E5E9913129,  827,  268}
+			,{0xE7109BFBA19C0C9D,  853,  276}
+			,{0xAC2820D9623BF429,  880,  284}
+			,{0x80444B5E7AA7CF85,  907,  292}
+			,{0xBF21E44003ACDD2D,  933,  300}
+			,{0x8E679C2F5E44FF8F,  960,  308}
+			,{0xD433179D9C8CB841,  986,  316}
+			,{0x9E19DB92B4E31BA9, 1013,  324}
+			,{0xEB96BF6EBADF77D9, 1039,  332}
+			,{0xAF87023B9BF0EE6B, 1066,  340}
+		};
+
+		// Returns c = 10^k such that ALPHA <= e_c + e + 64 <= GAMMA
+		inline const CachedPower & get_cached_power(int e){
+			const int f=ZJ_NUMBER_ALPHA-e-1;
+			// ceil(f * log10(2))
+			const int k=(f*78913)/(1 << 18)+(f > 0?1:0);
+			const int index=(k-ZJ_NUMBER_CACHED_POWERS_MIN_DEC_EXP+(ZJ_NUMBER_CACHED_POWERS_DEC_STEP-1))/ZJ_NUMBER_CACHED_POWERS_DEC_STEP;
+			return CACHED_POWERS[index];
+		}
+
+		// Returns the number of digits of n and in pow10 the largest power of 10 <= n
+		inline int find_largest_pow10(uint32_t n, uint32_t & pow10){
+			static const uint32_t POW10[]={
+				1,10,100,1000,10000,100000,1000000,10000000,100000000,1000000000
+			};
+
+			int k=9;
+			while(k > 0 && n < POW10[k]){
+				k--;
+			}
+			pow10=POW10[k];
+			return k+1;
+		}
+
+		// Moves the last digit towards w while the number stays inside the interval
+		inline void grisu2_round(char *buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k){
+			while(rest < dist
+				&& delta-rest >= ten_k
+				&& (rest+ten_k < dist || dist-rest > rest+ten_k-dist)
+			){
+				buffer[length-1]--;
+				rest+=ten_k;
+			}
+		}
+
+		// Generates the shortest digits of w inside (m_minus,m_plus)
+		void grisu2_digit_gen(char *buffer, int & length, int & decimal_exponent, DiyFp m_minus, DiyFp w, DiyFp m_plus){
+			uint64_t delta=diy_fp_sub(m_plus,m_minus).f;
+			uint64_t dist=diy_fp_sub(m_plus,w).f;
+
+			// split m_plus in integral (p1) and fractional (p2) parts
+			const DiyFp one=diy_fp((uint64_t)1 << -m_plus.e,m_plus.e);
+			uint32_t p1=(uint32_t)(m_plus.f >> -one.e);
+			uint64_t p2=m_plus.f & (one.f-1);
+
+			uint32_t pow10;
+			int n=find_largest_pow10(p1,pow10);
+
+			while(n > 0){
+				buffer[length++]=(char)('0'+p1/pow10);
+				p1%=pow10;
+				n--;
+
+				const uint64_t rest=((uint64_t)p1 << -one.e)+p2;
+				if(rest <= delta){
+					decimal_exponent+=n;
+					grisu2_round(buffer,length,dist,delta,rest,(uint64_t)pow10 << -one.e);
+					return;
+				}
+
+				pow10/=10;
+			}
+
+			int m=0;
+			for(;;){
+				p2*=10;
+				buffer[length++]=(char)('0'+(p2 >> -one.e));
+				p2&=one.f-1;
+				m++;
+
+				delta*=10;
+				dist*=10;
+				if(p2 <= delta){
+					break;
+				}
+			}
+
+			decimal_exponent-=m;
+			grisu2_round(buffer,length,dist,delta,p2,one.f);
+		}
+
+		// value = digits * 10^decimal_exponent
+		template<typename _T_VALUE, typename _T_BITS>
+		void grisu2(char *buffer, int & length, int & decimal_exponent, _T_VALUE value){
+			const Boundaries boundaries=compute_boundaries<_T_VALUE,_T_BITS>(value);
+			const CachedPower & cached=get_cached_power(boundaries.plus.e);
+			const DiyFp c_minus_k=diy_fp(cached.f,cached.e);
+
+			const DiyFp w=diy_fp_mul(boundaries.w,c_minus_k);
+			const DiyFp w_minus=diy_fp_mul(boundaries.minus,c_minus_k);
+			const DiyFp w_plus=diy_fp_mul(boundaries.plus,c_minus_k);
+
+			// products are not exact, so the interval is narrowed 1 ulp at each side
+			length=0;
+			decimal_exponent=-cached.k;
+			grisu2_digit_gen(buffer,length,decimal_exponent,diy_fp(w_minus.f+1,w_minus.e),w,diy_fp(w_plus.f-1,w_plus.e));
+		}
+
+		inline char *append_exponent(char *buffer, int e){
+			if(e < 0){
+				e=-e;
+				*buffer++='-';
+			}else{
+				*buffer++='+';
+			}
+
+			if(e >= 100){
+				*buffer++=(char)('0'+e/100);
+				e%=100;
+				*buffer++=(char)('0'+e/10);
+			}else{ // at least two digits as printf("%g") does
+				*buffer++=(char)('0'+e/10);
+			}
+			*buffer++=(char)('0'+e%10);
+
+			return buffer;
+		}
+
+		// Writes digits*10^decimal_exponent in fixed notation if the exponent is in
+		// (min_exponent,max_exponent], scientific notation otherwise
+		char *format_buffer(char *buffer, int length, int decimal_exponent, int min_exponent, int max_exponent){
+			const int k=length;
+			const int n=length+decimal_exponent; // position of the decimal point
+
+			if(k <= n && n <= max_exponent){ // digits[000].0
+				memset(buffer+k,'0',n-k);
+				buffer[n]='.';
+				buffer[n+1]='0';
+				return buffer+n+2;
+			}
+
+			if(0 < n && n <= max_exponent){ // dig.its
+				memmove(buffer+n+1,buffer+n,k-n);
+				buffer[n]='.';
+				return buffer+k+1;
+			}
+
+			if(min_exponent < n && n <= 0){ // 0.[000]digits
+				memmove(buffer+2-n,buffer,k);
+				buffer[0]='0';
+				buffer[1]='.';
+				memset(buffer+2,'0',-n);
+				return buffer+2-n+k;
+			}
+
+			if(k == 1){ // dE+123
+				buffer++;
+			}else{ // d.igitsE+123
+				memmove(buffer+2,buffer+1,k-1);
+				buffer[1]='.';
+				buffer+=k+1;
+			}
+
+			*buffer++='e';
+			return append_exponent(buffer,n-1);
+		}
+
+		template<typename _T_VALUE, typename _T_BITS>
+		char *floating_to_chars(char *buffer, _T_VALUE value){
+			if(!isfinite(value)){ // json has no nan or inf
+				memcpy(buffer,"null",4);
+				return buffer+4;
+			}
+
+			if(signbit(value)){
+				value=-value;
+				*buffer++='-';
+			}
+
+			if(value == 0){
+				memcpy(buffer,"0.0",3);
+				return buffer+3;
+			}
+
+			int length=0;
+			int decimal_exponent=0;
+			grisu2<_T_VALUE,_T_BITS>(buffer,length,decimal_exponent,value);
+
+			return format_buffer(buffer,length,decimal_exponent,-4,std::numeric_limits<_T_VALUE>::digits10);
+		}
+
+		char *to_chars(char *buffer, float value){
+			return floating_to_chars<float,uint32_t>(buffer,value);
+		}
+
+		char *to_chars(char *buffer, double value){
+			return floating_to_chars<double,uint64_t>(buffer,value);
+		}
+
+		char *to_chars(char *buffer, int64_t value){
+			char digits[20];
+			int n=0;
+			uint64_t abs_value=(uint64_t)value;
+
+			if(value < 0){
+				*buffer++='-';
+				abs_value=0-abs_value;
+			}
+
+			do{
+				digits[n++]=(char)('0'+abs_value%10);
+				abs_value/=10;
+			}while(abs_value != 0);
+
+			while(n > 0){
+				*buffer++=digits[--n];
+			}
+
+			return buffer;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#pragma once
+
+// max chars written by to_chars (sign, 17 digits, point and exponent)
+#define ZJ_NUMBER_MAX_CHARS 32
+
+namespace zetjsoncpp
+{
+	namespace zj_number{
+
+		// Parses the number in [str,str+str_len) regardless the current locale. The whole
+		// range must be a json number (no +, leading zeros, hex, nan or inf) that is finite in
+		// the type, otherwise it returns false and value is not modified.
+		// Values that fits in a float/double exactly are converted in place, the rest are
+		// converted through the C library to get the correctly rounded result.
+		bool parse(const char *str, size_t str_len, float *value);
+		bool parse(const char *str, size_t str_len, double *value);
+		bool parse(const char *str, size_t str_len, int64_t *value);
+
+		// Writes a representation that parses back to the same value (round-trips) and
+		// returns a pointer past the last written char (the buffer is not NUL terminated).
+		// Floats and doubles are written with Grisu2, that is not always the shortest: a
+		// few values get one digit more than needed.
+		// Nan and inf have no json representation and are written as null.
+		// buffer must have ZJ_NUMBER_MAX_CHARS at least.
+		char *to_chars(char *buffer, float value);
+		char *to_chars(char *buffer, double value);
+		char *to_chars(char *buffer, int64_t value);
+	}
+}
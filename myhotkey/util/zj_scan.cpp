@@ -0,0 +1,559 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "../zetjsoncpp.h"
+
+#if !defined(ZJ_SCAN_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ZJ_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__GNUC__)
+#define ZJ_SCAN_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(ZJ_SCAN_AVX2) && defined(__GNUC__)
+#define ZJ_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ZJ_SCAN_TARGET_AVX2
+#endif
+
+#define B CHAR_CLASS_BLANK
+#define N CHAR_CLASS_NEW_LINE
+#define Q CHAR_CLASS_QUOTE
+#define S CHAR_CLASS_BACKSLASH
+#define O CHAR_CLASS_OPEN
+#define C CHAR_CLASS_CLOSE
+#define A CHAR_CLASS_COMMA
+#define L CHAR_CLASS_COLON
+#define M CHAR_CLASS_COMMENT
+#define E CHAR_CLASS_END_COMMENT
+#define U CHAR_CLASS_NOT_ASCII
+#define X CHAR_CLASS_CONTROL
+
+namespace zetjsoncpp{
+
+	namespace zj_scan{
+
+		const uint16_t CHAR_CLASS_TABLE[256]={
+			X,X,X,X,X,X,X,X,X,B|X,N|X,X,X,N|X,X,X, // 0x00
+			X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X, // 0x10
+			B,0,Q,0,0,0,0,0,0,0,E,0,A,0,0,M, // 0x20
+			0,0,0,0,0,0,0,0,0,0,L,0,0,0,0,0, // 0x30
+			0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 0x40
+			0,0,0,0,0,0,0,0,0,0,0,O,S,C,0,0, // 0x50
+			0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 0x60
+			0,0,0,0,0,0,0,0,0,0,0,O,0,C,0,0, // 0x70
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0x80
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0x90
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0xa0
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0xb0
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0xc0
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0xd0
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U, // 0xe0
+			U,U,U,U,U,U,U,U,U,U,U,U,U,U,U,U  // 0xf0
+		};
+
+#undef B
+#undef N
+#undef Q
+#undef S
+#undef O
+#undef C
+#undef A
+#undef L
+#undef M
+#undef E
+#undef U
+#undef X
+
+		// chars of each class, in the same order as the CharClass bits
+		const char CLASS_CHARS[][3]={
+			 {' ','\t',0}
+			,{'\n','\r',0}
+			,{'\"',0,0}
+			,{'\\',0,0}
+			,{'{','[',0}
+			,{'}',']',0}
+			,{',',0,0}
+			,{':',0,0}
+			,{'/',0,0}
+			,{'*',0,0}
+			,{0,0,0} // not ascii and control chars are ranges, they're matched apart
+			,{0,0,0}
+		};
+
+		// Scans str until it finds a char that belongs to classes (negate=false) or a char
+		// that does not belong to classes (negate=true). NUL always stops the scan.
+		typedef const char *(*ScanFunction)(const char *str, uint16_t classes, bool negate);
+
+		inline int first_bit(uint32_t mask){
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index,mask);
+			return (int)index;
+#else
+			return __builtin_ctz(mask);
+#endif
+		}
+
+		inline int first_bit(uint64_t mask){
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index,mask);
+			return (int)index;
+#else
+			return __builtin_ctzll(mask);
+#endif
+		}
+
+		inline int get_class_chars(uint16_t classes, char *chars){
+			int n=0;
+			for(uint32_t bits=classes; bits != 0; bits&=bits-1){ // only the classes that are set
+				for(const char *c=CLASS_CHARS[first_bit(bits)]; *c!=0; c++){
+					chars[n++]=*c;
+				}
+			}
+			return n;
+		}
+
+		inline int count_bits(uint64_t mask){
+#if defined(_MSC_VER)
+			return (int)__popcnt64(mask);
+#else
+			return __builtin_popcountll(mask);
+#endif
+		}
+
+		// Fills the masks of the block of 64 chars that holds from. Bits before from may be
+		// anything, and no bit is set after the first NUL from from.
+		typedef void (*BlockMasksFunction)(const char *block, const char *from, BlockMasks & masks);
+
+		inline void end_block_masks(const char *block, const char *from, BlockMasks & masks){
+			masks.end&=~0ULL << (from-block); // NULs before from are not of this input
+			if(masks.end != 0){
+				uint64_t end=masks.end & (~masks.end+1);
+				uint64_t valid=(end<<1)-1;
+				masks.quote&=valid;
+				masks.backslash&=valid;
+				masks.open&=valid;
+				masks.close&=valid;
+				masks.comment&=valid;
+				masks.end_comment&=valid;
+				masks.new_line&=valid;
+				masks.carriage_return&=valid;
+				masks.end=end;
+			}
+		}
+
+		// reads from from to the NUL, so nothing outside the input is read
+		void block_masks_scalar(const char *block, const char *from, BlockMasks & masks){
+			memset(&masks,0,sizeof(masks));
+
+			for(const char *str=from; str < block+64; str++){
+				uint64_t bit=1ULL << (str-block);
+				switch(*str){
+				case 0: masks.end|=bit; return;
+				case '\"': masks.quote|=bit; break;
+				case '\\': masks.backslash|=bit; break;
+				case '{': case '[': masks.open|=bit; break;
+				case '}': case ']': masks.close|=bit; break;
+				case '/': masks.comment|=bit; break;
+				case '*': masks.end_comment|=bit; break;
+				case '\n': masks.new_line|=bit; break;
+				case '\r': masks.carriage_return|=bit; break;
+				default: break;
+				}
+			}
+		}
+
+		const char *scan_scalar(const char *str, uint16_t classes, bool negate){
+			while(*str != 0 && is_class(*str,classes) == negate){
+				str++;
+			}
+			return str;
+		}
+
+#ifdef ZJ_SCAN_SSE2
+		// bits of the chars of block that stop the scan
+		inline uint32_t scan_mask_sse2(__m128i block, uint16_t classes, const char *chars, int n, bool negate){
+			const __m128i zero=_mm_setzero_si128();
+			__m128i match=(classes & CHAR_CLASS_NOT_ASCII)?block:zero; // movemask takes the high bit
+
+			if(classes & CHAR_CLASS_CONTROL){ // <= 0x1f
+				match=_mm_or_si128(match,_mm_cmpeq_epi8(_mm_min_epu8(block,_mm_set1_epi8(0x1f)),block));
+			}
+			for(int i=0; i < n; i++){
+				match=_mm_or_si128(match,_mm_cmpeq_epi8(block,_mm_set1_epi8(chars[i])));
+			}
+
+			uint32_t mask=(uint32_t)_mm_movemask_epi8(match);
+			if(negate){
+				mask=~mask & 0xFFFF;
+			}
+			return mask | (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block,zero));
+		}
+
+		// Vectorized scans use aligned loads: a block never crosses a page boundary so
+		// reading up to the block that holds the NUL terminator is always safe. The chars
+		// before the first aligned block are copied to a block of their own, as the aligned
+		// block that holds str may start before the input.
+		const char *scan_sse2(const char *str, uint16_t classes, bool negate){
+			size_t head_len=(size_t)(-(uintptr_t)str & 15);
+			const char *block_str=str+head_len;
+			char chars[16];
+			int n=get_class_chars(classes,chars);
+
+			if(head_len != 0){ // the rest of the head block is NUL, that is masked out
+				alignas(16) char head[16]={0};
+				memcpy(head,str,head_len);
+				uint32_t mask=scan_mask_sse2(_mm_load_si128((const __m128i *)head),classes,chars,n,negate) & ((1u << head_len)-1);
+				if(mask != 0){
+					return str+first_bit(mask);
+				}
+			}
+
+			for(;;block_str+=16){
+				uint32_t mask=scan_mask_sse2(_mm_load_si128((const __m128i *)block_str),classes,chars,n,negate);
+				if(mask != 0){
+					return block_str+first_bit(mask);
+				}
+			}
+			return block_str;
+		}
+#endif
+
+#ifdef ZJ_SCAN_SSE2
+		inline uint64_t match_sse2(__m128i block, char c){
+			return (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block,_mm_set1_epi8(c)));
+		}
+
+		// block, or a copy of it from from if it may start before the input (chars before from are NUL)
+		inline const char *block_from(const char *block, const char *from, char *copy){
+			if(from == block){
+				return block;
+			}
+			memset(copy,0,from-block);
+			memcpy(copy+(from-block),from,64-(from-block));
+			return copy;
+		}
+
+		void block_masks_sse2(const char *block, const char *from, BlockMasks & masks){
+			const __m128i bracket_case=_mm_set1_epi8(0x20); // '[' | 0x20 is '{' and ']' | 0x20 is '}'
+			alignas(16) char copy[64];
+			const char *data=block_from(block,from,copy);
+
+			memset(&masks,0,sizeof(masks));
+			for(int i=0; i < 64; i+=16){
+				__m128i chunk=_mm_load_si128((const __m128i *)(data+i));
+				__m128i brackets=_mm_or_si128(chunk,bracket_case);
+
+				masks.quote|=match_sse2(chunk,'\"') << i;
+				masks.backslash|=match_sse2(chunk,'\\') << i;
+				masks.open|=match_sse2(brackets,'{') << i;
+				masks.close|=match_sse2(brackets,'}') << i;
+				masks.comment|=match_sse2(chunk,'/') << i;
+				masks.end_comment|=match_sse2(chunk,'*') << i;
+				masks.new_line|=match_sse2(chunk,'\n') << i;
+				masks.carriage_return|=match_sse2(chunk,'\r') << i;
+				masks.end|=match_sse2(chunk,0) << i;
+			}
+
+			end_block_masks(block,from,masks);
+		}
+#endif
+
+#ifdef ZJ_SCAN_AVX2
+		ZJ_SCAN_TARGET_AVX2 inline uint64_t match_avx2(__m256i block, char c){
+			return (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block,_mm256_set1_epi8(c)));
+		}
+
+		ZJ_SCAN_TARGET_AVX2 void block_masks_avx2(const char *block, const char *from, BlockMasks & masks){
+			const __m256i bracket_case=_mm256_set1_epi8(0x20);
+			alignas(32) char copy[64];
+			const char *data=block_from(block,from,copy);
+
+			memset(&masks,0,sizeof(masks));
+			for(int i=0; i < 64; i+=32){
+				__m256i chunk=_mm256_load_si256((const __m256i *)(data+i));
+				__m256i brackets=_mm256_or_si256(chunk,bracket_case);
+
+				masks.quote|=match_avx2(chunk,'\"') << i;
+				masks.backslash|=match_avx2(chunk,'\\') << i;
+				masks.open|=match_avx2(brackets,'{') << i;
+				masks.close|=match_avx2(brackets,'}') << i;
+				masks.comment|=match_avx2(chunk,'/') << i;
+				masks.end_comment|=match_avx2(chunk,'*') << i;
+				masks.new_line|=match_avx2(chunk,'\n') << i;
+				masks.carriage_return|=match_avx2(chunk,'\r') << i;
+				masks.end|=match_avx2(chunk,0) << i;
+			}
+
+			end_block_masks(block,from,masks);
+		}
+
+		ZJ_SCAN_TARGET_AVX2 inline uint32_t scan_mask_avx2(__m256i block, uint16_t classes, const char *chars, int n, bool negate){
+			const __m256i zero=_mm256_setzero_si256();
+			__m256i match=(classes & CHAR_CLASS_NOT_ASCII)?block:zero;
+
+			if(classes & CHAR_CLASS_CONTROL){
+				match=_mm256_or_si256(match,_mm256_cmpeq_epi8(_mm256_min_epu8(block,_mm256_set1_epi8(0x1f)),block));
+			}
+			for(int i=0; i < n; i++){
+				match=_mm256_or_si256(match,_mm256_cmpeq_epi8(block,_mm256_set1_epi8(chars[i])));
+			}
+
+			uint32_t mask=(uint32_t)_mm256_movemask_epi8(match);
+			if(negate){
+				mask=~mask;
+			}
+			return mask | (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block,zero));
+		}
+
+		// as scan_sse2, in blocks of 32 chars
+		ZJ_SCAN_TARGET_AVX2 const char *scan_avx2(const char *str, uint16_t classes, bool negate){
+			size_t head_len=(size_t)(-(uintptr_t)str & 31);
+			const char *block_str=str+head_len;
+			char chars[16];
+			int n=get_class_chars(classes,chars);
+
+			if(head_len != 0){
+				alignas(32) char head[32]={0};
+				memcpy(head,str,head_len);
+				uint32_t mask=scan_mask_avx2(_mm256_load_si256((const __m256i *)head),classes,chars,n,negate) & ((1u << head_len)-1);
+				if(mask != 0){
+					return str+first_bit(mask);
+				}
+			}
+
+			for(;;block_str+=32){
+				uint32_t mask=scan_mask_avx2(_mm256_load_si256((const __m256i *)block_str),classes,chars,n,negate);
+				if(mask != 0){
+					return block_str+first_bit(mask);
+				}
+			}
+			return block_str;
+		}
+
+		bool cpu_has_avx2(){
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info,0);
+			if(info[0] < 7){
+				return false;
+			}
+
+			__cpuid(info,1);
+			// AVX and OSXSAVE, and the OS saves the YMM registers
+			if((info[2] & (0x1<<27)) == 0 || (info[2] & (0x1<<28)) == 0 || (_xgetbv(0) & 0x6) != 0x6){
+				return false;
+			}
+
+			__cpuidex(info,7,0);
+			return (info[1] & (0x1<<5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}
+#endif
+
+		struct ScanImplementation{
+			const char *name;
+			ScanFunction function;
+			BlockMasksFunction block_masks;
+		};
+
+		ScanImplementation select_implementation(){
+			// ZETJSONCPP_SCAN environment variable forces a lower implementation (i.e for benchmarks)
+			const char *forced=getenv("ZETJSONCPP_SCAN");
+			std::string forced_name=forced!=NULL?forced:"";
+
+#ifdef ZJ_SCAN_AVX2
+			if((forced_name == "" || forced_name == "avx2") && cpu_has_avx2()){
+				return {"avx2",scan_avx2,block_masks_avx2};
+			}
+#endif
+
+#ifdef ZJ_SCAN_SSE2
+			if(forced_name != "scalar"){
+				return {"sse2",scan_sse2,block_masks_sse2};
+			}
+#endif
+			return {"scalar",scan_scalar,block_masks_scalar};
+		}
+
+		const ScanImplementation & get_implementation(){
+			static ScanImplementation implementation=select_implementation();
+			return implementation;
+		}
+
+		const char *find_class(const char *str, uint16_t classes){
+			return get_implementation().function(str,classes,false);
+		}
+
+		const char *skip_class(const char *str, uint16_t classes){
+			return get_implementation().function(str,classes,true);
+		}
+
+		//------------------------------------------------------------------------------------------------
+		// BracketScanner
+
+		BracketScanner::BracketScanner(const char *str){
+			__zj_block__=NULL;
+			__zj_current__=str;
+			__zj_state__=SCAN_CODE;
+			__zj_new_lines__=0;
+		}
+
+		const char *BracketScanner::stop(const char *str){
+			__zj_current__=str;
+			return NULL;
+		}
+
+		const char *BracketScanner::next(){
+			BlockMasksFunction block_masks=get_implementation().block_masks;
+
+			for(;;){
+				const char *block=(const char *)((uintptr_t)__zj_current__ & ~(uintptr_t)63);
+				if(block != __zj_block__){
+					block_masks(block,__zj_current__,__zj_masks__);
+					__zj_block__=block;
+				}
+
+				uint64_t pending=~0ULL << (__zj_current__-block);
+				uint64_t found=__zj_masks__.end;
+
+				switch(__zj_state__){
+				case SCAN_CODE:
+					found|=__zj_masks__.quote | __zj_masks__.open | __zj_masks__.close | __zj_masks__.comment;
+					break;
+				case SCAN_STRING:
+					found|=__zj_masks__.quote | __zj_masks__.backslash | __zj_masks__.new_line | __zj_masks__.carriage_return;
+					break;
+				case SCAN_LINE_COMMENT:
+					found|=__zj_masks__.new_line;
+					break;
+				case SCAN_BLOCK_COMMENT:
+					found|=__zj_masks__.end_comment;
+					break;
+				}
+
+				found&=pending;
+				if(found == 0){ // nothing in the rest of the block
+					__zj_new_lines__+=count_bits(__zj_masks__.new_line & pending);
+					__zj_current__=block+64;
+					continue;
+				}
+
+				int bit=first_bit(found);
+				const char *str=block+bit;
+
+				// new lines up to str, included
+				__zj_new_lines__+=count_bits(__zj_masks__.new_line & pending & ((2ULL << bit)-1));
+				__zj_current__=str+1;
+
+				if(*str == 0){
+					return stop(str);
+				}
+
+				switch(__zj_state__){
+				case SCAN_CODE:
+					switch(*str){
+					case '\"':
+						__zj_state__=SCAN_STRING;
+						break;
+					case '/':
+						if(str[1] == '/'){
+							__zj_state__=SCAN_LINE_COMMENT;
+						}else if(str[1] == '*'){
+							__zj_state__=SCAN_BLOCK_COMMENT;
+						}else{
+							return stop(str);
+						}
+						__zj_current__=str+2;
+						break;
+					default: // bracket
+						return str;
+					}
+					break;
+				case SCAN_STRING:
+					switch(*str){
+					case '\"':
+						__zj_state__=SCAN_CODE;
+						break;
+					case '\\': // the escaped char is skipped, unless it ends the string or the input
+						if(str[1] == 0 || str[1] == '\n' || str[1] == '\r'){
+							return stop(str+1);
+						}
+						__zj_current__=str+2;
+						break;
+					default: // new line
+						return stop(str);
+					}
+					break;
+				case SCAN_LINE_COMMENT:
+					__zj_state__=SCAN_CODE;
+					break;
+				case SCAN_BLOCK_COMMENT:
+					if(str[1] == '/'){
+						__zj_state__=SCAN_CODE;
+						__zj_current__=str+2;
+					}
+					break;
+				}
+			}
+		}
+
+		const char *BracketScanner::getStop() const{
+			return __zj_current__;
+		}
+
+		bool BracketScanner::isInString() const{
+			return __zj_state__ == SCAN_STRING;
+		}
+
+		int BracketScanner::getNewLines() const{
+			return __zj_new_lines__;
+		}
+
+		const char *skip_container(const char *str, int & line){
+			BracketScanner scanner(str);
+			uint64_t objects=0; // bit of each open container, 1 if it's an object
+			int depth=0;
+
+			for(const char *bracket=scanner.next(); bracket != NULL; bracket=scanner.next()){
+				bool is_object=*bracket == '{' || *bracket == '}';
+
+				if(*bracket == '{' || *bracket == '['){
+					if(depth == 64){
+						return NULL;
+					}
+					objects=(objects << 1) | (is_object?1:0);
+					depth++;
+				}else{
+					if(depth == 0 || (objects & 1) != (is_object?1u:0u)){
+						return NULL;
+					}
+					objects>>=1;
+					if(--depth == 0){
+						line+=scanner.getNewLines();
+						return bracket+1;
+					}
+				}
+			}
+
+			return NULL;
+		}
+
+		const char *get_implementation_name(){
+			return get_implementation().name;
+		}
+	}
+}
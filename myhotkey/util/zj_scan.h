@@ -0,0 +1,110 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#pragma once
+
+namespace zetjsoncpp
+{
+	namespace zj_scan{
+
+		// Character classes recognized by the structural scanner. The NUL terminator
+		// always stops any scan.
+		typedef enum:uint16_t{
+			CHAR_CLASS_NONE			=0,
+			CHAR_CLASS_BLANK		=0x1<<0, // ' ', '\t'
+			CHAR_CLASS_NEW_LINE		=0x1<<1, // '\n', '\r'
+			CHAR_CLASS_QUOTE		=0x1<<2, // '"'
+			CHAR_CLASS_BACKSLASH	=0x1<<3, // '\\'
+			CHAR_CLASS_OPEN			=0x1<<4, // '{', '['
+			CHAR_CLASS_CLOSE		=0x1<<5, // '}', ']'
+			CHAR_CLASS_COMMA		=0x1<<6, // ','
+			CHAR_CLASS_COLON		=0x1<<7, // ':'
+			CHAR_CLASS_COMMENT		=0x1<<8, // '/' (opens // or /* comments)
+			CHAR_CLASS_END_COMMENT	=0x1<<9, // '*' (closes /* comments)
+			CHAR_CLASS_NOT_ASCII	=0x1<<10, // 0x80-0xff (bytes of utf-8 sequences)
+			CHAR_CLASS_CONTROL		=0x1<<11, // 0x00-0x1f
+
+			CHAR_CLASS_STRUCTURAL	=CHAR_CLASS_OPEN|CHAR_CLASS_CLOSE|CHAR_CLASS_COMMA|CHAR_CLASS_COLON,
+			// chars that ends a primitive value (number, true, false)
+			CHAR_CLASS_END_VALUE	=CHAR_CLASS_BLANK|CHAR_CLASS_NEW_LINE|CHAR_CLASS_CLOSE|CHAR_CLASS_COMMA
+		}CharClass;
+
+		// class of each byte
+		extern const uint16_t CHAR_CLASS_TABLE[256];
+
+		inline bool is_class(char c, uint16_t classes){
+			return (CHAR_CLASS_TABLE[(uint8_t)c] & classes) != 0;
+		}
+
+		// Returns a pointer to the first char of str that belongs to any of 'classes' or
+		// to the NUL terminator.
+		const char *find_class(const char *str, uint16_t classes);
+
+		// Returns a pointer to the first char of str that does not belong to any of
+		// 'classes' or to the NUL terminator.
+		const char *skip_class(const char *str, uint16_t classes);
+
+		// Bits of the chars of a block of 64 chars that the bracket scanner follows
+		typedef struct{
+			uint64_t quote;
+			uint64_t backslash;
+			uint64_t open;
+			uint64_t close;
+			uint64_t comment; // '/'
+			uint64_t end_comment; // '*'
+			uint64_t new_line; // '\n'
+			uint64_t carriage_return;
+			uint64_t end; // NUL, no bit is set after it
+		}BlockMasks;
+
+		// Finds the brackets of the input that are outside strings and comments. The input is
+		// read in blocks of 64 chars (with SIMD if it's available) and only quotes, escapes,
+		// comments and new lines are followed, the rest (keys, values, commas...) is not checked.
+		class BracketScanner{
+		public:
+
+			// str is the first char to scan, that is not inside a string or comment
+			BracketScanner(const char *str);
+
+			// Returns the next '{', '[', '}' or ']', or NULL if the input ends, a string has a
+			// new line or a '/' doesn't start a comment (see getStop and isInString).
+			const char *next();
+
+			// char where next returned NULL
+			const char *getStop() const;
+
+			// if next stopped inside a string
+			bool isInString() const;
+
+			// '\n' passed over so far
+			int getNewLines() const;
+
+		private:
+
+			typedef enum{
+				SCAN_CODE=0,
+				SCAN_STRING,
+				SCAN_LINE_COMMENT,
+				SCAN_BLOCK_COMMENT
+			}ScanState;
+
+			const char *__zj_block__; // 64 chars aligned block of __zj_masks__
+			const char *__zj_current__; // next char to scan
+			BlockMasks __zj_masks__;
+			ScanState __zj_state__;
+			int __zj_new_lines__;
+
+			const char *stop(const char *str);
+		};
+
+		// Skips the object or vector that starts at str ('{' or '[') and returns the char after
+		// the bracket that closes it, adding to line the new lines it passed over. Only strings,
+		// comments and brackets are checked, so it returns NULL if they are not well formed or
+		// it's nested more than 64 levels, and line is not changed (the parser reports the error).
+		const char *skip_container(const char *str, int & line);
+
+		// Returns the name of the implementation selected at runtime ("avx2", "sse2" or "scalar")
+		const char *get_implementation_name();
+	}
+}
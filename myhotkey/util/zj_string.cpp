@@ -0,0 +1,343 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "../zetjsoncpp.h"
+
+namespace zetjsoncpp{
+
+	namespace zj_string{
+
+		// chars of find_escape checked one by one before the scan
+		const size_t ZJ_STRING_HEAD_LEN=16;
+
+		// outputs of decode_string
+		class StringOutput{
+		public:
+			StringOutput(std::string & _out):out(_out){}
+
+			inline void write(const char *str, size_t str_len){
+				out.append(str,str_len);
+			}
+
+			inline char *reserve(size_t str_len){
+				size_t size=out.size();
+				out.resize(size+str_len);
+				return &out[size];
+			}
+
+			inline void shrink(size_t str_len){
+				out.resize(out.size()-str_len);
+			}
+
+		private:
+			std::string & out;
+		};
+
+		class InSituOutput{
+		public:
+			InSituOutput(char *& _str_write):str_write(_str_write){}
+
+			inline void write(const char *str, size_t str_len){
+				if(str != str_write){ // nothing to move until the first escape
+					memmove(str_write,str,str_len);
+				}
+				str_write+=str_len;
+			}
+
+			inline char *reserve(size_t str_len){
+				char *str=str_write;
+				str_write+=str_len;
+				return str;
+			}
+
+			inline void shrink(size_t str_len){
+				str_write-=str_len;
+			}
+
+		private:
+			char *& str_write;
+		};
+
+		class NoOutput{
+		public:
+			inline void write(const char *, size_t){}
+
+			inline char *reserve(size_t){
+				return buffer;
+			}
+
+			inline void shrink(size_t){}
+
+		private:
+			char buffer[4];
+		};
+
+		inline int hex_digit(char c){
+			if(c >= '0' && c <= '9') return c-'0';
+			if(c >= 'a' && c <= 'f') return c-'a'+10;
+			if(c >= 'A' && c <= 'F') return c-'A'+10;
+			return -1;
+		}
+
+		// the 4 hexadecimal digits of \uXXXX at str, or -1
+		int read_unicode_escape(const char *str){
+			int code_point=0;
+
+			if(str[0] != '\\' || str[1] != 'u'){
+				return -1;
+			}
+
+			for(int i=2; i < 6; i++){
+				int digit=hex_digit(str[i]);
+				if(digit < 0){
+					return -1;
+				}
+				code_point=(code_point<<4) | digit;
+			}
+
+			return code_point;
+		}
+
+		// writes code_point as utf-8 in str and returns its length
+		size_t write_utf8(uint32_t code_point, char *str){
+			if(code_point < 0x80){
+				str[0]=(char)code_point;
+				return 1;
+			}
+
+			if(code_point < 0x800){
+				str[0]=(char)(0xc0 | (code_point>>6));
+				str[1]=(char)(0x80 | (code_point & 0x3f));
+				return 2;
+			}
+
+			if(code_point < 0x10000){
+				str[0]=(char)(0xe0 | (code_point>>12));
+				str[1]=(char)(0x80 | ((code_point>>6) & 0x3f));
+				str[2]=(char)(0x80 | (code_point & 0x3f));
+				return 3;
+			}
+
+			str[0]=(char)(0xf0 | (code_point>>18));
+			str[1]=(char)(0x80 | ((code_point>>12) & 0x3f));
+			str[2]=(char)(0x80 | ((code_point>>6) & 0x3f));
+			str[3]=(char)(0x80 | (code_point & 0x3f));
+			return 4;
+		}
+
+		// Decodes the escape at str ('\\') and advances str. The output is never longer than the
+		// escape, so it can be written in situ.
+		template<typename _T_OUTPUT>
+		bool decode_escape(const char *& str, _T_OUTPUT & output){
+			int code_point;
+			char c;
+
+			switch(str[1]){
+			case '\"': c='\"'; break;
+			case '\\': c='\\'; break;
+			case '/': c='/'; break;
+			case 'b': c='\b'; break;
+			case 'f': c='\f'; break;
+			case 'n': c='\n'; break;
+			case 'r': c='\r'; break;
+			case 't': c='\t'; break;
+			case 'u':
+				if((code_point=read_unicode_escape(str)) < 0){
+					return false;
+				}
+				if(code_point >= 0xdc00 && code_point <= 0xdfff){ // low surrogate without high one
+					return false;
+				}
+				if(code_point >= 0xd800 && code_point <= 0xdbff){ // high surrogate, the low one must follow
+					int low=read_unicode_escape(str+6);
+					if(low < 0xdc00 || low > 0xdfff){
+						return false;
+					}
+					code_point=0x10000+((code_point-0xd800)<<10)+(low-0xdc00);
+					str+=6;
+				}
+				str+=6;
+
+				{ // up to 4 bytes, and \uXXXX has 6 chars at least
+					char *str_utf8=output.reserve(4);
+					output.shrink(4-write_utf8((uint32_t)code_point,str_utf8));
+				}
+				return true;
+			default:
+				return false;
+			}
+
+			str+=2;
+			*output.reserve(1)=c;
+			return true;
+		}
+
+		size_t read_utf8(const char *str, const char *str_end, uint32_t *code_point){
+			const uint8_t *s=(const uint8_t *)str;
+			size_t len;
+			uint32_t value;
+			uint32_t min_value;
+
+			if(s[0] < 0x80){
+				len=1;
+				value=s[0];
+				min_value=0;
+			}else if((s[0] & 0xe0) == 0xc0){
+				len=2;
+				value=s[0] & 0x1f;
+				min_value=0x80;
+			}else if((s[0] & 0xf0) == 0xe0){
+				len=3;
+				value=s[0] & 0x0f;
+				min_value=0x800;
+			}else if((s[0] & 0xf8) == 0xf0){
+				len=4;
+				value=s[0] & 0x07;
+				min_value=0x10000;
+			}else{ // continuation byte or 0xf8-0xff
+				return 0;
+			}
+
+			if(str_end != NULL && (size_t)(str_end-str) < len){
+				return 0;
+			}
+
+			for(size_t i=1; i < len; i++){
+				if((s[i] & 0xc0) != 0x80){ // also stops at NUL
+					return 0;
+				}
+				value=(value<<6) | (s[i] & 0x3f);
+			}
+
+			if(value < min_value || value > 0x10ffff || (value >= 0xd800 && value <= 0xdfff)){
+				return 0;
+			}
+
+			if(code_point != NULL){
+				*code_point=value;
+			}
+
+			return len;
+		}
+
+		template<typename _T_OUTPUT>
+		StringError decode_string(const char *& str, _T_OUTPUT & output){
+			for(;;){
+				const char *str_run=str;
+
+				str=zj_scan::find_class(str,STRING_SPECIAL_CLASSES);
+				if(str != str_run){
+					output.write(str_run,str-str_run);
+				}
+
+				switch(*str){
+				case '\"':
+					return STRING_OK;
+				case '\\':
+					if(!decode_escape(str,output)){
+						return STRING_INVALID_ESCAPE;
+					}
+					break;
+				case 0:
+				case '\n':
+				case '\r':
+					return STRING_NOT_CLOSED;
+				default:
+					if((uint8_t)*str < 0x20){ // as tab, it must be escaped
+						return STRING_CONTROL_CHAR;
+					}
+
+					// not ascii, the whole run of utf-8 sequences is checked
+					str_run=str;
+					do{
+						size_t len=read_utf8(str,NULL,NULL);
+						if(len == 0){
+							output.write(str_run,str-str_run);
+							return STRING_INVALID_UTF8;
+						}
+						str+=len;
+					}while((uint8_t)*str >= 0x80);
+					output.write(str_run,str-str_run);
+					break;
+				}
+			}
+		}
+
+		StringError decode(const char *& str, std::string & out){
+			const uint16_t raw_classes=zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_BACKSLASH | zj_scan::CHAR_CLASS_NEW_LINE;
+			const char *str_end=zj_scan::find_class(str,raw_classes);
+			StringOutput output(out);
+
+			// the input is never shorter than its decoded content, so out grows only once
+			while(*str_end == '\\' && *(str_end+1) != 0){
+				str_end=zj_scan::find_class(str_end+2,raw_classes);
+			}
+			out.reserve(out.size()+(str_end-str));
+
+			return decode_string(str,output);
+		}
+
+		StringError decode_in_situ(char *& str, char *& str_write){
+			InSituOutput output(str_write);
+			const char *str_read=str;
+			StringError error=decode_string(str_read,output);
+
+			str=(char *)str_read;
+			return error;
+		}
+
+		StringError validate(const char *& str){
+			NoOutput output;
+			return decode_string(str,output);
+		}
+
+		const char *find_escape(const char *str, size_t str_len){
+			const char *str_end=str+str_len;
+
+			// the first chars are checked one by one, as the setup of the scan is not worth it
+			// for short strings or for escapes that are close to each other
+			const char *str_head_end=str_len < ZJ_STRING_HEAD_LEN?str_end:str+ZJ_STRING_HEAD_LEN;
+
+			for(; str < str_head_end; str++){
+				if((uint8_t)*str < 0x20 || *str == '\"' || *str == '\\'){
+					return str;
+				}
+			}
+
+			if(str == str_end){
+				return str_end;
+			}
+
+			// the scan stops at the NUL that ends the string, or at a NUL inside it that is a
+			// control char to escape as well
+			str=zj_scan::find_class(str,zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_BACKSLASH | zj_scan::CHAR_CLASS_CONTROL);
+			return str < str_end?str:str_end;
+		}
+
+		size_t escape(char c, char *buffer){
+			const char *hex="0123456789abcdef";
+
+			buffer[0]='\\';
+			switch(c){
+			case '\"': buffer[1]='\"'; return 2;
+			case '\\': buffer[1]='\\'; return 2;
+			case '\b': buffer[1]='b'; return 2;
+			case '\f': buffer[1]='f'; return 2;
+			case '\n': buffer[1]='n'; return 2;
+			case '\r': buffer[1]='r'; return 2;
+			case '\t': buffer[1]='t'; return 2;
+			default:
+				break;
+			}
+
+			buffer[1]='u';
+			buffer[2]='0';
+			buffer[3]='0';
+			buffer[4]=hex[((uint8_t)c)>>4];
+			buffer[5]=hex[((uint8_t)c) & 0xf];
+			return 6;
+		}
+	}
+}
@@ -0,0 +1,52 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#pragma once
+
+// max chars written by escape (\uXXXX)
+#define ZJ_STRING_MAX_ESCAPE_CHARS 6
+
+namespace zetjsoncpp
+{
+	namespace zj_string{
+
+		typedef enum:uint8_t{
+			STRING_OK=0,
+			STRING_NOT_CLOSED, // new line or end of input before the closing quote
+			STRING_INVALID_ESCAPE,
+			STRING_INVALID_UTF8,
+			STRING_CONTROL_CHAR // control char (< 0x20) that is not escaped
+		}StringError;
+
+		// chars where a run of the content of a string can't be copied as it is
+		const uint16_t STRING_SPECIAL_CLASSES=zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_BACKSLASH | zj_scan::CHAR_CLASS_NEW_LINE | zj_scan::CHAR_CLASS_NOT_ASCII | zj_scan::CHAR_CLASS_CONTROL;
+
+		// Decodes the content of the string that starts at str (the char after the opening
+		// quote) and appends it to out. Runs of chars without escapes are found with zj_scan
+		// and copied at once, escapes (\uXXXX and its surrogate pairs too) are decoded to
+		// utf-8, the bytes that are not ascii are validated as utf-8 and control chars must be
+		// escaped. str is left at the closing quote, or at the char of the error.
+		StringError decode(const char *& str, std::string & out);
+
+		// As decode, but the content is written over the input from str_write, that is not after
+		// str. The decoded content is never longer than the input.
+		StringError decode_in_situ(char *& str, char *& str_write);
+
+		// As decode without output, it finds the closing quote and checks the content
+		StringError validate(const char *& str);
+
+		// Returns the first char of [str,str+str_len) that must be escaped in a JSON string
+		// (quote, backslash and control chars), or str+str_len. str[str_len] must be '\0', as
+		// in std::string::c_str().
+		const char *find_escape(const char *str, size_t str_len);
+
+		// Writes the escape of c in buffer (ZJ_STRING_MAX_ESCAPE_CHARS at least) and returns
+		// the number of chars written.
+		size_t escape(char c, char *buffer);
+
+		// Length of the utf-8 sequence at str, or 0 if it's not valid (overlong, surrogate,
+		// beyond U+10FFFF or truncated). code_point is set if it's not NULL.
+		size_t read_utf8(const char *str, const char *str_end, uint32_t *code_point);
+	}
+}
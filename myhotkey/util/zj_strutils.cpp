@@ -71,10 +71,8 @@ namespace zetjsoncpp{
 
 		std::string float_to_str(float number){
 
-			char buff[100];
-			sprintf(buff, "%f",number);
-			std::string ss = buff;
-		   return ss;//return a string with the contents of the stream
+			char buff[ZJ_NUMBER_MAX_CHARS];
+			return std::string(buff,zj_number::to_chars(buff,number)-buff);
 		}
 
 		std::string to_lower(const std::string & str){
@@ -95,8 +93,32 @@ namespace zetjsoncpp{
 
 
 		std::wstring to_wstring_utf8(const std::string & str){
-			std::wstring_convert<std::codecvt_utf8<wchar_t>> str_utf8_to_wstring_conv;
-			return str_utf8_to_wstring_conv.from_bytes(str);
+			const char *str_current=str.c_str();
+			const char *str_end=str_current+str.size();
+			std::wstring result;
+
+			result.reserve(str.size());
+
+			while(str_current < str_end){
+				uint32_t code_point;
+				size_t len=zj_string::read_utf8(str_current,str_end,&code_point);
+
+				if(len == 0){ // as wstring_convert did
+					throw std::range_error(format("invalid utf-8 sequence at byte %i",(int)(str_current-str.c_str())));
+				}
+
+				if(sizeof(wchar_t) == 2 && code_point >= 0x10000){ // utf-16 surrogate pair
+					code_point-=0x10000;
+					result+=(wchar_t)(0xd800+(code_point>>10));
+					result+=(wchar_t)(0xdc00+(code_point & 0x3ff));
+				}else{
+					result+=(wchar_t)code_point;
+				}
+
+				str_current+=len;
+			}
+
+			return result;
 		}
 	}
 
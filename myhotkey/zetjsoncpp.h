@@ -12,11 +12,14 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <string.h>
 #include <vector>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <new>
 #include <locale>
-#include <codecvt>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <exception>
@@ -29,6 +32,11 @@
 #define ZETJSONCPP_MINOR_VERSION 0
 #define ZETJSONCPP_PATCH_VERSION 1
 
+#define ZJ_PUSH_DESERIALIZER_CHUNK_SIZE 65536
+
+// format of the snapshots of serialize_binary, snapshots of other version are stale
+#define ZJ_BINARY_VERSION 3
+
 #ifdef __MEMMANAGER__
 #include "memmgr.h"
 #endif
@@ -36,12 +44,19 @@
 #include "util/zj_strutils.h"
 #include "util/zj_file.h"
 #include "util/zj_path.h"
+#include "util/zj_scan.h"
+#include "util/zj_string.h"
+#include "util/zj_number.h"
 
 
 
 
 #include "exception.h"
+#include "zetjsoncpp_error.h"
 #include "jsonvar/JsonVar.h"
+#include "zetjsoncpp_sink.h"
+#include "zetjsoncpp_lazy.h"
+#include "zetjsoncpp_in_situ.h"
 
 
 // static zetjsoncpp
@@ -55,8 +70,120 @@ namespace zetjsoncpp {
 		template <typename _T>
 		_T * deserialize_file(const std::string & _filename);
 
+		// parses big vectors of objects with n_threads (0 uses all the cores)
+		template <typename _T>
+		_T * deserialize_parallel(const std::string & expression, unsigned n_threads=0);
+
+		template <typename _T>
+		_T * deserialize_file_parallel(const std::string & _filename, unsigned n_threads=0);
+
+		// as the functions above, but they don't throw on parse errors: they return NULL and
+		// set error, that tells the code, the offset and the line (the message is built on demand)
+		template <typename _T>
+		_T * deserialize(const std::string & expression, DeserializeError & error);
+
+		template <typename _T>
+		_T * deserialize_file(const std::string & _filename, DeserializeError & error);
+
+		template <typename _T>
+		_T * deserialize_parallel(const std::string & expression, unsigned n_threads, DeserializeError & error);
+
+		template <typename _T>
+		_T * deserialize_file_parallel(const std::string & _filename, unsigned n_threads, DeserializeError & error);
+
+		// as deserialize and deserialize_file, but the values of the keys that don't map to a
+		// property are jumped over by zj_scan::skip_container, that only checks their strings,
+		// comments and brackets: i.e a missing colon or comma inside them is not an error
+		template <typename _T>
+		_T * deserialize_skip_unmapped(const std::string & expression);
+
+		template <typename _T>
+		_T * deserialize_skip_unmapped(const std::string & expression, DeserializeError & error);
+
+		template <typename _T>
+		_T * deserialize_file_skip_unmapped(const std::string & _filename);
+
+		template <typename _T>
+		_T * deserialize_file_skip_unmapped(const std::string & _filename, DeserializeError & error);
+
+		// parses the input in chunks with bounded memory (see PushDeserializer). chunk_size
+		// can't be 0, and a read error of fp throws std::runtime_error.
+		template <typename _T>
+		_T * deserialize_stream(FILE *fp, const char *filename=NULL, size_t chunk_size=ZJ_PUSH_DESERIALIZER_CHUNK_SIZE);
+
+		template <typename _T>
+		_T * deserialize_file_stream(const std::string & _filename, size_t chunk_size=ZJ_PUSH_DESERIALIZER_CHUNK_SIZE);
+
+		// only builds the tape of the document, values are deserialized when they are asked (see JsonLazyDocument)
+		JsonLazyDocument * deserialize_lazy(const std::string & expression);
+
+		JsonLazyDocument * deserialize_file_lazy(const std::string & _filename);
+
+		JsonLazyDocument * deserialize_lazy(const std::string & expression, DeserializeError & error);
+
+		JsonLazyDocument * deserialize_file_lazy(const std::string & _filename, DeserializeError & error);
+
+		// Parses buffer, that must end with '\0', and modifies it: escapes of the strings of
+		// JsonVarStringViews are decoded in place and they end with '\0'. They point to buffer,
+		// so the caller keeps it while the result is used. Other types are deserialized as
+		// deserialize does (i.e JsonVarString is decoded in its own copy). If it fails, only the
+		// strings before the error and the string of the error (partly) may be modified, the
+		// rest of buffer is as it was (a string that is not closed ends at the new line or the
+		// end of buffer).
+		template <typename _T>
+		_T * deserialize_in_situ(char *buffer);
+
+		template <typename _T>
+		_T * deserialize_in_situ(char *buffer, DeserializeError & error);
+
+		// as deserialize_in_situ over a private writable mapping of the file (the file is not
+		// modified), that is kept by the returned document (see JsonInSituDocument)
+		template <typename _T>
+		JsonInSituDocument<_T> * deserialize_file_in_situ(const std::string & _filename);
+
+		template <typename _T>
+		JsonInSituDocument<_T> * deserialize_file_in_situ(const std::string & _filename, DeserializeError & error);
+
 		std::string serialize(JsonVar *json_var, bool minimized=false);
 
+		// writes the output to any sink (see zetjsoncpp_sink.h)
+		void serialize(JsonVar *json_var, JsonSink & sink, bool minimized=false);
+
+		void serialize_file(JsonVar *json_var, const std::string & filename, bool minimized=false);
+
+		// Binary snapshot of the tree: strings are length prefixed and numbers are native. It's
+		// only meant to be loaded by the same schema on the same platform, see deserialize_binary.
+		std::string serialize_binary(JsonVar *json_var);
+
+		void serialize_binary(JsonVar *json_var, JsonSink & sink);
+
+		// if source_filename is given (i.e the json the tree was parsed from), its size and
+		// modification time are kept in the snapshot (see deserialize_binary_file)
+		void serialize_binary_file(JsonVar *json_var, const std::string & filename, const std::string & source_filename="");
+
+		// loads a snapshot of serialize_binary. Snapshots written by other schema of _T (see
+		// JsonVar::getSchemaHash), other ZJ_BINARY_VERSION or other byte order are rejected as
+		// DESERIALIZE_ERROR_SNAPSHOT_STALE, so the caller can parse the text and write it again.
+		template <typename _T>
+		_T * deserialize_binary(const std::string & snapshot);
+
+		template <typename _T>
+		_T * deserialize_binary_file(const std::string & _filename);
+
+		template <typename _T>
+		_T * deserialize_binary(const std::string & snapshot, DeserializeError & error);
+
+		template <typename _T>
+		_T * deserialize_binary_file(const std::string & _filename, DeserializeError & error);
+
+		// as above, but the snapshot is also stale if _source_filename changed (size or
+		// modification time) or can't be stat since the snapshot was written
+		template <typename _T>
+		_T * deserialize_binary_file(const std::string & _filename, const std::string & _source_filename);
+
+		template <typename _T>
+		_T * deserialize_binary_file(const std::string & _filename, const std::string & _source_filename, DeserializeError & error);
+
 };
 
 #include "zetjsoncpp.hpp"
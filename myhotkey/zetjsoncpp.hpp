@@ -32,81 +32,538 @@ namespace zetjsoncpp{
 	typedef struct{
 		const char *filename;
 		const char *str_start;
+		size_t n_threads; // threads to parse vectors of objects (1 parses in the current thread only)
+		bool in_situ; // the input can be modified, JsonVarStringViews point to it
+		bool skip_unmapped; // values of keys without property are skipped by zj_scan::skip_container, unchecked
+		DeserializeError error; // set when a parse function returns NULL
 	}DeserializeData;
 
 	extern char json_message_error[16836];
 
+	// any data, to reach the elements of vectors of objects whatever its type
+	typedef struct{
+
+	}TestVoid;
+
 
 
 	void throw_error(DeserializeData *deserialize_data, const char * str_current, int line, const char *string_text, ...);
 	void throw_warning(DeserializeData *deserialize_data, const char * str_current, int line, const char *string_text, ...);
 
 
-	const char end_char_standard_value[] = {
-			',',
-			'}',
-			' ',
-			'\t',
-			'\n',
-			'\r', // for make compatible windows...
-			']',
-			0
-	};
+	// chars that ends a standard value: ',', '}', ']' and blanks (\r for make compatible windows...)
+	const uint16_t end_class_standard_value = zj_scan::CHAR_CLASS_END_VALUE;
 
+	// parse functions return the char after the parsed value, or NULL with deserialize_data->error set
 	char * deserialize_json_var(DeserializeData *deserialize_data, const char * str_current, int & line,JsonVar *json_var);
+	char * deserialize_json_var_value(DeserializeData *deserialize_data, const char *str_start, int & line, JsonVar *json_var);
+	// n_threads or the number of cores if it's 0
+	size_t get_deserialize_threads(unsigned n_threads);
+	JsonVar *find_property(JsonVar * c_data, const char *variable_name, size_t variable_name_len, int & property_index);
+	bool is_single_comment(char *str);
+	bool is_start_comment(char *str);
+	bool is_end_comment(char *str);
+	char *advance_to_char(char *str,char c);
+	char *advance_to_end_comment(char *aux_p, int &line);
+	char *ignore_blanks(char *str, int &line);
+	char *advance_to_one_of_collection_of_char(char *str,uint16_t end_classes, int &line);
+	// str_out/str_out_len (if not NULL) are set to the content of the string in the source buffer, or in
+	// str_decoded if it has escapes or utf-8 (if str_decoded is NULL the string is only validated)
+	char * read_string_between_quotes(DeserializeData *deserialize_data, const char *str_start,int & line, const char **str_out, size_t *str_out_len, std::string *str_decoded);
+	// as read_string_between_quotes, but escapes are decoded in place and the content ends with '\0'
+	char * read_string_in_situ(DeserializeData *deserialize_data, char *str_start,int & line, std::string_view *str_out);
+	// fills json_var from the snapshot in [buffer,buffer+size), it returns false and sets error if it's stale or corrupt
+	// (also stale if source is not NULL and it's not the stamp of the source kept in the snapshot)
+	bool deserialize_binary_json_var(const char *buffer, size_t size, JsonVar *json_var, DeserializeError & error, const zj_file::FileStamp *source=NULL);
+	// sets deserialize_data->error and returns NULL
+	char * json_deserialize_error(DeserializeData *deserialize_data, const char *str_current, int line, DeserializeErrorCode code, const char *detail=NULL, size_t detail_len=0, const char *type_str=NULL);
+
+	// Resumable deserializer that takes the input in chunks of any size (i.e from pipes or
+	// sockets). It keeps the nesting state between calls, so memory is proportional to the
+	// nesting depth and the largest single token instead of the document size.
+	class PushDeserializer{
+	public:
+
+		PushDeserializer(JsonVar *json_var, const char *filename=NULL);
+
+		// parses a chunk of input. It throws deserialize_error_exception on error.
+		void feed(const char *chunk, size_t chunk_len);
+
+		// tells there's no more input. It throws deserialize_error_exception if the document is not complete.
+		void finish();
+
+		// as feed and finish, but they return false on error instead of throwing (see getError).
+		// Once an error is found the rest of the input is ignored.
+		bool tryFeed(const char *chunk, size_t chunk_len);
+		bool tryFinish();
+
+		// the offset of the error is the one of the char where it was found
+		const DeserializeError & getError() const;
+
+		bool isDone() const;
+
+	private:
+
+		typedef enum{
+			LEX_NONE=0,
+			LEX_STRING,
+			LEX_PRIMITIVE,
+			LEX_COMMENT_START,
+			LEX_LINE_COMMENT,
+			LEX_BLOCK_COMMENT,
+			LEX_BLOCK_COMMENT_END
+		}LexState;
+
+		typedef enum{
+			PARSE_VALUE=0,
+			PARSE_VALUE_OR_END, // vector element or ']'
+			PARSE_KEY_OR_END, // object key or '}'
+			PARSE_COLON,
+			PARSE_COMMA_OR_END,
+			PARSE_DONE,
+			PARSE_ERROR
+		}ParseState;
 
+		typedef struct{
+			JsonVar *json_var;
+			bool is_object;
+			std::vector<bool> parsed_properties;
+		}PushFrame;
+
+		DeserializeData __zj_deserialize_data__;
+		std::vector<PushFrame> __zj_frames__;
+		std::string __zj_token__;
+		JsonVar *__zj_json_var_value__; // target of the next value
+		LexState __zj_lex_state__;
+		ParseState __zj_parse_state__;
+		bool __zj_is_key__;
+		bool __zj_is_escaped__;
+		int __zj_bom_state__;
+		int __zj_line__;
+		size_t __zj_offset__; // offset of the char being parsed
+		size_t __zj_token_offset__; // offset of the first char of __zj_token__
+
+		void parseChar(char c);
+		void beginValue(char c);
+		void endString();
+		void endPrimitive();
+		void endValue();
+		void openFrame(bool is_object);
+		void closeFrame();
+		void error(DeserializeErrorCode code, const char *detail=NULL, size_t detail_len=0, const char *type_str=NULL);
+	};
+
+	// deserialize and deserialize_file with the options of DeserializeData, the other
+	// entry points call them
 	template <typename _T>
-	_T * deserialize(const std::string & expression) {
+	_T * deserialize_expression(const std::string & expression, unsigned n_threads, bool skip_unmapped, DeserializeError & error) {
 
 		int line=-1;
 		_T *json_var=new _T;
+		DeserializeData deserialize_data;
+		deserialize_data.filename=NULL;
+		deserialize_data.str_start=expression.c_str();
+		deserialize_data.n_threads=get_deserialize_threads(n_threads);
+		deserialize_data.in_situ=false;
+		deserialize_data.skip_unmapped=skip_unmapped;
+
+		try{
+			if(deserialize_json_var(&deserialize_data,expression.c_str(),line, json_var) == NULL){
+				error=deserialize_data.error;
+				delete json_var;
+				return NULL;
+			}
+		}catch(...){ // not a parse error (i.e bad_alloc)
+			delete json_var;
+			throw;
+		}
+
+		error.clear();
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_mapped_file(const std::string & _filename, unsigned n_threads, bool skip_unmapped, DeserializeError & error) {
+		_T *json_var=NULL;
+		int line=1;
+		zj_file::MappedFile mapped_file;
+
+		try{
+			mapped_file = zj_file::map(_filename);
+		}catch(std::runtime_error & ex){
+			error.set(DESERIALIZE_ERROR_FILE,0,0,ex.what(),strlen(ex.what()));
+			return NULL;
+		}
 
 		try{
+			json_var=new _T;
+			char *aux_p=mapped_file.buffer;
+			uint8_t bom_signature[]={0xef,0xbb,0xbf};
 			DeserializeData deserialize_data;
-			deserialize_data.filename=NULL;
-			deserialize_data.str_start=expression.c_str();
-			deserialize_json_var(&deserialize_data,expression.c_str(),line, json_var);
-		}catch(deserialize_error_exception & err){
+			if(mapped_file.size >= sizeof(bom_signature) && memcmp(aux_p,bom_signature,sizeof(bom_signature))==0){ // ignore BOM signature
+				aux_p+=sizeof(bom_signature);
+			}
+
+			deserialize_data.filename=_filename.c_str();
+			deserialize_data.str_start=mapped_file.buffer; // offsets are from the start of the file
+			deserialize_data.n_threads=get_deserialize_threads(n_threads);
+			deserialize_data.in_situ=false;
+			deserialize_data.skip_unmapped=skip_unmapped;
+
+			if(deserialize_json_var(&deserialize_data,aux_p,line,json_var) == NULL){
+				error=deserialize_data.error;
+				delete json_var;
+				json_var=NULL;
+			}else{
+				error.clear();
+			}
+		}
+		catch(...){ // not a parse error (i.e bad_alloc)
 			delete json_var;
-			json_var=NULL;
-			throw err;
+			zj_file::unmap(mapped_file);
+			throw;
 		}
+		zj_file::unmap(mapped_file);
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_skip_unmapped(const std::string & expression) {
+		DeserializeError error;
+		_T *json_var=deserialize_skip_unmapped<_T>(expression,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,NULL);
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_skip_unmapped(const std::string & expression, DeserializeError & error) {
+		return deserialize_expression<_T>(expression,1,true,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_file_skip_unmapped(const std::string & _filename) {
+		DeserializeError error;
+		_T *json_var=deserialize_file_skip_unmapped<_T>(_filename,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_file_skip_unmapped(const std::string & _filename, DeserializeError & error) {
+		return deserialize_mapped_file<_T>(_filename,1,true,error);
+	}
+
+	template <typename _T>
+	_T * deserialize(const std::string & expression) {
+		return deserialize_parallel<_T>(expression,1);
+	}
+
+	template <typename _T>
+	_T * deserialize(const std::string & expression, DeserializeError & error) {
+		return deserialize_parallel<_T>(expression,1,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_parallel(const std::string & expression, unsigned n_threads) {
+		DeserializeError error;
+		_T *json_var=deserialize_parallel<_T>(expression,n_threads,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,NULL);
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_parallel(const std::string & expression, unsigned n_threads, DeserializeError & error) {
+		return deserialize_expression<_T>(expression,n_threads,false,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_stream(FILE *fp, const char *filename, size_t chunk_size) {
+		if(chunk_size == 0){
+			throw std::runtime_error("chunk size of deserialize_stream can't be 0");
+		}
+
+		_T *json_var=new _T;
+
+		try{
+			std::vector<char> chunk(chunk_size);
+			size_t chunk_len;
+			PushDeserializer push_deserializer(json_var,filename);
+
+			while((chunk_len=fread(&chunk[0],1,chunk_size,fp)) > 0){
+				push_deserializer.feed(&chunk[0],chunk_len);
+			}
+
+			// a read error isn't the end of the input
+			if(ferror(fp)){
+				throw std::runtime_error(std::string("I can't read file \"")+(filename!=NULL?filename:"")+"\"");
+			}
+			push_deserializer.finish();
+		}catch(...){ // parse error or not (i.e bad_alloc)
+			delete json_var;
+			throw;
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_file_stream(const std::string & _filename, size_t chunk_size) {
+		_T *json_var=NULL;
+		FILE *fp;
+
+		if((fp=fopen(_filename.c_str(),"rb")) == NULL){
+			throw std::runtime_error("I can't open file \""+_filename+"\"");
+		}
+
+		try{
+			json_var=deserialize_stream<_T>(fp,_filename.c_str(),chunk_size);
+		}catch(...){
+			fclose(fp);
+			throw;
+		}
+		fclose(fp);
 
 		return json_var;
 	}
 
 	template <typename _T>
 	_T * deserialize_file(const std::string & _filename) {
-		//_T * json_element;
-		std::string filename = _filename.c_str();
+		return deserialize_file_parallel<_T>(_filename,1);
+	}
+
+	template <typename _T>
+	_T * deserialize_file(const std::string & _filename, DeserializeError & error) {
+		return deserialize_file_parallel<_T>(_filename,1,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_file_parallel(const std::string & _filename, unsigned n_threads) {
+		DeserializeError error;
+		_T *json_var=deserialize_file_parallel<_T>(_filename,n_threads,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_file_parallel(const std::string & _filename, unsigned n_threads, DeserializeError & error) {
+		return deserialize_mapped_file<_T>(_filename,n_threads,false,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_in_situ(char *buffer) {
+		DeserializeError error;
+		_T *json_var=deserialize_in_situ<_T>(buffer,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,NULL);
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_in_situ(char *buffer, DeserializeError & error) {
+
+		int line=-1; // as deserialize
+		_T *json_var=new _T;
+		DeserializeData deserialize_data;
+		deserialize_data.filename=NULL;
+		deserialize_data.str_start=buffer;
+		deserialize_data.n_threads=1;
+		deserialize_data.in_situ=true;
+		deserialize_data.skip_unmapped=false;
+
+		try{
+			if(deserialize_json_var(&deserialize_data,buffer,line, json_var) == NULL){
+				error=deserialize_data.error;
+				delete json_var;
+				return NULL;
+			}
+		}catch(...){ // not a parse error (i.e bad_alloc)
+			delete json_var;
+			throw;
+		}
+
+		error.clear();
+		return json_var;
+	}
+
+	template <typename _T>
+	JsonInSituDocument<_T> * deserialize_file_in_situ(const std::string & _filename) {
+		DeserializeError error;
+		JsonInSituDocument<_T> *document=deserialize_file_in_situ<_T>(_filename,error);
+
+		if(document == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return document;
+	}
+
+	template <typename _T>
+	JsonInSituDocument<_T> * deserialize_file_in_situ(const std::string & _filename, DeserializeError & error) {
+		JsonInSituDocument<_T> *document=NULL;
 		_T *json_var=NULL;
 		int line=1;
+		zj_file::MappedFile mapped_file;
 
-		char *buf = zj_file::read(filename);
-		if (buf != NULL) {
-			try{
-				json_var=new _T;
-				char *aux_p=buf;
-				uint8_t bom_signature[]={0xef,0xbb,0xbf};
-				DeserializeData deserialize_data;
-				if(memcmp(aux_p,bom_signature,sizeof(bom_signature))==0){ // ignore BOM signature
-					aux_p+=sizeof(bom_signature);
-				}
-
-				deserialize_data.filename=_filename.c_str();
-				deserialize_data.str_start=aux_p;
-
-				deserialize_json_var(&deserialize_data,aux_p,line,json_var);
+		try{
+			mapped_file = zj_file::map(_filename,true);
+		}catch(std::runtime_error & ex){
+			error.set(DESERIALIZE_ERROR_FILE,0,0,ex.what(),strlen(ex.what()));
+			return NULL;
+		}
+
+		try{
+			json_var=new _T;
+			char *aux_p=mapped_file.buffer;
+			uint8_t bom_signature[]={0xef,0xbb,0xbf};
+			DeserializeData deserialize_data;
+			if(mapped_file.size >= sizeof(bom_signature) && memcmp(aux_p,bom_signature,sizeof(bom_signature))==0){ // ignore BOM signature
+				aux_p+=sizeof(bom_signature);
 			}
-			catch(deserialize_error_exception & err){
+
+			deserialize_data.filename=_filename.c_str();
+			deserialize_data.str_start=mapped_file.buffer; // offsets are from the start of the file
+			deserialize_data.n_threads=1;
+			deserialize_data.in_situ=true;
+			deserialize_data.skip_unmapped=false;
+
+			if(deserialize_json_var(&deserialize_data,aux_p,line,json_var) == NULL){
+				error=deserialize_data.error;
 				delete json_var;
-				free(buf);
-				throw err;
+				zj_file::unmap(mapped_file);
+				return NULL;
 			}
-			free(buf);
+
+			// from here the document owns the root and the mapping
+			document=new JsonInSituDocument<_T>(json_var,mapped_file);
+		}
+		catch(...){ // not a parse error (i.e bad_alloc)
+			delete json_var;
+			zj_file::unmap(mapped_file);
+			throw;
+		}
+
+		error.clear();
+		return document;
+	}
+
+	template <typename _T>
+	_T * deserialize_binary(const std::string & snapshot) {
+		DeserializeError error;
+		_T *json_var=deserialize_binary<_T>(snapshot,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,NULL);
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_binary(const std::string & snapshot, DeserializeError & error) {
+		_T *json_var=new _T;
+
+		try{
+			if(!deserialize_binary_json_var(snapshot.data(),snapshot.size(),json_var,error)){
+				delete json_var;
+				return NULL;
+			}
+		}catch(...){ // not a snapshot error (i.e bad_alloc)
+			delete json_var;
+			throw;
 		}
 
 		return json_var;
 	}
+
+	template <typename _T>
+	_T * deserialize_binary_file(const std::string & _filename) {
+		DeserializeError error;
+		_T *json_var=deserialize_binary_file<_T>(_filename,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return json_var;
+	}
+
+	// deserialize_binary_file, source is the stamp the snapshot must have or NULL
+	template <typename _T>
+	_T * deserialize_binary_file_stamp(const std::string & _filename, const zj_file::FileStamp *source, DeserializeError & error) {
+		_T *json_var=NULL;
+		zj_file::MappedFile mapped_file;
+
+		try{
+			mapped_file = zj_file::map(_filename);
+		}catch(std::runtime_error & ex){
+			error.set(DESERIALIZE_ERROR_FILE,0,0,ex.what(),strlen(ex.what()));
+			return NULL;
+		}
+
+		try{
+			json_var=new _T;
+			if(!deserialize_binary_json_var(mapped_file.buffer,mapped_file.size,json_var,error,source)){
+				delete json_var;
+				json_var=NULL;
+			}
+		}
+		catch(...){ // not a snapshot error (i.e bad_alloc)
+			delete json_var;
+			zj_file::unmap(mapped_file);
+			throw;
+		}
+		zj_file::unmap(mapped_file);
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_binary_file(const std::string & _filename, DeserializeError & error) {
+		return deserialize_binary_file_stamp<_T>(_filename,NULL,error);
+	}
+
+	template <typename _T>
+	_T * deserialize_binary_file(const std::string & _filename, const std::string & _source_filename) {
+		DeserializeError error;
+		_T *json_var=deserialize_binary_file<_T>(_filename,_source_filename,error);
+
+		if(json_var == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return json_var;
+	}
+
+	template <typename _T>
+	_T * deserialize_binary_file(const std::string & _filename, const std::string & _source_filename, DeserializeError & error) {
+		zj_file::FileStamp source;
+
+		if(!zj_file::get_stamp(_source_filename,source)){
+			error.set(DESERIALIZE_ERROR_SNAPSHOT_STALE,0,0);
+			return NULL;
+		}
+
+		return deserialize_binary_file_stamp<_T>(_filename,&source,error);
+	}
 }
 
@@ -0,0 +1,430 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "zetjsoncpp.h"
+
+// written as uint16_t, it reads 0x0201 on a platform of other byte order
+#define ZJ_BINARY_BYTE_ORDER	0x0102
+
+namespace zetjsoncpp{
+
+	// Snapshot: header and the root value. Values are written as:
+	//
+	// boolean: uint8_t
+	// number, double, int64: float, double, int64_t
+	// string: uint32_t length and its chars
+	// object: parsed state of its properties (one bit each, in property table order) and its properties
+	// vector: uint32_t count and its elements
+	// map: uint32_t count and its entries (key string and value)
+	//
+	// Numbers are native, the header tells the byte order, the schema hash of the root and the
+	// size and modification time of the source (zero if there's no source).
+	static const char binary_magic[4]={'Z','J','B','S'};
+
+	//------------------------------------------------------------------------------------------------
+	// serialize_binary
+
+	void serialize_binary_json_var(JsonSink & sink, JsonVar *json_var);
+
+	template<typename _T_VALUE>
+	inline void write_binary(JsonSink & sink, _T_VALUE value){
+		sink.write((const char *)&value,sizeof(value));
+	}
+
+	void write_binary_size(JsonSink & sink, size_t size){
+		if(size > UINT32_MAX){
+			throw std::runtime_error(zj_strutils::format("%zu elements or chars don't fit in a snapshot",size));
+		}
+		write_binary(sink,(uint32_t)size);
+	}
+
+	void write_binary_string(JsonSink & sink, const std::string & str){
+		write_binary_size(sink,str.size());
+		sink.write(str);
+	}
+
+	class CountMapVisitor: public JsonVarMapVisitor{
+	public:
+		size_t count=0;
+
+		virtual void visit(const std::string &, JsonVar *){
+			count++;
+		}
+	};
+
+	class SerializeBinaryMapVisitor: public JsonVarMapVisitor{
+	public:
+		SerializeBinaryMapVisitor(JsonSink & _sink):sink(_sink){}
+
+		virtual void visit(const std::string & key, JsonVar *json_var){
+			write_binary_string(sink,key);
+			serialize_binary_json_var(sink,json_var);
+		}
+
+	private:
+		JsonSink & sink;
+	};
+
+	void serialize_binary_json_var_map(JsonSink & sink, JsonVar *json_var_map){
+		CountMapVisitor count_visitor;
+		SerializeBinaryMapVisitor visitor(sink);
+
+		// maps have no size in JsonVar
+		json_var_map->visitMapEntries(count_visitor);
+		write_binary_size(sink,count_visitor.count);
+		json_var_map->visitMapEntries(visitor);
+	}
+
+	template<typename _T>
+	void serialize_binary_json_var_vector(JsonSink & sink, _T *json_var_vector){
+		write_binary_size(sink,json_var_vector->size());
+
+		for(unsigned i = 0; i < json_var_vector->size(); i++){
+			serialize_binary_json_var(sink,json_var_vector->getJsonVarPtr(i));
+		}
+	}
+
+	void serialize_binary_json_var_object(JsonSink & sink, JsonVar *json_var){
+		const JsonVarPropertyTable *property_table=json_var->getPropertyTable();
+		char *data_start=(char *)json_var->getPtrDataStart();
+		uint8_t parsed=0;
+
+		for(size_t k=0; k < property_table->size(); k++){
+			if(((JsonVar *)(data_start+property_table->at(k).offset))->isDeserialized()){
+				parsed|=0x1<<(k%8);
+			}
+
+			if(k%8 == 7 || k+1 == property_table->size()){
+				write_binary(sink,parsed);
+				parsed=0;
+			}
+		}
+
+		for(size_t k=0; k < property_table->size(); k++){
+			serialize_binary_json_var(sink,(JsonVar *)(data_start+property_table->at(k).offset));
+		}
+	}
+
+	void serialize_binary_json_var(JsonSink & sink, JsonVar *json_var){
+		switch(json_var->getType()){
+		default:
+			throw std::runtime_error(zj_strutils::format("%s cannot be written in a snapshot",json_var->getTypeStr()));
+		case JSON_VAR_TYPE_BOOLEAN:
+			write_binary(sink,(uint8_t)(*(bool *)json_var->getPtrValue()?1:0));
+			break;
+		case JSON_VAR_TYPE_NUMBER:
+			write_binary(sink,*(float *)json_var->getPtrValue());
+			break;
+		case JSON_VAR_TYPE_DOUBLE:
+			write_binary(sink,*(double *)json_var->getPtrValue());
+			break;
+		case JSON_VAR_TYPE_INT64:
+			write_binary(sink,*(int64_t *)json_var->getPtrValue());
+			break;
+		case JSON_VAR_TYPE_STRING:
+			write_binary_string(sink,*(std::string *)json_var->getPtrValue());
+			break;
+		case JSON_VAR_TYPE_OBJECT:
+			serialize_binary_json_var_object(sink,json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
+			serialize_binary_json_var_vector<JsonVarVectorBoolean<>>(sink,(JsonVarVectorBoolean<> *)json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
+			serialize_binary_json_var_vector<JsonVarVectorNumber<>>(sink,(JsonVarVectorNumber<> *)json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_DOUBLES:
+			serialize_binary_json_var_vector<JsonVarVectorDouble<>>(sink,(JsonVarVectorDouble<> *)json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_INT64S:
+			serialize_binary_json_var_vector<JsonVarVectorInt64<>>(sink,(JsonVarVectorInt64<> *)json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_STRINGS:
+			serialize_binary_json_var_vector<JsonVarVectorString<>>(sink,(JsonVarVectorString<> *)json_var);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
+			serialize_binary_json_var_vector<JsonVarVectorObject<TestVoid>>(sink,(JsonVarVectorObject<TestVoid> *)json_var);
+			break;
+		case JSON_VAR_TYPE_MAP_OF_BOOLEANS:
+		case JSON_VAR_TYPE_MAP_OF_NUMBERS:
+		case JSON_VAR_TYPE_MAP_OF_DOUBLES:
+		case JSON_VAR_TYPE_MAP_OF_INT64S:
+		case JSON_VAR_TYPE_MAP_OF_STRINGS:
+		case JSON_VAR_TYPE_MAP_OF_OBJECTS:
+			serialize_binary_json_var_map(sink,json_var);
+			break;
+		}
+	}
+
+	void serialize_binary_snapshot(JsonVar *json_var, JsonSink & sink, const zj_file::FileStamp & source){
+		sink.write(binary_magic,sizeof(binary_magic));
+		write_binary(sink,(uint16_t)ZJ_BINARY_VERSION);
+		write_binary(sink,(uint16_t)ZJ_BINARY_BYTE_ORDER);
+		write_binary(sink,json_var->getSchemaHash());
+		write_binary(sink,source.size);
+		write_binary(sink,source.mtime);
+
+		serialize_binary_json_var(sink,json_var);
+	}
+
+	void serialize_binary(JsonVar *json_var, JsonSink & sink){
+		zj_file::FileStamp no_source={0,0};
+		serialize_binary_snapshot(json_var,sink,no_source);
+	}
+
+	std::string serialize_binary(JsonVar *json_var){
+		JsonSinkChunked sink;
+
+		serialize_binary(json_var,sink);
+
+		return sink.toString();
+	}
+
+	void serialize_binary_file(JsonVar *json_var, const std::string & filename, const std::string & source_filename){
+		zj_file::FileStamp source={0,0};
+		FILE *fp;
+
+		if(!source_filename.empty() && !zj_file::get_stamp(source_filename,source)){
+			throw std::runtime_error("I can't stat file \""+source_filename+"\"");
+		}
+
+		if((fp=fopen(filename.c_str(),"wb")) == NULL){
+			throw std::runtime_error("I can't open file \""+filename+"\"");
+		}
+
+		try{
+			JsonSinkFile sink(fp);
+			serialize_binary_snapshot(json_var,sink,source);
+			sink.flush();
+		}catch(...){
+			fclose(fp);
+			throw;
+		}
+
+		if(fclose(fp) != 0){
+			throw std::runtime_error("I can't write file \""+filename+"\"");
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// deserialize_binary
+
+	typedef struct{
+		const char *start;
+		const char *current;
+		const char *end;
+		DeserializeError *error;
+	}BinaryInput;
+
+	bool deserialize_binary_json_var(BinaryInput & input, JsonVar *json_var);
+
+	bool binary_corrupt(BinaryInput & input){
+		input.error->set(DESERIALIZE_ERROR_SNAPSHOT_CORRUPT,input.current-input.start,0);
+		return false;
+	}
+
+	inline bool read_binary(BinaryInput & input, void *value, size_t len){
+		if(len > (size_t)(input.end-input.current)){
+			return binary_corrupt(input);
+		}
+
+		memcpy(value,input.current,len);
+		input.current+=len;
+		return true;
+	}
+
+	// count of a vector or map whose elements take min_size bytes at least
+	bool read_binary_size(BinaryInput & input, size_t min_size, uint32_t & size){
+		if(!read_binary(input,&size,sizeof(size))){
+			return false;
+		}
+
+		if(min_size > 0 && size > (size_t)(input.end-input.current)/min_size){
+			return binary_corrupt(input);
+		}
+
+		return true;
+	}
+
+	bool read_binary_string(BinaryInput & input, std::string & str){
+		uint32_t len;
+
+		if(!read_binary_size(input,1,len)){
+			return false;
+		}
+
+		str.assign(input.current,len);
+		input.current+=len;
+		return true;
+	}
+
+	bool deserialize_binary_json_var_vector(BinaryInput & input, JsonVar *json_var, size_t min_element_size){
+		uint32_t size;
+
+		if(!read_binary_size(input,min_element_size,size)){
+			return false;
+		}
+
+		for(uint32_t i=0; i < size; i++){
+			JsonVar *json_var_element=json_var->newJsonVar();
+			if(!deserialize_binary_json_var(input,json_var_element)){
+				return false;
+			}
+			json_var_element->setParsed(true);
+		}
+
+		return true;
+	}
+
+	bool deserialize_binary_json_var_map(BinaryInput & input, JsonVar *json_var){
+		std::string key;
+		uint32_t size;
+
+		// entries take its key length at least
+		if(!read_binary_size(input,sizeof(uint32_t),size)){
+			return false;
+		}
+
+		for(uint32_t i=0; i < size; i++){
+			if(!read_binary_string(input,key)){
+				return false;
+			}
+
+			JsonVar *json_var_element;
+			try{
+				json_var_element=json_var->newJsonVar(key);
+			}catch(std::runtime_error &){ // duplicated key
+				return binary_corrupt(input);
+			}
+
+			if(!deserialize_binary_json_var(input,json_var_element)){
+				return false;
+			}
+			json_var_element->setParsed(true);
+		}
+
+		return true;
+	}
+
+	bool deserialize_binary_json_var_object(BinaryInput & input, JsonVar *json_var){
+		const JsonVarPropertyTable *property_table=json_var->getPropertyTable();
+		char *data_start=(char *)json_var->getPtrDataStart();
+		const char *str_parsed=input.current;
+		size_t parsed_len=(property_table->size()+7)/8;
+
+		if(parsed_len > (size_t)(input.end-input.current)){
+			return binary_corrupt(input);
+		}
+		input.current+=parsed_len;
+
+		for(size_t k=0; k < property_table->size(); k++){
+			JsonVar *json_var_property=(JsonVar *)(data_start+property_table->at(k).offset);
+
+			if(!deserialize_binary_json_var(input,json_var_property)){
+				return false;
+			}
+			json_var_property->setParsed((str_parsed[k/8] & (0x1<<(k%8))) != 0);
+		}
+
+		return true;
+	}
+
+	bool deserialize_binary_json_var(BinaryInput & input, JsonVar *json_var){
+		switch(json_var->getType()){
+		default:
+			throw std::runtime_error(zj_strutils::format("%s cannot be read from a snapshot",json_var->getTypeStr()));
+		case JSON_VAR_TYPE_BOOLEAN:
+			{
+				uint8_t value;
+				if(!read_binary(input,&value,sizeof(value))){
+					return false;
+				}
+				*(bool *)json_var->getPtrValue()=value!=0;
+			}
+			break;
+		case JSON_VAR_TYPE_NUMBER:
+			return read_binary(input,json_var->getPtrValue(),sizeof(float));
+		case JSON_VAR_TYPE_DOUBLE:
+			return read_binary(input,json_var->getPtrValue(),sizeof(double));
+		case JSON_VAR_TYPE_INT64:
+			return read_binary(input,json_var->getPtrValue(),sizeof(int64_t));
+		case JSON_VAR_TYPE_STRING:
+			return read_binary_string(input,*(std::string *)json_var->getPtrValue());
+		case JSON_VAR_TYPE_OBJECT:
+			return deserialize_binary_json_var_object(input,json_var);
+		case JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
+			return deserialize_binary_json_var_vector(input,json_var,sizeof(uint8_t));
+		case JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
+			return deserialize_binary_json_var_vector(input,json_var,sizeof(float));
+		case JSON_VAR_TYPE_VECTOR_OF_DOUBLES:
+		case JSON_VAR_TYPE_VECTOR_OF_INT64S:
+			return deserialize_binary_json_var_vector(input,json_var,sizeof(int64_t));
+		case JSON_VAR_TYPE_VECTOR_OF_STRINGS:
+			return deserialize_binary_json_var_vector(input,json_var,sizeof(uint32_t));
+		case JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
+			return deserialize_binary_json_var_vector(input,json_var,0); // objects without properties take 0 bytes
+		case JSON_VAR_TYPE_MAP_OF_BOOLEANS:
+		case JSON_VAR_TYPE_MAP_OF_NUMBERS:
+		case JSON_VAR_TYPE_MAP_OF_DOUBLES:
+		case JSON_VAR_TYPE_MAP_OF_INT64S:
+		case JSON_VAR_TYPE_MAP_OF_STRINGS:
+		case JSON_VAR_TYPE_MAP_OF_OBJECTS:
+			return deserialize_binary_json_var_map(input,json_var);
+		}
+
+		return true;
+	}
+
+	bool deserialize_binary_json_var(const char *buffer, size_t size, JsonVar *json_var, DeserializeError & error, const zj_file::FileStamp *source){
+		BinaryInput input;
+		char magic[sizeof(binary_magic)];
+		uint16_t version;
+		uint16_t byte_order;
+		uint64_t schema_hash;
+		zj_file::FileStamp snapshot_source;
+
+		input.start=buffer;
+		input.current=buffer;
+		input.end=buffer+size;
+		input.error=&error;
+
+		if(!read_binary(input,magic,sizeof(magic))
+			|| memcmp(magic,binary_magic,sizeof(magic)) != 0
+			|| !read_binary(input,&version,sizeof(version))
+			|| !read_binary(input,&byte_order,sizeof(byte_order))
+			|| !read_binary(input,&schema_hash,sizeof(schema_hash))){
+			input.current=buffer;
+			return binary_corrupt(input);
+		}
+
+		// the source stamp is read after the version, as other versions may not have it
+		if(version != ZJ_BINARY_VERSION || byte_order != ZJ_BINARY_BYTE_ORDER || schema_hash != json_var->getSchemaHash()){
+			error.set(DESERIALIZE_ERROR_SNAPSHOT_STALE,0,0);
+			return false;
+		}
+
+		if(!read_binary(input,&snapshot_source.size,sizeof(snapshot_source.size))
+			|| !read_binary(input,&snapshot_source.mtime,sizeof(snapshot_source.mtime))){
+			return false;
+		}
+
+		if(source != NULL && (source->size != snapshot_source.size || source->mtime != snapshot_source.mtime)){
+			error.set(DESERIALIZE_ERROR_SNAPSHOT_STALE,0,0);
+			return false;
+		}
+
+		if(!deserialize_binary_json_var(input,json_var)){
+			return false;
+		}
+
+		if(input.current != input.end){ // something after the root
+			return binary_corrupt(input);
+		}
+
+		json_var->setParsed(true);
+		error.clear();
+		return true;
+	}
+}
@@ -4,62 +4,91 @@
  */
 
 #include "zetjsoncpp.h"
-
-#ifdef CAPTURE_VARIABLE_ARGS
-#undef CAPTURE_VARIABLE_ARGS
-#endif
-
-
-// Util to capture args by ...
-#define CAPTURE_VARIABLE_ARGS(text_out, text_in)\
-	{va_list  ap;\
-	va_start(ap,  text_in);\
-	vsprintf(text_out,  text_in,  ap);\
-	va_end(ap);}
+#include <thread>
+#include <atomic>
 
 #define PREVIEW_SSTRING(start, current,n) (((current)-(n))<((start))?(start):((current)-(n)))
 
+// elements of a vector parsed in the current thread before the rest are parsed in parallel,
+// smaller vectors are not worth it
+#define ZJ_PARALLEL_MIN_ELEMENTS		256
+// slices per thread, so threads that ends first can take the work left
+#define ZJ_PARALLEL_SLICES_PER_THREAD	8
+
 namespace zetjsoncpp{
 
 	char * deserialize_json_var_object(DeserializeData *deserialize_data, const char *str_current, int & line, JsonVar *json_var);
+	char * deserialize_json_var_vector(DeserializeData *deserialize_data, const char *str_start, int & line, JsonVar *json_var);
 
-	void json_deserialize_error(DeserializeData *deserialize_data, const char *str_current,int line, const char *string_text, ...) {
-
-
-		char  where[1024]={0};
-		char  text[MAX_C_STRING]={0};
-		char temp_buff[1024]={0};
-		CAPTURE_VARIABLE_ARGS(text, string_text);
-		char *aux=(char *)str_current-1;
-		char captured[100]={0};
-
-		int n=0;
+	char * json_deserialize_error(DeserializeData *deserialize_data, const char *str_current, int line, DeserializeErrorCode code, const char *detail, size_t detail_len, const char *type_str) {
+		deserialize_data->error.set(code,str_current-deserialize_data->str_start,line,detail,detail_len,type_str);
+		return NULL;
+	}
 
-		/*if(*(aux) == '\r' || *(aux) == '\n' ){
-			aux--;
-		}
+	int DeserializeError::getColumn(const char *input) const{
+		const char *str_line=input+offset;
 
-		while(n<40 && deserialize_data->str_start<aux){
-			if(*(aux-1) == '\r' || *(aux-1) == '\n'){
-				break;
-			}
-			aux--;
-			n++;
+		while(str_line > input && *(str_line-1) != '\n'){
+			str_line--;
 		}
 
-		strncpy(captured,aux,n);*/
-
+		return (int)(input+offset-str_line)+1;
+	}
 
-		/*sprintf(where,"...%s..."
-				  "\n              ^   "
-				  "\n  ------------+ \n", captured);//PREVIEW_SSTRING(deserialize_data->str_start, aux, n));
-		//strncpy(where,str_start,str_end-str_start);
+	std::string DeserializeError::getMessage() const{
+		std::string detail_str(detail,detail_len);
+
+		switch(code){
+		case DESERIALIZE_ERROR_NONE:
+			break;
+		case DESERIALIZE_ERROR_EXPECTED_STRING:
+			return "expected string value";
+		case DESERIALIZE_ERROR_STRING_NOT_CLOSED:
+			return "string value not closed";
+		case DESERIALIZE_ERROR_INVALID_VALUE:
+			return zj_strutils::format("Cannot parse value \"%s\" as %s",detail_str.c_str(),type_str!=NULL?type_str:"");
+		case DESERIALIZE_ERROR_EXPECTED_VECTOR:
+			return "A '[' was expected to parse JsonVarVector type";
+		case DESERIALIZE_ERROR_EXPECTED_OBJECT:
+			return zj_strutils::format("A '{' was expected to parse %s type",type_str!=NULL?type_str:"");
+		case DESERIALIZE_ERROR_EXPECTED_COLON:
+			return "Error ':' expected";
+		case DESERIALIZE_ERROR_EXPECTED_VECTOR_END:
+			return "Expected ',' or ']'";
+		case DESERIALIZE_ERROR_EXPECTED_OBJECT_END:
+			return "Expected ',' or '}'";
+		case DESERIALIZE_ERROR_DUPLICATED_PROPERTY:
+			return zj_strutils::format("property name \"%s\" already exist",detail_str.c_str());
+		case DESERIALIZE_ERROR_UNEXPECTED_CHAR:
+			return zj_strutils::format("Unexpected char '%s'",detail_str.c_str());
+		case DESERIALIZE_ERROR_UNEXPECTED_END:
+			return "Unexpected end of input";
+		case DESERIALIZE_ERROR_INVALID_KEY:
+		case DESERIALIZE_ERROR_FILE:
+			return detail_str;
+		case DESERIALIZE_ERROR_SNAPSHOT_STALE:
+			return "Snapshot was written for other schema, format version or source";
+		case DESERIALIZE_ERROR_SNAPSHOT_CORRUPT:
+			return "Snapshot is truncated or corrupt";
+		case DESERIALIZE_ERROR_INVALID_ESCAPE:
+			return zj_strutils::format("Invalid escape sequence \"%s\"",detail_str.c_str());
+		case DESERIALIZE_ERROR_NOT_IN_SITU:
+			return zj_strutils::format("%s can only be deserialized in situ",type_str!=NULL?type_str:"");
+		case DESERIALIZE_ERROR_INVALID_UTF8:
+			return "Invalid utf-8 sequence in string value";
+		case DESERIALIZE_ERROR_CONTROL_CHAR:
+			return "Control char not escaped in string value";
+		}
 
-		sprintf(temp_buff,"%s\n%s\n",text,where);*/
-		throw deserialize_error_exception(deserialize_data->filename,line,text);
+		return "";
 	}
 
-
+	void throw_deserialize_error(const DeserializeError & error, const char *filename){
+		if(error.code == DESERIALIZE_ERROR_FILE){
+			throw std::runtime_error(error.getMessage());
+		}
+		throw deserialize_error_exception(filename,error.line,error.getMessage());
+	}
 
 	bool is_single_comment(char *str){
 
@@ -87,8 +116,18 @@ namespace zetjsoncpp{
 
 	char *advance_to_char(char *str,char c) {
 		char *aux_p = str;
+		uint16_t c_class = zj_scan::CHAR_CLASS_TABLE[(uint8_t)c];
+
 		// make compatible windows format (\r)...
-		while(*aux_p!='\n' && *aux_p!='\r' && *aux_p!=0 && (*aux_p !=(c) )) aux_p++;
+		if(c_class != zj_scan::CHAR_CLASS_NONE){
+			aux_p=(char *)zj_scan::find_class(aux_p,zj_scan::CHAR_CLASS_NEW_LINE | c_class);
+			// c shares its class with other chars
+			while(*aux_p!='\n' && *aux_p!='\r' && *aux_p!=0 && (*aux_p !=(c) )){
+				aux_p=(char *)zj_scan::find_class(aux_p+1,zj_scan::CHAR_CLASS_NEW_LINE | c_class);
+			}
+		}else{
+			while(*aux_p!='\n' && *aux_p!='\r' && *aux_p!=0 && (*aux_p !=(c) )) aux_p++;
+		}
 
 		if(*aux_p=='\r')
 			aux_p++;
@@ -100,11 +139,15 @@ namespace zetjsoncpp{
 
 		if(is_start_comment(aux_p)){
 			aux_p+=2; //advance first
-			while(!is_end_comment(aux_p) && *aux_p != 0){
-				aux_p = advance_to_char(aux_p,'*');
-				if(*aux_p == '\n') aux_p++; // make compatible windows format...
-				if(*aux_p == '\r') aux_p++;
-				if(*(aux_p+1) != '/') aux_p++; // not end comment ... advance ...
+			while(*aux_p != 0){
+				aux_p = (char *)zj_scan::find_class(aux_p,zj_scan::CHAR_CLASS_END_COMMENT | zj_scan::CHAR_CLASS_NEW_LINE);
+				if(is_end_comment(aux_p) || *aux_p == 0){
+					break;
+				}
+				if(*aux_p == '\n'){ // lines of the comment are counted as the others
+					line++;
+				}
+				aux_p++; // not end comment ... advance ...
 			}
 		}
 
@@ -116,7 +159,9 @@ namespace zetjsoncpp{
 		bool end = false;
 		while(!end){
 			end = true;
-			while(*aux_p!=0 && ((*aux_p==' ')  || (*aux_p=='\t'))) aux_p++;
+			if(zj_scan::is_class(*aux_p,zj_scan::CHAR_CLASS_BLANK)){
+				aux_p = (char *)zj_scan::skip_class(aux_p,zj_scan::CHAR_CLASS_BLANK);
+			}
 
 			if(is_single_comment(aux_p)) {// ignore line
 				aux_p = advance_to_char(aux_p,'\n');
@@ -143,52 +188,69 @@ namespace zetjsoncpp{
 		return aux_p;
 	}
 
-	char *advance_to_one_of_collection_of_char(char *str,char *end_char_standard_value, int &line) {
+	char *advance_to_one_of_collection_of_char(char *str,uint16_t end_classes, int &line) {
 		char *aux_p = str;
-		char *chk_char;
 		while(*aux_p!=0){
-			chk_char = end_char_standard_value;
+			// comment openers also stops the scan (these lines must be ignored)
+			aux_p = (char *)zj_scan::find_class(aux_p,end_classes | zj_scan::CHAR_CLASS_COMMENT);
 
-			// comment blocks also is returned (these lines must be ignored)
 			if(is_start_comment(aux_p)) {
 				aux_p = advance_to_end_comment(aux_p, line);
 				if(is_end_comment(aux_p))
 					aux_p+=2;
+				continue;
 			}
 
 			if(is_single_comment(aux_p)) {
 				aux_p = advance_to_char(aux_p,'\n');
 			}
 
-			while(*chk_char != 0){
-				if(*chk_char == *aux_p)
-					return aux_p;
-				chk_char++;
+			if(*aux_p == 0 || zj_scan::is_class(*aux_p,end_classes)){
+				return aux_p;
 			}
 			aux_p++;
 		}
 		return aux_p;
 	}
 
-	JsonVar *find_property(JsonVar * c_data, const std::string & variable_name) {
+	JsonVar *find_property(JsonVar * c_data, const char *variable_name, size_t variable_name_len, int & property_index) {
 		// no data no search...
 		if (c_data == NULL) return NULL;
 
-		char *aux_p = (char *)c_data->getPtrDataStart();
-		char *end_p = (char *)c_data->getPtrDataEnd();
+		const JsonVarPropertyTable *property_table = c_data->getPropertyTable();
+		if (property_table == NULL) return NULL;
 
-		// Main loop iteration to whole C struct
-		for (; aux_p < end_p; ) {
+		property_index = property_table->find(variable_name, variable_name_len);
+		if (property_index == -1) return NULL;
 
-			JsonVar * p_sv = (JsonVar *)aux_p;
-			if (p_sv->getVariableName() == variable_name)
-				return p_sv;
+		return (JsonVar *)((char *)c_data->getPtrDataStart() + property_table->at(property_index).offset);
+	}
 
-			aux_p += p_sv->getSizeData();
+	// Properties already read while parsing one object, to detect duplicated keys
+	class ParsedProperties{
+	public:
+		ParsedProperties(size_t n_properties){
+			memset(bits_static,0,sizeof(bits_static));
+			bits=bits_static;
+			if(n_properties > sizeof(bits_static)*8){
+				bits_dynamic.assign((n_properties+63)/64,0);
+				bits=&bits_dynamic[0];
+			}
 		}
 
-		return NULL;
-	}
+		// returns true if the property was already set
+		bool testAndSet(int index){
+			uint64_t mask=(uint64_t)1 << (index & 63);
+			bool is_set=(bits[index >> 6] & mask) != 0;
+			bits[index >> 6]|=mask;
+			return is_set;
+		}
+
+	private:
+		uint64_t bits_static[4];
+		std::vector<uint64_t> bits_dynamic;
+		uint64_t *bits;
+	};
 
 	void set_parsed_to_false_all_properies(JsonVar * c_data) {
 		// no data no search...
@@ -196,41 +258,96 @@ namespace zetjsoncpp{
 			return;
 		}
 
-		char *aux_p = (char *)c_data->getPtrDataStart();
-		char *end_p = (char *)c_data->getPtrDataEnd();
-
-		// Main loop iteration to whole C struct
-		for (; aux_p < end_p; ) {
+		const JsonVarPropertyTable *property_table = c_data->getPropertyTable();
+		if (property_table == NULL){
+			return;
+		}
 
-			JsonVar * p_sv = (JsonVar *)aux_p;
+		for (size_t i = 0; i < property_table->size(); i++) {
+			JsonVar * p_sv = (JsonVar *)((char *)c_data->getPtrDataStart() + property_table->at(i).offset);
 			p_sv->setParsed(false);
+		}
+	}
 
-			aux_p += p_sv->getSizeData();
+	// Reports the error of zj_string at str_error for the string that starts at str_start
+	char * string_deserialize_error(DeserializeData *deserialize_data, const char *str_start, const char *str_error, int line, zj_string::StringError error){
+		switch(error){
+		case zj_string::STRING_INVALID_ESCAPE:
+			return json_deserialize_error(deserialize_data,str_error,line,DESERIALIZE_ERROR_INVALID_ESCAPE,str_error,strnlen(str_error,str_error[1]=='u'?ZJ_STRING_MAX_ESCAPE_CHARS:2));
+		case zj_string::STRING_INVALID_UTF8:
+			return json_deserialize_error(deserialize_data,str_error,line,DESERIALIZE_ERROR_INVALID_UTF8);
+		case zj_string::STRING_CONTROL_CHAR:
+			return json_deserialize_error(deserialize_data,str_error,line,DESERIALIZE_ERROR_CONTROL_CHAR);
+		default:
+			break;
 		}
+
+		return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_STRING_NOT_CLOSED);
 	}
 
-	char * read_string_between_quotes(DeserializeData *deserialize_data, const char *str_start,int & line, std::string * str_out){
-		char *str_current = (char *) str_start;
-		size_t str_size;
+	// Reads a string between quotes and returns in str_out/str_out_len its content. If it has
+	// no escapes nor utf-8 to check, that is the common case, it's a view inside the source
+	// buffer and no copy is done. Otherwise it's decoded in str_decoded and the view points
+	// there, or it's only validated if str_decoded is NULL.
+	char * read_string_between_quotes(DeserializeData *deserialize_data, const char *str_start,int & line, const char **str_out, size_t *str_out_len, std::string *str_decoded){
+		const char *str_current = str_start+1;
+		const char *str_value=str_current;
+		size_t str_value_len;
+
+		if (*str_start != '\"'){ // try to single quote...
+			return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_EXPECTED_STRING);
+		}
+
+		// find closing quote in bulk (new lines are not allowed)
+		str_current=zj_scan::find_class(str_current,zj_string::STRING_SPECIAL_CLASSES);
+		str_value_len=str_current-str_value;
+
+		if(*str_current != '\"'){
+			zj_string::StringError error;
+
+			if(str_decoded != NULL){
+				str_decoded->assign(str_value,str_value_len);
+				error=zj_string::decode(str_current,*str_decoded);
+				str_value=str_decoded->data();
+				str_value_len=str_decoded->size();
+			}else{
+				error=zj_string::validate(str_current);
+			}
+
+			if(error != zj_string::STRING_OK){
+				return string_deserialize_error(deserialize_data,str_start,str_current,line,error);
+			}
+		}
 
 		if(str_out != NULL){
-			*str_out="";
+			*str_out=str_value;
 		}
 
-		if (*str_current == '\"'){ // try to single quote...
-			str_current++;
-			while(*str_current!='\n' && *str_current!='\r' && *str_current!=0 &&  (*str_current=='\"' && *(str_current-1)!='\\')==false){
-				if(str_out != NULL){
-					(*str_out)+=*str_current;
-				}
-				str_current++;
-			}
-		}else{
-			json_deserialize_error(deserialize_data,str_start,line,"expected string value");
+		if(str_out_len != NULL){
+			*str_out_len=str_value_len;
 		}
 
-		if(*str_current != '\"'){
-			json_deserialize_error(deserialize_data,str_start,line,"string value not closed");
+		return ignore_blanks((char *)str_current+1, line);
+	}
+
+	// Reads a string between quotes decoding its escapes in the source buffer, the content is
+	// moved back over the escapes and it ends with '\0', that can overwrite the closing quote.
+	char * read_string_in_situ(DeserializeData *deserialize_data, char *str_start,int & line, std::string_view *str_out){
+		char *str_current=str_start+1;
+		char *str_write=str_current;
+		zj_string::StringError error;
+
+		if (*str_start != '\"'){
+			return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_EXPECTED_STRING);
+		}
+
+		if((error=zj_string::decode_in_situ(str_current,str_write)) != zj_string::STRING_OK){
+			return string_deserialize_error(deserialize_data,str_start,str_current,line,error);
+		}
+
+		*str_write=0;
+		if(str_out != NULL){
+			*str_out=std::string_view(str_start+1,str_write-(str_start+1));
 		}
 
 		return ignore_blanks(str_current+1, line);
@@ -247,7 +364,8 @@ namespace zetjsoncpp{
 		// key in case
 		char *str_current = (char *)str_start;
 		int bytes_readed=0;
-		std::string str_value="";
+		const char *str_value="";
+		size_t str_value_len=0;
 		char *str_end=NULL;
 		bool ok=false;
 		JsonVarType type_data=JsonVarType::JSON_VAR_TYPE_UNKNOWN;
@@ -259,16 +377,40 @@ namespace zetjsoncpp{
 		}
 
 		if (*str_current == '\"') {// try string ...
-			//std::string str_aux;
-			str_current=read_string_between_quotes(deserialize_data,str_current,line,&str_value);
+			if(type_data == JsonVarType::JSON_VAR_TYPE_STRING_VIEW){
+				if(!deserialize_data->in_situ){
+					return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_NOT_IN_SITU,NULL,0,json_var->getTypeStr());
+				}
 
-			if(type_data ==  JsonVarType::JSON_VAR_TYPE_STRING){ // is string, save...
-				*(std::string *)ptr_data = str_value;
+				// decoded in the buffer, the view points to it
+				if((str_current=read_string_in_situ(deserialize_data,str_current,line,(std::string_view *)ptr_data)) == NULL){
+					return NULL;
+				}
 				ok=true;
+			}else{
+				std::string *str_decoded=NULL;
+
+				// a string with escapes is decoded straight in the value
+				if(type_data ==  JsonVarType::JSON_VAR_TYPE_STRING){
+					str_decoded=(std::string *)ptr_data;
+				}
+
+				str_current=read_string_between_quotes(deserialize_data,str_current,line,&str_value,&str_value_len,str_decoded);
+				if(str_current == NULL){
+					return NULL;
+				}
+
+				if(str_decoded != NULL){ // is string, save...
+					if(str_value != str_decoded->data()){
+						str_decoded->assign(str_value,str_value_len);
+					}
+					ok=true;
+				}
 			}
 		}
 		else if (strncmp(str_current, "true", 4)==0) { // true detected ...
-			str_value="true";
+			str_value=str_current;
+			str_value_len=4;
 			str_current+=4;
 			if(type_data ==  JsonVarType::JSON_VAR_TYPE_BOOLEAN){
 				if(ptr_data != NULL){
@@ -278,7 +420,8 @@ namespace zetjsoncpp{
 			}
 		}
 		else if (strncmp(str_current, "false", 5) == 0) {// boolean detected
-			str_value="false";
+			str_value=str_current;
+			str_value_len=5;
 			str_current+=5;
 
 
@@ -292,31 +435,33 @@ namespace zetjsoncpp{
 		}
 		else{ // must a number
 			// try read until next comma
-			char str_char_value[1024]={0};
-
-			str_end = advance_to_one_of_collection_of_char(str_current, (char *)end_char_standard_value, line);
+			str_end = advance_to_one_of_collection_of_char(str_current, end_class_standard_value, line);
 			bytes_readed = str_end - str_current;
 			if (*str_end != 0) {
 				str_end--;
 			}
 
 			if (bytes_readed > 0) {
-				// copy string...
-				strncpy(str_char_value,str_current,bytes_readed);
-				str_value=str_char_value;
+				str_value=str_current;
+				str_value_len=bytes_readed;
 				str_current+=bytes_readed;
 
 
-				float number_value = 0;
-				if(zetjsoncpp::zj_strutils::str_to_float(&number_value,str_value) == zetjsoncpp::zj_strutils::STR_2_NUMBER_SUCCESS){
-					if(type_data ==  JsonVarType::JSON_VAR_TYPE_NUMBER){
-						if(ptr_data!=NULL){
-							*((float *) ptr_data) = number_value;
-						}
-
-						ok=true;
+				// numbers are converted straight from the source buffer
+				if(ptr_data != NULL){
+					switch(type_data){
+					case JsonVarType::JSON_VAR_TYPE_NUMBER:
+						ok=zj_number::parse(str_value,str_value_len,(float *)ptr_data);
+						break;
+					case JsonVarType::JSON_VAR_TYPE_DOUBLE:
+						ok=zj_number::parse(str_value,str_value_len,(double *)ptr_data);
+						break;
+					case JsonVarType::JSON_VAR_TYPE_INT64:
+						ok=zj_number::parse(str_value,str_value_len,(int64_t *)ptr_data);
+						break;
+					default:
+						break;
 					}
-
 				}
 			}
 		}
@@ -329,24 +474,263 @@ namespace zetjsoncpp{
 
 			return str_current;
 		}
-		else{
-			if(json_var != NULL){
 
-				throw deserialize_error_exception(
-						zj_path::get_filename(deserialize_data->filename).c_str()
-						,line,zetjsoncpp::zj_strutils::format(
-								"Cannot parse value \"%s\" as %s"
-								,str_value.c_str()
-								,json_var->getTypeStr()
-						)
-				);
+		return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_INVALID_VALUE,str_value,str_value_len,json_var->getTypeStr());
+	}
 
-			}
+	size_t get_deserialize_threads(unsigned n_threads){
+		if(n_threads == 0){
+			n_threads=std::thread::hardware_concurrency();
 		}
+		return n_threads>0?n_threads:1;
+	}
 
+	typedef struct{
+		const char *str_start; // first char of the element
+		const char *str_end; // ',' or ']' after the element
+		int line; // line at str_start
+	}VectorElement;
+
+	// Finds the elements of a vector from the one that starts at str_start following strings,
+	// comments and nesting as the parser does, and counting lines the same way. It returns the ']'
+	// that closes the vector, or NULL if something is not well formed (the parser reports the error).
+	const char *find_vector_elements(const char *str_start, int & line, std::vector<VectorElement> & elements){
+		const uint16_t structural_classes=zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_OPEN | zj_scan::CHAR_CLASS_CLOSE
+				| zj_scan::CHAR_CLASS_COMMA | zj_scan::CHAR_CLASS_NEW_LINE | zj_scan::CHAR_CLASS_COMMENT;
+		char *str_current=(char *)str_start;
+		int depth=0;
+		VectorElement element;
+
+		element.str_start=str_current;
+		element.line=line;
+
+		for(;;){
+			str_current=(char *)zj_scan::find_class(str_current,structural_classes);
+
+			switch(*str_current){
+			case 0:
+				return NULL;
+			case '\n':
+				line++;
+				str_current++;
+				break;
+			case '\r':
+				str_current++;
+				break;
+			case '\"':
+				// escapes are skipped but not checked, the parser decodes the string later
+				str_current=(char *)zj_scan::find_class(str_current+1,zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_BACKSLASH | zj_scan::CHAR_CLASS_NEW_LINE);
+				while(*str_current == '\\' && *(str_current+1) != 0){
+					str_current=(char *)zj_scan::find_class(str_current+2,zj_scan::CHAR_CLASS_QUOTE | zj_scan::CHAR_CLASS_BACKSLASH | zj_scan::CHAR_CLASS_NEW_LINE);
+				}
+				if(*str_current != '\"'){
+					return NULL;
+				}
+				str_current++;
+				break;
+			case '/':
+				if(is_single_comment(str_current)){
+					str_current=advance_to_char(str_current,'\n');
+				}else if(is_start_comment(str_current)){
+					str_current=advance_to_end_comment(str_current,line);
+					if(!is_end_comment(str_current)){
+						return NULL;
+					}
+					str_current+=2;
+				}else{
+					return NULL;
+				}
+				break;
+			case '{':
+			case '[':
+				depth++;
+				str_current++;
+				break;
+			case '}':
+			case ']':
+				if(depth == 0){
+					if(*str_current != ']'){
+						return NULL;
+					}
+					element.str_end=str_current;
+					elements.push_back(element);
+					return str_current;
+				}
+				depth--;
+				str_current++;
+				break;
+			case ',':
+				if(depth == 0){
+					element.str_end=str_current;
+					elements.push_back(element);
+
+					str_current=ignore_blanks(str_current+1, line);
+					if(*str_current == ']'){ // trailing comma
+						return str_current;
+					}
+					element.str_start=str_current;
+					element.line=line;
+				}else{
+					str_current++;
+				}
+				break;
+			default:
+				str_current++;
+				break;
+			}
+		}
 		return NULL;
 	}
 
+	// Result of parsing a slice of elements
+	typedef struct{
+		JsonVarVectorBuilder *builder;
+		size_t first_error; // index of the first element that failed
+		DeserializeError error; // error of first_error, if there's no error nor exception the parser doesn't agree with find_vector_elements
+		std::exception_ptr exception; // i.e bad_alloc
+	}VectorSlice;
+
+	void deserialize_json_var_vector_slice(DeserializeData *deserialize_data, const std::vector<VectorElement> & elements, size_t first, size_t last, VectorSlice & slice){
+		DeserializeData slice_data=*deserialize_data;
+		slice_data.n_threads=1; // nested vectors are parsed in the current thread
+
+		for(size_t i=first; i < last; i++){
+			int line=elements[i].line;
+
+			try{
+				JsonVar *json_var_property=slice.builder->newJsonVar();
+				char *str_current=deserialize_json_var_object(&slice_data,elements[i].str_start,line,json_var_property);
+
+				if(str_current != NULL){
+					str_current=ignore_blanks(str_current, line);
+					if(*str_current!=',' && *str_current!=']'){
+						str_current=json_deserialize_error(&slice_data, str_current, line, DESERIALIZE_ERROR_EXPECTED_VECTOR_END);
+					}
+				}
+
+				if(str_current == NULL){
+					slice.first_error=i;
+					slice.error=slice_data.error;
+					return;
+				}
+
+				if(str_current != elements[i].str_end){
+					slice.first_error=i;
+					return;
+				}
+			}catch(...){
+				slice.first_error=i;
+				slice.exception=std::current_exception();
+				return;
+			}
+		}
+	}
+
+	// Parses the rest of a vector of objects, from the element at str_start, in several threads. A first
+	// pass finds where each element starts, then the elements are parsed by slices, each one in its own
+	// builder, and they are appended in order. It returns NULL with the error set if an element is wrong,
+	// or NULL without error if the rest has to be parsed sequentially (nothing is appended in that case).
+	char * deserialize_json_var_vector_parallel(DeserializeData *deserialize_data, const char *str_start, int & line, JsonVar *json_var){
+		std::vector<VectorElement> elements;
+		std::vector<VectorSlice> slices;
+		std::vector<std::thread> threads;
+		std::atomic<size_t> next_slice(0);
+		int end_line=line;
+		const char *str_end=find_vector_elements(str_start,end_line,elements);
+
+		if(str_end == NULL){
+			return NULL;
+		}
+
+		size_t n_threads=deserialize_data->n_threads;
+		size_t n_slices=MIN(elements.size(),n_threads*ZJ_PARALLEL_SLICES_PER_THREAD);
+		size_t slice_size=(elements.size()+n_slices-1)/n_slices;
+		n_slices=(elements.size()+slice_size-1)/slice_size;
+
+		for(size_t i=0; i < n_slices; i++){
+			VectorSlice slice;
+			slice.builder=NULL;
+			slice.first_error=elements.size();
+			slices.push_back(slice);
+		}
+
+		auto worker=[&](){
+			size_t i;
+			while((i=next_slice++) < n_slices){
+				size_t last=MIN((i+1)*slice_size,elements.size());
+				deserialize_json_var_vector_slice(deserialize_data,elements,i*slice_size,last,slices[i]);
+			}
+		};
+
+		try{
+			for(size_t i=0; i < n_slices; i++){
+				if((slices[i].builder=json_var->newJsonVarBuilder()) == NULL){ // not supported
+					for(size_t j=0; j < i; j++){
+						delete slices[j].builder;
+					}
+					return NULL;
+				}
+			}
+
+			for(size_t i=1; i < MIN(n_threads,n_slices); i++){
+				threads.push_back(std::thread(worker));
+			}
+		}catch(...){
+			next_slice=n_slices; // stop the threads already started
+			for(size_t i=0; i < threads.size(); i++){
+				threads[i].join();
+			}
+			for(size_t i=0; i < n_slices; i++){
+				delete slices[i].builder;
+			}
+			throw;
+		}
+
+		worker();
+
+		for(size_t i=0; i < threads.size(); i++){
+			threads[i].join();
+		}
+
+		// first slice that failed has the error that the sequential parser would report
+		size_t i_error=0;
+		while(i_error < n_slices && slices[i_error].first_error == elements.size()){
+			i_error++;
+		}
+
+		try{
+			if(i_error < n_slices){
+				if(slices[i_error].exception != NULL){
+					std::rethrow_exception(slices[i_error].exception);
+				}
+
+				// if there's no error the parser doesn't agree with the first pass
+				deserialize_data->error=slices[i_error].error;
+				for(size_t i=0; i < n_slices; i++){
+					delete slices[i].builder;
+				}
+				return NULL;
+			}
+
+			for(size_t i=0; i < n_slices; i++){
+				json_var->appendJsonVars(slices[i].builder);
+			}
+		}catch(...){
+			for(size_t i=0; i < n_slices; i++){
+				delete slices[i].builder;
+			}
+			throw;
+		}
+
+		for(size_t i=0; i < n_slices; i++){
+			delete slices[i].builder;
+		}
+
+		json_var->setParsed(true);
+		line=end_line;
+		return (char *)str_end+1;
+	}
+
 	char * deserialize_json_var_vector(
 			DeserializeData *deserialize_data
 			,const char *str_start
@@ -368,15 +752,24 @@ namespace zetjsoncpp{
 		str_current = ignore_blanks(str_current, line);
 
 		if(*str_current != '['){
-			json_deserialize_error(deserialize_data,str_start,line,"A '[' was expected to parse JsonVarVector type");
-			return 0;
+			return json_deserialize_error(deserialize_data,str_start,line,DESERIALIZE_ERROR_EXPECTED_VECTOR);
 		}
 
 		str_current = ignore_blanks(str_current+1, line);
 
 		if(*str_current != ']'){ // do parsing primitive...
+			bool parallel=deserialize_data->n_threads > 1 && type_data == JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS;
+			size_t n_elements=0;
 
 			do{
+				// the rest of a big vector of objects is parsed in parallel, a small one is never scanned twice
+				if(parallel && n_elements++ == ZJ_PARALLEL_MIN_ELEMENTS){
+					char *str_end=deserialize_json_var_vector_parallel(deserialize_data, str_current, line, json_var);
+					if(str_end != NULL || deserialize_data->error){
+						return str_end;
+					}
+				}
+
 				JsonVar *json_var_property = NULL;
 				if(json_var != NULL){
 					json_var_property = json_var->newJsonVar();
@@ -390,13 +783,16 @@ namespace zetjsoncpp{
 					str_current=deserialize_json_var(deserialize_data,str_current,line,json_var);
 				}
 
+				if(str_current == NULL){
+					return NULL;
+				}
+
 				str_current = ignore_blanks(str_current, line);
 
 				if(*str_current==','){
 					str_current = ignore_blanks(str_current+1, line);
 				}else if(*str_current!=']'){
-					json_deserialize_error(deserialize_data, str_current, line,  "Expected ',' or ']'");
-					return 0;
+					return json_deserialize_error(deserialize_data, str_current, line, DESERIALIZE_ERROR_EXPECTED_VECTOR_END);
 				}
 
 			}while(*str_current != ']');
@@ -411,19 +807,25 @@ namespace zetjsoncpp{
 
 	char * deserialize_json_var_object(DeserializeData *deserialize_data, const char * str_start, int & line, JsonVar *json_var) {
 		char *str_current = (char *)str_start;
-		std::string variable_name,key_id;
+		const char *key_id=NULL;
+		size_t key_id_len=0;
+		std::string key_decoded; // for keys with escapes
+		int property_index=-1;
 		std::string error;
 		JsonVarType type=JsonVarType::JSON_VAR_TYPE_UNKNOWN;
+		const JsonVarPropertyTable *property_table=NULL;
 
 		if(json_var != NULL){
 			type=json_var->getType();
+			property_table=json_var->getPropertyTable();
 		}
 
+		ParsedProperties parsed_properties(property_table!=NULL?property_table->size():0);
+
 		str_current = ignore_blanks(str_current, line);
 
 		if(*str_current != '{'){
-			json_deserialize_error(deserialize_data, str_start, line, "A '{' was expected to parse %s type",json_var!=NULL?json_var->getTypeStr():"");
-			return NULL;
+			return json_deserialize_error(deserialize_data, str_start, line, DESERIALIZE_ERROR_EXPECTED_OBJECT, NULL, 0, json_var!=NULL?json_var->getTypeStr():"");
 		}
 
 		str_current = ignore_blanks(str_current+1, line);
@@ -431,45 +833,47 @@ namespace zetjsoncpp{
 		if(*str_current != '}'){ // do parsing object values...
 			do{
 				JsonVar *json_var_property=NULL;
-				str_current =read_string_between_quotes(deserialize_data, str_current, line, &key_id);
-				if (*str_current != ':') {// ok check value
-					json_deserialize_error(deserialize_data, str_current, line, "Error ':' expected");
+				str_current =read_string_between_quotes(deserialize_data, str_current, line, &key_id, &key_id_len, &key_decoded);
+				if(str_current == NULL){
 					return NULL;
 				}
 
+				if (*str_current != ':') {// ok check value
+					return json_deserialize_error(deserialize_data, str_current, line, DESERIALIZE_ERROR_EXPECTED_COLON);
+				}
+
 				str_current = ignore_blanks(str_current + 1, line);
 
 				// get c property
 				if(json_var==NULL || type == JsonVarType::JSON_VAR_TYPE_OBJECT){ // parse json object
-					json_var_property = find_property(json_var, key_id);
+					json_var_property = find_property(json_var, key_id, key_id_len, property_index);
 					if (json_var_property != NULL){
-						if (json_var_property->isDeserialized()) {
-							json_deserialize_error(deserialize_data, str_current, line,"property name \"%s\" already exist", key_id.c_str());
-							return NULL;
+						if (parsed_properties.testAndSet(property_index)) {
+							return json_deserialize_error(deserialize_data, str_current, line, DESERIALIZE_ERROR_DUPLICATED_PROPERTY, key_id, key_id_len);
 						}
 					}
 
 				}else{ // parse map...
 					if(json_var != NULL){
 						try{
-							json_var_property = json_var->newJsonVar(key_id);
+							json_var_property = json_var->newJsonVar(std::string(key_id,key_id_len));
 						}catch(std::exception &ex){
-							json_deserialize_error(deserialize_data, str_current, line,ex.what());
-							return NULL;
+							return json_deserialize_error(deserialize_data, str_current, line, DESERIALIZE_ERROR_INVALID_KEY, ex.what(), strlen(ex.what()));
 						}
 					}
 				}
 
 				str_current=deserialize_json_var(deserialize_data, str_current, line, json_var_property);
-
+				if(str_current == NULL){
+					return NULL;
+				}
 
 				str_current = ignore_blanks(str_current, line);
 
 				if(*str_current==','){
 					str_current = ignore_blanks(str_current+1, line);
 				}else if(*str_current!='}'){
-					json_deserialize_error(deserialize_data, str_current, line, "Expected ',' or '}'");
-					return NULL;
+					return json_deserialize_error(deserialize_data, str_current, line, DESERIALIZE_ERROR_EXPECTED_OBJECT_END);
 				}
 
 			}while(*str_current != '}');
@@ -490,6 +894,15 @@ namespace zetjsoncpp{
 		str_current = ignore_blanks(str_current, line);
 
 		if(json_var == NULL){ // continue parse file/string
+			// not mapped objects and vectors are skipped if it's asked (see deserialize_skip_unmapped),
+			// and parsed only to report their error
+			if(deserialize_data->skip_unmapped && (*str_current == '[' || *str_current == '{')){
+				const char *str_end=zj_scan::skip_container(str_current,line);
+				if(str_end != NULL){
+					return (char *)str_end;
+				}
+			}
+
 			//try to deduce ...
 			if(*str_current == '['){ // try parse vector
 				str_current=deserialize_json_var_vector(deserialize_data, str_current, line,json_var);
@@ -504,11 +917,16 @@ namespace zetjsoncpp{
 			switch(json_var->getType()){
 			case JsonVarType::JSON_VAR_TYPE_BOOLEAN:
 			case JsonVarType::JSON_VAR_TYPE_NUMBER:
+			case JsonVarType::JSON_VAR_TYPE_DOUBLE:
+			case JsonVarType::JSON_VAR_TYPE_INT64:
 			case JsonVarType::JSON_VAR_TYPE_STRING:
+			case JsonVarType::JSON_VAR_TYPE_STRING_VIEW:
 				str_current=deserialize_json_var_value(deserialize_data,str_current,line,json_var);
 				break;
 			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
 			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_DOUBLES:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_INT64S:
 			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_STRINGS:
 			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
 				str_current=deserialize_json_var_vector(deserialize_data, str_current, line, json_var);
@@ -516,6 +934,8 @@ namespace zetjsoncpp{
 			default: // tries to parse a map of values or object
 			case JsonVarType::JSON_VAR_TYPE_MAP_OF_BOOLEANS:
 			case JsonVarType::JSON_VAR_TYPE_MAP_OF_NUMBERS:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_DOUBLES:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_INT64S:
 			case JsonVarType::JSON_VAR_TYPE_MAP_OF_STRINGS:
 			case JsonVarType::JSON_VAR_TYPE_MAP_OF_OBJECTS:
 			case JsonVarType::JSON_VAR_TYPE_OBJECT:
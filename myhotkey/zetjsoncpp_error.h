@@ -0,0 +1,88 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#ifndef __ZJ_ERROR_H__
+#define __ZJ_ERROR_H__
+
+// chars of the error detail (value, key or message) kept to build the message
+#define ZJ_DESERIALIZE_ERROR_DETAIL_SIZE	256
+
+namespace zetjsoncpp {
+
+	typedef enum:uint8_t{
+		DESERIALIZE_ERROR_NONE=0,
+		DESERIALIZE_ERROR_EXPECTED_STRING,
+		DESERIALIZE_ERROR_STRING_NOT_CLOSED,
+		DESERIALIZE_ERROR_INVALID_VALUE, // detail is the value
+		DESERIALIZE_ERROR_EXPECTED_VECTOR,
+		DESERIALIZE_ERROR_EXPECTED_OBJECT,
+		DESERIALIZE_ERROR_EXPECTED_COLON,
+		DESERIALIZE_ERROR_EXPECTED_VECTOR_END, // ',' or ']'
+		DESERIALIZE_ERROR_EXPECTED_OBJECT_END, // ',' or '}'
+		DESERIALIZE_ERROR_DUPLICATED_PROPERTY, // detail is the property name
+		DESERIALIZE_ERROR_INVALID_KEY, // the map rejected the key, detail is its message
+		DESERIALIZE_ERROR_UNEXPECTED_CHAR, // detail is the char
+		DESERIALIZE_ERROR_UNEXPECTED_END,
+		DESERIALIZE_ERROR_FILE, // the file cannot be read, detail is the message
+		DESERIALIZE_ERROR_SNAPSHOT_STALE, // binary snapshot of other schema, format version, byte order or source
+		DESERIALIZE_ERROR_SNAPSHOT_CORRUPT, // binary snapshot truncated or not a snapshot
+		DESERIALIZE_ERROR_INVALID_ESCAPE, // detail is the escape sequence
+		DESERIALIZE_ERROR_NOT_IN_SITU, // a JsonVarStringView is deserialized from a buffer it cannot point to
+		DESERIALIZE_ERROR_INVALID_UTF8, // a string has bytes that are not utf-8
+		DESERIALIZE_ERROR_CONTROL_CHAR // a string has a control char that is not escaped
+	}DeserializeErrorCode;
+
+	// Error of the non throwing deserialize functions. Only the code, the offset and the line
+	// are set while parsing, the column and the message are built when they are asked for.
+	class DeserializeError{
+	public:
+
+		DeserializeErrorCode code;
+		size_t offset; // bytes from the start of the input to the place of the error
+		int line;
+
+		DeserializeError(){
+			clear();
+		}
+
+		void clear(){
+			code=DESERIALIZE_ERROR_NONE;
+			offset=0;
+			line=0;
+			type_str=NULL;
+			detail_len=0;
+		}
+
+		operator bool() const{
+			return code != DESERIALIZE_ERROR_NONE;
+		}
+
+		// detail is truncated to ZJ_DESERIALIZE_ERROR_DETAIL_SIZE chars
+		void set(DeserializeErrorCode _code, size_t _offset, int _line, const char *_detail=NULL, size_t _detail_len=0, const char *_type_str=NULL){
+			code=_code;
+			offset=_offset;
+			line=_line;
+			type_str=_type_str;
+			detail_len=_detail_len<sizeof(detail)?_detail_len:sizeof(detail);
+			if(detail_len > 0){
+				memcpy(detail,_detail,detail_len);
+			}
+		}
+
+		// column (from 1) of offset in input, that must be the parsed input
+		int getColumn(const char *input) const;
+
+		std::string getMessage() const;
+
+	private:
+		const char *type_str; // type of the JsonVar, for the errors of values
+		size_t detail_len;
+		char detail[ZJ_DESERIALIZE_ERROR_DETAIL_SIZE];
+	};
+
+	// throws the error as deserialize_error_exception, as the throwing deserialize functions do
+	void throw_deserialize_error(const DeserializeError & error, const char *filename);
+};
+
+#endif
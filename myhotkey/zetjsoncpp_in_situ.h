@@ -0,0 +1,41 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#ifndef __ZJ_IN_SITU_H__
+#define __ZJ_IN_SITU_H__
+
+namespace zetjsoncpp {
+
+	// Document deserialized in situ from a private mapping of a file (see deserialize_file_in_situ).
+	// The JsonVarStringViews of the root point to the mapping, so they're valid while the
+	// document is: the destructor deletes the root and then unmaps the file.
+	template<typename _T>
+	class JsonInSituDocument{
+	public:
+
+		JsonInSituDocument(_T *root, const zj_file::MappedFile & mapped_file){
+			__zj_root__=root;
+			__zj_mapped_file__=mapped_file;
+		}
+
+		_T *getRoot(){
+			return __zj_root__;
+		}
+
+		~JsonInSituDocument(){
+			delete __zj_root__;
+			zj_file::unmap(__zj_mapped_file__);
+		}
+
+	private:
+
+		_T *__zj_root__;
+		zj_file::MappedFile __zj_mapped_file__;
+
+		JsonInSituDocument(const JsonInSituDocument &);
+		JsonInSituDocument & operator =(const JsonInSituDocument &);
+	};
+};
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "zetjsoncpp.h"
+
+// objects with more properties are searched through a hash of their keys
+#define ZJ_LAZY_KEY_INDEX_MIN_PROPERTIES	16
+
+namespace zetjsoncpp{
+
+	// line (from 1) of str
+	static int get_line(const char *str_start, const char *str){
+		int line=1;
+
+		for(const char *str_line=str_start; (str_line=(const char *)memchr(str_line,'\n',str-str_line)) != NULL; str_line++){
+			line++;
+		}
+
+		return line;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// JsonTape
+
+	bool JsonTape::build(const char *str_start, const char *str_begin, DeserializeError & error){
+		std::vector<uint32_t> containers; // open objects and vectors
+		DeserializeErrorCode error_code;
+		int line=1; // lines are counted on error only
+		const char *str_current;
+
+		__zj_tokens__.clear();
+		error.clear();
+
+		str_current=ignore_blanks((char *)str_begin,line);
+		if(*str_current != '{'){
+			error.set(*str_current==0?DESERIALIZE_ERROR_UNEXPECTED_END:DESERIALIZE_ERROR_EXPECTED_OBJECT,str_current-str_start,get_line(str_start,str_current));
+			return false;
+		}
+
+		zj_scan::BracketScanner scanner(str_current);
+
+		while((str_current=scanner.next()) != NULL){
+			if(*str_current == '{' || *str_current == '['){
+				JsonTapeToken token;
+
+				if(__zj_tokens__.size() >= UINT32_MAX){
+					throw std::runtime_error("too many objects and vectors");
+				}
+
+				if(containers.size() > 0){
+					__zj_tokens__[containers.back()].n_children++;
+				}
+
+				token.offset=str_current-str_start;
+				token.end=0;
+				token.next=0;
+				token.n_children=0;
+				containers.push_back((uint32_t)__zj_tokens__.size());
+				__zj_tokens__.push_back(token);
+			}else{ // '}' or ']'
+				JsonTapeToken & token=__zj_tokens__[containers.back()];
+
+				if(*str_current != (str_start[token.offset]=='{'?'}':']')){
+					error_code=str_start[token.offset]=='{'?DESERIALIZE_ERROR_EXPECTED_OBJECT_END:DESERIALIZE_ERROR_EXPECTED_VECTOR_END;
+					error.set(error_code,str_current-str_start,get_line(str_start,str_current));
+					return false;
+				}
+
+				token.end=str_current-str_start;
+				token.next=(uint32_t)__zj_tokens__.size();
+				containers.pop_back();
+
+				if(containers.size() == 0){ // end of the document
+					return true;
+				}
+			}
+		}
+
+		// new line in a string, end of input or '/' that doesn't start a comment
+		str_current=scanner.getStop();
+		if(scanner.isInString()){
+			error_code=DESERIALIZE_ERROR_STRING_NOT_CLOSED;
+		}else if(*str_current == 0){
+			error_code=DESERIALIZE_ERROR_UNEXPECTED_END;
+		}else{
+			error_code=DESERIALIZE_ERROR_UNEXPECTED_CHAR;
+		}
+
+		error.set(error_code,str_current-str_start,get_line(str_start,str_current),str_current,error_code==DESERIALIZE_ERROR_UNEXPECTED_CHAR?1:0);
+		return false;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// JsonLazyDocument
+
+	JsonLazyDocument::JsonLazyDocument(const zj_file::MappedFile & mapped_file, const char *str_current, const char *filename){
+		__zj_mapped_file__=mapped_file;
+		__zj_str_current__=str_current;
+		if(filename != NULL){
+			__zj_filename__=filename;
+		}
+	}
+
+	bool JsonLazyDocument::build(DeserializeError & error){
+		return __zj_tape__.build(__zj_mapped_file__.buffer,__zj_str_current__,error);
+	}
+
+	void JsonLazyDocument::throwError(DeserializeError error){
+		// the lines of the values are only counted from where they're parsed, and the ones of
+		// the skipped objects and vectors are not counted at all, so it's taken from the offset
+		error.line=get_line(__zj_mapped_file__.buffer,__zj_mapped_file__.buffer+error.offset);
+		throw_deserialize_error(error,__zj_filename__.size()>0?__zj_filename__.c_str():NULL);
+	}
+
+	void JsonLazyDocument::deserialize(size_t offset, JsonVar *json_var){
+		DeserializeData deserialize_data;
+		const char *str_value=__zj_mapped_file__.buffer+offset;
+		int line=0;
+
+		deserialize_data.filename=NULL;
+		deserialize_data.str_start=__zj_mapped_file__.buffer;
+		deserialize_data.n_threads=1;
+		deserialize_data.in_situ=false;
+		deserialize_data.skip_unmapped=false;
+
+		if(deserialize_json_var(&deserialize_data,str_value,line,json_var) == NULL){
+			throwError(deserialize_data.error);
+		}
+	}
+
+	const std::vector<JsonLazyValue> & JsonLazyDocument::getValues(uint32_t token){
+		auto it=__zj_values__.find(token);
+		if(it != __zj_values__.end()){
+			return it->second;
+		}
+
+		DeserializeData deserialize_data;
+		const JsonTapeToken & container=__zj_tape__.at(token);
+		char *str_container=__zj_mapped_file__.buffer+container.offset;
+		bool is_object=*str_container == '{';
+		char end_char=is_object?'}':']';
+		uint32_t child=token+1; // next object or vector inside it
+		std::vector<JsonLazyValue> values;
+		JsonLazyValue value;
+		int line=0;
+		char *str_current=ignore_blanks(str_container+1,line);
+
+		deserialize_data.filename=NULL;
+		deserialize_data.str_start=__zj_mapped_file__.buffer;
+		deserialize_data.n_threads=1;
+		deserialize_data.in_situ=false;
+		deserialize_data.skip_unmapped=false;
+
+		while(*str_current != end_char){
+			if(is_object){ // key
+				const char *str_key;
+				size_t str_key_len;
+				std::string key_decoded;
+
+				if((str_current=read_string_between_quotes(&deserialize_data,str_current,line,&str_key,&str_key_len,&key_decoded)) == NULL){
+					throwError(deserialize_data.error);
+				}
+
+				if(*str_current != ':'){
+					json_deserialize_error(&deserialize_data,str_current,line,DESERIALIZE_ERROR_EXPECTED_COLON);
+					throwError(deserialize_data.error);
+				}
+
+				if(str_key == key_decoded.data()){ // keep it while the document is alive
+					__zj_decoded_keys__.push_back(std::move(key_decoded));
+					str_key=__zj_decoded_keys__.back().data();
+				}
+
+				value.key=std::string_view(str_key,str_key_len);
+				str_current=ignore_blanks(str_current+1,line);
+			}
+
+			value.offset=str_current-__zj_mapped_file__.buffer;
+			value.token=ZJ_TAPE_NO_TOKEN;
+
+			switch(*str_current){
+			case '{':
+			case '[':
+				// the tape has all the objects and vectors in input order
+				value.token=child;
+				str_current=ignore_blanks(__zj_mapped_file__.buffer+__zj_tape__.at(child).end+1,line);
+				child=__zj_tape__.at(child).next;
+				break;
+			case '\"':
+				if((str_current=read_string_between_quotes(&deserialize_data,str_current,line,NULL,NULL,NULL)) == NULL){
+					throwError(deserialize_data.error);
+				}
+				break;
+			default: // primitive, it is converted when it's deserialized
+				{
+					char *str_end=advance_to_one_of_collection_of_char(str_current,end_class_standard_value,line);
+					if(str_end == str_current){
+						json_deserialize_error(&deserialize_data,str_current,line,DESERIALIZE_ERROR_UNEXPECTED_CHAR,str_current,1);
+						throwError(deserialize_data.error);
+					}
+					str_current=ignore_blanks(str_end,line);
+				}
+				break;
+			}
+
+			values.push_back(value);
+
+			if(*str_current == ','){
+				str_current=ignore_blanks(str_current+1,line); // trailing comma is allowed
+			}else if(*str_current != end_char){
+				json_deserialize_error(&deserialize_data,str_current,line,is_object?DESERIALIZE_ERROR_EXPECTED_OBJECT_END:DESERIALIZE_ERROR_EXPECTED_VECTOR_END);
+				throwError(deserialize_data.error);
+			}
+		}
+
+		return __zj_values__.emplace(token,std::move(values)).first->second;
+	}
+
+	const JsonLazyValue *JsonLazyDocument::findProperty(uint32_t token, std::string_view name){
+		if(__zj_mapped_file__.buffer[__zj_tape__.at(token).offset] != '{'){
+			return NULL;
+		}
+
+		const std::vector<JsonLazyValue> & properties=getValues(token);
+
+		if(properties.size() < ZJ_LAZY_KEY_INDEX_MIN_PROPERTIES){
+			for(size_t i=0; i < properties.size(); i++){
+				if(properties[i].key == name){
+					return &properties[i];
+				}
+			}
+			return NULL;
+		}
+
+		auto it=__zj_keys__.find(token);
+		if(it == __zj_keys__.end()){
+			it=__zj_keys__.emplace(token,std::unordered_map<std::string_view, uint32_t>()).first;
+			it->second.reserve(properties.size());
+			for(size_t i=0; i < properties.size(); i++){
+				it->second.emplace(properties[i].key,(uint32_t)i); // the first one if it's duplicated
+			}
+		}
+
+		auto it_key=it->second.find(name);
+		return it_key != it->second.end()?&properties[it_key->second]:NULL;
+	}
+
+	JsonLazyDocument::~JsonLazyDocument(){
+		for(auto it=__zj_objects__.begin(); it != __zj_objects__.end(); it++){
+			delete it->second;
+		}
+		zj_file::unmap(__zj_mapped_file__);
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// deserialize_lazy
+
+	JsonLazyDocument * deserialize_lazy(const zj_file::MappedFile & mapped_file, const char *filename, DeserializeError & error){
+		JsonLazyDocument *document=NULL;
+		char *aux_p=mapped_file.buffer;
+		uint8_t bom_signature[]={0xef,0xbb,0xbf};
+
+		if(mapped_file.size >= sizeof(bom_signature) && memcmp(aux_p,bom_signature,sizeof(bom_signature))==0){ // ignore BOM signature
+			aux_p+=sizeof(bom_signature);
+		}
+
+		try{
+			document=new JsonLazyDocument(mapped_file,aux_p,filename);
+		}catch(...){
+			zj_file::MappedFile aux_mapped_file=mapped_file;
+			zj_file::unmap(aux_mapped_file);
+			throw;
+		}
+
+		try{
+			if(!document->build(error)){
+				delete document;
+				return NULL;
+			}
+		}catch(...){ // not a parse error (i.e bad_alloc)
+			delete document;
+			throw;
+		}
+
+		return document;
+	}
+
+	JsonLazyDocument * deserialize_lazy(const std::string & expression, DeserializeError & error){
+		zj_file::MappedFile mapped_file;
+
+		mapped_file.size=expression.size();
+		mapped_file.mapped_size=0;
+		mapped_file.buffer=(char *)malloc(mapped_file.size+1);
+		if(mapped_file.buffer == NULL){
+			throw std::bad_alloc();
+		}
+		memcpy(mapped_file.buffer,expression.c_str(),mapped_file.size+1);
+
+		return deserialize_lazy(mapped_file,NULL,error);
+	}
+
+	JsonLazyDocument * deserialize_lazy(const std::string & expression){
+		DeserializeError error;
+		JsonLazyDocument *document=deserialize_lazy(expression,error);
+
+		if(document == NULL){
+			throw_deserialize_error(error,NULL);
+		}
+
+		return document;
+	}
+
+	JsonLazyDocument * deserialize_file_lazy(const std::string & _filename, DeserializeError & error){
+		zj_file::MappedFile mapped_file;
+
+		try{
+			mapped_file = zj_file::map(_filename);
+		}catch(std::runtime_error & ex){
+			error.set(DESERIALIZE_ERROR_FILE,0,0,ex.what(),strlen(ex.what()));
+			return NULL;
+		}
+
+		return deserialize_lazy(mapped_file,_filename.c_str(),error);
+	}
+
+	JsonLazyDocument * deserialize_file_lazy(const std::string & _filename){
+		DeserializeError error;
+		JsonLazyDocument *document=deserialize_file_lazy(_filename,error);
+
+		if(document == NULL){
+			throw_deserialize_error(error,_filename.c_str());
+		}
+
+		return document;
+	}
+}
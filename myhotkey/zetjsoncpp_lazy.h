@@ -0,0 +1,330 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#ifndef __ZJ_LAZY_H__
+#define __ZJ_LAZY_H__
+
+// JsonLazyValue::token of the values that are not objects or vectors
+#define ZJ_TAPE_NO_TOKEN	UINT32_MAX
+
+namespace zetjsoncpp {
+
+	template<typename _T_DATA>
+	class JsonLazyObject;
+
+	template<typename _T_DATA>
+	class JsonLazyVector;
+
+	template<typename _T_DATA>
+	class JsonLazyMap;
+
+	// Object or vector of the input
+	typedef struct{
+		size_t offset; // of '{' or '['
+		size_t end; // offset of the '}' or ']' that closes it
+		uint32_t next; // index of the token after it and all its children
+		uint32_t n_children; // objects and vectors right inside it
+	}JsonTapeToken;
+
+	// Property of an object or element of a vector of the input, found the first time its container is visited
+	typedef struct{
+		std::string_view key; // decoded, empty for elements of vectors
+		size_t offset; // of the value
+		uint32_t token; // if the value is an object or a vector, ZJ_TAPE_NO_TOKEN otherwise
+	}JsonLazyValue;
+
+	// Structural index of a document: its objects and vectors in the order they are opened,
+	// nesting is known through JsonTapeToken::next. It's built in one pass that only looks
+	// for quotes, comments and brackets (see zj_scan::BracketScanner), so the rest of the input is skipped
+	// in bulk. Keys, values, colons and commas are checked when their container is visited.
+	class JsonTape{
+	public:
+
+		// returns false and sets error if the document is not well formed. str_start must be NUL terminated.
+		bool build(const char *str_start, const char *str_current, DeserializeError & error);
+
+		size_t size() const { return __zj_tokens__.size(); }
+
+		const JsonTapeToken & at(uint32_t index) const { return __zj_tokens__[index]; }
+
+	private:
+		std::vector<JsonTapeToken> __zj_tokens__;
+	};
+
+	// Document deserialized on demand (see deserialize_lazy). Only the tape is built up front,
+	// values are deserialized into JsonVars the first time they are asked through the views
+	// JsonLazyObject, JsonLazyVector and JsonLazyMap, and then cached in the document.
+	// The views are valid while the document is, and they are not thread safe.
+	class JsonLazyDocument{
+	public:
+
+		// takes the ownership of buffer, that is freed as mapped_file
+		JsonLazyDocument(const zj_file::MappedFile & mapped_file, const char *str_current, const char *filename=NULL);
+
+		// builds the tape, it returns false and sets error if the document is not well formed
+		bool build(DeserializeError & error);
+
+		const JsonTape & getTape() const { return __zj_tape__; }
+
+		const char *getInput() const { return __zj_mapped_file__.buffer; }
+
+		// the root value
+		template<typename _T_DATA>
+		JsonLazyObject<_T_DATA> getRoot();
+
+		// deserializes the value at offset into json_var. It throws deserialize_error_exception on error.
+		void deserialize(size_t offset, JsonVar *json_var);
+
+		// properties of the object or elements of the vector token, in input order. It throws
+		// deserialize_error_exception if they are not well formed.
+		const std::vector<JsonLazyValue> & getValues(uint32_t token);
+
+		// the property of the object token, or NULL if not exist. If it's duplicated the first one.
+		const JsonLazyValue *findProperty(uint32_t token, std::string_view name);
+
+		// the JsonVarObject cached for token, created empty the first time
+		template<typename _T_DATA>
+		JsonVarObject<_T_DATA> *getJsonVarObject(uint32_t token){
+			auto it=__zj_objects__.find(token);
+			if(it != __zj_objects__.end()){
+				JsonVarObject<_T_DATA> *json_object=dynamic_cast<JsonVarObject<_T_DATA> *>(it->second);
+				if(json_object == NULL){
+					throw std::runtime_error("value already deserialized as other type");
+				}
+				return json_object;
+			}
+
+			JsonVarObject<_T_DATA> *json_object=new JsonVarObject<_T_DATA>();
+			try{
+				__zj_objects__[token]=json_object;
+			}catch(...){
+				delete json_object;
+				throw;
+			}
+			return json_object;
+		}
+
+		~JsonLazyDocument();
+
+	private:
+		zj_file::MappedFile __zj_mapped_file__;
+		const char *__zj_str_current__; // start of the document, after the BOM
+		std::string __zj_filename__;
+		JsonTape __zj_tape__;
+		std::unordered_map<uint32_t, JsonVar *> __zj_objects__;
+		std::unordered_map<uint32_t, std::vector<JsonLazyValue>> __zj_values__;
+		std::unordered_map<uint32_t, std::unordered_map<std::string_view, uint32_t>> __zj_keys__; // of objects with many properties
+		std::deque<std::string> __zj_decoded_keys__; // keys with escapes, the rest point to the input
+
+		void throwError(DeserializeError error);
+
+		JsonLazyDocument(const JsonLazyDocument &);
+		JsonLazyDocument & operator=(const JsonLazyDocument &);
+	};
+
+	// View of an object of the document. Properties are deserialized one by one the first time
+	// they are asked, i.e. object.get(&Data::name). Properties that are objects, vectors of
+	// objects or maps of objects can be also visited lazily with getObject, getVector and getMap.
+	// Their views deserialize into JsonVarObjects of their own, detached from the property: a
+	// later get(&Data::property) or get() deserializes the property again into the parent, so
+	// changes made through one of the copies are not seen through the other.
+	template<typename _T_DATA>
+	class JsonLazyObject{
+	public:
+
+		JsonLazyObject(JsonLazyDocument *document, uint32_t token){
+			__zj_document__=document;
+			__zj_token__=token;
+		}
+
+		// the property, deserialized if it's not yet. It is left as default if it's not in the input.
+		template<typename _T_JSON_VAR>
+		_T_JSON_VAR & get(_T_JSON_VAR _T_DATA::*property){
+			_T_JSON_VAR *json_var=&(getJsonVarObject()->*property);
+
+			if(!json_var->isDeserialized()){
+				const JsonLazyValue *value=__zj_document__->findProperty(__zj_token__,json_var->getVariableName());
+				if(value != NULL){
+					__zj_document__->deserialize(value->offset,json_var);
+				}
+			}
+
+			return *json_var;
+		}
+
+		template<typename _T_CHILD, char... _T_NAME>
+		JsonLazyObject<_T_CHILD> getObject(JsonVarObject<_T_CHILD,_T_NAME...> _T_DATA::*property){
+			return JsonLazyObject<_T_CHILD>(__zj_document__,findProperty(JsonVarObject<_T_CHILD,_T_NAME...>::VARIABLE_NAME,JsonVarObject<_T_CHILD,_T_NAME...>::VARIABLE_NAME_LEN,'{'));
+		}
+
+		template<typename _T_CHILD, char... _T_NAME>
+		JsonLazyVector<_T_CHILD> getVector(JsonVarVectorObject<_T_CHILD,_T_NAME...> _T_DATA::*property);
+
+		template<template<typename> class _T_STORAGE, typename _T_CHILD, char... _T_NAME>
+		JsonLazyMap<_T_CHILD> getMap(JsonVarBasicMapObject<_T_STORAGE,_T_CHILD,_T_NAME...> _T_DATA::*property);
+
+		// the whole object, the properties that are not deserialized yet are deserialized
+		JsonVarObject<_T_DATA> & get(){
+			JsonVarObject<_T_DATA> *json_object=getJsonVarObject();
+
+			if(!json_object->isDeserialized()){
+				const JsonVarPropertyTable *property_table=json_object->getPropertyTable();
+				for(size_t i=0; i < property_table->size(); i++){
+					JsonVar *json_var=(JsonVar *)((char *)json_object->getPtrDataStart()+property_table->at(i).offset);
+					if(!json_var->isDeserialized()){
+						const JsonLazyValue *value=__zj_document__->findProperty(__zj_token__,property_table->at(i).name);
+						if(value != NULL){
+							__zj_document__->deserialize(value->offset,json_var);
+						}
+					}
+				}
+				json_object->setParsed(true);
+			}
+
+			return *json_object;
+		}
+
+		uint32_t getToken() const { return __zj_token__; }
+
+	private:
+		JsonLazyDocument *__zj_document__;
+		uint32_t __zj_token__;
+
+		JsonVarObject<_T_DATA> *getJsonVarObject(){
+			return __zj_document__->getJsonVarObject<_T_DATA>(__zj_token__);
+		}
+
+		// token of the property, that has to start with open_char
+		uint32_t findProperty(const char *name, size_t name_len, char open_char){
+			const JsonLazyValue *value=__zj_document__->findProperty(__zj_token__,std::string_view(name,name_len));
+
+			if(value == NULL){
+				throw std::out_of_range(zj_strutils::format("property \"%.*s\" not found",(int)name_len,name));
+			}
+
+			if(value->token == ZJ_TAPE_NO_TOKEN || __zj_document__->getInput()[value->offset] != open_char){
+				throw std::runtime_error(zj_strutils::format("property \"%.*s\" is not a%s",(int)name_len,name,open_char=='{'?"n object":" vector"));
+			}
+
+			return value->token;
+		}
+	};
+
+	// token of the object values[index]
+	inline uint32_t get_lazy_object_token(JsonLazyDocument *document, const std::vector<JsonLazyValue> & values, size_t index){
+		if(index >= values.size()){
+			throw std::out_of_range(zj_strutils::format("index %zu out of range (size %zu)",index,values.size()));
+		}
+
+		if(values[index].token == ZJ_TAPE_NO_TOKEN || document->getInput()[values[index].offset] != '{'){
+			throw std::runtime_error(zj_strutils::format("value %zu is not an object",index));
+		}
+
+		return values[index].token;
+	}
+
+	// View of a vector of objects of the document, elements are deserialized when they are asked.
+	template<typename _T_DATA>
+	class JsonLazyVector{
+	public:
+
+		JsonLazyVector(JsonLazyDocument *document, uint32_t token){
+			__zj_document__=document;
+			__zj_token__=token;
+		}
+
+		size_t size(){
+			return __zj_document__->getValues(__zj_token__).size();
+		}
+
+		JsonLazyObject<_T_DATA> at(size_t index){
+			return JsonLazyObject<_T_DATA>(__zj_document__,get_lazy_object_token(__zj_document__,__zj_document__->getValues(__zj_token__),index));
+		}
+
+		JsonLazyObject<_T_DATA> operator[](size_t index){
+			return at(index);
+		}
+
+	private:
+		JsonLazyDocument *__zj_document__;
+		uint32_t __zj_token__;
+	};
+
+	// View of a map of objects of the document, values are deserialized when they are asked.
+	template<typename _T_DATA>
+	class JsonLazyMap{
+	public:
+
+		JsonLazyMap(JsonLazyDocument *document, uint32_t token){
+			__zj_document__=document;
+			__zj_token__=token;
+		}
+
+		size_t size(){
+			return __zj_document__->getValues(__zj_token__).size();
+		}
+
+		// key of the entry index, in input order
+		std::string_view getKey(size_t index){
+			const std::vector<JsonLazyValue> & values=__zj_document__->getValues(__zj_token__);
+
+			if(index >= values.size()){
+				throw std::out_of_range(zj_strutils::format("index %zu out of range (size %zu)",index,values.size()));
+			}
+
+			return values[index].key;
+		}
+
+		// value of the entry index, in input order
+		JsonLazyObject<_T_DATA> at(size_t index){
+			return JsonLazyObject<_T_DATA>(__zj_document__,get_lazy_object_token(__zj_document__,__zj_document__->getValues(__zj_token__),index));
+		}
+
+		size_t count(const std::string & key){
+			return __zj_document__->findProperty(__zj_token__,key) != NULL ? 1 : 0;
+		}
+
+		JsonLazyObject<_T_DATA> at(const std::string & key){
+			const JsonLazyValue *value=__zj_document__->findProperty(__zj_token__,key);
+
+			if(value == NULL){
+				throw std::out_of_range(zj_strutils::format("key \"%s\" not found",key.c_str()));
+			}
+
+			if(value->token == ZJ_TAPE_NO_TOKEN || __zj_document__->getInput()[value->offset] != '{'){
+				throw std::runtime_error(zj_strutils::format("value of key \"%s\" is not an object",key.c_str()));
+			}
+
+			return JsonLazyObject<_T_DATA>(__zj_document__,value->token);
+		}
+
+		JsonLazyObject<_T_DATA> operator[](const std::string & key){
+			return at(key);
+		}
+
+	private:
+		JsonLazyDocument *__zj_document__;
+		uint32_t __zj_token__;
+	};
+
+	template<typename _T_DATA>
+	JsonLazyObject<_T_DATA> JsonLazyDocument::getRoot(){
+		// the tape is not built if the root is not an object
+		return JsonLazyObject<_T_DATA>(this,0);
+	}
+
+	template<typename _T_DATA>
+	template<typename _T_CHILD, char... _T_NAME>
+	JsonLazyVector<_T_CHILD> JsonLazyObject<_T_DATA>::getVector(JsonVarVectorObject<_T_CHILD,_T_NAME...> _T_DATA::*property){
+		return JsonLazyVector<_T_CHILD>(__zj_document__,findProperty(JsonVarVectorObject<_T_CHILD,_T_NAME...>::VARIABLE_NAME,JsonVarVectorObject<_T_CHILD,_T_NAME...>::VARIABLE_NAME_LEN,'['));
+	}
+
+	template<typename _T_DATA>
+	template<template<typename> class _T_STORAGE, typename _T_CHILD, char... _T_NAME>
+	JsonLazyMap<_T_CHILD> JsonLazyObject<_T_DATA>::getMap(JsonVarBasicMapObject<_T_STORAGE,_T_CHILD,_T_NAME...> _T_DATA::*property){
+		return JsonLazyMap<_T_CHILD>(__zj_document__,findProperty(JsonVarBasicMapObject<_T_STORAGE,_T_CHILD,_T_NAME...>::VARIABLE_NAME,JsonVarBasicMapObject<_T_STORAGE,_T_CHILD,_T_NAME...>::VARIABLE_NAME_LEN,'{'));
+	}
+};
+
+#endif
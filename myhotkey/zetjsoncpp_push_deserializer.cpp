@@ -0,0 +1,405 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "zetjsoncpp.h"
+
+namespace zetjsoncpp{
+
+	static const uint8_t bom_signature[]={0xef,0xbb,0xbf};
+
+	PushDeserializer::PushDeserializer(JsonVar *json_var, const char *filename){
+		__zj_deserialize_data__.filename=filename;
+		__zj_deserialize_data__.str_start=NULL;
+		__zj_deserialize_data__.n_threads=1;
+		__zj_deserialize_data__.in_situ=false;
+		__zj_deserialize_data__.skip_unmapped=false;
+		__zj_json_var_value__=json_var;
+		__zj_lex_state__=LEX_NONE;
+		__zj_parse_state__=PARSE_VALUE;
+		__zj_is_key__=false;
+		__zj_is_escaped__=false;
+		__zj_bom_state__=0;
+		__zj_line__=1;
+		__zj_offset__=0;
+		__zj_token_offset__=0;
+	}
+
+	void PushDeserializer::feed(const char *chunk, size_t chunk_len){
+		if(!tryFeed(chunk,chunk_len)){
+			throw_deserialize_error(getError(),__zj_deserialize_data__.filename);
+		}
+	}
+
+	void PushDeserializer::finish(){
+		if(!tryFinish()){
+			throw_deserialize_error(getError(),__zj_deserialize_data__.filename);
+		}
+	}
+
+	bool PushDeserializer::tryFeed(const char *chunk, size_t chunk_len){
+		const char *end=chunk+chunk_len;
+
+		// ignore BOM signature (it may be split between chunks)
+		while(__zj_bom_state__ >= 0 && chunk < end){
+			if((uint8_t)*chunk == bom_signature[__zj_bom_state__]){
+				chunk++;
+				__zj_offset__++;
+				if(++__zj_bom_state__ == sizeof(bom_signature)){
+					__zj_bom_state__=-1;
+				}
+			}else{ // not a BOM, give back the bytes that matched
+				int matched=__zj_bom_state__;
+				__zj_bom_state__=-1;
+				for(int i=0; i < matched; i++){
+					parseChar((char)bom_signature[i]);
+				}
+			}
+		}
+
+		for(; chunk < end && __zj_parse_state__ < PARSE_DONE; chunk++, __zj_offset__++){
+			parseChar(*chunk);
+		}
+
+		return __zj_parse_state__ != PARSE_ERROR;
+	}
+
+	bool PushDeserializer::tryFinish(){
+		if(__zj_bom_state__ > 0){ // input was a BOM prefix only
+			int matched=__zj_bom_state__;
+			__zj_bom_state__=-1;
+			for(int i=0; i < matched; i++){
+				parseChar((char)bom_signature[i]);
+			}
+		}
+
+		if(__zj_parse_state__ < PARSE_DONE){
+			// end of input ends the last primitive as the NUL terminator does in deserialize
+			parseChar(0);
+		}
+
+		if(__zj_parse_state__ < PARSE_DONE){
+			error(DESERIALIZE_ERROR_UNEXPECTED_END);
+		}
+
+		return __zj_parse_state__ != PARSE_ERROR;
+	}
+
+	const DeserializeError & PushDeserializer::getError() const{
+		return __zj_deserialize_data__.error;
+	}
+
+	bool PushDeserializer::isDone() const{
+		return __zj_parse_state__ == PARSE_DONE;
+	}
+
+	void PushDeserializer::parseChar(char c){
+
+		if(__zj_parse_state__ == PARSE_ERROR){
+			return;
+		}
+
+		switch(__zj_lex_state__){
+		case LEX_STRING:
+			if(c == '\n' || c == '\r' || c == 0){
+				error(DESERIALIZE_ERROR_STRING_NOT_CLOSED);
+				return;
+			}
+
+			__zj_token__+=c;
+			if(c == '\"' && !__zj_is_escaped__){
+				__zj_lex_state__=LEX_NONE;
+				endString();
+			}
+			__zj_is_escaped__=!__zj_is_escaped__ && c == '\\'; // an escaped backslash doesn't escape the next char
+			return;
+		case LEX_PRIMITIVE:
+			if(c != 0 && !zj_scan::is_class(c,end_class_standard_value | zj_scan::CHAR_CLASS_COMMENT)){
+				__zj_token__+=c;
+				return;
+			}
+			__zj_lex_state__=LEX_NONE;
+			endPrimitive();
+			break; // c still has to be processed
+		case LEX_COMMENT_START:
+			if(c == '/'){
+				__zj_lex_state__=LEX_LINE_COMMENT;
+			}else if(c == '*'){
+				__zj_lex_state__=LEX_BLOCK_COMMENT;
+			}else{
+				error(DESERIALIZE_ERROR_UNEXPECTED_CHAR,"/",1);
+			}
+			return;
+		case LEX_LINE_COMMENT:
+			if(c != '\n' && c != 0){
+				return;
+			}
+			__zj_lex_state__=LEX_NONE;
+			break; // new line still has to be counted
+		case LEX_BLOCK_COMMENT:
+		case LEX_BLOCK_COMMENT_END:
+			if(c == '\n'){
+				__zj_line__++;
+			}
+
+			if(__zj_lex_state__ == LEX_BLOCK_COMMENT_END && c == '/'){
+				__zj_lex_state__=LEX_NONE;
+			}else{
+				__zj_lex_state__=c=='*'?LEX_BLOCK_COMMENT_END:LEX_BLOCK_COMMENT;
+			}
+			return;
+		default:
+			break;
+		}
+
+		if(__zj_parse_state__ >= PARSE_DONE){
+			return;
+		}
+
+		if(c == '\n'){
+			__zj_line__++;
+			return;
+		}
+
+		if(c == '\r' || zj_scan::is_class(c,zj_scan::CHAR_CLASS_BLANK)){
+			return;
+		}
+
+		if(c == '/'){
+			__zj_lex_state__=LEX_COMMENT_START;
+			return;
+		}
+
+		switch(__zj_parse_state__){
+		case PARSE_VALUE_OR_END:
+			if(c == ']'){
+				closeFrame();
+				return;
+			}
+			__zj_json_var_value__=NULL;
+			if(__zj_frames__.back().json_var != NULL){
+				__zj_json_var_value__=__zj_frames__.back().json_var->newJsonVar();
+			}
+			beginValue(c);
+			return;
+		case PARSE_VALUE:
+			beginValue(c);
+			return;
+		case PARSE_KEY_OR_END:
+			if(c == '}'){
+				closeFrame();
+				return;
+			}
+
+			if(c != '\"'){
+				error(DESERIALIZE_ERROR_EXPECTED_STRING);
+				return;
+			}
+			__zj_is_key__=true;
+			__zj_is_escaped__=false;
+			__zj_token__.assign(1,c);
+			__zj_token_offset__=__zj_offset__;
+			__zj_lex_state__=LEX_STRING;
+			return;
+		case PARSE_COLON:
+			if(c != ':'){
+				error(DESERIALIZE_ERROR_EXPECTED_COLON);
+				return;
+			}
+			__zj_parse_state__=PARSE_VALUE;
+			return;
+		case PARSE_COMMA_OR_END:
+			if(__zj_frames__.back().is_object){
+				if(c == ','){
+					__zj_parse_state__=PARSE_KEY_OR_END;
+				}else if(c == '}'){
+					closeFrame();
+				}else{
+					error(DESERIALIZE_ERROR_EXPECTED_OBJECT_END);
+				}
+			}else{
+				if(c == ','){
+					__zj_parse_state__=PARSE_VALUE_OR_END;
+				}else if(c == ']'){
+					closeFrame();
+				}else{
+					error(DESERIALIZE_ERROR_EXPECTED_VECTOR_END);
+				}
+			}
+			return;
+		default:
+			break;
+		}
+	}
+
+	void PushDeserializer::beginValue(char c){
+		JsonVar *json_var=__zj_json_var_value__;
+		JsonVarType type=json_var!=NULL?json_var->getType():JsonVarType::JSON_VAR_TYPE_UNKNOWN;
+
+		if(c == '{' || c == '['){
+			if(json_var == NULL){ // not mapped, parse but not save
+				openFrame(c == '{');
+				return;
+			}
+
+			switch(type){
+			case JsonVarType::JSON_VAR_TYPE_BOOLEAN:
+			case JsonVarType::JSON_VAR_TYPE_NUMBER:
+			case JsonVarType::JSON_VAR_TYPE_DOUBLE:
+			case JsonVarType::JSON_VAR_TYPE_INT64:
+			case JsonVarType::JSON_VAR_TYPE_STRING:
+			case JsonVarType::JSON_VAR_TYPE_STRING_VIEW:
+				error(DESERIALIZE_ERROR_INVALID_VALUE,&c,1,json_var->getTypeStr());
+				return;
+			default:
+				break;
+			}
+
+			if((type & JsonVarType::JSON_VAR_TYPE_VECTOR) == JsonVarType::JSON_VAR_TYPE_VECTOR){
+				if(c != '['){
+					error(DESERIALIZE_ERROR_EXPECTED_VECTOR);
+					return;
+				}
+			}else if(c != '{'){
+				error(DESERIALIZE_ERROR_EXPECTED_OBJECT,NULL,0,json_var->getTypeStr());
+				return;
+			}
+
+			openFrame(c == '{');
+			return;
+		}
+
+		if(json_var != NULL){
+			if((type & JsonVarType::JSON_VAR_TYPE_VECTOR) == JsonVarType::JSON_VAR_TYPE_VECTOR){
+				error(DESERIALIZE_ERROR_EXPECTED_VECTOR);
+				return;
+			}else if((type & (JsonVarType::JSON_VAR_TYPE_MAP | JsonVarType::JSON_VAR_TYPE_OBJECT)) != 0){
+				error(DESERIALIZE_ERROR_EXPECTED_OBJECT,NULL,0,json_var->getTypeStr());
+				return;
+			}
+		}
+
+		__zj_token__.assign(1,c);
+		__zj_token_offset__=__zj_offset__;
+		if(c == '\"'){
+			__zj_is_key__=false;
+			__zj_is_escaped__=false;
+			__zj_lex_state__=LEX_STRING;
+		}else if(c == ',' || c == '}' || c == ']'){ // empty value
+			__zj_token__.clear();
+			endPrimitive();
+			parseChar(c);
+		}else{
+			__zj_lex_state__=LEX_PRIMITIVE;
+		}
+	}
+
+	void PushDeserializer::endString(){
+
+		if(__zj_is_key__){ // key of object or map
+			PushFrame & frame=__zj_frames__.back();
+			const char *key_id=NULL;
+			size_t key_id_len=0;
+			std::string key_decoded; // for keys with escapes
+			JsonVar *json_var=frame.json_var;
+			int property_index=-1;
+			int line=__zj_line__;
+
+			__zj_deserialize_data__.str_start=__zj_token__.c_str();
+			if(read_string_between_quotes(&__zj_deserialize_data__,__zj_token__.c_str(),line,&key_id,&key_id_len,&key_decoded) == NULL){
+				__zj_deserialize_data__.error.offset+=__zj_token_offset__; // offset is from the start of the token
+				__zj_parse_state__=PARSE_ERROR;
+				return;
+			}
+
+			__zj_json_var_value__=NULL;
+			if(json_var==NULL || json_var->getType() == JsonVarType::JSON_VAR_TYPE_OBJECT){
+				__zj_json_var_value__=find_property(json_var, key_id, key_id_len, property_index);
+				if(__zj_json_var_value__ != NULL){
+					if(frame.parsed_properties[property_index]){
+						error(DESERIALIZE_ERROR_DUPLICATED_PROPERTY,key_id,key_id_len);
+						return;
+					}
+					frame.parsed_properties[property_index]=true;
+				}
+			}else{ // parse map...
+				try{
+					__zj_json_var_value__ = json_var->newJsonVar(std::string(key_id,key_id_len));
+				}catch(std::exception &ex){
+					error(DESERIALIZE_ERROR_INVALID_KEY,ex.what(),strlen(ex.what()));
+					return;
+				}
+			}
+
+			__zj_parse_state__=PARSE_COLON;
+			return;
+		}
+
+		endPrimitive();
+	}
+
+	void PushDeserializer::endPrimitive(){
+		// the whole token is available, so the value is converted as deserialize does
+		const char *str_start=__zj_token__.c_str();
+		int line=__zj_line__;
+
+		__zj_deserialize_data__.str_start=str_start;
+		const char *str_end=deserialize_json_var_value(&__zj_deserialize_data__,str_start,line,__zj_json_var_value__);
+
+		if(str_end == NULL){ // offset is from the start of the token
+			__zj_deserialize_data__.error.offset+=__zj_token_offset__;
+			__zj_parse_state__=PARSE_ERROR;
+			return;
+		}
+
+		if(str_end != str_start+__zj_token__.size()){
+			if(__zj_frames__.size() == 0){ // single value document, ignore the rest
+				__zj_parse_state__=PARSE_DONE;
+				return;
+			}
+			error(__zj_frames__.back().is_object?DESERIALIZE_ERROR_EXPECTED_OBJECT_END:DESERIALIZE_ERROR_EXPECTED_VECTOR_END);
+			return;
+		}
+
+		endValue();
+	}
+
+	void PushDeserializer::endValue(){
+		__zj_json_var_value__=NULL;
+		__zj_parse_state__=__zj_frames__.size()==0?PARSE_DONE:PARSE_COMMA_OR_END;
+	}
+
+	void PushDeserializer::openFrame(bool is_object){
+		PushFrame frame;
+		frame.json_var=__zj_json_var_value__;
+		frame.is_object=is_object;
+
+		if(is_object && frame.json_var != NULL){
+			const JsonVarPropertyTable *property_table=frame.json_var->getPropertyTable();
+			if(property_table != NULL){
+				frame.parsed_properties.assign(property_table->size(),false);
+			}
+		}
+
+		__zj_frames__.push_back(frame);
+		__zj_json_var_value__=NULL;
+		__zj_parse_state__=is_object?PARSE_KEY_OR_END:PARSE_VALUE_OR_END;
+	}
+
+	void PushDeserializer::closeFrame(){
+		JsonVar *json_var=__zj_frames__.back().json_var;
+		__zj_frames__.pop_back();
+
+		if(json_var != NULL){
+			json_var->setParsed(true);
+		}
+
+		endValue();
+	}
+
+	void PushDeserializer::error(DeserializeErrorCode code, const char *detail, size_t detail_len, const char *type_str){
+		__zj_deserialize_data__.error.set(code,__zj_offset__,__zj_line__,detail,detail_len,type_str);
+		__zj_parse_state__=PARSE_ERROR;
+	}
+}
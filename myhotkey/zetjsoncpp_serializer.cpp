@@ -5,201 +5,281 @@
 
 #include "zetjsoncpp.h"
 
-#define ZJ_FORMAT_OUTPUT_IDENT(str_value,ident)  for (int k = 0; k < (ident); k++) str_value += "\t";
-#define ZJ_FORMAT_OUTPUT_NEW_LINE(str_value,ident) \
-	str_value += "\n";\
-	for (int k = 0; k < (ident); k++)	str_value += "\t";
-
 namespace zetjsoncpp{
 
-	typedef struct{
+	void serialize_json_var(JsonSink & sink, JsonVar *json_var, int ident,bool minimized);
 
-	}TestVoid;
+	// numbers are written in a short form that reads back the same value (see zj_number::to_chars)
+	template<typename _T_VALUE>
+	void serialize_json_var_number(JsonSink & sink, _T_VALUE value){
+		char buffer[ZJ_NUMBER_MAX_CHARS];
+		sink.write(buffer,zj_number::to_chars(buffer,value)-buffer);
+	}
 
-	void serialize_json_var(std::string & str_result, JsonVar *json_var, int ident,bool minimized);
+	// Strings hold decoded content, so it's escaped again between quotes. The runs without
+	// chars to escape are found with zj_scan and written at once. str[str_len] must be '\0'.
+	void serialize_json_var_string(JsonSink & sink, const char *str, size_t str_len){
+		const char *str_end=str+str_len;
+		char escape[ZJ_STRING_MAX_ESCAPE_CHARS];
 
-	template<typename _T>
-	void serialize_json_var_map(std::string & str_result, _T * json_var_map, int ident, bool minimized) {
+		sink.write('\"');
+		for(;;){
+			const char *str_escape=zj_string::find_escape(str,str_end-str);
 
+			sink.write(str,str_escape-str);
+			if(str_escape == str_end){
+				break;
+			}
 
-		str_result += "{";
-
-		if (minimized==false){
-			ZJ_FORMAT_OUTPUT_NEW_LINE(str_result,ident+1);
+			sink.write(escape,zj_string::escape(*str_escape,escape));
+			str=str_escape+1;
 		}
+		sink.write('\"');
+	}
 
-		int j=0;
-		for (auto it=json_var_map->begin();it !=json_var_map->end();it++,j++) {
+	// writes the entries of any map, whatever its storage
+	class SerializeMapVisitor: public JsonVarMapVisitor{
+	public:
+		SerializeMapVisitor(JsonSink & _sink, int _ident, bool _minimized):sink(_sink){
+			ident=_ident;
+			minimized=_minimized;
+			n_entries=0;
+		}
 
-			if (j > 0){
+		virtual void visit(const std::string & key, JsonVar *json_var){
+			if (n_entries > 0){
 				if (minimized==false){
-					ZJ_FORMAT_OUTPUT_NEW_LINE(str_result,ident+1);
+					sink.writeNewLine(ident+1);
 				}
-				str_result += ",";
+				sink.write(',');
 			}
 
-			str_result += "\""+it->first +"\":";
-			serialize_json_var(str_result,json_var_map->getJsonVarPtr(it->first),ident+1,minimized);
+			serialize_json_var_string(sink,key.c_str(),key.size());
+			sink.write(':');
+			serialize_json_var(sink,json_var,ident+1,minimized);
+			n_entries++;
+		}
+
+	private:
+		JsonSink & sink;
+		int ident;
+		bool minimized;
+		int n_entries;
+	};
 
+	void serialize_json_var_map(JsonSink & sink, JsonVar * json_var_map, int ident, bool minimized) {
+		SerializeMapVisitor visitor(sink,ident,minimized);
+
+		sink.write('{');
+
+		if (minimized==false){
+			sink.writeNewLine(ident+1);
 		}
 
+		json_var_map->visitMapEntries(visitor);
+
 		if (minimized==false){
-			ZJ_FORMAT_OUTPUT_NEW_LINE(str_result,ident);
+			sink.writeNewLine(ident);
 		}
-		str_result += "}";
+		sink.write('}');
 	}
 
 	template<typename _T>
-	void serialize_json_var_vector(std::string & str_result, _T * json_var_vector,int ident, bool minimized){
+	void serialize_json_var_vector(JsonSink & sink, _T * json_var_vector,int ident, bool minimized){
 
-		str_result+="[";
+		sink.write('[');
 
 		if (minimized==false && json_var_vector->getType() !=JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS){
-			ZJ_FORMAT_OUTPUT_NEW_LINE(str_result,ident+1);
+			sink.writeNewLine(ident+1);
 		}
 		for (unsigned i = 0; i < json_var_vector->size(); i++) {
 			if (i > 0) {
-				str_result += ",";
+				sink.write(',');
 			}
 
-			serialize_json_var(str_result,json_var_vector->getJsonVarPtr(i),ident,minimized);
+			serialize_json_var(sink,json_var_vector->getJsonVarPtr(i),ident,minimized);
 		}
 		if (minimized==false && json_var_vector->getType() !=JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS){
-			ZJ_FORMAT_OUTPUT_NEW_LINE(str_result,ident);
+			sink.writeNewLine(ident);
 		}
-		str_result+="]";
+		sink.write(']');
 	}
 
-	void serialize_json_var_object(std::string & str_result, JsonVar *json_var, int ident, bool minimized){
-		int k=0;
-
+	void serialize_json_var_object(JsonSink & sink, JsonVar *json_var, int ident, bool minimized){
 		if(json_var->getType() != JsonVarType::JSON_VAR_TYPE_OBJECT){
 			throw std::runtime_error(zj_strutils::format("Expected json object but it was %s",json_var->getTypeStr()));
 		}
 
-		str_result += "{";
+		sink.write('{');
 
 		if (minimized == false){
-			str_result += "\n";
+			sink.write('\n');
 		}
 
-		char *aux_p = (char *)json_var->getPtrDataStart();
-		char *end_p = (char *)json_var->getPtrDataEnd();
+		const JsonVarPropertyTable *property_table=json_var->getPropertyTable();
+		char *data_start = (char *)json_var->getPtrDataStart();
 
-		for (; aux_p < end_p; k++) {
-			JsonVar * p_sv = (JsonVar *)aux_p;
+		for (size_t k = 0; k < property_table->size(); k++) {
+			const JsonVarPropertyTable::JsonVarProperty & property=property_table->at(k);
+			JsonVar * p_sv = (JsonVar *)(data_start+property.offset);
 
-			if (p_sv != NULL) {
+			if (minimized==false){
+				sink.writeIdent(ident+1);
+			}
 
+			sink.write('\"');
+			sink.write(property.name.data(),property.name.size());
+			sink.write("\":",2);
+
+			switch (property.type)
+			{
+			case JsonVarType::JSON_VAR_TYPE_BOOLEAN:
+			case JsonVarType::JSON_VAR_TYPE_NUMBER:
+			case JsonVarType::JSON_VAR_TYPE_DOUBLE:
+			case JsonVarType::JSON_VAR_TYPE_INT64:
+			case JsonVarType::JSON_VAR_TYPE_STRING:
+			case JsonVarType::JSON_VAR_TYPE_STRING_VIEW:
+				serialize_json_var(sink,p_sv,0,minimized);
+				break;
+
+			case JsonVarType::JSON_VAR_TYPE_OBJECT:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_STRINGS:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_DOUBLES:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_INT64S:
+			case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_BOOLEANS:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_STRINGS:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_NUMBERS:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_DOUBLES:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_INT64S:
+			case JsonVarType::JSON_VAR_TYPE_MAP_OF_OBJECTS:
 				if (minimized==false){
-					for (int i = 0; i <= (ident); i++){
-						str_result += "\t";
-					}
-				}
-
-				str_result += "\"" + p_sv->getVariableName()+ "\":";
-
-				switch (p_sv->getType())// == )
-				{
-				case JsonVarType::JSON_VAR_TYPE_BOOLEAN:
-				case JsonVarType::JSON_VAR_TYPE_NUMBER:
-				case JsonVarType::JSON_VAR_TYPE_STRING:
-					serialize_json_var(str_result,p_sv,0,minimized);
-					break;
-
-				case JsonVarType::JSON_VAR_TYPE_OBJECT:
-				case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
-				case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_STRINGS:
-				case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
-				case JsonVarType::JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
-				case JsonVarType::JSON_VAR_TYPE_MAP_OF_BOOLEANS:
-				case JsonVarType::JSON_VAR_TYPE_MAP_OF_STRINGS:
-				case JsonVarType::JSON_VAR_TYPE_MAP_OF_NUMBERS:
-				case JsonVarType::JSON_VAR_TYPE_MAP_OF_OBJECTS:
-					if (minimized==false){
-						str_result += "\n";
-						for (int i = 0; i <= ident; i++){
-							str_result += "\t";
-						}
-					}
-					serialize_json_var(str_result,p_sv,ident+1, minimized);
-					break;
+					sink.writeNewLine(ident+1);
 				}
+				serialize_json_var(sink,p_sv,ident+1, minimized);
+				break;
+			default:
+				break;
 			}
-			aux_p += p_sv->getSizeData();
 
-			if (aux_p < end_p){
-				str_result += ",";
+			if (k+1 < property_table->size()){
+				sink.write(',');
 			}
 
 			if (minimized == false){
-				str_result += "\n";
+				sink.write('\n');
 			}
 
 		}
 
 		if (minimized == false){
-			for (int i = 0; i < ident; i++){
-				str_result += "\t";
-			}
+			sink.writeIdent(ident);
 		}
 
-		str_result += "}";
+		sink.write('}');
 
 		if (minimized == false){
 			"\n";
 		}
 	}
 
-	void serialize_json_var(std::string & str_result, JsonVar *json_var, int ident,bool minimized){
+	void serialize_json_var(JsonSink & sink, JsonVar *json_var, int ident,bool minimized){
 		switch(json_var->getType()){
 		default:
 			break;
 		case JSON_VAR_TYPE_BOOLEAN:
-			str_result+=(*((JsonVarBoolean<> *)json_var)==true)?"true":"false";
+			if(*((JsonVarBoolean<> *)json_var)==true){
+				sink.write("true",4);
+			}else{
+				sink.write("false",5);
+			}
 			break;
 		case JSON_VAR_TYPE_NUMBER:
-			str_result+=zj_strutils::float_to_str(*((JsonVarNumber<> *)json_var));
+			serialize_json_var_number(sink,(float)*((JsonVarNumber<> *)json_var));
+			break;
+		case JSON_VAR_TYPE_DOUBLE:
+			serialize_json_var_number(sink,(double)*((JsonVarDouble<> *)json_var));
+			break;
+		case JSON_VAR_TYPE_INT64:
+			serialize_json_var_number(sink,(int64_t)*((JsonVarInt64<> *)json_var));
 			break;
 		case JSON_VAR_TYPE_STRING:
-			str_result+=std::string("\"") + *((JsonVarString<> *)json_var) + "\"";
+			{
+				const std::string *value=(const std::string *)json_var->getPtrValue();
+				serialize_json_var_string(sink,value->c_str(),value->size());
+			}
+			break;
+		case JSON_VAR_TYPE_STRING_VIEW:
+			{
+				JsonVarStringView<> *json_var_string_view=(JsonVarStringView<> *)json_var;
+				serialize_json_var_string(sink,json_var_string_view->c_str(),json_var_string_view->size());
+			}
 			break;
 		case JSON_VAR_TYPE_OBJECT:
-			serialize_json_var_object(str_result, json_var,ident,minimized);
+			serialize_json_var_object(sink, json_var,ident,minimized);
 			break;
 		case JSON_VAR_TYPE_VECTOR_OF_BOOLEANS:
-			serialize_json_var_vector<JsonVarVectorBoolean<>>(str_result, (JsonVarVectorBoolean<> *)json_var,ident,minimized);
+			serialize_json_var_vector<JsonVarVectorBoolean<>>(sink, (JsonVarVectorBoolean<> *)json_var,ident,minimized);
 			break;
 		case JSON_VAR_TYPE_VECTOR_OF_NUMBERS:
-			serialize_json_var_vector<JsonVarVectorNumber<>>(str_result,(JsonVarVectorNumber<> *)json_var,ident,minimized);
+			serialize_json_var_vector<JsonVarVectorNumber<>>(sink,(JsonVarVectorNumber<> *)json_var,ident,minimized);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_DOUBLES:
+			serialize_json_var_vector<JsonVarVectorDouble<>>(sink,(JsonVarVectorDouble<> *)json_var,ident,minimized);
+			break;
+		case JSON_VAR_TYPE_VECTOR_OF_INT64S:
+			serialize_json_var_vector<JsonVarVectorInt64<>>(sink,(JsonVarVectorInt64<> *)json_var,ident,minimized);
 			break;
 		case JSON_VAR_TYPE_VECTOR_OF_STRINGS:
-			serialize_json_var_vector<JsonVarVectorString<>>(str_result,(JsonVarVectorString<> *)(json_var),ident,minimized);
+			serialize_json_var_vector<JsonVarVectorString<>>(sink,(JsonVarVectorString<> *)(json_var),ident,minimized);
 			break;
 		case JSON_VAR_TYPE_VECTOR_OF_OBJECTS:
-			serialize_json_var_vector<JsonVarVectorObject<TestVoid>>(str_result,(JsonVarVectorObject<TestVoid> *)json_var,ident,minimized);
+			serialize_json_var_vector<JsonVarVectorObject<TestVoid>>(sink,(JsonVarVectorObject<TestVoid> *)json_var,ident,minimized);
 			break;
 		case JSON_VAR_TYPE_MAP_OF_BOOLEANS:
-			serialize_json_var_map<JsonVarMapBoolean<>>(str_result, (JsonVarMapBoolean<> *)json_var,ident,minimized);
-			break;
 		case JSON_VAR_TYPE_MAP_OF_NUMBERS:
-			serialize_json_var_map<JsonVarMapNumber<>>(str_result, (JsonVarMapNumber<> *)json_var,ident,minimized);
-			break;
+		case JSON_VAR_TYPE_MAP_OF_DOUBLES:
+		case JSON_VAR_TYPE_MAP_OF_INT64S:
 		case JSON_VAR_TYPE_MAP_OF_STRINGS:
-			serialize_json_var_map<JsonVarMapString<>>(str_result, (JsonVarMapString<> *)json_var,ident,minimized);
-			break;
 		case JSON_VAR_TYPE_MAP_OF_OBJECTS:
-			serialize_json_var_map<JsonVarMapObject<TestVoid>>(str_result, (JsonVarMapObject<TestVoid> *)json_var,ident,minimized);
+			serialize_json_var_map(sink, json_var,ident,minimized);
 			break;
 		}
 	}
 
 	std::string serialize(JsonVar *json_var, bool minimized){
-		std::string serialized_var="";
+		JsonSinkChunked sink;
 
-		serialize_json_var(serialized_var,json_var,0,minimized);
+		serialize_json_var(sink,json_var,0,minimized);
 
-		return serialized_var;
+		return sink.toString();
+	}
+
+	void serialize(JsonVar *json_var, JsonSink & sink, bool minimized){
+		serialize_json_var(sink,json_var,0,minimized);
+	}
+
+	void serialize_file(JsonVar *json_var, const std::string & filename, bool minimized){
+		FILE *fp;
+
+		if((fp=fopen(filename.c_str(),"wb")) == NULL){
+			throw std::runtime_error("I can't open file \""+filename+"\"");
+		}
+
+		try{
+			JsonSinkFile sink(fp);
+			serialize_json_var(sink,json_var,0,minimized);
+			sink.flush();
+		}catch(...){
+			fclose(fp);
+			throw;
+		}
+
+		if(fclose(fp) != 0){
+			throw std::runtime_error("I can't write file \""+filename+"\"");
+		}
 	}
 
 
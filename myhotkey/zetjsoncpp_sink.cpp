@@ -0,0 +1,239 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+
+#include "zetjsoncpp.h"
+#include <errno.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define ZJ_SINK_WRITE(fd,str,str_len) _write(fd,str,(unsigned)(str_len))
+#else
+#include <unistd.h>
+#define ZJ_SINK_WRITE(fd,str,str_len) ::write(fd,str,str_len)
+#endif
+
+#define ZJ_SINK_TABS_LEN 64
+
+namespace zetjsoncpp {
+
+	//-------------------------------------------------------------------------------------
+	// JsonSink
+
+	void JsonSink::writeIdent(int ident){
+		static const std::string tabs(ZJ_SINK_TABS_LEN,'\t');
+
+		while(ident > ZJ_SINK_TABS_LEN){
+			write(tabs.c_str(),ZJ_SINK_TABS_LEN);
+			ident-=ZJ_SINK_TABS_LEN;
+		}
+
+		if(ident > 0){
+			write(tabs.c_str(),ident);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------
+	// JsonSinkChunked
+
+	JsonSinkChunked::JsonSinkChunked(size_t chunk_size){
+		__zj_chunk_size__=chunk_size>0?chunk_size:ZJ_SINK_CHUNK_SIZE;
+		__zj_size_full_chunks__=0;
+	}
+
+	void JsonSinkChunked::newChunk(size_t min_capacity){
+		Chunk chunk;
+
+		if(__zj_chunks__.size() > 0){
+			__zj_size_full_chunks__+=__zj_current__-__zj_chunks__.back().data;
+			// chunks grows with the output, so big documents need few allocations
+			if(__zj_chunk_size__ < ZJ_SINK_MAX_CHUNK_SIZE){
+				__zj_chunk_size__*=2;
+			}
+		}
+
+		chunk.capacity=__zj_chunk_size__>min_capacity?__zj_chunk_size__:min_capacity;
+		chunk.data=(char *)malloc(chunk.capacity);
+		if(chunk.data == NULL){
+			throw std::runtime_error("JsonSinkChunked: out of memory");
+		}
+
+		__zj_chunks__.push_back(chunk);
+		__zj_current__=chunk.data;
+		__zj_end__=chunk.data+chunk.capacity;
+	}
+
+	void JsonSinkChunked::overflow(const char *str, size_t str_len){
+		size_t room=__zj_end__-__zj_current__;
+
+		// fill the current chunk and put the rest in a new one
+		if(room > 0){
+			memcpy(__zj_current__,str,room);
+			__zj_current__+=room;
+			str+=room;
+			str_len-=room;
+		}
+
+		newChunk(str_len);
+		memcpy(__zj_current__,str,str_len);
+		__zj_current__+=str_len;
+	}
+
+	size_t JsonSinkChunked::size() const{
+		if(__zj_chunks__.size() == 0){
+			return 0;
+		}
+
+		return __zj_size_full_chunks__+(__zj_current__-__zj_chunks__.back().data);
+	}
+
+	void JsonSinkChunked::copyTo(char *buffer) const{
+		for(size_t i=0; i < __zj_chunks__.size(); i++){
+			const Chunk & chunk=__zj_chunks__[i];
+			size_t chunk_len=i+1<__zj_chunks__.size()?chunk.capacity:__zj_current__-chunk.data;
+			memcpy(buffer,chunk.data,chunk_len);
+			buffer+=chunk_len;
+		}
+	}
+
+	std::string JsonSinkChunked::toString() const{
+		std::string str(size(),0);
+
+		if(str.size() > 0){
+			copyTo(&str[0]);
+		}
+
+		return str;
+	}
+
+	void JsonSinkChunked::writeTo(JsonSink & sink) const{
+		for(size_t i=0; i < __zj_chunks__.size(); i++){
+			const Chunk & chunk=__zj_chunks__[i];
+			sink.write(chunk.data,i+1<__zj_chunks__.size()?chunk.capacity:__zj_current__-chunk.data);
+		}
+	}
+
+	void JsonSinkChunked::clear(){
+		for(size_t i=0; i < __zj_chunks__.size(); i++){
+			free(__zj_chunks__[i].data);
+		}
+
+		__zj_chunks__.clear();
+		__zj_size_full_chunks__=0;
+		__zj_current__=NULL;
+		__zj_end__=NULL;
+	}
+
+	JsonSinkChunked::~JsonSinkChunked(){
+		clear();
+	}
+
+	//-------------------------------------------------------------------------------------
+	// JsonSinkBuffer
+
+	JsonSinkBuffer::JsonSinkBuffer(char *buffer, size_t buffer_size){
+		__zj_buffer__=buffer;
+		__zj_current__=buffer;
+		__zj_end__=buffer+buffer_size;
+		__zj_size_truncated__=0;
+	}
+
+	void JsonSinkBuffer::overflow(const char *str, size_t str_len){
+		size_t room=__zj_end__-__zj_current__;
+
+		if(room > 0){
+			memcpy(__zj_current__,str,room);
+			__zj_current__+=room;
+		}
+		__zj_size_truncated__+=str_len-room;
+	}
+
+	size_t JsonSinkBuffer::size() const{
+		return (__zj_current__-__zj_buffer__)+__zj_size_truncated__;
+	}
+
+	bool JsonSinkBuffer::isTruncated() const{
+		return __zj_size_truncated__ > 0;
+	}
+
+	//-------------------------------------------------------------------------------------
+	// JsonSinkFile
+
+	JsonSinkFile::JsonSinkFile(FILE *fp, size_t buffer_size){
+		__zj_fp__=fp;
+		__zj_fd__=-1;
+		init(buffer_size);
+	}
+
+	JsonSinkFile::JsonSinkFile(int fd, size_t buffer_size){
+		__zj_fp__=NULL;
+		__zj_fd__=fd;
+		init(buffer_size);
+	}
+
+	void JsonSinkFile::init(size_t buffer_size){
+		__zj_buffer__.resize(buffer_size>0?buffer_size:ZJ_SINK_CHUNK_SIZE);
+		__zj_current__=&__zj_buffer__[0];
+		__zj_end__=__zj_current__+__zj_buffer__.size();
+	}
+
+	void JsonSinkFile::writeToDestination(const char *str, size_t str_len){
+		if(__zj_fp__ != NULL){
+			if(fwrite(str,1,str_len,__zj_fp__) != str_len){
+				throw std::runtime_error("JsonSinkFile: cannot write to file");
+			}
+			return;
+		}
+
+		while(str_len > 0){
+			auto written=ZJ_SINK_WRITE(__zj_fd__,str,str_len);
+			if(written < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				throw std::runtime_error(zj_strutils::format("JsonSinkFile: cannot write to file descriptor (%s)",strerror(errno)));
+			}
+			str+=written;
+			str_len-=written;
+		}
+	}
+
+	void JsonSinkFile::flush(){
+		char *start=&__zj_buffer__[0];
+		size_t pending=__zj_current__-start;
+
+		// buffer is released before writing, so a failed flush doesn't write twice the same data
+		__zj_current__=start;
+		if(pending > 0){
+			writeToDestination(start,pending);
+		}
+
+		if(__zj_fp__ != NULL && fflush(__zj_fp__) != 0){
+			throw std::runtime_error("JsonSinkFile: cannot write to file");
+		}
+	}
+
+	void JsonSinkFile::overflow(const char *str, size_t str_len){
+		char *start=&__zj_buffer__[0];
+		size_t pending=__zj_current__-start;
+
+		__zj_current__=start;
+		writeToDestination(start,pending);
+
+		if(str_len >= __zj_buffer__.size()){ // big blocks goes straight to destination
+			writeToDestination(str,str_len);
+		}else{
+			memcpy(__zj_current__,str,str_len);
+			__zj_current__+=str_len;
+		}
+	}
+
+	JsonSinkFile::~JsonSinkFile(){
+		try{
+			flush();
+		}catch(std::exception &){
+		}
+	}
+
+};
@@ -0,0 +1,150 @@
+/*
+ *  This file is distributed under the MIT License.
+ *  See LICENSE file for details.
+ */
+#ifndef __ZJ_SINK_H__
+#define __ZJ_SINK_H__
+
+#define ZJ_SINK_CHUNK_SIZE		65536
+#define ZJ_SINK_MAX_CHUNK_SIZE	(16*1024*1024)
+
+namespace zetjsoncpp {
+
+	// Output of the serializer. Writes are copied into the window [current,end) and
+	// only when it's full the derived sink is called through overflow, so the common
+	// case is an inline memcpy.
+	class JsonSink{
+	public:
+
+		JsonSink(){
+			__zj_current__=NULL;
+			__zj_end__=NULL;
+		}
+
+		inline void write(const char *str, size_t str_len){
+			if(str_len <= (size_t)(__zj_end__-__zj_current__)){
+				memcpy(__zj_current__,str,str_len);
+				__zj_current__+=str_len;
+			}else{
+				overflow(str,str_len);
+			}
+		}
+
+		inline void write(char c){
+			if(__zj_current__ < __zj_end__){
+				*__zj_current__++=c;
+			}else{
+				overflow(&c,1);
+			}
+		}
+
+		inline void write(const std::string & str){
+			write(str.c_str(),str.size());
+		}
+
+		// writes n tabs
+		void writeIdent(int ident);
+
+		// writes a new line followed by n tabs
+		void writeNewLine(int ident){
+			write('\n');
+			writeIdent(ident);
+		}
+
+		// writes pending data to its destination, if any
+		virtual void flush(){}
+
+		virtual ~JsonSink(){}
+
+	protected:
+		char *__zj_current__;
+		char *__zj_end__;
+
+		// called when str doesn't fit in [current,end). It has to write str and it may set a new window.
+		virtual void overflow(const char *str, size_t str_len)=0;
+	};
+
+	// Growable buffer. Chunks are never moved once written, so growing doesn't copy
+	// the output written so far.
+	class JsonSinkChunked: public JsonSink{
+	public:
+
+		JsonSinkChunked(size_t chunk_size=ZJ_SINK_CHUNK_SIZE);
+
+		size_t size() const;
+
+		std::string toString() const;
+
+		// copies the output to buffer, which must have size() bytes at least
+		void copyTo(char *buffer) const;
+
+		void writeTo(JsonSink & sink) const;
+
+		void clear();
+
+		virtual ~JsonSinkChunked();
+
+	protected:
+		virtual void overflow(const char *str, size_t str_len);
+
+	private:
+
+		typedef struct{
+			char *data;
+			size_t capacity;
+		}Chunk;
+
+		std::vector<Chunk> __zj_chunks__;
+		size_t __zj_chunk_size__;
+		size_t __zj_size_full_chunks__; // bytes written in all chunks but the last
+
+		void newChunk(size_t min_capacity);
+	};
+
+	// Fixed buffer provided by the caller. Output that doesn't fit is discarded but
+	// counted, so size() returns the buffer size needed (as snprintf does).
+	class JsonSinkBuffer: public JsonSink{
+	public:
+
+		JsonSinkBuffer(char *buffer, size_t buffer_size);
+
+		size_t size() const;
+
+		bool isTruncated() const;
+
+	protected:
+		virtual void overflow(const char *str, size_t str_len);
+
+	private:
+		char *__zj_buffer__;
+		size_t __zj_size_truncated__;
+	};
+
+	// Writes to a FILE* or a file descriptor in blocks of buffer_size bytes. It throws
+	// std::runtime_error if the destination fails.
+	class JsonSinkFile: public JsonSink{
+	public:
+
+		JsonSinkFile(FILE *fp, size_t buffer_size=ZJ_SINK_CHUNK_SIZE);
+		JsonSinkFile(int fd, size_t buffer_size=ZJ_SINK_CHUNK_SIZE);
+
+		virtual void flush();
+
+		// pending data is flushed, but errors are ignored at this point (call flush before to check them)
+		virtual ~JsonSinkFile();
+
+	protected:
+		virtual void overflow(const char *str, size_t str_len);
+
+	private:
+		FILE *__zj_fp__;
+		int __zj_fd__;
+		std::vector<char> __zj_buffer__;
+
+		void init(size_t buffer_size);
+		void writeToDestination(const char *str, size_t str_len);
+	};
+
+};
+
+#endif